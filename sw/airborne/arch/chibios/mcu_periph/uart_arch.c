@@ -1035,11 +1035,7 @@ void uart_put_buffer(struct uart_periph *p, long fd, const uint8_t *data, uint16
     }
   }
   // insert data into buffer
-  int i;
-  for (i = 0; i < len; i++) {
-    p->tx_buf[p->tx_insert_idx] = data[i];
-    p->tx_insert_idx = (p->tx_insert_idx + 1) % UART_TX_BUFFER_SIZE;
-  }
+  uart_tx_buffer_insert(p, data, len);
   // unlock if needed
   if (fd == 0) {
     chMtxUnlock(init_struct->tx_mtx);
@@ -286,6 +286,25 @@ void uart_put_byte(struct uart_periph *periph, long fd __attribute__((unused)),
   }
 }
 
+void uart_put_buffer(struct uart_periph *periph, long fd __attribute__((unused)), const uint8_t *data, uint16_t len)
+{
+  if (periph->reg_addr == NULL) { return; } // device not initialized ?
+
+  /* write the whole buffer to serial port, usually in a single call */
+  struct SerialPort *port = (struct SerialPort *)(periph->reg_addr);
+
+  uint16_t sent = 0;
+  while (sent < len) {
+    int ret = write((int)(port->fd), data + sent, len - sent);
+    if (ret > 0) {
+      sent += ret;
+    } else if (ret < 0 && errno != EAGAIN) { //FIXME: max retry
+      TRACE("uart_put_buffer: write %d bytes failed [%d: %s]\n", len - sent, ret, strerror(errno));
+      break;
+    }
+  }
+}
+
 
 static void __attribute__((unused)) uart_receive_handler(struct uart_periph *periph)
 {
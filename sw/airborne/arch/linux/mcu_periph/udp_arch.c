@@ -27,8 +27,10 @@
 #include "udp_socket.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <errno.h>
 #include <pthread.h>
+#include <unistd.h>
 #include <sys/select.h>
 
 #include "rt_priority.h"
@@ -40,9 +42,46 @@
 static void *udp_thread(void *data __attribute__((unused)));
 static pthread_mutex_t udp_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/** Parameters of the UDP peripherals, to recreate their sockets */
+struct udp_arch_config {
+  struct udp_periph *p;
+  char host[64];
+  int port_out;
+  int port_in;
+  bool broadcast;
+};
+
+#define UDP_ARCH_NB_PERIPH 3
+static struct udp_arch_config udp_arch_configs[UDP_ARCH_NB_PERIPH];
+static int udp_arch_nb_configs = 0;
+
+/** The reading thread is not duplicated by fork, keep udp_mutex consistent */
+static void udp_arch_fork_prepare(void)
+{
+  pthread_mutex_lock(&udp_mutex);
+}
+
+static void udp_arch_fork_release(void)
+{
+  pthread_mutex_unlock(&udp_mutex);
+}
+
+static void udp_arch_start_thread(void)
+{
+  pthread_t tid;
+  if (pthread_create(&tid, NULL, udp_thread, NULL) != 0) {
+    fprintf(stderr, "udp_arch_init: Could not create UDP reading thread.\n");
+    return;
+  }
+#ifndef __APPLE__
+  pthread_setname_np(tid, "udp");
+#endif
+}
+
 void udp_arch_init(void)
 {
   pthread_mutex_init(&udp_mutex, NULL);
+  pthread_atfork(udp_arch_fork_prepare, udp_arch_fork_release, udp_arch_fork_release);
 
 #ifdef USE_UDP0
   UDP0Init();
@@ -54,14 +93,30 @@ void udp_arch_init(void)
   UDP2Init();
 #endif
 
-  pthread_t tid;
-  if (pthread_create(&tid, NULL, udp_thread, NULL) != 0) {
-    fprintf(stderr, "udp_arch_init: Could not create UDP reading thread.\n");
-    return;
+  udp_arch_start_thread();
+}
+
+/**
+ * Recreate the UDP sockets with shifted ports and start a new reading thread.
+ * Used in a forked simulation process that must not share its link with the
+ * parent.
+ */
+void udp_arch_reopen(int port_offset)
+{
+  for (int i = 0; i < udp_arch_nb_configs; i++) {
+    struct udp_arch_config *c = &udp_arch_configs[i];
+    struct UdpSocket *sock = (struct UdpSocket *) c->p->network;
+    int port_in = c->port_in < 0 ? c->port_in : c->port_in + port_offset;
+    close(sock->sockfd);
+    if (udp_socket_create(sock, c->host, c->port_out + port_offset, port_in, c->broadcast) < 0) {
+      fprintf(stderr, "udp_arch_reopen: Could not create UDP socket on port %d.\n", c->port_out + port_offset);
+    }
+    pthread_mutex_lock(&udp_mutex);
+    c->p->rx_insert_idx = 0;
+    c->p->rx_extract_idx = 0;
+    pthread_mutex_unlock(&udp_mutex);
   }
-#ifndef __APPLE__
-  pthread_setname_np(tid, "udp");
-#endif
+  udp_arch_start_thread();
 }
 
 /**
@@ -73,6 +128,16 @@ void udp_arch_periph_init(struct udp_periph *p, char *host, int port_out, int po
   struct UdpSocket *sock = malloc(sizeof(struct UdpSocket));
   udp_socket_create(sock, host, port_out, port_in, broadcast);
   p->network = (void *)sock;
+
+  if (udp_arch_nb_configs < UDP_ARCH_NB_PERIPH) {
+    struct udp_arch_config *c = &udp_arch_configs[udp_arch_nb_configs++];
+    c->p = p;
+    strncpy(c->host, host, sizeof(c->host) - 1);
+    c->host[sizeof(c->host) - 1] = '\0';
+    c->port_out = port_out;
+    c->port_in = port_in;
+    c->broadcast = broadcast;
+  }
 }
 
 /**
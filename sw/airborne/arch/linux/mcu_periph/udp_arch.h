@@ -31,4 +31,10 @@
 
 extern void udp_arch_init(void);
 
+/**
+ * Recreate the UDP sockets with all ports shifted by port_offset and restart
+ * the reading thread, e.g. in a forked simulation process.
+ */
+extern void udp_arch_reopen(int port_offset);
+
 #endif /* UDP_ARCH_H */
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file arch/linux/shm_bus.c
+ *
+ * Binary message bus between processes of the same host, in shared memory.
+ *
+ * A slot sequence stamp is 2 * (seq + 1) when the message seq is complete
+ * and 2 * seq + 1 while it is being written.
+ */
+
+#define _GNU_SOURCE
+
+#include "arch/linux/shm_bus.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/** Size of the header, the slots start on a cache line */
+#define SHM_BUS_HEADER_SIZE 64
+/** Time to wait for another process to initialize a topic */
+#define SHM_BUS_OPEN_TIMEOUT_MS 1000
+
+struct ShmBusSlot {
+  uint64_t seq;             ///< sequence stamp
+  uint32_t len;             ///< payload length
+  uint32_t pad;
+  uint8_t data[];
+};
+
+static inline struct ShmBusSlot *shm_bus_slot(struct ShmBus *bus, uint64_t seq)
+{
+  return (struct ShmBusSlot *)(bus->slots + (seq & (bus->hdr->nb_slots - 1)) * bus->stride);
+}
+
+static int shm_bus_futex(uint32_t *addr, int op, uint32_t val, const struct timespec *timeout)
+{
+  return syscall(SYS_futex, addr, op, val, timeout, NULL, 0);
+}
+
+static int shm_bus_map(struct ShmBus *bus, int fd, size_t size)
+{
+  void *m = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (m == MAP_FAILED) {
+    return -1;
+  }
+  bus->hdr = (struct ShmBusHeader *)m;
+  bus->slots = (uint8_t *)m + SHM_BUS_HEADER_SIZE;
+  bus->map_size = size;
+  return 0;
+}
+
+int shm_bus_open(struct ShmBus *bus, const char *topic, uint32_t nb_slots, uint32_t slot_size)
+{
+  memset(bus, 0, sizeof(struct ShmBus));
+  snprintf(bus->name, sizeof(bus->name), "/pprz_bus_%s", topic);
+
+  uint32_t n = 1;
+  while (n < nb_slots) {
+    n <<= 1;
+  }
+
+  int fd = shm_open(bus->name, O_RDWR | O_CREAT | O_EXCL, 0666);
+  if (fd >= 0) {
+    // new topic, initialize it and publish the magic number last
+    bus->stride = (sizeof(struct ShmBusSlot) + slot_size + 63) & ~63U;
+    size_t size = SHM_BUS_HEADER_SIZE + (size_t)n * bus->stride;
+    if (ftruncate(fd, size) < 0 || shm_bus_map(bus, fd, size) < 0) {
+      close(fd);
+      shm_unlink(bus->name);
+      return -1;
+    }
+    close(fd);
+    bus->hdr->version = SHM_BUS_VERSION;
+    bus->hdr->nb_slots = n;
+    bus->hdr->slot_size = slot_size;
+    __atomic_store_n(&bus->hdr->magic, SHM_BUS_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+  }
+  if (errno != EEXIST) {
+    return -1;
+  }
+
+  // existing topic, wait until its creator has sized and initialized it
+  fd = shm_open(bus->name, O_RDWR, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  const struct timespec ms = { 0, 1000000 };
+  struct stat st;
+  int t = 0;
+  while (fstat(fd, &st) == 0 && st.st_size == 0 && t++ < SHM_BUS_OPEN_TIMEOUT_MS) {
+    nanosleep(&ms, NULL);
+  }
+  if (st.st_size < SHM_BUS_HEADER_SIZE || shm_bus_map(bus, fd, st.st_size) < 0) {
+    close(fd);
+    return -1;
+  }
+  close(fd);
+  while (__atomic_load_n(&bus->hdr->magic, __ATOMIC_ACQUIRE) != SHM_BUS_MAGIC && t++ < SHM_BUS_OPEN_TIMEOUT_MS) {
+    nanosleep(&ms, NULL);
+  }
+  bus->stride = (sizeof(struct ShmBusSlot) + bus->hdr->slot_size + 63) & ~63U;
+  if (bus->hdr->magic != SHM_BUS_MAGIC || bus->hdr->version != SHM_BUS_VERSION ||
+      SHM_BUS_HEADER_SIZE + (size_t)bus->hdr->nb_slots * bus->stride > bus->map_size) {
+    munmap(bus->hdr, bus->map_size);
+    bus->hdr = NULL;
+    return -1;
+  }
+  bus->read_seq = __atomic_load_n(&bus->hdr->write_seq, __ATOMIC_ACQUIRE);
+  return 0;
+}
+
+void shm_bus_close(struct ShmBus *bus, bool unlink)
+{
+  if (bus->hdr != NULL) {
+    munmap(bus->hdr, bus->map_size);
+    bus->hdr = NULL;
+  }
+  if (unlink) {
+    shm_unlink(bus->name);
+  }
+}
+
+uint8_t *shm_bus_reserve(struct ShmBus *bus)
+{
+  bus->pub_seq = __atomic_fetch_add(&bus->hdr->write_seq, 1, __ATOMIC_RELAXED);
+  struct ShmBusSlot *slot = shm_bus_slot(bus, bus->pub_seq);
+  __atomic_store_n(&slot->seq, 2 * bus->pub_seq + 1, __ATOMIC_RELAXED);
+  // the writing stamp is visible before the new payload
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  return slot->data;
+}
+
+void shm_bus_commit(struct ShmBus *bus, uint32_t len)
+{
+  struct ShmBusSlot *slot = shm_bus_slot(bus, bus->pub_seq);
+  slot->len = len;
+  __atomic_store_n(&slot->seq, 2 * (bus->pub_seq + 1), __ATOMIC_RELEASE);
+  __atomic_fetch_add(&bus->hdr->notify, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&bus->hdr->nb_waiters, __ATOMIC_SEQ_CST) > 0) {
+    shm_bus_futex(&bus->hdr->notify, FUTEX_WAKE, INT_MAX, NULL);
+  }
+}
+
+int shm_bus_publish(struct ShmBus *bus, const uint8_t *data, uint32_t len)
+{
+  if (len > bus->hdr->slot_size) {
+    return -1;
+  }
+  memcpy(shm_bus_reserve(bus), data, len);
+  shm_bus_commit(bus, len);
+  return 0;
+}
+
+const uint8_t *shm_bus_peek(struct ShmBus *bus, uint32_t *len)
+{
+  for (;;) {
+    struct ShmBusSlot *slot = shm_bus_slot(bus, bus->read_seq);
+    uint64_t stamp = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (stamp == 2 * (bus->read_seq + 1)) {
+      *len = slot->len;
+      if (*len > bus->hdr->slot_size) {
+        *len = bus->hdr->slot_size;
+      }
+      return slot->data;
+    }
+    if (stamp < 2 * (bus->read_seq + 1)) {
+      // not published yet
+      return NULL;
+    }
+    // overwritten by the publishers, skip to the oldest message left
+    uint64_t w = __atomic_load_n(&bus->hdr->write_seq, __ATOMIC_ACQUIRE);
+    uint64_t oldest = (w > bus->hdr->nb_slots) ? w - bus->hdr->nb_slots + 1 : 0;
+    if (oldest <= bus->read_seq) {
+      oldest = bus->read_seq + 1;
+    }
+    bus->nb_dropped += oldest - bus->read_seq;
+    bus->read_seq = oldest;
+  }
+}
+
+bool shm_bus_release(struct ShmBus *bus)
+{
+  struct ShmBusSlot *slot = shm_bus_slot(bus, bus->read_seq);
+  // the payload is read before checking the stamp again
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  bool valid = (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == 2 * (bus->read_seq + 1));
+  bus->read_seq++;
+  if (valid) {
+    bus->nb_received++;
+  } else {
+    bus->nb_dropped++;
+  }
+  return valid;
+}
+
+int shm_bus_read(struct ShmBus *bus, uint8_t *buf, uint32_t size)
+{
+  for (;;) {
+    uint32_t len;
+    const uint8_t *data = shm_bus_peek(bus, &len);
+    if (data == NULL) {
+      return 0;
+    }
+    if (len > size) {
+      shm_bus_release(bus);
+      return -1;
+    }
+    memcpy(buf, data, len);
+    if (shm_bus_release(bus)) {
+      return len;
+    }
+  }
+}
+
+bool shm_bus_wait(struct ShmBus *bus, uint32_t timeout_us)
+{
+  uint32_t len;
+  uint32_t notify = __atomic_load_n(&bus->hdr->notify, __ATOMIC_SEQ_CST);
+  __atomic_fetch_add(&bus->hdr->nb_waiters, 1, __ATOMIC_SEQ_CST);
+  if (shm_bus_peek(bus, &len) == NULL) {
+    struct timespec timeout = { timeout_us / 1000000, (timeout_us % 1000000) * 1000 };
+    shm_bus_futex(&bus->hdr->notify, FUTEX_WAIT, notify, &timeout);
+  }
+  __atomic_fetch_sub(&bus->hdr->nb_waiters, 1, __ATOMIC_SEQ_CST);
+  return (shm_bus_peek(bus, &len) != NULL);
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file arch/linux/shm_bus.h
+ *
+ * Binary message bus between processes of the same host, in shared memory.
+ *
+ * Each topic is a POSIX shared memory ring of fixed size slots, named
+ * /pprz_bus_<topic>. Any number of processes can publish and subscribe to
+ * a topic:
+ * - a publisher reserves the next slot with an atomic increment and writes
+ *   the message in place, there is no lock and no copy,
+ * - each subscriber has its own read position and reads the messages in
+ *   place; a slot sequence number (seqlock) tells if the message is
+ *   complete and if it was overwritten while being read,
+ * - publishers never wait: a subscriber which is too slow loses the oldest
+ *   messages, they are counted in nb_dropped.
+ *
+ * The payloads are opaque to the bus, see shm_bus_transport.h to send
+ * pprzlink messages on it.
+ */
+
+#ifndef SHM_BUS_H
+#define SHM_BUS_H
+
+#include <stddef.h>
+#include "std.h"
+
+#define SHM_BUS_MAGIC 0x50505A42        ///< "PPZB"
+#define SHM_BUS_VERSION 1
+
+/** Default number of slots of a topic, must be a power of two */
+#ifndef SHM_BUS_NB_SLOTS
+#define SHM_BUS_NB_SLOTS 1024
+#endif
+
+/** Default slot payload size, a pprzlink message is at most 255 bytes */
+#ifndef SHM_BUS_SLOT_SIZE
+#define SHM_BUS_SLOT_SIZE 256
+#endif
+
+/** Shared header of a topic, at the beginning of the mapping */
+struct ShmBusHeader {
+  uint32_t magic;           ///< SHM_BUS_MAGIC once initialized
+  uint32_t version;         ///< SHM_BUS_VERSION
+  uint32_t nb_slots;        ///< number of slots, power of two
+  uint32_t slot_size;       ///< maximum payload size of a slot
+  uint64_t write_seq;       ///< sequence number of the next message
+  uint32_t notify;          ///< futex word, incremented on each message
+  uint32_t nb_waiters;      ///< number of subscribers sleeping on notify
+};
+
+struct ShmBus {
+  struct ShmBusHeader *hdr; ///< shared header
+  uint8_t *slots;           ///< first slot
+  uint32_t stride;          ///< slot size with its sequence header
+  size_t map_size;          ///< size of the mapping
+  char name[64];            ///< shared memory object name
+  /* publisher */
+  uint64_t pub_seq;         ///< sequence number of the reserved slot
+  /* subscriber */
+  uint64_t read_seq;        ///< sequence number of the next message to read
+  uint32_t nb_received;     ///< number of messages read
+  uint32_t nb_dropped;      ///< number of messages lost by this subscriber
+};
+
+/**
+ * Open a topic, create it if it doesn't exist.
+ * When the topic exists, its size parameters are used and the requested ones
+ * are ignored. The subscriber position starts at the next published message.
+ * @param bus the topic
+ * @param topic topic name
+ * @param nb_slots number of slots, rounded up to a power of two
+ * @param slot_size maximum payload size
+ * @return 0 on success, -1 on error
+ */
+extern int shm_bus_open(struct ShmBus *bus, const char *topic, uint32_t nb_slots, uint32_t slot_size);
+
+/**
+ * Close a topic.
+ * @param unlink remove the shared memory object, it is freed when the other
+ *               processes close it
+ */
+extern void shm_bus_close(struct ShmBus *bus, bool unlink);
+
+/**
+ * Reserve the next slot to publish a message.
+ * @return pointer to the slot payload, slot_size bytes are available
+ */
+extern uint8_t *shm_bus_reserve(struct ShmBus *bus);
+
+/**
+ * Publish the message written in the reserved slot.
+ * @param len message length
+ */
+extern void shm_bus_commit(struct ShmBus *bus, uint32_t len);
+
+/**
+ * Publish a copy of a message.
+ * @return 0 on success, -1 if the message is bigger than a slot
+ */
+extern int shm_bus_publish(struct ShmBus *bus, const uint8_t *data, uint32_t len);
+
+/**
+ * Get the next message in place, without copy.
+ * The message can be overwritten by a publisher at any time, it is only
+ * valid if shm_bus_release returns true.
+ * @param[out] len message length
+ * @return pointer to the message or NULL if there is no new message
+ */
+extern const uint8_t *shm_bus_peek(struct ShmBus *bus, uint32_t *len);
+
+/**
+ * Release the message returned by shm_bus_peek and move to the next one.
+ * @return true if the message wasn't overwritten while being used
+ */
+extern bool shm_bus_release(struct ShmBus *bus);
+
+/**
+ * Copy the next message.
+ * @param buf destination buffer
+ * @param size size of the buffer
+ * @return message length, 0 if there is no new message, -1 if the buffer is too small
+ */
+extern int shm_bus_read(struct ShmBus *bus, uint8_t *buf, uint32_t size);
+
+/**
+ * Wait for a new message.
+ * @param timeout_us maximum waiting time in microseconds
+ * @return true if a message is available
+ */
+extern bool shm_bus_wait(struct ShmBus *bus, uint32_t timeout_us);
+
+#endif /* SHM_BUS_H */
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file arch/linux/shm_bus_transport.c
+ *
+ * pprzlink transport over the shared memory bus.
+ */
+
+#include "arch/linux/shm_bus_transport.h"
+#include <string.h>
+
+static void shm_bus_put(struct shm_bus_transport *t, const uint8_t *bytes, uint16_t len)
+{
+  // size was checked by check_available_space
+  memcpy(t->slot + t->len, bytes, len);
+  t->len += len;
+}
+
+static void shm_bus_start(struct shm_bus_transport *t)
+{
+  t->slot = shm_bus_reserve(t->bus);
+  t->len = 0;
+}
+
+static void shm_bus_end(struct shm_bus_transport *t)
+{
+  shm_bus_commit(t->bus, t->len);
+}
+
+#if PPRZLINK_DEFAULT_VER == 2
+
+static struct shm_bus_transport *get_trans(struct pprzlink_msg *msg)
+{
+  return (struct shm_bus_transport *)(msg->trans->impl);
+}
+
+static void put_bytes(struct pprzlink_msg *msg, long fd __attribute__((unused)),
+                      enum TransportDataType type __attribute__((unused)),
+                      enum TransportDataFormat format __attribute__((unused)),
+                      const void *bytes, uint16_t len)
+{
+  shm_bus_put(get_trans(msg), (const uint8_t *)bytes, len);
+}
+
+static void put_named_byte(struct pprzlink_msg *msg, long fd __attribute__((unused)),
+                           enum TransportDataType type __attribute__((unused)),
+                           enum TransportDataFormat format __attribute__((unused)),
+                           uint8_t byte, const char *name __attribute__((unused)))
+{
+  shm_bus_put(get_trans(msg), &byte, 1);
+}
+
+/** No framing, a slot holds the payload only */
+static uint8_t size_of(struct pprzlink_msg *msg __attribute__((unused)), uint8_t len)
+{
+  return len;
+}
+
+static void start_message(struct pprzlink_msg *msg, long fd __attribute__((unused)),
+                          uint8_t payload_len __attribute__((unused)))
+{
+  shm_bus_start(get_trans(msg));
+}
+
+static void end_message(struct pprzlink_msg *msg, long fd __attribute__((unused)))
+{
+  shm_bus_end(get_trans(msg));
+}
+
+static void overrun(struct pprzlink_msg *msg __attribute__((unused)))
+{
+}
+
+static void count_bytes(struct pprzlink_msg *msg __attribute__((unused)), uint8_t bytes __attribute__((unused)))
+{
+}
+
+static int check_available_space(struct pprzlink_msg *msg, long *fd __attribute__((unused)), uint16_t bytes)
+{
+  return (bytes <= get_trans(msg)->bus->hdr->slot_size);
+}
+
+#else
+
+static void put_bytes(struct shm_bus_transport *trans, struct link_device *dev __attribute__((unused)),
+                      long fd __attribute__((unused)),
+                      enum TransportDataType type __attribute__((unused)),
+                      enum TransportDataFormat format __attribute__((unused)),
+                      const void *bytes, uint16_t len)
+{
+  shm_bus_put(trans, (const uint8_t *)bytes, len);
+}
+
+static void put_named_byte(struct shm_bus_transport *trans, struct link_device *dev __attribute__((unused)),
+                           long fd __attribute__((unused)),
+                           enum TransportDataType type __attribute__((unused)),
+                           enum TransportDataFormat format __attribute__((unused)),
+                           uint8_t byte, const char *name __attribute__((unused)))
+{
+  shm_bus_put(trans, &byte, 1);
+}
+
+static uint8_t size_of(struct shm_bus_transport *trans __attribute__((unused)), uint8_t len)
+{
+  return len;
+}
+
+static void start_message(struct shm_bus_transport *trans, struct link_device *dev __attribute__((unused)),
+                          long fd __attribute__((unused)), uint8_t payload_len __attribute__((unused)))
+{
+  shm_bus_start(trans);
+}
+
+static void end_message(struct shm_bus_transport *trans, struct link_device *dev __attribute__((unused)),
+                        long fd __attribute__((unused)))
+{
+  shm_bus_end(trans);
+}
+
+static void overrun(struct shm_bus_transport *trans __attribute__((unused)),
+                    struct link_device *dev __attribute__((unused)))
+{
+}
+
+static void count_bytes(struct shm_bus_transport *trans __attribute__((unused)),
+                        struct link_device *dev __attribute__((unused)), uint8_t bytes __attribute__((unused)))
+{
+}
+
+static int check_available_space(struct shm_bus_transport *trans, struct link_device *dev __attribute__((unused)),
+                                 long *fd __attribute__((unused)), uint16_t bytes)
+{
+  return (bytes <= trans->bus->hdr->slot_size);
+}
+
+#endif /* PPRZLINK_DEFAULT_VER == 2 */
+
+void shm_bus_transport_init(struct shm_bus_transport *t, struct ShmBus *bus)
+{
+  t->bus = bus;
+  t->slot = NULL;
+  t->len = 0;
+  t->trans_tx.size_of = (size_of_t) size_of;
+  t->trans_tx.check_available_space = (check_available_space_t) check_available_space;
+  t->trans_tx.put_bytes = (put_bytes_t) put_bytes;
+  t->trans_tx.put_named_byte = (put_named_byte_t) put_named_byte;
+  t->trans_tx.start_message = (start_message_t) start_message;
+  t->trans_tx.end_message = (end_message_t) end_message;
+  t->trans_tx.overrun = (overrun_t) overrun;
+  t->trans_tx.count_bytes = (count_bytes_t) count_bytes;
+  t->trans_tx.impl = (void *)(t);
+  memset(&t->device, 0, sizeof(struct link_device));
+  t->device.periph = (void *)bus;
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of Paparazzi.
+ *
+ * Paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * Paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file arch/linux/shm_bus_transport.h
+ *
+ * pprzlink transport over the shared memory bus.
+ *
+ * The generated send functions write the message (sender id, receiver id,
+ * class and component, message id and fields) directly in the reserved bus
+ * slot, without framing nor checksum. A slot holds exactly one message, so
+ * a subscriber gets typed payloads that can be decoded in place with the
+ * generated DL_<MSG>_<field> macros:
+ *
+ *   struct ShmBus bus;
+ *   struct shm_bus_transport tp;
+ *   shm_bus_open(&bus, "telemetry", SHM_BUS_NB_SLOTS, SHM_BUS_SLOT_SIZE);
+ *   shm_bus_transport_init(&tp, &bus);
+ *   pprz_msg_send_NPS_WIND(&tp.trans_tx, &tp.device, AC_ID, &x, &y, &z);
+ */
+
+#ifndef SHM_BUS_TRANSPORT_H
+#define SHM_BUS_TRANSPORT_H
+
+#include "std.h"
+#include "pprzlink/pprzlink_transport.h"
+#include "pprzlink/pprzlink_device.h"
+#include "arch/linux/shm_bus.h"
+
+struct shm_bus_transport {
+  struct transport_tx trans_tx;   ///< generic transmission interface
+  struct link_device device;      ///< device argument of the send functions, not used
+  struct ShmBus *bus;             ///< topic the messages are published on
+  uint8_t *slot;                  ///< payload of the slot being written
+  uint16_t len;                   ///< length of the message being written
+};
+
+/** Init the transport on an opened topic */
+extern void shm_bus_transport_init(struct shm_bus_transport *t, struct ShmBus *bus);
+
+#endif /* SHM_BUS_TRANSPORT_H */
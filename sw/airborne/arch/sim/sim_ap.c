@@ -106,6 +106,8 @@ value sim_init(value unit)
 {
   init_fbw();
   init_ap();
+  /* datalink.c is always part of the sim, even without telemetry module */
+  datalink_init();
 
   return unit;
 }
@@ -145,6 +147,7 @@ value set_datalink_message(value s)
     dl_buffer[i] = ss[i];
   }
 
+  dl_msg_len = n;
   dl_msg_available = true;
   DlCheckAndParse(&(DOWNLINK_DEVICE).device, &ivy_tp.trans_tx, dl_buffer, &dl_msg_available, SIM_UPDATE_DL);
 
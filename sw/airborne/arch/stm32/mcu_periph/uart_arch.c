@@ -133,6 +133,30 @@ void uart_put_byte(struct uart_periph *p, long fd __attribute__((unused)), uint8
 
 }
 
+void uart_put_buffer(struct uart_periph *p, long fd __attribute__((unused)), const uint8_t *data, uint16_t len)
+{
+  int space = p->tx_extract_idx - p->tx_insert_idx - 1;
+  if (space < 0) {
+    space += UART_TX_BUFFER_SIZE;
+  }
+  if (len == 0 || space < len) {
+    return;  // no room
+  }
+
+  USART_CR1((uint32_t)p->reg_addr) &= ~USART_CR1_TXEIE; // Disable TX interrupt
+
+  // queue the whole buffer at once, start with the first byte if not sending
+  if (!p->tx_running) {
+    p->tx_running = true;
+    usart_send((uint32_t)p->reg_addr, data[0]);
+    data++;
+    len--;
+  }
+  uart_tx_buffer_insert(p, data, len);
+
+  USART_CR1((uint32_t)p->reg_addr) |= USART_CR1_TXEIE; // Enable TX interrupt
+}
+
 static inline void usart_isr(struct uart_periph *p)
 {
 
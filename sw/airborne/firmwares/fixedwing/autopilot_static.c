@@ -32,6 +32,7 @@
 #include "inter_mcu.h"
 #include "link_mcu.h"
 #include "state.h"
+#include "mcu_periph/sys_time.h"
 #include "firmwares/fixedwing/nav.h"
 #include "firmwares/fixedwing/stabilization/stabilization_attitude.h"
 #include "generated/flight_plan.h"
@@ -284,6 +285,8 @@ void navigation_task(void)
 
 void attitude_loop(void)
 {
+  /* publish state for other threads */
+  StateSnapshotPeriodic(get_sys_time_usec());
 
   if (autopilot_get_mode() >= AP_MODE_AUTO2) {
 #if CTRL_VERTICAL_LANDING
@@ -241,6 +241,7 @@ void handle_periodic_tasks_ap(void)
 
 #if USE_GENERATED_AUTOPILOT
   if (sys_time_check_and_ack_timer(attitude_tid)) {
+    StateSnapshotPeriodic(get_sys_time_usec());
     autopilot_periodic();
   }
 #else
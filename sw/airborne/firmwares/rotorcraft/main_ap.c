@@ -241,6 +241,9 @@ void main_periodic(void)
   intermcu_periodic();
 #endif
 
+  /* publish state for other threads */
+  StateSnapshotPeriodic(get_sys_time_usec());
+
   /* run control loops */
   autopilot_periodic();
   /* set actuators     */
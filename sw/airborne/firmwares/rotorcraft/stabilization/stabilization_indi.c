@@ -51,6 +51,7 @@
 float du_min[INDI_NUM_ACT];
 float du_max[INDI_NUM_ACT];
 float du_pref[INDI_NUM_ACT];
+float indi_wls_ws[INDI_NUM_ACT]; // working set of the WLS allocation, used as warm start
 float indi_v[INDI_OUTPUTS];
 float *Bwls[INDI_OUTPUTS];
 int num_iter = 0;
@@ -260,6 +261,7 @@ void stabilization_indi_enter(void)
 
   float_vect_zero(du_estimation, INDI_NUM_ACT);
   float_vect_zero(ddu_estimation, INDI_NUM_ACT);
+  float_vect_zero(indi_wls_ws, INDI_NUM_ACT);
 }
 
 /**
@@ -437,7 +439,7 @@ void stabilization_indi_rate_run(struct FloatRates rate_sp, bool in_flight)
 
   // WLS Control Allocator
   num_iter =
-    wls_alloc(indi_du, indi_v, du_min, du_max, Bwls, 0, 0, Wv, 0, du_pref, 10000, 10);
+    wls_alloc(indi_du, indi_v, du_min, du_max, Bwls, 0, indi_wls_ws, Wv, 0, du_pref, 10000, 10);
 #endif
 
   // Add the increments to the actuators
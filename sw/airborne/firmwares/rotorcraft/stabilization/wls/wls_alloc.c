@@ -31,6 +31,10 @@
  * Prioritized Control Allocation for Quadrotors Subject to Saturation -
  * E.J.J. Smeur, D.C. Höppener, C. de Wagter. In IMAV 2017
  *
+ * The least squares subproblems are solved with a QR factorisation of the
+ * free columns that is updated with Givens rotations when an actuator enters
+ * or leaves the working set, instead of being recomputed at each iteration.
+ *
  * written by Anton Naruta && Daniel Hoppener 2016
  * MAVLab Delft University of Technology
  */
@@ -45,8 +49,6 @@
 #include "math/qr_solve/qr_solve.h"
 #include "math/qr_solve/r8lib_min.h"
 
-void print_final_values(int n_u, int n_v, float* u, float** B, float* v, float* umin, float* umax);
-void print_in_and_outputs(int n_c, int n_free, float** A_free_ptr, float* d, float* p_free);
 
 // provide loop feedback
 #define WLS_VERBOSE FALSE
@@ -62,6 +64,9 @@ void print_in_and_outputs(int n_c, int n_free, float** A_free_ptr, float* d, flo
 
 #define CA_N_C  (CA_N_U+CA_N_V)
 
+void print_final_values(int n_u, int n_v, float* u, float** B, float* v, float* umin, float* umax);
+void print_in_and_outputs(int n_c, int n_free, float A[CA_N_C][CA_N_U], int* free_index, float* d, float* p_free);
+
 /**
  * @brief Wrapper for qr solve
  *
@@ -84,6 +89,195 @@ void qr_solve_wrapper(int m, int n, float** A, float* b, float* x) {
   qr_solve(m, n, in, b, x);
 }
 
+/**
+ * @brief QR factorisation of the free columns of A
+ *
+ * Qt is the transpose of the orthogonal matrix Q, R is upper triangular
+ * with one column per free actuator, in the order of free_index.
+ */
+struct wls_qr {
+  float Qt[CA_N_C][CA_N_C];
+  float R[CA_N_C][CA_N_U];
+};
+
+/**
+ * @brief Compute a Givens rotation zeroing b in (a, b)
+ */
+static void wls_givens(float a, float b, float *c, float *s)
+{
+  if (fabsf(b) < FLT_MIN) {
+    *c = 1.f;
+    *s = 0.f;
+  } else {
+    float r = sqrtf(a * a + b * b);
+    *c = a / r;
+    *s = b / r;
+  }
+}
+
+/**
+ * @brief Apply a Givens rotation to two rows of a matrix
+ *
+ * @param Mi first row
+ * @param Mk second row
+ * @param j0 first column
+ * @param j1 last column (excluded)
+ */
+static inline void wls_rotate_rows(float *Mi, float *Mk, int j0, int j1, float c, float s)
+{
+  for (int j = j0; j < j1; j++) {
+    float t = c * Mi[j] + s * Mk[j];
+    Mk[j] = -s * Mi[j] + c * Mk[j];
+    Mi[j] = t;
+  }
+}
+
+/**
+ * @brief Append a column to the QR factorisation
+ *
+ * @param qr factorisation of n_free columns
+ * @param n_free current number of columns
+ * @param A full matrix
+ * @param col column of A to append
+ */
+static void wls_qr_add_column(struct wls_qr *qr, int n_free, float A[CA_N_C][CA_N_U], int col)
+{
+  float w[CA_N_C];
+  // w = Q' * a
+  for (int i = 0; i < CA_N_C; i++) {
+    w[i] = 0.f;
+    for (int k = 0; k < CA_N_C; k++) {
+      w[i] += qr->Qt[i][k] * A[k][col];
+    }
+  }
+  // zero w below row n_free, rows of R below n_free are zero so R is not affected
+  for (int i = CA_N_C - 1; i > n_free; i--) {
+    float c, s;
+    wls_givens(w[i - 1], w[i], &c, &s);
+    wls_rotate_rows(qr->Qt[i - 1], qr->Qt[i], 0, CA_N_C, c, s);
+    w[i - 1] = c * w[i - 1] + s * w[i];
+    w[i] = 0.f;
+  }
+  for (int i = 0; i < CA_N_C; i++) {
+    qr->R[i][n_free] = w[i];
+  }
+}
+
+/**
+ * @brief Remove a column from the QR factorisation
+ *
+ * @param qr factorisation of n_free columns
+ * @param n_free current number of columns
+ * @param pos index of the column to remove
+ */
+static void wls_qr_remove_column(struct wls_qr *qr, int n_free, int pos)
+{
+  // shift the columns after pos, R becomes upper Hessenberg from pos
+  for (int i = 0; i < CA_N_C; i++) {
+    for (int j = pos; j < n_free - 1; j++) {
+      qr->R[i][j] = qr->R[i][j + 1];
+    }
+    qr->R[i][n_free - 1] = 0.f;
+  }
+  // restore the triangular structure
+  for (int j = pos; j < n_free - 1; j++) {
+    float c, s;
+    wls_givens(qr->R[j][j], qr->R[j + 1][j], &c, &s);
+    wls_rotate_rows(qr->R[j], qr->R[j + 1], j, n_free - 1, c, s);
+    qr->R[j + 1][j] = 0.f;
+    wls_rotate_rows(qr->Qt[j], qr->Qt[j + 1], 0, CA_N_C, c, s);
+  }
+}
+
+/**
+ * @brief Solve min ||A_free * x - b|| with the QR factorisation
+ */
+static void wls_qr_solve(struct wls_qr *qr, int n_free, float *b, float *x)
+{
+  float y[CA_N_U];
+  for (int i = 0; i < n_free; i++) {
+    y[i] = 0.f;
+    for (int k = 0; k < CA_N_C; k++) {
+      y[i] += qr->Qt[i][k] * b[k];
+    }
+  }
+  for (int i = n_free - 1; i >= 0; i--) {
+    float sum = y[i];
+    for (int j = i + 1; j < n_free; j++) {
+      sum -= qr->R[i][j] * x[j];
+    }
+    x[i] = (fabsf(qr->R[i][i]) > FLT_MIN) ? sum / qr->R[i][i] : 0.f;
+  }
+}
+
+/**
+ * @brief Lagrange multipliers of the inputs in the working set
+ *
+ * lambda = A'*Q2*Q2'*(b - A_W*u_W) where Q2 are the last rows of Qt. The
+ * free inputs do not appear, so their rounding errors are projected out.
+ * Free inputs get a zero multiplier.
+ */
+static void wls_multipliers(struct wls_qr *qr, int n_free, float A[CA_N_C][CA_N_U], float *b, float *u, float *W,
+                            float *lambda)
+{
+  float c[CA_N_C];
+  float q2c[CA_N_C];
+  for (int i = 0; i < CA_N_C; i++) {
+    c[i] = b[i];
+    for (int k = 0; k < CA_N_U; k++) {
+      if (W[k] != 0) {
+        c[i] -= A[i][k] * u[k];
+      }
+    }
+  }
+  for (int r = n_free; r < CA_N_C; r++) {
+    q2c[r] = 0.f;
+    for (int i = 0; i < CA_N_C; i++) {
+      q2c[r] += qr->Qt[r][i] * c[i];
+    }
+  }
+  for (int k = 0; k < CA_N_U; k++) {
+    lambda[k] = 0.f;
+    if (W[k] == 0) {
+      continue;
+    }
+    for (int r = n_free; r < CA_N_C; r++) {
+      float qa = 0.f;
+      for (int i = 0; i < CA_N_C; i++) {
+        qa += qr->Qt[r][i] * A[i][k];
+      }
+      lambda[k] += qa * q2c[r];
+    }
+  }
+}
+
+/**
+ * @brief One step of iterative refinement of the free inputs
+ *
+ * The residual is accumulated in double, the free inputs solve the least
+ * squares problem to the float resolution whatever the path of the active
+ * set iterations (cold or warm start).
+ */
+static void wls_refine(struct wls_qr *qr, int n_free, int *free_index, float A[CA_N_C][CA_N_U], float *b,
+                       float *u, float *umin, float *umax)
+{
+  float r[CA_N_C];
+  float p_free[CA_N_U];
+  for (int i = 0; i < CA_N_C; i++) {
+    double ri = b[i];
+    for (int k = 0; k < CA_N_U; k++) {
+      ri -= (double)A[i][k] * u[k];
+    }
+    r[i] = (float)ri;
+  }
+  wls_qr_solve(qr, n_free, r, p_free);
+  for (int i = 0; i < n_free; i++) {
+    int id = free_index[i];
+    u[id] += p_free[i];
+    Bound(u[id], umin[id], umax[id]);
+  }
+}
+
 /**
  * @brief active set algorithm for control allocation
  *
@@ -99,7 +293,8 @@ void qr_solve_wrapper(int m, int n, float** A, float* b, float* x) {
  * @param n_u Length of u
  * @param n_v Lenght of v
  * @param u_guess Initial value for u
- * @param W_init Initial working set, if known
+ * @param W_init Initial working set, if known, updated with the final working set
+ * so that it can be used as a warm start in the next cycle
  * @param Wv Weighting on different control objectives
  * @param Wu Weighting on different controls
  * @param up Preferred control vector
@@ -121,13 +316,7 @@ int wls_alloc(float* u, float* v, float* umin, float* umax, float** B,
   int n_v = CA_N_V;
 
   float A[CA_N_C][CA_N_U];
-  float A_free[CA_N_C][CA_N_U];
-
-  // Create a pointer array to the rows of A_free
-  // such that we can pass it to a function
-  float * A_free_ptr[CA_N_C];
-  for(int i = 0; i < n_c; i++)
-    A_free_ptr[i] = A_free[i];
+  struct wls_qr qr;
 
   float b[CA_N_C];
   float d[CA_N_C];
@@ -135,7 +324,6 @@ int wls_alloc(float* u, float* v, float* umin, float* umax, float** B,
   int free_index[CA_N_U];
   int free_index_lookup[CA_N_U];
   int n_free = 0;
-  int free_chk = -1;
 
   int iter = 0;
   float p_free[CA_N_U];
@@ -152,13 +340,24 @@ int wls_alloc(float* u, float* v, float* umin, float* umax, float** B,
       u[i] = (umax[i] + umin[i]) * 0.5;
     }
   } else {
+    // the active set iterations need a feasible starting point
     for (int i = 0; i < n_u; i++) {
       u[i] = u_guess[i];
+      Bound(u[i], umin[i], umax[i]);
     }
   }
   W_init ? memcpy(W, W_init, n_u * sizeof(float))
     : memset(W, 0, n_u * sizeof(float));
 
+  // actuators in the working set start at their limit
+  for (int i = 0; i < n_u; i++) {
+    if (W[i] > 0) {
+      u[i] = umax[i];
+    } else if (W[i] < 0) {
+      u[i] = umin[i];
+    }
+  }
+
   memset(free_index_lookup, -1, n_u * sizeof(float));
 
 
@@ -170,7 +369,7 @@ int wls_alloc(float* u, float* v, float* umin, float* umax, float** B,
     }
   }
 
-  // fill up A, A_free, b and d
+  // fill up A, b and d
   for (int i = 0; i < n_v; i++) {
     // If Wv is a NULL pointer, use Wv = identity
     b[i] = Wv ? gamma_sq * Wv[i] * v[i] : gamma_sq * v[i];
@@ -188,32 +387,30 @@ int wls_alloc(float* u, float* v, float* umin, float* umax, float** B,
     d[i] = b[i] - A[i][i - n_v] * u[i - n_v];
   }
 
+  // factorise the free columns of A
+  memset(&qr, 0, sizeof(qr));
+  for (int i = 0; i < n_c; i++) {
+    qr.Qt[i][i] = 1.f;
+  }
+  for (int j = 0; j < n_free; j++) {
+    wls_qr_add_column(&qr, j, A, free_index[j]);
+  }
+
   // -------------- Start loop ------------
   while (iter++ < imax) {
     // clear p, copy u to u_opt
     memset(p, 0, n_u * sizeof(float));
     memcpy(u_opt, u, n_u * sizeof(float));
 
-    // Construct a matrix with the free columns of A
-    if (free_chk != n_free) {
-      for (int i = 0; i < n_c; i++) {
-        for (int j = 0; j < n_free; j++) {
-          A_free[i][j] = A[i][free_index[j]];
-        }
-      }
-      free_chk = n_free;
-    }
-
-
     if (n_free) {
       // Still free variables left, calculate corresponding solution
 
-      // use a solver to find the solution to A_free*p_free = d
-      qr_solve_wrapper(n_c, n_free, A_free_ptr, d, p_free);
+      // use the QR factorisation to find the solution to A_free*p_free = d
+      wls_qr_solve(&qr, n_free, d, p_free);
 
       //print results current step
 #if WLS_VERBOSE
-      print_in_and_outputs(n_c, n_free, A_free_ptr, d, p_free);
+      print_in_and_outputs(n_c, n_free, A, free_index, d, p_free);
 #endif
 
     }
@@ -235,17 +432,16 @@ int wls_alloc(float* u, float* v, float* umin, float* umax, float** B,
     if (n_infeasible == 0) {
       // all variables are within limits
       memcpy(u, u_opt, n_u * sizeof(float));
-      memset(lambda, 0, n_u * sizeof(float));
 
-      // d = d + A_free*p_free; lambda = A*d;
+      // d = d + A_free*p_free
       for (int i = 0; i < n_c; i++) {
         for (int k = 0; k < n_free; k++) {
-          d[i] -= A_free[i][k] * p_free[k];
-        }
-        for (int k = 0; k < n_u; k++) {
-          lambda[k] += A[i][k] * d[i];
+          d[i] -= A[i][free_index[k]] * p_free[k];
         }
       }
+      // lambda = A'*d, not computed from d directly: with a large gamma_sq it
+      // is dominated by the rounding errors of the control objective rows
+      wls_multipliers(&qr, n_free, A, b, u, W, lambda);
       bool break_flag = true;
 
       // lambda = lambda x W;
@@ -257,17 +453,22 @@ int wls_alloc(float* u, float* v, float* umin, float* umax, float** B,
           W[i] = 0;
           // add a free index
           if (free_index_lookup[i] < 0) {
+            wls_qr_add_column(&qr, n_free, A, i);
             free_index_lookup[i] = n_free;
             free_index[n_free++] = i;
           }
         }
       }
       if (break_flag) {
+        wls_refine(&qr, n_free, free_index, A, b, u, umin, umax);
 
 #if WLS_VERBOSE
-        print_final_values(1, n_u, n_v, u, B, v, umin, umax);
+        print_final_values(n_u, n_v, u, B, v, umin, umax);
 #endif
 
+        if (W_init) {
+          memcpy(W_init, W, n_u * sizeof(float));
+        }
         // if solution is found, return number of iterations
         return iter;
       }
@@ -298,31 +499,38 @@ int wls_alloc(float* u, float* v, float* umin, float* umax, float** B,
       // update d = d-alpha*A*p_free
       for (int i = 0; i < n_c; i++) {
         for (int k = 0; k < n_free; k++) {
-          d[i] -= A_free[i][k] * alpha * p_free[k];
+          d[i] -= A[i][free_index[k]] * alpha * p_free[k];
         }
       }
-      // get rid of a free index
+      // get rid of a free index, keeping the column order of the factorisation
       W[id_alpha] = (p[id_alpha] > 0) ? 1.0 : -1.0;
 
-      free_index[free_index_lookup[id_alpha]] = free_index[--n_free];
-      free_index_lookup[free_index[free_index_lookup[id_alpha]]] =
-        free_index_lookup[id_alpha];
+      int pos = free_index_lookup[id_alpha];
+      wls_qr_remove_column(&qr, n_free, pos);
+      for (int i = pos; i < n_free - 1; i++) {
+        free_index[i] = free_index[i + 1];
+        free_index_lookup[free_index[i]] = i;
+      }
+      n_free--;
       free_index_lookup[id_alpha] = -1;
     }
   }
-  // solution failed, return negative one to indicate failure
+  // solution failed, reset the working set and return negative one to indicate failure
+  if (W_init) {
+    memset(W_init, 0, n_u * sizeof(float));
+  }
   return -1;
 }
 
 #if WLS_VERBOSE
-void print_in_and_outputs(int n_c, int n_free, float** A_free_ptr, float* d, float* p_free) {
+void print_in_and_outputs(int n_c, int n_free, float A[CA_N_C][CA_N_U], int* free_index, float* d, float* p_free) {
 
   printf("n_c = %d n_free = %d\n", n_c, n_free);
 
   printf("A_free =\n");
   for(int i = 0; i < n_c; i++) {
     for (int j = 0; j < n_free; j++) {
-      printf("%f ", A_free_ptr[i][j]);
+      printf("%f ", A[i][free_index[j]]);
     }
     printf("\n");
   }
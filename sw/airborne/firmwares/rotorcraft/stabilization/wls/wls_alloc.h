@@ -46,7 +46,8 @@ void qr_solve_wrapper(int m, int n, float** A, float* b, float* x);
  * @param n_u Length of u
  * @param n_v Lenght of v
  * @param u_guess Initial value for u
- * @param W_init Initial working set, if known
+ * @param W_init Initial working set, if known, updated with the final working set
+ * so that it can be used as a warm start in the next cycle
  * @param Wv Weighting on different control objectives
  * @param Wu Weighting on different controls
  * @param up Preferred control vector
@@ -19,7 +19,7 @@
  */
 
 /**
- * @file RANSAC.h
+ * @file RANSAC.c
  * @brief Perform Random Sample Consensus (RANSAC), a robust fitting method.
  *
  * The concept is to select (minimal) subsets of the samples for learning
@@ -29,101 +29,324 @@
  * Read: Fischler, M. A., & Bolles, R. C. (1981). Random sample consensus: a paradigm for model fitting with applications to image analysis and automated cartography.
  * Communications of the ACM, 24(6), 381-395.
  *
- * This file depends on the function fit_linear_model in math/pprz_matrix_decomp_float.h/c
+ * The linear model is fit with a least squares solver working on the fixed
+ * size workspace of the engine.
  */
 
 
 #include "RANSAC.h"
-#include "math/pprz_matrix_decomp_float.h"
 #include "math/pprz_algebra_float.h"
 #include <math.h>
+#include <float.h>
 #include <string.h>
 #include <stdlib.h>
-#include "stdio.h"
+
+/** Confidence used by RANSAC_linear_model to stop early */
+#ifndef RANSAC_CONFIDENCE
+#define RANSAC_CONFIDENCE 0.99f
+#endif
+
+/** Number of points used for preemptive scoring by RANSAC_linear_model */
+#ifndef RANSAC_PREEMPTIVE
+#define RANSAC_PREEMPTIVE 16
+#endif
+
+/** Relative column norm below which a subset is degenerated for the linear model */
+#define RANSAC_RANK_TOLERANCE 1e-4f
+
+/** xorshift32 random generator, state must not be zero */
+static inline uint32_t ransac_rand(uint32_t *state)
+{
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+/** Sample n distinct indices in [0, count) with Floyd's algorithm (bounded time) */
+static void ransac_sample(uint16_t *indices, uint16_t n, uint16_t count, uint32_t *rng)
+{
+  uint16_t k = 0;
+  for (uint32_t j = count - n; j < count; j++) {
+    uint16_t t = (uint16_t)(ransac_rand(rng) % (j + 1));
+    for (uint16_t i = 0; i < k; i++) {
+      if (indices[i] == t) {
+        t = (uint16_t)j;
+        break;
+      }
+    }
+    indices[k++] = t;
+  }
+}
+
+/** Number of iterations needed to draw an outlier free subset with some confidence */
+static uint16_t ransac_nb_iterations(float inlier_ratio, uint16_t n_samples, float confidence, uint16_t max_iterations)
+{
+  float p_good = powf(inlier_ratio, (float)n_samples);
+  if (p_good >= 1.f - FLT_EPSILON) {
+    return 1;
+  }
+  if (p_good <= FLT_EPSILON) {
+    return max_iterations;
+  }
+  float n = logf(1.f - confidence) / logf(1.f - p_good);
+  if (n >= (float)max_iterations) {
+    return max_iterations;
+  }
+  return (uint16_t)ceilf(n);
+}
+
+/** Sort a few indices in increasing order */
+static void ransac_sort(uint16_t *indices, uint16_t n)
+{
+  for (uint16_t i = 1; i < n; i++) {
+    uint16_t v = indices[i];
+    uint16_t j = i;
+    for (; j > 0 && indices[j - 1] > v; j--) {
+      indices[j] = indices[j - 1];
+    }
+    indices[j] = v;
+  }
+}
+
+/** Capped error of a sample, counted as inlier if below the threshold */
+static inline float ransac_capped_error(struct RansacModel *model, uint16_t index, float *params,
+                                        float error_threshold, uint16_t *n_inliers)
+{
+  float err = model->error(model->data, index, params);
+  if (err < error_threshold) {
+    (*n_inliers)++;
+    return err;
+  }
+  return error_threshold;
+}
+
+bool ransac_run(struct RansacModel *model, struct RansacSettings *settings, uint16_t count,
+                struct RansacResult *result)
+{
+  uint16_t indices[RANSAC_MAX_SAMPLES];
+  uint16_t pre_indices[RANSAC_MAX_PREEMPTIVE];
+  float params[RANSAC_MAX_PARAMS];
+
+  result->score = FLT_MAX;
+  result->n_inliers = 0;
+  result->n_iterations = 0;
+  memset(result->params, 0, sizeof(result->params));
+
+  uint16_t n_samples = settings->n_samples;
+  if (n_samples == 0 || n_samples > RANSAC_MAX_SAMPLES || count < n_samples || model->n_params > RANSAC_MAX_PARAMS) {
+    return false;
+  }
+  float confidence = Min(settings->confidence, 0.9999f);
+  uint32_t rng = settings->seed != 0 ? settings->seed : 0x9E3779B9;
+
+  // preemptive scoring only pays off if the subset is small compared to the data set
+  uint16_t n_pre = Min(settings->n_preemptive, RANSAC_MAX_PREEMPTIVE);
+  if (2 * n_pre >= count) {
+    n_pre = 0;
+  }
+  ransac_sample(pre_indices, n_pre, count, &rng);
+  ransac_sort(pre_indices, n_pre);
+
+  bool found = false;
+  uint16_t n_iterations = settings->max_iterations;
+  uint16_t it;
+  for (it = 0; it < n_iterations; it++) {
+    ransac_sample(indices, n_samples, count, &rng);
+    if (!model->fit(model->data, indices, n_samples, params)) {
+      continue;
+    }
+
+    // the capped errors are positive, so the score on the preemptive subset is a lower bound
+    // of the full score: reject the hypothesis if it is already worse than the best one
+    float score = 0.f;
+    uint16_t n_inliers = 0;
+    for (uint16_t i = 0; i < n_pre; i++) {
+      score += ransac_capped_error(model, pre_indices[i], params, settings->error_threshold, &n_inliers);
+    }
+    if (score >= result->score) {
+      continue;
+    }
+
+    // complete the score with the other points, stop as soon as it can not be the best one anymore
+    bool better = true;
+    uint16_t i = 0;
+    for (uint16_t p = 0; p < count; p++) {
+      if (i < n_pre && pre_indices[i] == p) {
+        i++;
+        continue;
+      }
+      score += ransac_capped_error(model, p, params, settings->error_threshold, &n_inliers);
+      if (score >= result->score) {
+        better = false;
+        break;
+      }
+    }
+    if (!better) {
+      continue;
+    }
+
+    found = true;
+    result->score = score;
+    result->n_inliers = n_inliers;
+    memcpy(result->params, params, model->n_params * sizeof(float));
+    if (confidence > 0.f) {
+      n_iterations = ransac_nb_iterations((float)n_inliers / (float)count, n_samples, confidence,
+                                          settings->max_iterations);
+    }
+  }
+
+  result->n_iterations = it;
+  settings->seed = rng;
+  return found;
+}
+
+/** Data of the linear model used by RANSAC_linear_model */
+struct ransac_linear_data {
+  float *targets;
+  float *samples;
+  int D;
+};
+
+/** Least squares solution of A x = b with Householder reflections, A is n x m with n >= m.
+ *  A and b are overwritten.
+ *  @return false if A is rank deficient
+ */
+static bool ransac_least_squares(float A[RANSAC_MAX_SAMPLES][RANSAC_MAX_PARAMS], float *b, uint16_t n, uint16_t m,
+                                 float *x)
+{
+  float col_norm[RANSAC_MAX_PARAMS];
+  for (uint16_t j = 0; j < m; j++) {
+    float s = 0.f;
+    for (uint16_t i = 0; i < n; i++) {
+      s += A[i][j] * A[i][j];
+    }
+    col_norm[j] = sqrtf(s);
+  }
+
+  // A = Q R, with R stored in the upper triangle of A and b replaced by Q' b
+  for (uint16_t k = 0; k < m; k++) {
+    float s = 0.f;
+    for (uint16_t i = k; i < n; i++) {
+      s += A[i][k] * A[i][k];
+    }
+    float norm = sqrtf(s);
+    if (norm <= RANSAC_RANK_TOLERANCE * col_norm[k]) {
+      return false;
+    }
+    float alpha = (A[k][k] > 0.f) ? -norm : norm;
+    // reflection vector v = A[k:n][k] - alpha e_k, with v'v = 2 norm (norm + |A[k][k]|)
+    A[k][k] -= alpha;
+    float vtv = 2.f * norm * (norm + fabsf(A[k][k] + alpha));
+    for (uint16_t j = k + 1; j < m; j++) {
+      float dot = 0.f;
+      for (uint16_t i = k; i < n; i++) {
+        dot += A[i][k] * A[i][j];
+      }
+      float f = 2.f * dot / vtv;
+      for (uint16_t i = k; i < n; i++) {
+        A[i][j] -= f * A[i][k];
+      }
+    }
+    float dot = 0.f;
+    for (uint16_t i = k; i < n; i++) {
+      dot += A[i][k] * b[i];
+    }
+    float f = 2.f * dot / vtv;
+    for (uint16_t i = k; i < n; i++) {
+      b[i] -= f * A[i][k];
+    }
+    A[k][k] = alpha;
+  }
+
+  // back substitution R x = Q' b
+  for (int16_t k = m - 1; k >= 0; k--) {
+    float s = b[k];
+    for (uint16_t j = k + 1; j < m; j++) {
+      s -= A[k][j] * x[j];
+    }
+    x[k] = s / A[k][k];
+  }
+  return true;
+}
+
+static bool ransac_linear_fit(void *data, uint16_t *indices, uint16_t n, float *params)
+{
+  struct ransac_linear_data *lin = (struct ransac_linear_data *)data;
+  float A[RANSAC_MAX_SAMPLES][RANSAC_MAX_PARAMS];
+  float b[RANSAC_MAX_SAMPLES];
+
+  // get the corresponding samples and targets, with a constant 1 for the bias:
+  for (uint16_t j = 0; j < n; j++) {
+    for (int k = 0; k < lin->D; k++) {
+      A[j][k] = lin->samples[indices[j] * lin->D + k];
+    }
+    A[j][lin->D] = 1.f;
+    b[j] = lin->targets[indices[j]];
+  }
+
+  // fit a linear model on the small system:
+  return ransac_least_squares(A, b, n, (uint16_t)(lin->D + 1), params);
+}
+
+static float ransac_linear_error(void *data, uint16_t index, float *params)
+{
+  struct ransac_linear_data *lin = (struct ransac_linear_data *)data;
+  float prediction = predict_value(&lin->samples[index * lin->D], params, lin->D, true);
+  return fabsf(prediction - lin->targets[index]);
+}
+
+/** Random state of RANSAC_linear_model, successive calls are reproducible */
+static uint32_t ransac_linear_seed = 1;
 
 /** Perform RANSAC to fit a linear model.
  *
- * @param[in] n_samples The number of samples to use for a single fit
- * @param[in] n_iterations The number of times a linear fit is performed
+ * @param[in] n_samples The number of samples to use for a single fit, at most RANSAC_MAX_SAMPLES
+ * @param[in] n_iterations The maximum number of times a linear fit is performed
  * @param[in] error_threshold The threshold used to cap errors in the RANSAC process
  * @param[in] targets The target values
  * @param[in] samples The samples / feature vectors
- * @param[in] D The dimensionality of the samples
+ * @param[in] D The dimensionality of the samples, at most RANSAC_MAX_PARAMS - 1
  * @param[in] count The number of samples
  * @param[out] parameters* Parameters of the linear fit, of size D + 1 (accounting for a constant 1 being added to the samples to represent a potential bias)
  * @param[out] fit_error* Total error of the fit
- *
+ * @return false if no fit was found or the workspace is too small, the parameters are then set to zero
  */
-void RANSAC_linear_model(int n_samples, int n_iterations, float error_threshold, float *targets, int D,
-                         float (*samples)[D], uint16_t count, float *params, float *fit_error __attribute__((unused)))
+bool RANSAC_linear_model(int n_samples, int n_iterations, float error_threshold, float *targets, int D,
+                         float (*samples)[D], uint16_t count, float *params, float *fit_error)
 {
-
-  uint8_t D_1 = D + 1;
-  float err;
-  float errors[n_iterations];
-  int indices_subset[n_samples];
-  float subset_targets[n_samples];
-  float subset_samples[n_samples][D];
-  float subset_params[n_iterations][D_1];
-  bool use_bias = true;
+  int D_1 = D + 1;
+  struct ransac_linear_data lin = { targets, &samples[0][0], D };
+  struct RansacModel model = { ransac_linear_fit, ransac_linear_error, &lin, (uint16_t)D_1 };
+  struct RansacResult result;
 
   // ensure that n_samples is high enough to ensure a result for a single fit:
   n_samples = (n_samples < D_1) ? D_1 : n_samples;
   // n_samples should not be higher than count:
   n_samples = (n_samples < count) ? n_samples : count;
 
-  // do the RANSAC iterations:
-  for (int i = 0; i < n_iterations; i++) {
+  struct RansacSettings settings = {
+    .n_samples = (uint16_t)n_samples,
+    .max_iterations = (uint16_t)Min(n_iterations, UINT16_MAX),
+    .error_threshold = error_threshold,
+    .confidence = RANSAC_CONFIDENCE,
+    .n_preemptive = RANSAC_PREEMPTIVE,
+    .seed = ransac_linear_seed
+  };
 
-    // get a subset of indices
-    get_indices_without_replacement(indices_subset, n_samples, count);
-
-    // get the corresponding samples and targets:
-    for (int j = 0; j < n_samples; j++) {
-      subset_targets[j] = targets[indices_subset[j]];
-      for (int k = 0; k < D; k++) {
-        subset_samples[j][k] = samples[indices_subset[j]][k];
-      }
-    }
-
-    // fit a linear model on the small system:
-    fit_linear_model(subset_targets, D, subset_samples, n_samples, use_bias, subset_params[i], &err);
-    printf("params normal: %f, %f\n", subset_params[i][0], subset_params[i][1]);
-    float priors[2];
-    priors[0] = 1.0f;
-    priors[1] = 10.0f;
-    fit_linear_model_prior(subset_targets, D, subset_samples, n_samples, use_bias, priors, subset_params[i], &err);
-    printf("params prior: %f, %f\n", subset_params[i][0], subset_params[i][1]);
-
-    // determine the error on the whole set:
-    float err_sum = 0.0f;
-    float prediction;
-    for (int j = 0; j < count; j++) {
-      // predict the sample's value and determine the absolute error:
-      prediction = predict_value(samples[j], subset_params[i], D, use_bias);
-      err = fabsf(prediction - targets[j]);
-      // cap the error with the threshold:
-      err = (err > error_threshold) ? error_threshold : err;
-      err_sum += err;
-    }
-    errors[i] = err_sum;
-  }
-
-  // determine the minimal error:
-  float min_err = errors[0];
-  int min_ind = 0;
-  for (int i = 1; i < n_iterations; i++) {
-    if (errors[i] < min_err) {
-      min_err = errors[i];
-      min_ind = i;
-    }
+  if (D_1 > RANSAC_MAX_PARAMS || n_samples > RANSAC_MAX_SAMPLES || !ransac_run(&model, &settings, count, &result)) {
+    memset(params, 0, D_1 * sizeof(float));
+    *fit_error = FLT_MAX;
+    return false;
   }
+  ransac_linear_seed = settings.seed;
 
   // copy the parameters:
-  for (int d = 0; d < D_1; d++) {
-    params[d] = subset_params[min_ind][d];
-  }
-
+  memcpy(params, result.params, D_1 * sizeof(float));
+  *fit_error = result.score;
+  return true;
 }
 
 /** Predict the value of a sample with linear weights.
@@ -29,7 +29,13 @@
  * Read: Fischler, M. A., & Bolles, R. C. (1981). Random sample consensus: a paradigm for model fitting with applications to image analysis and automated cartography.
  * Communications of the ACM, 24(6), 381-395.
  *
- * This file depends on the function fit_linear_model in math/pprz_matrix_decomp_float.h/c
+ * The generic engine ransac_run() works on any model given by a fit and an
+ * error function. It does not allocate memory, uses a fixed size workspace
+ * and its own random generator, so a run is reproducible from its seed.
+ * The number of iterations is adapted to the best inlier ratio found so far.
+ * Hypotheses are first scored on a small random subset of the data, and
+ * rejected if this partial score already exceeds the best full score, so
+ * preemption never drops a better hypothesis.
  */
 
 #ifndef RANSAC_H
@@ -41,19 +47,86 @@ extern "C" {
 
 #include "std.h"
 
+/** Maximum number of samples used for a single fit */
+#ifndef RANSAC_MAX_SAMPLES
+#define RANSAC_MAX_SAMPLES 16
+#endif
+
+/** Maximum number of model parameters */
+#ifndef RANSAC_MAX_PARAMS
+#define RANSAC_MAX_PARAMS 8
+#endif
+
+/** Maximum number of points used for preemptive scoring */
+#ifndef RANSAC_MAX_PREEMPTIVE
+#define RANSAC_MAX_PREEMPTIVE 32
+#endif
+
+/** Fit the model parameters on a subset of the data.
+ * @param[in] data user data of the model
+ * @param[in] indices indices of the samples to use
+ * @param[in] n number of samples
+ * @param[out] params fitted parameters
+ * @return false if the subset is degenerated
+ */
+typedef bool (*ransac_fit_fn)(void *data, uint16_t *indices, uint16_t n, float *params);
+
+/** Absolute error of a single sample for some model parameters.
+ * @param[in] data user data of the model
+ * @param[in] index index of the sample
+ * @param[in] params model parameters
+ * @return the absolute error
+ */
+typedef float (*ransac_error_fn)(void *data, uint16_t index, float *params);
+
+struct RansacModel {
+  ransac_fit_fn fit;      ///< fit function
+  ransac_error_fn error;  ///< error function
+  void *data;             ///< user data passed to fit and error functions
+  uint16_t n_params;      ///< number of parameters, at most RANSAC_MAX_PARAMS
+};
+
+struct RansacSettings {
+  uint16_t n_samples;       ///< number of samples for a single fit, ransac_run fails above RANSAC_MAX_SAMPLES
+  uint16_t max_iterations;  ///< maximum number of hypotheses
+  float error_threshold;    ///< sample errors are capped to this value, samples below it are inliers
+  float confidence;         ///< stop when the best model is found with this probability, 0 to run all iterations
+  uint16_t n_preemptive;    ///< number of random points scored first, at most RANSAC_MAX_PREEMPTIVE, 0 to disable
+  uint32_t seed;            ///< random generator state, updated by each run
+};
+
+struct RansacResult {
+  float params[RANSAC_MAX_PARAMS];  ///< parameters of the best model
+  float score;                      ///< sum of the capped errors of the best model
+  uint16_t n_inliers;               ///< number of inliers of the best model
+  uint16_t n_iterations;            ///< number of hypotheses generated
+};
+
+/** Run RANSAC on a generic model.
+ *
+ * @param[in] model The model to fit
+ * @param[in,out] settings RANSAC settings, the seed is updated so that successive runs draw different subsets
+ * @param[in] count The number of samples in the data set
+ * @param[out] result The best model
+ * @return false if no model could be fit or the settings exceed the workspace
+ */
+bool ransac_run(struct RansacModel *model, struct RansacSettings *settings, uint16_t count,
+                struct RansacResult *result);
+
 /** Perform RANSAC to fit a linear model.
  *
- * @param[in] n_samples The number of samples to use for a single fit
- * @param[in] n_iterations The number of times a linear fit is performed
+ * @param[in] n_samples The number of samples to use for a single fit, at most RANSAC_MAX_SAMPLES
+ * @param[in] n_iterations The maximum number of times a linear fit is performed
  * @param[in] error_threshold The threshold used to cap errors in the RANSAC process
  * @param[in] targets The target values
  * @param[in] samples The samples / feature vectors
- * @param[in] D The dimensionality of the samples
+ * @param[in] D The dimensionality of the samples, at most RANSAC_MAX_PARAMS - 1
  * @param[in] count The number of samples
  * @param[out] parameters* Parameters of the linear fit
  * @param[out] fit_error* Total error of the fit
+ * @return false if no fit was found or the workspace is too small, the parameters are then set to zero
  */
-void RANSAC_linear_model(int n_samples, int n_iterations, float error_threshold, float *targets, int D,
+bool RANSAC_linear_model(int n_samples, int n_iterations, float error_threshold, float *targets, int D,
                          float (*samples)[D], uint16_t count, float *params, float *fit_error);
 
 /** Get indices without replacement.
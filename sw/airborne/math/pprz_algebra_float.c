@@ -418,6 +418,34 @@ void float_quat_integrate(struct FloatQuat *q, struct FloatRates *omega, float d
   }
 }
 
+void float_quat_slerp(struct FloatQuat *q_out, struct FloatQuat *q0, struct FloatQuat *q1, float t)
+{
+  float dot = q0->qi * q1->qi + q0->qx * q1->qx + q0->qy * q1->qy + q0->qz * q1->qz;
+  /* take the shortest path */
+  float sign = 1.f;
+  if (dot < 0.f) {
+    dot = -dot;
+    sign = -1.f;
+  }
+  float s0, s1;
+  if (dot > 0.9995f) {
+    /* quaternions are very close, use linear interpolation */
+    s0 = 1.f - t;
+    s1 = t;
+  } else {
+    const float theta = acosf(dot);
+    const float sin_theta = sinf(theta);
+    s0 = sinf((1.f - t) * theta) / sin_theta;
+    s1 = sinf(t * theta) / sin_theta;
+  }
+  s1 *= sign;
+  q_out->qi = s0 * q0->qi + s1 * q1->qi;
+  q_out->qx = s0 * q0->qx + s1 * q1->qx;
+  q_out->qy = s0 * q0->qy + s1 * q1->qy;
+  q_out->qz = s0 * q0->qz + s1 * q1->qz;
+  float_quat_normalize(q_out);
+}
+
 void float_quat_vmult(struct FloatVect3 *v_out, struct FloatQuat *q, const struct FloatVect3 *v_in)
 {
   const float qi2_M1_2  = q->qi * q->qi - 0.5;
@@ -457,6 +457,16 @@ extern void float_quat_integrate_fi(struct FloatQuat *q, struct FloatRates *omeg
 /** in place quaternion integration with constant rotational velocity */
 extern void float_quat_integrate(struct FloatQuat *q, struct FloatRates *omega, float dt);
 
+/** Spherical linear interpolation between two unit quaternions.
+ * Takes the shortest path, falls back to normalized linear interpolation
+ * for very close quaternions.
+ * @param q_out interpolated quaternion
+ * @param q0 quaternion at t = 0
+ * @param q1 quaternion at t = 1
+ * @param t interpolation parameter in [0, 1]
+ */
+extern void float_quat_slerp(struct FloatQuat *q_out, struct FloatQuat *q0, struct FloatQuat *q1, float t);
+
 /** rotate 3D vector by quaternion.
  * vb = q_a2b * va * q_a2b^-1
  */
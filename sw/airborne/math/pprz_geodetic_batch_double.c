@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pprz_geodetic_batch_double.c
+ * @brief Double-precision geodetic conversions of arrays of points.
+ *
+ */
+
+#include "pprz_geodetic_batch_double.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__GNUC__) && !defined(PPRZ_GEODETIC_BATCH_NO_SIMD)
+#define PPRZ_GEODETIC_BATCH_SIMD 1
+/** two doubles, maps to SSE2 on x86_64 and NEON on aarch64 */
+typedef double v2d __attribute__((vector_size(16)));
+
+static inline v2d v2d_load(const double *p)
+{
+  v2d v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline void v2d_store(double *p, v2d v)
+{
+  memcpy(p, &v, sizeof(v));
+}
+#endif
+
+// FIXME : make an ellipsoid struct
+#define WGS84_A 6378137.0           /* earth semimajor axis in meters */
+#define WGS84_F (1. / 298.257223563)  /* reciprocal flattening          */
+
+void lla_of_ecef_fast_d(struct LlaCoor_d *lla, struct EcefCoor_d *ecef)
+{
+  const double a = WGS84_A;
+  const double f = WGS84_F;
+  const double b = a * (1. - f);                            /* semi-minor axis               */
+  const double e2 = 2.*f - (f * f);                         /* first eccentricity squared    */
+  const double ep2 = f * (2. - f) / ((1. - f) * (1. - f));  /* second eccentricity squared   */
+
+  const double x = ecef->x, y = ecef->y, z = ecef->z;
+  const double p = sqrt(x * x + y * y);
+
+  /* parametric latitude u, tan(u) = z * a / (p * b) */
+  double su = z * a, cu = p * b;
+  double nu = sqrt(su * su + cu * cu);
+  if (nu > 0.) {
+    su /= nu;
+    cu /= nu;
+  } else {
+    su = 0.;
+    cu = 1.;
+  }
+
+  /* Bowring's formula for the geodetic latitude */
+  double num = z + ep2 * b * su * su * su;
+  double den = p - e2 * a * cu * cu * cu;
+  /* one more iteration from the updated parametric latitude, tan(u) = (1 - f) tan(lat) */
+  su = (1. - f) * num;
+  cu = den;
+  nu = sqrt(su * su + cu * cu);
+  if (nu > 0.) {
+    su /= nu;
+    cu /= nu;
+  }
+  num = z + ep2 * b * su * su * su;
+  den = p - e2 * a * cu * cu * cu;
+
+  const double h = sqrt(num * num + den * den);
+  const double s_lat = h > 0. ? num / h : 0.;
+  const double c_lat = h > 0. ? den / h : 1.;
+
+  lla->lat = atan2(num, den);
+  lla->lon = atan2(y, x);
+  /* distance along the normal, valid at all latitudes */
+  lla->alt = p * c_lat + z * s_lat - a * sqrt(1. - e2 * s_lat * s_lat);
+}
+
+void lla_of_ecef_array_d(struct LlaCoorArray_d *lla, struct EcefCoorArray_d *ecef, int n)
+{
+  for (int i = 0; i < n; i++) {
+    struct EcefCoor_d e = { ecef->x[i], ecef->y[i], ecef->z[i] };
+    struct LlaCoor_d l;
+    lla_of_ecef_fast_d(&l, &e);
+    lla->lat[i] = l.lat;
+    lla->lon[i] = l.lon;
+    lla->alt[i] = l.alt;
+  }
+}
+
+void ecef_of_lla_array_d(struct EcefCoorArray_d *ecef, struct LlaCoorArray_d *lla, int n)
+{
+  const double a = WGS84_A;
+  const double f = WGS84_F;
+  const double e2 = 2.*f - (f * f);            /* first eccentricity squared     */
+
+  for (int i = 0; i < n; i++) {
+    const double sin_lat = sin(lla->lat[i]);
+    const double cos_lat = cos(lla->lat[i]);
+    const double sin_lon = sin(lla->lon[i]);
+    const double cos_lon = cos(lla->lon[i]);
+    const double a_chi = a / sqrt(1. - e2 * sin_lat * sin_lat);
+    const double alt = lla->alt[i];
+
+    ecef->x[i] = (a_chi + alt) * cos_lat * cos_lon;
+    ecef->y[i] = (a_chi + alt) * cos_lat * sin_lon;
+    ecef->z[i] = (a_chi * (1. - e2) + alt) * sin_lat;
+  }
+}
+
+/** out = sign * ltp_of_ecef * (in - origin), with sign = -1 for the third axis to get NED */
+static void ltp_of_ecef_points(double *ox, double *oy, double *oz, struct LtpDef_d *def,
+                               double *ix, double *iy, double *iz, int n, double sign_z)
+{
+  const double *m = def->ltp_of_ecef.m;
+  int i = 0;
+#if PPRZ_GEODETIC_BATCH_SIMD
+  for (; i + 2 <= n; i += 2) {
+    v2d dx = v2d_load(&ix[i]) - def->ecef.x;
+    v2d dy = v2d_load(&iy[i]) - def->ecef.y;
+    v2d dz = v2d_load(&iz[i]) - def->ecef.z;
+    v2d rx = m[0] * dx + m[1] * dy + m[2] * dz;
+    v2d ry = m[3] * dx + m[4] * dy + m[5] * dz;
+    v2d rz = sign_z * (m[6] * dx + m[7] * dy + m[8] * dz);
+    v2d_store(&ox[i], rx);
+    v2d_store(&oy[i], ry);
+    v2d_store(&oz[i], rz);
+  }
+#endif
+  for (; i < n; i++) {
+    const double dx = ix[i] - def->ecef.x;
+    const double dy = iy[i] - def->ecef.y;
+    const double dz = iz[i] - def->ecef.z;
+    ox[i] = m[0] * dx + m[1] * dy + m[2] * dz;
+    oy[i] = m[3] * dx + m[4] * dy + m[5] * dz;
+    oz[i] = sign_z * (m[6] * dx + m[7] * dy + m[8] * dz);
+  }
+}
+
+/** out = ltp_of_ecef' * in + origin, in is (east, north, sign * up) */
+static void ecef_of_ltp_points(double *ox, double *oy, double *oz, struct LtpDef_d *def,
+                               double *ie, double *in, double *iu, int n, double sign_u)
+{
+  const double *m = def->ltp_of_ecef.m;
+  int i = 0;
+#if PPRZ_GEODETIC_BATCH_SIMD
+  for (; i + 2 <= n; i += 2) {
+    v2d e = v2d_load(&ie[i]);
+    v2d nn = v2d_load(&in[i]);
+    v2d u = sign_u * v2d_load(&iu[i]);
+    v2d_store(&ox[i], m[0] * e + m[3] * nn + m[6] * u + def->ecef.x);
+    v2d_store(&oy[i], m[1] * e + m[4] * nn + m[7] * u + def->ecef.y);
+    v2d_store(&oz[i], m[2] * e + m[5] * nn + m[8] * u + def->ecef.z);
+  }
+#endif
+  for (; i < n; i++) {
+    const double e = ie[i];
+    const double nn = in[i];
+    const double u = sign_u * iu[i];
+    ox[i] = m[0] * e + m[3] * nn + m[6] * u + def->ecef.x;
+    oy[i] = m[1] * e + m[4] * nn + m[7] * u + def->ecef.y;
+    oz[i] = m[2] * e + m[5] * nn + m[8] * u + def->ecef.z;
+  }
+}
+
+void enu_of_ecef_point_array_d(struct EnuCoorArray_d *enu, struct LtpDef_d *def,
+                               struct EcefCoorArray_d *ecef, int n)
+{
+  ltp_of_ecef_points(enu->x, enu->y, enu->z, def, ecef->x, ecef->y, ecef->z, n, 1.);
+}
+
+void ned_of_ecef_point_array_d(struct NedCoorArray_d *ned, struct LtpDef_d *def,
+                               struct EcefCoorArray_d *ecef, int n)
+{
+  // north is the second row and east the first one
+  ltp_of_ecef_points(ned->y, ned->x, ned->z, def, ecef->x, ecef->y, ecef->z, n, -1.);
+}
+
+void ecef_of_enu_point_array_d(struct EcefCoorArray_d *ecef, struct LtpDef_d *def,
+                               struct EnuCoorArray_d *enu, int n)
+{
+  ecef_of_ltp_points(ecef->x, ecef->y, ecef->z, def, enu->x, enu->y, enu->z, n, 1.);
+}
+
+void ecef_of_ned_point_array_d(struct EcefCoorArray_d *ecef, struct LtpDef_d *def,
+                               struct NedCoorArray_d *ned, int n)
+{
+  ecef_of_ltp_points(ecef->x, ecef->y, ecef->z, def, ned->y, ned->x, ned->z, n, -1.);
+}
+
+void enu_of_lla_point_array_d(struct EnuCoorArray_d *enu, struct LtpDef_d *def,
+                              struct LlaCoorArray_d *lla, int n)
+{
+  // ECEF points are stored in the output arrays then converted in place
+  struct EcefCoorArray_d ecef = { enu->x, enu->y, enu->z };
+  ecef_of_lla_array_d(&ecef, lla, n);
+  enu_of_ecef_point_array_d(enu, def, &ecef, n);
+}
+
+void ned_of_lla_point_array_d(struct NedCoorArray_d *ned, struct LtpDef_d *def,
+                              struct LlaCoorArray_d *lla, int n)
+{
+  struct EcefCoorArray_d ecef = { ned->x, ned->y, ned->z };
+  ecef_of_lla_array_d(&ecef, lla, n);
+  ned_of_ecef_point_array_d(ned, def, &ecef, n);
+}
+
+void utm_of_lla_array_d(struct UtmCoorArray_d *utm, struct LlaCoorArray_d *lla, int n)
+{
+  struct UtmCoor_d u;
+  u.zone = utm->zone;
+  for (int i = 0; i < n; i++) {
+    struct LlaCoor_d l = { lla->lat[i], lla->lon[i], lla->alt[i] };
+    utm_of_lla_d(&u, &l);
+    utm->north[i] = u.north;
+    utm->east[i] = u.east;
+    utm->alt[i] = u.alt;
+  }
+  utm->zone = u.zone;
+}
+
+void lla_of_utm_array_d(struct LlaCoorArray_d *lla, struct UtmCoorArray_d *utm, int n)
+{
+  struct UtmCoor_d u;
+  u.zone = utm->zone;
+  for (int i = 0; i < n; i++) {
+    struct LlaCoor_d l;
+    u.north = utm->north[i];
+    u.east = utm->east[i];
+    u.alt = utm->alt[i];
+    lla_of_utm_d(&l, &u);
+    lla->lat[i] = l.lat;
+    lla->lon[i] = l.lon;
+    lla->alt[i] = l.alt;
+  }
+}
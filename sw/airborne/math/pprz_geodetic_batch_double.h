@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pprz_geodetic_batch_double.h
+ * @brief Double-precision geodetic conversions of arrays of points.
+ *
+ * @addtogroup math_geodetic
+ * @{
+ * Batched double Geodetic functions.
+ * @addtogroup math_geodetic_batch_double Batched double Geodetic functions
+ * @{
+ *
+ * Points are passed as structures of arrays (one array per coordinate)
+ * so that the conversions can process several points with SIMD
+ * instructions. Without GCC vector extensions, or when
+ * PPRZ_GEODETIC_BATCH_NO_SIMD is defined, plain loops are used.
+ *
+ * Input and output arrays can be the same (in-place conversion).
+ */
+
+#ifndef PPRZ_GEODETIC_BATCH_DOUBLE_H
+#define PPRZ_GEODETIC_BATCH_DOUBLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "pprz_geodetic_double.h"
+
+/** Array of points in ECEF coordinates, in meters */
+struct EcefCoorArray_d {
+  double *x;
+  double *y;
+  double *z;
+};
+
+/** Array of points in LLA coordinates, lat/lon in radians, alt in meters */
+struct LlaCoorArray_d {
+  double *lat;
+  double *lon;
+  double *alt;
+};
+
+/** Array of points in NED coordinates, in meters */
+struct NedCoorArray_d {
+  double *x;
+  double *y;
+  double *z;
+};
+
+/** Array of points in ENU coordinates, in meters */
+struct EnuCoorArray_d {
+  double *x;
+  double *y;
+  double *z;
+};
+
+/** Array of points in UTM coordinates, in meters, all in the same zone */
+struct UtmCoorArray_d {
+  double *north;
+  double *east;
+  double *alt;
+  uint8_t zone; ///< UTM zone number, computed from the first point if 0
+};
+
+/**
+ * Fast closed-form ECEF to LLA conversion.
+ * Uses Bowring's formula without intermediate trigonometric functions,
+ * error is below 1e-10 rad and 1 mm from the surface up to 1000 km of altitude.
+ */
+extern void lla_of_ecef_fast_d(struct LlaCoor_d *lla, struct EcefCoor_d *ecef);
+
+extern void lla_of_ecef_array_d(struct LlaCoorArray_d *lla, struct EcefCoorArray_d *ecef, int n);
+extern void ecef_of_lla_array_d(struct EcefCoorArray_d *ecef, struct LlaCoorArray_d *lla, int n);
+
+extern void enu_of_ecef_point_array_d(struct EnuCoorArray_d *enu, struct LtpDef_d *def,
+                                      struct EcefCoorArray_d *ecef, int n);
+extern void ned_of_ecef_point_array_d(struct NedCoorArray_d *ned, struct LtpDef_d *def,
+                                      struct EcefCoorArray_d *ecef, int n);
+
+extern void ecef_of_enu_point_array_d(struct EcefCoorArray_d *ecef, struct LtpDef_d *def,
+                                      struct EnuCoorArray_d *enu, int n);
+extern void ecef_of_ned_point_array_d(struct EcefCoorArray_d *ecef, struct LtpDef_d *def,
+                                      struct NedCoorArray_d *ned, int n);
+
+extern void enu_of_lla_point_array_d(struct EnuCoorArray_d *enu, struct LtpDef_d *def,
+                                     struct LlaCoorArray_d *lla, int n);
+extern void ned_of_lla_point_array_d(struct NedCoorArray_d *ned, struct LtpDef_d *def,
+                                     struct LlaCoorArray_d *lla, int n);
+
+extern void utm_of_lla_array_d(struct UtmCoorArray_d *utm, struct LlaCoorArray_d *lla, int n);
+extern void lla_of_utm_array_d(struct LlaCoorArray_d *lla, struct UtmCoorArray_d *utm, int n);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PPRZ_GEODETIC_BATCH_DOUBLE_H */
+/** @}*/
+/** @}*/
@@ -0,0 +1,379 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pprz_matrix_fixed_float.h
+ * @brief Fixed-size square matrix algebra on contiguous float arrays.
+ *
+ * The generic float_mat_* functions of pprz_algebra_float.h work on
+ * row pointer arrays (float **) of any size, which needs a pointer array
+ * (MAKE_MATRIX_PTR) for each call and prevents the compiler from unrolling
+ * and vectorizing the loops.
+ *
+ * The functions below work directly on `float m[N][N]` arrays and are
+ * specialized for the sizes commonly used in filters (3, 4, 6 and 9),
+ * all loop bounds are compile-time constants. The products of these sizes
+ * are unrolled, with NEON the 4x4 ones use intrinsics. The generic loop
+ * versions stay available as float_matN_mul_generic and
+ * float_matN_vect_mul_generic.
+ *
+ * For a size N the available functions are:
+ * - float_matN_zero(o), float_matN_identity(o), float_matN_copy(o, a)
+ * - float_matN_sum(o, a, b), float_matN_diff(o, a, b), float_matN_scale(a, k)
+ * - float_matN_transpose(o, a)
+ * - float_matN_mul(o, a, b): o = a * b
+ * - float_matN_mul_transp(o, a, b): o = a * b'
+ * - float_matN_vect_mul(o, a, v): o = a * v
+ * - float_matN_invert(o, a): Gauss-Jordan with partial pivoting
+ * - float_matN_cholesky(o, a): lower triangular o with a = o * o'
+ *
+ * The output must not be one of the inputs for mul, mul_transp,
+ * vect_mul and transpose.
+ * Other sizes can be defined with PPRZ_FLOAT_MAT_FIXED_DEFINE(N).
+ */
+
+#ifndef PPRZ_MATRIX_FIXED_FLOAT_H
+#define PPRZ_MATRIX_FIXED_FLOAT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "std.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PPRZ_MAT_FIXED_NEON 1
+#endif
+
+/** Element-wise operations, transposition, inversion and decomposition */
+#define PPRZ_FLOAT_MAT_FIXED_DEFINE_COMMON(N) \
+  \
+  /** o = 0 */ \
+  static inline void float_mat##N##_zero(float o[N][N]) \
+  { \
+    memset(o, 0, sizeof(float) * N * N); \
+  } \
+  \
+  /** o = I */ \
+  static inline void float_mat##N##_identity(float o[N][N]) \
+  { \
+    memset(o, 0, sizeof(float) * N * N); \
+    for (int i = 0; i < N; i++) { o[i][i] = 1.f; } \
+  } \
+  \
+  /** o = a */ \
+  static inline void float_mat##N##_copy(float o[N][N], float a[N][N]) \
+  { \
+    memcpy(o, a, sizeof(float) * N * N); \
+  } \
+  \
+  /** o = a + b */ \
+  static inline void float_mat##N##_sum(float o[N][N], float a[N][N], float b[N][N]) \
+  { \
+    float *_o = &o[0][0], *_a = &a[0][0], *_b = &b[0][0]; \
+    for (int i = 0; i < N * N; i++) { _o[i] = _a[i] + _b[i]; } \
+  } \
+  \
+  /** o = a - b */ \
+  static inline void float_mat##N##_diff(float o[N][N], float a[N][N], float b[N][N]) \
+  { \
+    float *_o = &o[0][0], *_a = &a[0][0], *_b = &b[0][0]; \
+    for (int i = 0; i < N * N; i++) { _o[i] = _a[i] - _b[i]; } \
+  } \
+  \
+  /** a = a * k */ \
+  static inline void float_mat##N##_scale(float a[N][N], float k) \
+  { \
+    float *_a = &a[0][0]; \
+    for (int i = 0; i < N * N; i++) { _a[i] *= k; } \
+  } \
+  \
+  /** o = a' */ \
+  static inline void float_mat##N##_transpose(float o[N][N], float a[N][N]) \
+  { \
+    for (int i = 0; i < N; i++) { \
+      for (int j = 0; j < N; j++) { o[j][i] = a[i][j]; } \
+    } \
+  } \
+  \
+  /** o = a * b' */ \
+  static inline void float_mat##N##_mul_transp(float o[N][N], float a[N][N], float b[N][N]) \
+  { \
+    for (int i = 0; i < N; i++) { \
+      for (int j = 0; j < N; j++) { \
+        float sum = 0.f; \
+        for (int k = 0; k < N; k++) { sum += a[i][k] * b[j][k]; } \
+        o[i][j] = sum; \
+      } \
+    } \
+  } \
+  \
+  /** o = a^-1, returns false if a is singular */ \
+  static inline bool float_mat##N##_invert(float o[N][N], float a[N][N]) \
+  { \
+    float t[N][N]; \
+    memcpy(t, a, sizeof(t)); \
+    float_mat##N##_identity(o); \
+    for (int c = 0; c < N; c++) { \
+      int p = c; \
+      for (int r = c + 1; r < N; r++) { \
+        if (fabsf(t[r][c]) > fabsf(t[p][c])) { p = r; } \
+      } \
+      if (fabsf(t[p][c]) < 1e-20f) { return false; } \
+      if (p != c) { \
+        for (int k = 0; k < N; k++) { \
+          float tmp = t[c][k]; t[c][k] = t[p][k]; t[p][k] = tmp; \
+          tmp = o[c][k]; o[c][k] = o[p][k]; o[p][k] = tmp; \
+        } \
+      } \
+      float inv = 1.f / t[c][c]; \
+      for (int k = 0; k < N; k++) { t[c][k] *= inv; o[c][k] *= inv; } \
+      for (int r = 0; r < N; r++) { \
+        if (r != c) { \
+          float f = t[r][c]; \
+          for (int k = 0; k < N; k++) { t[r][k] -= f * t[c][k]; o[r][k] -= f * o[c][k]; } \
+        } \
+      } \
+    } \
+    return true; \
+  } \
+  \
+  /** Cholesky decomposition a = o * o', returns false if a is not positive definite */ \
+  static inline bool float_mat##N##_cholesky(float o[N][N], float a[N][N]) \
+  { \
+    memset(o, 0, sizeof(float) * N * N); \
+    for (int i = 0; i < N; i++) { \
+      for (int j = 0; j <= i; j++) { \
+        float sum = a[i][j]; \
+        for (int k = 0; k < j; k++) { sum -= o[i][k] * o[j][k]; } \
+        if (i == j) { \
+          if (sum <= 0.f) { return false; } \
+          o[i][i] = sqrtf(sum); \
+        } else { \
+          o[i][j] = sum / o[j][j]; \
+        } \
+      } \
+    } \
+    return true; \
+  }
+
+/** Generic products, always defined with a _generic suffix as a reference
+ * for the specialized versions */
+#define PPRZ_FLOAT_MAT_FIXED_DEFINE_MUL_GENERIC(N) \
+  \
+  /** o = a * b */ \
+  static inline void float_mat##N##_mul_generic(float o[N][N], float a[N][N], float b[N][N]) \
+  { \
+    for (int i = 0; i < N; i++) { \
+      float row[N]; \
+      for (int j = 0; j < N; j++) { row[j] = a[i][0] * b[0][j]; } \
+      for (int k = 1; k < N; k++) { \
+        const float aik = a[i][k]; \
+        for (int j = 0; j < N; j++) { row[j] += aik * b[k][j]; } \
+      } \
+      for (int j = 0; j < N; j++) { o[i][j] = row[j]; } \
+    } \
+  } \
+  \
+  /** o = a * v, two partial sums to halve the dependency chain */ \
+  static inline void float_mat##N##_vect_mul_generic(float o[N], float a[N][N], float v[N]) \
+  { \
+    for (int i = 0; i < N; i++) { \
+      float s0 = 0.f, s1 = 0.f; \
+      int k = 0; \
+      for (; k + 1 < N; k += 2) { \
+        s0 += a[i][k] * v[k]; \
+        s1 += a[i][k + 1] * v[k + 1]; \
+      } \
+      if (k < N) { s0 += a[i][k] * v[k]; } \
+      o[i] = s0 + s1; \
+    } \
+  }
+
+/** Products using the generic versions */
+#define PPRZ_FLOAT_MAT_FIXED_DEFINE_MUL(N) \
+  PPRZ_FLOAT_MAT_FIXED_DEFINE_MUL_GENERIC(N) \
+  \
+  /** o = a * b */ \
+  static inline void float_mat##N##_mul(float o[N][N], float a[N][N], float b[N][N]) \
+  { \
+    float_mat##N##_mul_generic(o, a, b); \
+  } \
+  \
+  /** o = a * v */ \
+  static inline void float_mat##N##_vect_mul(float o[N], float a[N][N], float v[N]) \
+  { \
+    float_mat##N##_vect_mul_generic(o, a, v); \
+  }
+
+/** Define all functions for a matrix size */
+#define PPRZ_FLOAT_MAT_FIXED_DEFINE(N) \
+  PPRZ_FLOAT_MAT_FIXED_DEFINE_COMMON(N) \
+  PPRZ_FLOAT_MAT_FIXED_DEFINE_MUL(N)
+
+PPRZ_FLOAT_MAT_FIXED_DEFINE_COMMON(3)
+PPRZ_FLOAT_MAT_FIXED_DEFINE_MUL_GENERIC(3)
+PPRZ_FLOAT_MAT_FIXED_DEFINE_COMMON(4)
+PPRZ_FLOAT_MAT_FIXED_DEFINE_MUL_GENERIC(4)
+PPRZ_FLOAT_MAT_FIXED_DEFINE_COMMON(6)
+PPRZ_FLOAT_MAT_FIXED_DEFINE_MUL_GENERIC(6)
+PPRZ_FLOAT_MAT_FIXED_DEFINE_COMMON(9)
+PPRZ_FLOAT_MAT_FIXED_DEFINE_MUL_GENERIC(9)
+
+/*
+ * Specialized products.
+ * The loops of the generic versions are a single chain of dependent
+ * multiply-adds per output, or are too short to be vectorized with an
+ * epilogue, and are often slower than the float ** versions. The sums below
+ * are split into independent partial sums and the row updates are unrolled
+ * so that they map to 4 float wide vector operations.
+ */
+
+/** o = a * b */
+static inline void float_mat3_mul(float o[3][3], float a[3][3], float b[3][3])
+{
+  for (int i = 0; i < 3; i++) {
+    const float a0 = a[i][0], a1 = a[i][1], a2 = a[i][2];
+    o[i][0] = a0 * b[0][0] + a1 * b[1][0] + a2 * b[2][0];
+    o[i][1] = a0 * b[0][1] + a1 * b[1][1] + a2 * b[2][1];
+    o[i][2] = a0 * b[0][2] + a1 * b[1][2] + a2 * b[2][2];
+  }
+}
+
+/** o = a * v */
+static inline void float_mat3_vect_mul(float o[3], float a[3][3], float v[3])
+{
+  for (int i = 0; i < 3; i++) {
+    o[i] = a[i][0] * v[0] + a[i][1] * v[1] + a[i][2] * v[2];
+  }
+}
+
+/** o = a * b */
+static inline void float_mat6_mul(float o[6][6], float a[6][6], float b[6][6])
+{
+  for (int i = 0; i < 6; i++) {
+    float row[6];
+    for (int j = 0; j < 6; j++) { row[j] = a[i][0] * b[0][j]; }
+    for (int k = 1; k < 6; k++) {
+      const float aik = a[i][k];
+      for (int j = 0; j < 4; j++) { row[j] += aik * b[k][j]; }
+      row[4] += aik * b[k][4];
+      row[5] += aik * b[k][5];
+    }
+    for (int j = 0; j < 6; j++) { o[i][j] = row[j]; }
+  }
+}
+
+/** o = a * v */
+static inline void float_mat6_vect_mul(float o[6], float a[6][6], float v[6])
+{
+  for (int i = 0; i < 6; i++) {
+    const float s0 = a[i][0] * v[0] + a[i][1] * v[1] + a[i][2] * v[2];
+    const float s1 = a[i][3] * v[3] + a[i][4] * v[4] + a[i][5] * v[5];
+    o[i] = s0 + s1;
+  }
+}
+
+/** o = a * b */
+static inline void float_mat9_mul(float o[9][9], float a[9][9], float b[9][9])
+{
+  for (int i = 0; i < 9; i++) {
+    float row[9];
+    for (int j = 0; j < 9; j++) { row[j] = a[i][0] * b[0][j]; }
+    for (int k = 1; k < 9; k++) {
+      const float aik = a[i][k];
+      for (int j = 0; j < 8; j++) { row[j] += aik * b[k][j]; }
+      row[8] += aik * b[k][8];
+    }
+    for (int j = 0; j < 9; j++) { o[i][j] = row[j]; }
+  }
+}
+
+/** o = a * v */
+static inline void float_mat9_vect_mul(float o[9], float a[9][9], float v[9])
+{
+  for (int i = 0; i < 9; i++) {
+    const float s0 = a[i][0] * v[0] + a[i][1] * v[1] + a[i][2] * v[2];
+    const float s1 = a[i][3] * v[3] + a[i][4] * v[4] + a[i][5] * v[5];
+    const float s2 = a[i][6] * v[6] + a[i][7] * v[7] + a[i][8] * v[8];
+    o[i] = s0 + s1 + s2;
+  }
+}
+
+#if PPRZ_MAT_FIXED_NEON
+
+/** o = a * b, NEON version */
+static inline void float_mat4_mul(float o[4][4], float a[4][4], float b[4][4])
+{
+  float32x4_t b0 = vld1q_f32(b[0]);
+  float32x4_t b1 = vld1q_f32(b[1]);
+  float32x4_t b2 = vld1q_f32(b[2]);
+  float32x4_t b3 = vld1q_f32(b[3]);
+  for (int i = 0; i < 4; i++) {
+    float32x4_t r = vmulq_n_f32(b0, a[i][0]);
+    r = vmlaq_n_f32(r, b1, a[i][1]);
+    r = vmlaq_n_f32(r, b2, a[i][2]);
+    r = vmlaq_n_f32(r, b3, a[i][3]);
+    vst1q_f32(o[i], r);
+  }
+}
+
+/** o = a * v, NEON version */
+static inline void float_mat4_vect_mul(float o[4], float a[4][4], float v[4])
+{
+  float32x4_t r0 = vmulq_n_f32((float32x4_t) { a[0][0], a[1][0], a[2][0], a[3][0] }, v[0]);
+  float32x4_t r1 = vmulq_n_f32((float32x4_t) { a[0][1], a[1][1], a[2][1], a[3][1] }, v[1]);
+  r0 = vmlaq_n_f32(r0, (float32x4_t) { a[0][2], a[1][2], a[2][2], a[3][2] }, v[2]);
+  r1 = vmlaq_n_f32(r1, (float32x4_t) { a[0][3], a[1][3], a[2][3], a[3][3] }, v[3]);
+  vst1q_f32(o, vaddq_f32(r0, r1));
+}
+
+#else
+
+/** o = a * b */
+static inline void float_mat4_mul(float o[4][4], float a[4][4], float b[4][4])
+{
+  for (int i = 0; i < 4; i++) {
+    const float a0 = a[i][0], a1 = a[i][1], a2 = a[i][2], a3 = a[i][3];
+    o[i][0] = (a0 * b[0][0] + a1 * b[1][0]) + (a2 * b[2][0] + a3 * b[3][0]);
+    o[i][1] = (a0 * b[0][1] + a1 * b[1][1]) + (a2 * b[2][1] + a3 * b[3][1]);
+    o[i][2] = (a0 * b[0][2] + a1 * b[1][2]) + (a2 * b[2][2] + a3 * b[3][2]);
+    o[i][3] = (a0 * b[0][3] + a1 * b[1][3]) + (a2 * b[2][3] + a3 * b[3][3]);
+  }
+}
+
+/** o = a * v */
+static inline void float_mat4_vect_mul(float o[4], float a[4][4], float v[4])
+{
+  for (int i = 0; i < 4; i++) {
+    o[i] = (a[i][0] * v[0] + a[i][1] * v[1]) + (a[i][2] * v[2] + a[i][3] * v[3]);
+  }
+}
+
+#endif
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* PPRZ_MATRIX_FIXED_FLOAT_H */
@@ -27,7 +27,7 @@
 #include "pprz_trig_int.h"
 #include "pprz_algebra_int.h"
 #if !defined(PPRZ_TRIG_INT_USE_FLOAT)
-#if !defined(PPRZ_TRIG_INT_COMPR_FLASH) || defined(PPRZ_TRIG_INT_TEST)
+#if (!defined(PPRZ_TRIG_INT_COMPR_FLASH) && !defined(PPRZ_TRIG_INT_POLY)) || defined(PPRZ_TRIG_INT_TEST)
 PPRZ_TRIG_CONST int16_t pprz_trig_int[6434] = {    0,
                                                    3,     7,    11,    15,    19,    23,    27,    31,    35,    39,    43,    47,    51,    55,    59,    63,
                                                    67,    71,    75,    79,    83,    87,    91,    95,    99,   103,   107,   111,   115,   119,   123,   127,
@@ -856,6 +856,32 @@ inline int16_t pprz_trig_int_f(int32_t angle)
 
 #endif // PPRZ_TRIG_INT_COMPR_FLASH
 
+#if defined(PPRZ_TRIG_INT_POLY) || defined(PPRZ_TRIG_INT_TEST)
+
+/* 2/pi with 30 - INT32_ANGLE_FRAC bits, maps an angle in [0, pi/2] to z in [0, 1] with 30 bits */
+#define TRIG_POLY_Z_OF_ANGLE 166886
+
+/* odd polynomial sin(pi/2 z) = z (c1 + c3 z^2 + c5 z^4 + c7 z^6) in Q30,
+ * least squares fit on Chebyshev nodes, max error 1 LSB of the table */
+#define TRIG_POLY_C1  1686624950
+#define TRIG_POLY_C3  -693528462
+#define TRIG_POLY_C5    85303417
+#define TRIG_POLY_C7    -4658781
+
+int16_t pprz_trig_int_poly(int32_t angle)
+{
+  const int32_t z = angle * TRIG_POLY_Z_OF_ANGLE;
+  const int32_t z2 = (int32_t)(((int64_t)z * z) >> 30);
+  int32_t t = TRIG_POLY_C7;
+  t = TRIG_POLY_C5 + (int32_t)(((int64_t)t * z2) >> 30);
+  t = TRIG_POLY_C3 + (int32_t)(((int64_t)t * z2) >> 30);
+  t = TRIG_POLY_C1 + (int32_t)(((int64_t)t * z2) >> 30);
+  /* Q30 to INT32_TRIG_FRAC, rounded down as the table */
+  return (int16_t)(((int64_t)z * t) >> (30 + 30 - INT32_TRIG_FRAC));
+}
+
+#endif // PPRZ_TRIG_INT_POLY
+
 int32_t pprz_itrig_sin(int32_t angle)
 {
 #if defined(PPRZ_TRIG_INT_USE_FLOAT)
@@ -872,7 +898,11 @@ int32_t pprz_itrig_sin(int32_t angle)
     angle = -INT32_ANGLE_PI - angle;
   }
   if (angle >= 0) {
-#if defined(PPRZ_TRIG_INT_COMPR_FLASH)
+#if defined(PPRZ_TRIG_INT_POLY)
+    return pprz_trig_int_poly(angle);
+  } else {
+    return -pprz_trig_int_poly(-angle);
+#elif defined(PPRZ_TRIG_INT_COMPR_FLASH)
     return pprz_trig_int_f(angle);
   } else {
     return -pprz_trig_int_f(-angle);
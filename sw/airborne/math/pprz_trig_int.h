@@ -33,6 +33,17 @@ extern "C" {
 
 #include "std.h"
 
+/** Sine implementation, chosen per target:
+ *  - default: uncompressed quarter-wave table (12868 bytes, in RAM or in
+ *    flash with PPRZ_TRIG_CONST), fastest when memory is not an issue
+ *  - PPRZ_TRIG_INT_POLY: fixed-point polynomial, no table and no init,
+ *    within 1 LSB of the table, for targets short of flash and RAM
+ *    (set by the STM32F1 airframes that used the compressed table)
+ *  - PPRZ_TRIG_INT_COMPR_FLASH: compressed table in flash, decoded in RAM by
+ *    pprz_trig_int_init(), exact but slower than both previous ones
+ *  - PPRZ_TRIG_INT_USE_FLOAT: float sinf(), for targets with a FPU
+ */
+
 /** Allow makefile to define PPRZ_TRIG_CONST in case we want
  to make the trig tables const and store them in flash.
  Otherwise use the empty string and keep the table in RAM. */
@@ -48,6 +59,10 @@ extern "C" {
 #define PPRZ_TRIG_INT_COMPR_NONE
 #endif
 
+#if defined(PPRZ_TRIG_INT_POLY) && defined(PPRZ_TRIG_INT_COMPR_FLASH) && !defined(PPRZ_TRIG_INT_TEST)
+#error "PPRZ_TRIG_INT_POLY and PPRZ_TRIG_INT_COMPR_FLASH are exclusive, the compressed table would be decoded but not used"
+#endif
+
 #if defined(PPRZ_TRIG_INT_COMPR_FLASH) && !defined(PPRZ_TRIG_INT_COMPR_HIGHEST) && !defined(PPRZ_TRIG_INT_COMPR_HIGH) && !defined(PPRZ_TRIG_INT_COMPR_LOW)
 #define PPRZ_TRIG_INT_COMPR_NONE
 #endif
@@ -69,10 +84,16 @@ extern "C" {
 #define TREE_BUF_12_2 2145
 #define TREE_BUF_12_3 3474
 
-#if !defined(PPRZ_TRIG_INT_COMPR_FLASH) || defined(PPRZ_TRIG_INT_TEST)
+#if (!defined(PPRZ_TRIG_INT_COMPR_FLASH) && !defined(PPRZ_TRIG_INT_POLY)) || defined(PPRZ_TRIG_INT_TEST)
 extern PPRZ_TRIG_CONST int16_t pprz_trig_int[];
 #endif
 
+#if defined(PPRZ_TRIG_INT_POLY) || defined(PPRZ_TRIG_INT_TEST)
+/** Sine of an angle in [0, INT32_ANGLE_PI_2] with INT32_TRIG_FRAC bits,
+ *  same scaling as the pprz_trig_int table */
+int16_t pprz_trig_int_poly(int32_t angle);
+#endif
+
 extern int32_t pprz_itrig_sin(int32_t angle);
 extern int32_t pprz_itrig_cos(int32_t angle);
 extern int32_t int32_atan2(int32_t y, int32_t x);
@@ -31,6 +31,7 @@
 #include "mcu_periph/uart_arch.h"
 #include "pprzlink/pprzlink_device.h"
 #include "std.h"
+#include <string.h>
 
 #ifndef UART_RX_BUFFER_SIZE
 #if defined STM32F4 || defined STM32F7 //the F4 and F7 have enough memory
@@ -104,6 +105,21 @@ extern int uart_check_free_space(struct uart_periph *p, long *fd, uint16_t len);
 extern void uart_send_message(struct uart_periph *p, long fd);
 extern uint8_t uart_getch(struct uart_periph *p);
 
+/**
+ * Copy a buffer in the TX ring and commit it at once.
+ * The free space must be checked and the buffer locked by the caller.
+ */
+static inline void uart_tx_buffer_insert(struct uart_periph *p, const uint8_t *data, uint16_t len)
+{
+  uint16_t first = UART_TX_BUFFER_SIZE - p->tx_insert_idx;
+  if (first > len) {
+    first = len;
+  }
+  memcpy(&p->tx_buf[p->tx_insert_idx], data, first);
+  memcpy(p->tx_buf, data + first, len - first);
+  p->tx_insert_idx = (p->tx_insert_idx + len) % UART_TX_BUFFER_SIZE;
+}
+
 /**
  * Check UART for available chars in receive buffer.
  * @return number of chars in the buffer
@@ -42,10 +42,22 @@
 #include "math/pprz_algebra_float.h"
 #include "math/pprz_matrix_decomp_float.h"
 #include "math/pprz_simple_matrix.h"
+#include "math/RANSAC.h"
+#include <string.h>
 
 // Is this still necessary?
 #define MAX_COUNT_PT 50
 
+/** Stop RANSAC when the best fit is found with this probability */
+#ifndef LINEAR_FLOW_FIT_CONFIDENCE
+#define LINEAR_FLOW_FIT_CONFIDENCE 0.99f
+#endif
+
+/** Number of flow vectors used to reject bad hypotheses early */
+#ifndef LINEAR_FLOW_FIT_PREEMPTIVE
+#define LINEAR_FLOW_FIT_PREEMPTIVE 16
+#endif
+
 #define MIN_SAMPLES_FIT 3
 
 /**
@@ -54,7 +66,7 @@
  * @param[in] vectors The optical flow vectors
  * @param[in] count The number of optical flow vectors
  * @param[in] error_threshold Error used to determine inliers / outliers.
- * @param[in] n_iterations Number of RANSAC iterations.
+ * @param[in] n_iterations Maximum number of RANSAC iterations.
  * @param[in] n_samples Number of samples used for a single fit (min. 3).
  * @param[in] im_width Image width in pixels
  * @param[in] im_height Image height in pixels
@@ -70,7 +82,7 @@ bool analyze_linear_flow_field(struct flow_t *vectors, int count, float error_th
 
   // fit linear flow field:
   float parameters_u[3], parameters_v[3], min_error_u, min_error_v;
-  fit_linear_flow_field(vectors, count, n_iterations, error_threshold, n_samples, parameters_u, parameters_v, &info->fit_error, &min_error_u, &min_error_v, &info->n_inliers_u, &info->n_inliers_v);
+  fit_linear_flow_field(vectors, count, error_threshold, n_iterations, n_samples, parameters_u, parameters_v, &info->fit_error, &min_error_u, &min_error_v, &info->n_inliers_u, &info->n_inliers_v);
 
   // extract information from the parameters:
   extract_information_from_parameters(parameters_u, parameters_v, im_width, im_height, info);
@@ -85,12 +97,66 @@ bool analyze_linear_flow_field(struct flow_t *vectors, int count, float error_th
   return true;
 }
 
+/** Data of the horizontal or vertical linear flow model used by RANSAC */
+struct linear_flow_model_data {
+  struct flow_t *vectors;
+  bool vertical;          ///< fit flow_y instead of flow_x
+};
+
+static inline float linear_flow_of_vector(struct linear_flow_model_data *lf, uint16_t index)
+{
+  return (float)(lf->vertical ? lf->vectors[index].flow_y : lf->vectors[index].flow_x);
+}
+
+/** Fit u = p0 * x + p1 * y + p2 (or v) on a subset of the flow vectors with SVD */
+static bool linear_flow_model_fit(void *data, uint16_t *indices, uint16_t n, float *params)
+{
+  struct linear_flow_model_data *lf = (struct linear_flow_model_data *)data;
+
+  float _A[RANSAC_MAX_SAMPLES][3];
+  MAKE_MATRIX_PTR(A, _A, RANSAC_MAX_SAMPLES);
+  float _b[RANSAC_MAX_SAMPLES][1];
+  MAKE_MATRIX_PTR(b, _b, RANSAC_MAX_SAMPLES);
+  float w[3], _v[3][3];
+  MAKE_MATRIX_PTR(v, _v, 3);
+  float _p[3][1];
+  MAKE_MATRIX_PTR(p, _p, 3);
+
+  // Setup the system:
+  for (uint16_t sam = 0; sam < n; sam++) {
+    A[sam][0] = (float) lf->vectors[indices[sam]].pos.x;
+    A[sam][1] = (float) lf->vectors[indices[sam]].pos.y;
+    A[sam][2] = 1.0f;
+    b[sam][0] = linear_flow_of_vector(lf, indices[sam]);
+  }
+
+  // decompose A in u, w, v with singular value decomposition A = u * w * vT.
+  // u replaces A as output:
+  pprz_svd_float(A, w, v, n, 3);
+  pprz_svd_solve_float(p, A, w, v, b, n, 3, 1);
+  params[0] = p[0][0];
+  params[1] = p[1][0];
+  params[2] = p[2][0];
+  return true;
+}
+
+static float linear_flow_model_error(void *data, uint16_t index, float *params)
+{
+  struct linear_flow_model_data *lf = (struct linear_flow_model_data *)data;
+  float prediction = params[0] * (float) lf->vectors[index].pos.x + params[1] * (float) lf->vectors[index].pos.y +
+                     params[2];
+  return fabsf(prediction - linear_flow_of_vector(lf, index));
+}
+
+/** Random state of the flow field fits, successive fits are reproducible */
+static uint32_t linear_flow_seed = 1;
+
 /**
  * Analyze a linear flow field, retrieving information such as divergence, surface roughness, focus of expansion, etc.
  * @param[in] vectors The optical flow vectors
  * @param[in] count The number of optical flow vectors
  * @param[in] error_threshold Error used to determine inliers / outliers.
- * @param[in] n_iterations Number of RANSAC iterations.
+ * @param[in] n_iterations Maximum number of RANSAC iterations.
  * @param[in] n_samples Number of samples used for a single fit (min. 3).
  * @param[out] parameters_u* Parameters of the horizontal flow field
  * @param[out] parameters_v* Parameters of the vertical flow field
@@ -108,195 +174,49 @@ void fit_linear_flow_field(struct flow_t *vectors, int count, float error_thresh
   // and b = [nx1] vector with either the horizontal (bu) or vertical (bv) flow.
   // x in the system are the parameters for the horizontal (pu) or vertical (pv) flow field.
 
-  // local vars for iterating, random numbers:
-  int sam, p, i_rand, si, add_si;
-
   // ensure that n_samples is high enough to ensure a result for a single fit:
   n_samples = (n_samples < MIN_SAMPLES_FIT) ? MIN_SAMPLES_FIT : n_samples;
-  // n_samples should not be higher than count:
+  // n_samples should not be higher than count or the RANSAC workspace:
   n_samples = (n_samples < count) ? n_samples : count;
-
-  // initialize matrices and vectors for the full point set problem:
-  // this is used for determining inliers
-  float _AA[count][3];
-  MAKE_MATRIX_PTR(AA, _AA, count);
-  float _bu_all[count][1];
-  MAKE_MATRIX_PTR(bu_all, _bu_all, count);
-  float _bv_all[count][1];
-  MAKE_MATRIX_PTR(bv_all, _bv_all, count);
-  for (sam = 0; sam < count; sam++) {
-    AA[sam][0] = (float) vectors[sam].pos.x;
-    AA[sam][1] = (float) vectors[sam].pos.y;
-    AA[sam][2] = 1.0f;
-    bu_all[sam][0] = (float) vectors[sam].flow_x;
-    bv_all[sam][0] = (float) vectors[sam].flow_y;
-  }
-
-  // later used to determine the error of a set of parameters on the whole set:
-  float _bb[count][1];
-  MAKE_MATRIX_PTR(bb, _bb, count);
-  float _C[count][1];
-  MAKE_MATRIX_PTR(C, _C, count);
+  n_samples = (n_samples < RANSAC_MAX_SAMPLES) ? n_samples : RANSAC_MAX_SAMPLES;
 
   // ***************
   // perform RANSAC:
   // ***************
 
-  // set up variables for small linear system solved repeatedly inside RANSAC:
-  float _A[n_samples][3];
-  MAKE_MATRIX_PTR(A, _A, n_samples);
-  float _bu[n_samples][1];
-  MAKE_MATRIX_PTR(bu, _bu, n_samples);
-  float _bv[n_samples][1];
-  MAKE_MATRIX_PTR(bv, _bv, n_samples);
-  float w[n_samples], _v[3][3];
-  MAKE_MATRIX_PTR(v, _v, 3);
-  float _pu[3][1];
-  MAKE_MATRIX_PTR(pu, _pu, 3);
-  float _pv[3][1];
-  MAKE_MATRIX_PTR(pv, _pv, 3);
-
-  // iterate and store parameters, errors, inliers per fit:
-  float PU[n_iterations * 3];
-  float PV[n_iterations * 3];
-  float errors_pu[n_iterations];
-  errors_pu[0] = 0.0;
-  float errors_pv[n_iterations];
-  errors_pv[0] = 0.0;
-  int n_inliers_pu[n_iterations];
-  int n_inliers_pv[n_iterations];
-  int it, ii;
-  for (it = 0; it < n_iterations; it++) {
-    // select a random sample of n_sample points:
-    int sample_indices[n_samples];
-    i_rand = 0;
-
-    // sampling without replacement:
-    while (i_rand < n_samples) {
-      si = rand() % count;
-      add_si = 1;
-      for (ii = 0; ii < i_rand; ii++) {
-        if (sample_indices[ii] == si) { add_si = 0; }
-      }
-      if (add_si) {
-        sample_indices[i_rand] = si;
-        i_rand ++;
-      }
-    }
-
-    // Setup the system:
-    for (sam = 0; sam < n_samples; sam++) {
-      A[sam][0] = (float) vectors[sample_indices[sam]].pos.x;
-      A[sam][1] = (float) vectors[sample_indices[sam]].pos.y;
-      A[sam][2] = 1.0f;
-      bu[sam][0] = (float) vectors[sample_indices[sam]].flow_x;
-      bv[sam][0] = (float) vectors[sample_indices[sam]].flow_y;
-      //printf("%d,%d,%d,%d,%d\n",A[sam][0],A[sam][1],A[sam][2],bu[sam][0],bv[sam][0]);
-    }
-
-    // Solve the small system:
-
-    // for horizontal flow:
-    // decompose A in u, w, v with singular value decomposition A = u * w * vT.
-    // u replaces A as output:
-    pprz_svd_float(A, w, v, n_samples, 3);
-    pprz_svd_solve_float(pu, A, w, v, bu, n_samples, 3, 1);
-    PU[it * 3] = pu[0][0];
-    PU[it * 3 + 1] = pu[1][0];
-    PU[it * 3 + 2] = pu[2][0];
-
-    // for vertical flow:
-    pprz_svd_solve_float(pv, A, w, v, bv, n_samples, 3, 1);
-    PV[it * 3] = pv[0][0];
-    PV[it * 3 + 1] = pv[1][0];
-    PV[it * 3 + 2] = pv[2][0];
-
-    // count inliers and determine their error on all points:
-    errors_pu[it] = 0;
-    errors_pv[it] = 0;
-    n_inliers_pu[it] = 0;
-    n_inliers_pv[it] = 0;
-
-    // for horizontal flow:
-    // bb = AA * pu:
-    MAT_MUL(count, 3, 1, bb, AA, pu);
-    // subtract bu_all: C = 0 in case of perfect fit:
-    MAT_SUB(count, 1, C, bb, bu_all);
-
-    for (p = 0; p < count; p++) {
-      C[p][0] = abs(C[p][0]);
-      if (C[p][0] < error_threshold) {
-        errors_pu[it] += C[p][0];
-        n_inliers_pu[it]++;
-      } else {
-        errors_pu[it] += error_threshold;
-      }
-    }
-
-    // for vertical flow:
-    // bb = AA * pv:
-    MAT_MUL(count, 3, 1, bb, AA, pv);
-    // subtract bv_all: C = 0 in case of perfect fit:
-    MAT_SUB(count, 1, C, bb, bv_all);
-
-    for (p = 0; p < count; p++) {
-      C[p][0] = abs(C[p][0]);
-      if (C[p][0] < error_threshold) {
-        errors_pv[it] += C[p][0];
-        n_inliers_pv[it]++;
-      } else {
-        errors_pv[it] += error_threshold;
-      }
-    }
-  }
+  struct linear_flow_model_data lf = { vectors, false };
+  struct RansacModel model = { linear_flow_model_fit, linear_flow_model_error, &lf, 3 };
+  struct RansacSettings settings = {
+    .n_samples = (uint16_t)n_samples,
+    .max_iterations = (uint16_t)n_iterations,
+    .error_threshold = error_threshold,
+    .confidence = LINEAR_FLOW_FIT_CONFIDENCE,
+    .n_preemptive = LINEAR_FLOW_FIT_PREEMPTIVE,
+    .seed = linear_flow_seed
+  };
+  struct RansacResult result;
 
-  // After all iterations:
-  // select the parameters with lowest error:
   // for horizontal flow:
-  int param;
-  int min_ind = 0;
-  *min_error_u = (float)errors_pu[0];
-  for (it = 1; it < n_iterations; it++) {
-    if (errors_pu[it] < *min_error_u) {
-      *min_error_u = (float)errors_pu[it];
-      min_ind = it;
-    }
-  }
-  for (param = 0; param < 3; param++) {
-    parameters_u[param] = PU[min_ind * 3 + param];
-  }
-  *n_inliers_u = n_inliers_pu[min_ind];
+  ransac_run(&model, &settings, (uint16_t)count, &result);
+  memcpy(parameters_u, result.params, 3 * sizeof(float));
+  *n_inliers_u = result.n_inliers;
 
   // for vertical flow:
-  min_ind = 0;
-  *min_error_v = (float)errors_pv[0];
-  for (it = 0; it < n_iterations; it++) {
-    if (errors_pv[it] < *min_error_v) {
-      *min_error_v = (float)errors_pv[it];
-      min_ind = it;
-    }
-  }
-  for (param = 0; param < 3; param++) {
-    parameters_v[param] = PV[min_ind * 3 + param];
-  }
-  *n_inliers_v = n_inliers_pv[min_ind];
+  lf.vertical = true;
+  ransac_run(&model, &settings, (uint16_t)count, &result);
+  memcpy(parameters_v, result.params, 3 * sizeof(float));
+  *n_inliers_v = result.n_inliers;
+
+  linear_flow_seed = settings.seed;
 
   // error has to be determined on the entire set without threshold:
-  // bb = AA * pu:
-  MAT_MUL(count, 3, 1, bb, AA, pu);
-  // subtract bu_all: C = 0 in case of perfect fit:
-  MAT_SUB(count, 1, C, bb, bu_all);
   *min_error_u = 0;
-  for (p = 0; p < count; p++) {
-    *min_error_u += abs(C[p][0]);
-  }
-  // bb = AA * pv:
-  MAT_MUL(count, 3, 1, bb, AA, pv);
-  // subtract bv_all: C = 0 in case of perfect fit:
-  MAT_SUB(count, 1, C, bb, bv_all);
   *min_error_v = 0;
-  for (p = 0; p < count; p++) {
-    *min_error_v += abs(C[p][0]);
+  for (int p = 0; p < count; p++) {
+    lf.vertical = false;
+    *min_error_u += linear_flow_model_error(&lf, p, parameters_u);
+    lf.vertical = true;
+    *min_error_v += linear_flow_model_error(&lf, p, parameters_v);
   }
   *fit_error = (*min_error_u + *min_error_v) / (2 * count);
 
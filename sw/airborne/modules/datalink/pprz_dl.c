@@ -25,6 +25,9 @@
 
 #include "modules/datalink/pprz_dl.h"
 #include "subsystems/datalink/datalink.h"
+#if PPRZ_DL_FAST_TX
+#include "modules/datalink/pprz_fast_transport.h"
+#endif
 
 #ifndef PPRZ_UPDATE_DL
 #define PPRZ_UPDATE_DL TRUE
@@ -32,14 +35,26 @@
 
 struct pprz_transport pprz_tp;
 
+#if PPRZ_DL_FAST_TX
+/** Fast path for the messages sent with pprz_tp */
+static struct pprz_fast_transport pprz_fast_tp;
+#endif
+
 void pprz_dl_init(void)
 {
   pprz_transport_init(&pprz_tp);
+#if PPRZ_DL_FAST_TX
+  pprz_fast_transport_init(&pprz_fast_tp);
+  pprz_fast_transport_attach(&pprz_fast_tp, &pprz_tp.trans_tx);
+#endif
 }
 
 void pprz_dl_event(void)
 {
   pprz_check_and_parse(&DOWNLINK_DEVICE.device, &pprz_tp, dl_buffer, &dl_msg_available);
+  if (dl_msg_available) {
+    dl_msg_len = pprz_tp.trans_rx.payload_len;
+  }
   DlCheckAndParse(&DOWNLINK_DEVICE.device, &pprz_tp.trans_tx, dl_buffer, &dl_msg_available, PPRZ_UPDATE_DL);
 }
 
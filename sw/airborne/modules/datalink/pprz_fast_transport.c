@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/datalink/pprz_fast_transport.c
+ *
+ * Fast path of the PPRZ transport for sending.
+ */
+
+#include "modules/datalink/pprz_fast_transport.h"
+#include <string.h>
+
+#define PPRZ_FAST_STX 0x99
+
+/** Append bytes to the frame, the last two bytes are kept for the checksum */
+static void pprz_fast_put(struct pprz_fast_transport *t, const uint8_t *bytes, uint16_t len)
+{
+  if (t->overflow || t->len + len > PPRZ_FAST_FRAME_SIZE - 2) {
+    t->overflow = true;
+    return;
+  }
+  memcpy(&t->frame[t->len], bytes, len);
+  t->len += len;
+}
+
+static void pprz_fast_start(struct pprz_fast_transport *t, uint8_t payload_len)
+{
+  PPRZ_MUTEX_LOCK(t->mtx_tx);
+  t->frame[0] = PPRZ_FAST_STX;
+  t->frame[1] = payload_len + 4;
+  t->len = 2;
+  // the length field can not hold more than 251 bytes of payload
+  t->overflow = (payload_len > PPRZ_FAST_FRAME_SIZE - 5);
+}
+
+static void pprz_fast_end(struct pprz_fast_transport *t, struct link_device *dev, long fd)
+{
+  if (t->overflow) {
+    // truncated frame, drop it
+    dev->nb_ovrn++;
+  } else {
+    pprz_fast_checksum(t->frame[1], &t->frame[2], t->len - 2, &t->frame[t->len]);
+    dev->put_buffer(dev->periph, fd, t->frame, t->len + 2);
+  }
+  // always end the message, some devices are locked from check_free_space to send_message
+  dev->send_message(dev->periph, fd);
+  PPRZ_MUTEX_UNLOCK(t->mtx_tx);
+}
+
+#if PPRZLINK_DEFAULT_VER == 2
+
+static struct pprz_fast_transport *get_trans(struct pprzlink_msg *msg)
+{
+  return (struct pprz_fast_transport *)(msg->trans->impl);
+}
+
+static void put_bytes(struct pprzlink_msg *msg, long fd __attribute__((unused)),
+                      enum TransportDataType type __attribute__((unused)),
+                      enum TransportDataFormat format __attribute__((unused)),
+                      const void *bytes, uint16_t len)
+{
+  pprz_fast_put(get_trans(msg), (const uint8_t *)bytes, len);
+}
+
+static void put_named_byte(struct pprzlink_msg *msg, long fd __attribute__((unused)),
+                           enum TransportDataType type __attribute__((unused)),
+                           enum TransportDataFormat format __attribute__((unused)),
+                           uint8_t byte, const char *name __attribute__((unused)))
+{
+  pprz_fast_put(get_trans(msg), &byte, 1);
+}
+
+static uint8_t size_of(struct pprzlink_msg *msg __attribute__((unused)), uint8_t len)
+{
+  // message length: payload + protocol overhead (STX + len + ck_a + ck_b = 4)
+  return len + 4;
+}
+
+static void start_message(struct pprzlink_msg *msg, long fd __attribute__((unused)), uint8_t payload_len)
+{
+  pprz_fast_start(get_trans(msg), payload_len);
+}
+
+static void end_message(struct pprzlink_msg *msg, long fd)
+{
+  pprz_fast_end(get_trans(msg), msg->dev, fd);
+}
+
+static void overrun(struct pprzlink_msg *msg)
+{
+  msg->dev->nb_ovrn++;
+}
+
+static void count_bytes(struct pprzlink_msg *msg, uint8_t bytes)
+{
+  msg->dev->nb_bytes += bytes;
+}
+
+static int check_available_space(struct pprzlink_msg *msg, long *fd, uint16_t bytes)
+{
+  return msg->dev->check_free_space(msg->dev->periph, fd, bytes);
+}
+
+#else
+
+static void put_bytes(struct pprz_fast_transport *trans, struct link_device *dev __attribute__((unused)),
+                      long fd __attribute__((unused)),
+                      enum TransportDataType type __attribute__((unused)),
+                      enum TransportDataFormat format __attribute__((unused)),
+                      const void *bytes, uint16_t len)
+{
+  pprz_fast_put(trans, (const uint8_t *)bytes, len);
+}
+
+static void put_named_byte(struct pprz_fast_transport *trans, struct link_device *dev __attribute__((unused)),
+                           long fd __attribute__((unused)),
+                           enum TransportDataType type __attribute__((unused)),
+                           enum TransportDataFormat format __attribute__((unused)),
+                           uint8_t byte, const char *name __attribute__((unused)))
+{
+  pprz_fast_put(trans, &byte, 1);
+}
+
+static uint8_t size_of(struct pprz_fast_transport *trans __attribute__((unused)), uint8_t len)
+{
+  // message length: payload + protocol overhead (STX + len + ck_a + ck_b = 4)
+  return len + 4;
+}
+
+static void start_message(struct pprz_fast_transport *trans, struct link_device *dev __attribute__((unused)),
+                          long fd __attribute__((unused)), uint8_t payload_len)
+{
+  pprz_fast_start(trans, payload_len);
+}
+
+static void end_message(struct pprz_fast_transport *trans, struct link_device *dev, long fd)
+{
+  pprz_fast_end(trans, dev, fd);
+}
+
+static void overrun(struct pprz_fast_transport *trans __attribute__((unused)), struct link_device *dev)
+{
+  dev->nb_ovrn++;
+}
+
+static void count_bytes(struct pprz_fast_transport *trans __attribute__((unused)), struct link_device *dev,
+                        uint8_t bytes)
+{
+  dev->nb_bytes += bytes;
+}
+
+static int check_available_space(struct pprz_fast_transport *trans __attribute__((unused)),
+                                 struct link_device *dev, long *fd, uint16_t bytes)
+{
+  return dev->check_free_space(dev->periph, fd, bytes);
+}
+
+#endif /* PPRZLINK_DEFAULT_VER == 2 */
+
+void pprz_fast_transport_init(struct pprz_fast_transport *t)
+{
+  t->len = 0;
+  t->overflow = false;
+  PPRZ_MUTEX_INIT(t->mtx_tx);
+  pprz_fast_transport_attach(t, &t->trans_tx);
+}
+
+void pprz_fast_transport_attach(struct pprz_fast_transport *t, struct transport_tx *tx)
+{
+  tx->size_of = (size_of_t) size_of;
+  tx->check_available_space = (check_available_space_t) check_available_space;
+  tx->put_bytes = (put_bytes_t) put_bytes;
+  tx->put_named_byte = (put_named_byte_t) put_named_byte;
+  tx->start_message = (start_message_t) start_message;
+  tx->end_message = (end_message_t) end_message;
+  tx->overrun = (overrun_t) overrun;
+  tx->count_bytes = (count_bytes_t) count_bytes;
+  tx->impl = (void *)(t);
+}
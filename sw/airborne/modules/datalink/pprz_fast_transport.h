@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/datalink/pprz_fast_transport.h
+ *
+ * Fast path of the PPRZ transport for sending.
+ *
+ * The frames are the same as with pprz_transport (STX, length, payload,
+ * checksum), but instead of writing each byte through the device put_byte
+ * and updating the checksum on the fly:
+ * - the fields are copied in a contiguous frame buffer,
+ * - the checksum is computed once on the whole payload, with a loop that
+ *   the compiler can vectorize,
+ * - the frame is written with a single put_buffer call, so the device
+ *   commits it to its TX buffer at once (one write() on Linux).
+ *
+ * It only replaces the sending functions of a transport: the receiving
+ * part of pprz_transport is unchanged, e.g. with pprz_dl:
+ *
+ *   pprz_transport_init(&pprz_tp);
+ *   pprz_fast_transport_init(&pprz_fast_tp);
+ *   pprz_fast_transport_attach(&pprz_fast_tp, &pprz_tp.trans_tx);
+ */
+
+#ifndef PPRZ_FAST_TRANSPORT_H
+#define PPRZ_FAST_TRANSPORT_H
+
+#include "std.h"
+#include "pprz_mutex.h"
+#include "pprzlink/pprzlink_transport.h"
+#include "pprzlink/pprzlink_device.h"
+
+/** Maximum frame size, the length field is a byte */
+#define PPRZ_FAST_FRAME_SIZE 256
+
+struct pprz_fast_transport {
+  struct transport_tx trans_tx;           ///< generic transmission interface
+  uint8_t frame[PPRZ_FAST_FRAME_SIZE];    ///< frame being built
+  uint16_t len;                           ///< current frame length
+  bool overflow;                          ///< frame too long for the buffer, dropped and counted as overrun
+  PPRZ_MUTEX(mtx_tx);                     ///< lock of the frame buffer
+};
+
+/** Init the transport */
+extern void pprz_fast_transport_init(struct pprz_fast_transport *t);
+
+/**
+ * Replace the sending functions of an existing transport,
+ * all the messages sent through it use the fast path.
+ */
+extern void pprz_fast_transport_attach(struct pprz_fast_transport *t, struct transport_tx *tx);
+
+/**
+ * PPRZ checksum of a frame payload.
+ * Same result as the running sum of pprz_transport (ck_a += b; ck_b += ck_a
+ * starting from the length), written as ck_a = len + sum(b[i]) and
+ * ck_b = (n + 1) * len + sum((n - i) * b[i]) so that it vectorizes.
+ * @param len frame length, first checksummed byte
+ * @param payload payload bytes
+ * @param n payload length
+ * @param[out] ck checksum bytes
+ */
+static inline void pprz_fast_checksum(uint8_t len, const uint8_t *payload, uint16_t n, uint8_t ck[2])
+{
+  uint32_t a = len, b = (uint32_t)(n + 1) * len;
+  for (uint16_t i = 0; i < n; i++) {
+    a += payload[i];
+    b += (uint32_t)(n - i) * payload[i];
+  }
+  ck[0] = (uint8_t)a;
+  ck[1] = (uint8_t)b;
+}
+
+#endif /* PPRZ_FAST_TRANSPORT_H */
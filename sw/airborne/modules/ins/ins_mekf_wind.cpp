@@ -60,6 +60,7 @@ enum MekfWindCovVar {
 };
 
 typedef Matrix<float, MEKF_WIND_COV_SIZE, MEKF_WIND_COV_SIZE> MEKFWCov;
+typedef Matrix<float, MEKF_WIND_COV_SIZE, 1> MEKFWErr;
 
 /** Process noise elements and size
  */
@@ -208,6 +209,14 @@ struct InsMekfWindPrivate {
 #define INS_MEKF_WIND_R_AOS         0.1f
 #endif
 
+/** Use dense products for the covariance propagation and updates,
+ *  otherwise the block structure of the Jacobians is used, the measurements
+ *  are fused one by one and only the upper triangle of P is kept up to date.
+ */
+#ifndef INS_MEKF_WIND_DENSE
+#define INS_MEKF_WIND_DENSE FALSE
+#endif
+
 // Disable wind estimation by default
 #ifndef INS_MEKF_WIND_DISABLE_WIND
 #define INS_MEKF_WIND_DISABLE_WIND true
@@ -345,6 +354,70 @@ void ins_mekf_wind_reset(void)
   init_mekf_state();
 }
 
+/** Error state update from M scalar measurements with diagonal noise.
+ *
+ * The measurements are fused one after the other, so no matrix inverse is
+ * needed, and only the upper triangle of the covariance is read and updated.
+ * The residual of each measurement is corrected by the error accumulated
+ * from the previous ones, which is equivalent to the batch update.
+ *
+ * @param H measurement Jacobian
+ * @param res residuals z - h(x)
+ * @param r measurement noise variances
+ * @return error state correction
+ */
+template<int M>
+static MEKFWErr mekf_wind_update(const Matrix<float, M, MEKF_WIND_COV_SIZE> &H,
+                                 const Matrix<float, M, 1> &res,
+                                 const Matrix<float, M, 1> &r)
+{
+#if INS_MEKF_WIND_DENSE
+  // S = H*P*Ht + Hn*N*Hnt
+  const Matrix<float, M, M> S = H * mwp.P * H.transpose() + Matrix<float, M, M>(r.asDiagonal());
+  // K = P*Ht*S^-1
+  const Matrix<float, MEKF_WIND_COV_SIZE, M> K = mwp.P * H.transpose() * S.inverse();
+  // Update covariance
+  mwp.P = (MEKFWCov::Identity() - K * H) * mwp.P;
+  return K * res;
+#else
+  MEKFWErr dx = MEKFWErr::Zero();
+  for (int i = 0; i < M; i++) {
+    const MEKFWErr PHt = mwp.P.template selfadjointView<Upper>() * H.row(i).transpose();
+    const float S = H.row(i).dot(PHt) + r(i);
+    const float innov = res(i) - H.row(i).dot(dx);
+    dx += PHt * (innov / S);
+    // P = P - P*Ht*H*P / S
+    mwp.P.template selfadjointView<Upper>().rankUpdate(PHt, -1.f / S);
+  }
+  return dx;
+#endif
+}
+
+/** Apply an error state correction
+ * @param dx error state
+ * @param attitude_only only correct attitude and gyro bias
+ */
+static void mekf_wind_correct(const MEKFWErr &dx, bool attitude_only)
+{
+  Quaternionf q_tmp;
+  q_tmp.w() = 1.f;
+  q_tmp.vec() = 0.5f * dx.segment<3>(MEKF_WIND_qx);
+  q_tmp.normalize();
+  mwp.state.quat = q_tmp * mwp.state.quat;
+  mwp.state.quat.normalize();
+  mwp.state.rates_bias  += dx.segment<3>(MEKF_WIND_rbp);
+  if (attitude_only) {
+    return;
+  }
+  mwp.state.speed       += dx.segment<3>(MEKF_WIND_vx);
+  mwp.state.pos         += dx.segment<3>(MEKF_WIND_px);
+  mwp.state.accel_bias  += dx.segment<3>(MEKF_WIND_abx);
+  mwp.state.baro_bias   += dx(MEKF_WIND_bb);
+  if (!ins_mekf_wind_params.disable_wind) {
+    mwp.state.wind        += dx.segment<3>(MEKF_WIND_wx);
+  }
+}
+
 /** Full INS propagation
  */
 void ins_mekf_wind_propagate(struct FloatRates *gyro, struct FloatVect3 *acc, float dt)
@@ -381,6 +454,7 @@ void ins_mekf_wind_propagate(struct FloatRates *gyro, struct FloatVect3 *acc, fl
   const Matrix3f RqAdt = RqA * dt;
   const Matrix3f RqAdt2 = RqAdt * dt;
 
+#if INS_MEKF_WIND_DENSE
   MEKFWCov A = MEKFWCov::Identity();
   A.block<3,3>(MEKF_WIND_qx,MEKF_WIND_rbp) = -Rqdt;
   A.block<3,3>(MEKF_WIND_vx,MEKF_WIND_qx) = -RqAdt;
@@ -406,6 +480,40 @@ void ins_mekf_wind_propagate(struct FloatRates *gyro, struct FloatVect3 *acc, fl
   Ant = An.transpose();
 
   mwp.P = A * mwp.P * At + An * mwp.Q * Ant * dt;
+#else
+  // A is the identity except for the rows of the attitude, speed and position errors,
+  // so P = A*P*At only changes in these rows (and columns)
+  const Matrix3f RqAdt2dt = RqAdt2 * dt;
+  const Matrix3f Rqdt2 = Rqdt * dt;
+  const MEKFWCov Ps = mwp.P.selfadjointView<Upper>();
+  Matrix<float, 9, MEKF_WIND_COV_SIZE> AP;
+  AP.middleRows<3>(MEKF_WIND_qx) = Ps.middleRows<3>(MEKF_WIND_qx) - Rqdt * Ps.middleRows<3>(MEKF_WIND_rbp);
+  AP.middleRows<3>(MEKF_WIND_vx) = Ps.middleRows<3>(MEKF_WIND_vx) - RqAdt * Ps.middleRows<3>(MEKF_WIND_qx)
+                                   + RqAdt2 * Ps.middleRows<3>(MEKF_WIND_rbp) - Rqdt * Ps.middleRows<3>(MEKF_WIND_abx);
+  AP.middleRows<3>(MEKF_WIND_px) = Ps.middleRows<3>(MEKF_WIND_px) + dt * Ps.middleRows<3>(MEKF_WIND_vx)
+                                   - RqAdt2 * Ps.middleRows<3>(MEKF_WIND_qx) + RqAdt2dt * Ps.middleRows<3>(MEKF_WIND_rbp)
+                                   - Rqdt2 * Ps.middleRows<3>(MEKF_WIND_abx);
+  // same combinations on the columns of A*P, upper triangle blocks only
+  mwp.P.block<3,3>(MEKF_WIND_qx,MEKF_WIND_qx) = AP.block<3,3>(MEKF_WIND_qx,MEKF_WIND_qx)
+      - AP.block<3,3>(MEKF_WIND_qx,MEKF_WIND_rbp) * Rqdt.transpose();
+  mwp.P.block<6,3>(MEKF_WIND_qx,MEKF_WIND_vx) = AP.block<6,3>(MEKF_WIND_qx,MEKF_WIND_vx)
+      - AP.block<6,3>(MEKF_WIND_qx,MEKF_WIND_qx) * RqAdt.transpose()
+      + AP.block<6,3>(MEKF_WIND_qx,MEKF_WIND_rbp) * RqAdt2.transpose()
+      - AP.block<6,3>(MEKF_WIND_qx,MEKF_WIND_abx) * Rqdt.transpose();
+  mwp.P.block<9,3>(MEKF_WIND_qx,MEKF_WIND_px) = AP.block<9,3>(MEKF_WIND_qx,MEKF_WIND_px)
+      + dt * AP.block<9,3>(MEKF_WIND_qx,MEKF_WIND_vx)
+      - AP.block<9,3>(MEKF_WIND_qx,MEKF_WIND_qx) * RqAdt2.transpose()
+      + AP.block<9,3>(MEKF_WIND_qx,MEKF_WIND_rbp) * RqAdt2dt.transpose()
+      - AP.block<9,3>(MEKF_WIND_qx,MEKF_WIND_abx) * Rqdt2.transpose();
+  mwp.P.block<9,MEKF_WIND_COV_SIZE-9>(MEKF_WIND_qx,MEKF_WIND_rbp) = AP.rightCols<MEKF_WIND_COV_SIZE-9>();
+
+  // + An*Q*Ant*dt with Q diagonal
+  mwp.P.block<3,3>(MEKF_WIND_qx,MEKF_WIND_qx) += Rq * mwp.Q.block<3,3>(MEKF_WIND_qgp,MEKF_WIND_qgp) * Rq.transpose() * dt;
+  mwp.P.block<3,3>(MEKF_WIND_vx,MEKF_WIND_vx) += Rq * mwp.Q.block<3,3>(MEKF_WIND_qax,MEKF_WIND_qax) * Rq.transpose() * dt;
+  for (int i = 0; i < MEKF_WIND_COV_SIZE - MEKF_WIND_rbp; i++) {
+    mwp.P(MEKF_WIND_rbp + i, MEKF_WIND_rbp + i) += mwp.Q(MEKF_WIND_qrbp + i, MEKF_WIND_qrbp + i) * dt;
+  }
+#endif
 
   if (ins_mekf_wind_params.disable_wind) {
     mwp.P.block<3,MEKF_WIND_COV_SIZE>(MEKF_WIND_wx,0) = Matrix<float,3,MEKF_WIND_COV_SIZE>::Zero();
@@ -444,6 +552,7 @@ void ins_mekf_wind_propagate_ahrs(struct FloatRates *gyro, struct FloatVect3 *ac
   const Matrix3f Rq = mwp.state.quat.toRotationMatrix();
   const Matrix3f Rqdt = Rq * dt;
 
+#if INS_MEKF_WIND_DENSE
   MEKFWCov A = MEKFWCov::Zero();
   A.block<3,3>(MEKF_WIND_qx,MEKF_WIND_qx) = Matrix3f::Identity();
   A.block<3,3>(MEKF_WIND_qx,MEKF_WIND_rbp) = -Rqdt;
@@ -460,27 +569,29 @@ void ins_mekf_wind_propagate_ahrs(struct FloatRates *gyro, struct FloatVect3 *ac
   Ant = An.transpose();
 
   mwp.P = A * mwp.P * At + An * mwp.Q * Ant * dt;
+#else
+  // only the attitude and gyro bias blocks of A are not zero
+  const Matrix3f Pqq = mwp.P.block<3,3>(MEKF_WIND_qx,MEKF_WIND_qx).selfadjointView<Upper>();
+  const Matrix3f Pqrb = mwp.P.block<3,3>(MEKF_WIND_qx,MEKF_WIND_rbp);
+  const Matrix3f Prbrb = mwp.P.block<3,3>(MEKF_WIND_rbp,MEKF_WIND_rbp).selfadjointView<Upper>();
+  const Matrix3f APqrb = Pqrb - Rqdt * Prbrb;
+  const Matrix3f APqq = Pqq - Rqdt * Pqrb.transpose();
+  mwp.P.setZero();
+  mwp.P.block<3,3>(MEKF_WIND_qx,MEKF_WIND_qx) = APqq - APqrb * Rqdt.transpose()
+      + Rq * mwp.Q.block<3,3>(MEKF_WIND_qgp,MEKF_WIND_qgp) * Rq.transpose() * dt;
+  mwp.P.block<3,3>(MEKF_WIND_qx,MEKF_WIND_rbp) = APqrb;
+  mwp.P.block<3,3>(MEKF_WIND_rbp,MEKF_WIND_rbp) = Prbrb + mwp.Q.block<3,3>(MEKF_WIND_qrbp,MEKF_WIND_qrbp) * dt;
+#endif
 
   // correction from accel measurements
   const Matrix3f Rqt = Rq.transpose();
   Matrix<float, 3, MEKF_WIND_COV_SIZE> H = Matrix<float, 3, MEKF_WIND_COV_SIZE>::Zero();
   H.block<3,3>(0,0) = - Rqt * skew_sym(gravity);
-  Matrix<float, MEKF_WIND_COV_SIZE, 3> Ht = H.transpose();
-  // S = H*P*Ht + Hn*N*Hnt
-  Matrix3f S = H * mwp.P * Ht + mwp.R.block<3,3>(MEKF_WIND_rmx,MEKF_WIND_rmx); // FIXME currently abusing mag noise ????
-  // K = P*Ht*S^-1
-  Matrix<float, MEKF_WIND_COV_SIZE, 3> K = mwp.P * Ht * S.inverse();
   // Residual z_a - h(z)
-  Vector3f res = accel_unbiased + (Rqt * gravity);
-  // Update state
-  q_tmp.w() = 1.f;
-  q_tmp.vec() = 0.5f * K.block<3,3>(MEKF_WIND_qx,0) * res;
-  q_tmp.normalize();
-  mwp.state.quat = q_tmp * mwp.state.quat;
-  mwp.state.quat.normalize();
-  mwp.state.rates_bias  += K.block<3,3>(MEKF_WIND_rbp,0) * res;
-  // Update covariance
-  mwp.P = (MEKFWCov::Identity() - K * H) * mwp.P;
+  const Vector3f res = accel_unbiased + (Rqt * gravity);
+  // FIXME currently abusing mag noise ????
+  const Vector3f r = mwp.R.diagonal().segment<3>(MEKF_WIND_rmx);
+  mekf_wind_correct(mekf_wind_update<3>(H, res, r), true);
 }
 
 
@@ -504,72 +615,28 @@ void ins_mekf_wind_update_mag(struct FloatVect3* mag, bool attitude_only)
   mwp.measurements.mag(1) = mag->y;
   mwp.measurements.mag(2) = mag->z;
 
-  // H and Ht matrices
+  // H matrix
   const Matrix3f Rqt = mwp.state.quat.toRotationMatrix().transpose();
   Matrix<float, 3, MEKF_WIND_COV_SIZE> H = Matrix<float, 3, MEKF_WIND_COV_SIZE>::Zero();
   H.block<3,3>(0,0) = Rqt * skew_sym(mwp.mag_h);
-  Matrix<float, MEKF_WIND_COV_SIZE, 3> Ht = H.transpose();
-  // S = H*P*Ht + Hn*N*Hnt
-  Matrix3f S = H * mwp.P * Ht + mwp.R.block<3,3>(MEKF_WIND_rmx,MEKF_WIND_rmx);
-  // K = P*Ht*S^-1
-  Matrix<float, MEKF_WIND_COV_SIZE, 3> K = mwp.P * Ht * S.inverse();
   // Residual z_m - h(z)
-  Vector3f res = mwp.measurements.mag - (Rqt * mwp.mag_h);
-  // Update state
-  Quaternionf q_tmp;
-  q_tmp.w() = 1.f;
-  q_tmp.vec() = 0.5f * K.block<3,3>(MEKF_WIND_qx,0) * res;
-  q_tmp.normalize();
-  mwp.state.quat = q_tmp * mwp.state.quat;
-  mwp.state.quat.normalize();
-  if (attitude_only) {
-    mwp.state.rates_bias  += K.block<3,3>(MEKF_WIND_rbp,0) * res;
-  } else {
-    mwp.state.speed       += K.block<3,3>(MEKF_WIND_vx,0) * res;
-    mwp.state.pos         += K.block<3,3>(MEKF_WIND_px,0) * res;
-    mwp.state.rates_bias  += K.block<3,3>(MEKF_WIND_rbp,0) * res;
-    mwp.state.accel_bias  += K.block<3,3>(MEKF_WIND_abx,0) * res;
-    mwp.state.baro_bias   += K.block<1,3>(MEKF_WIND_bb,0) * res;
-    if (!ins_mekf_wind_params.disable_wind) {
-      mwp.state.wind        += K.block<3,3>(MEKF_WIND_wx,0) * res;
-    }
-  }
-  // Update covariance
-  mwp.P = (MEKFWCov::Identity() - K * H) * mwp.P;
+  const Vector3f res = mwp.measurements.mag - (Rqt * mwp.mag_h);
+  const Vector3f r = mwp.R.diagonal().segment<3>(MEKF_WIND_rmx);
+  mekf_wind_correct(mekf_wind_update<3>(H, res, r), attitude_only);
 }
 
 void ins_mekf_wind_update_baro(float baro_alt)
 {
   mwp.measurements.baro_alt = baro_alt;
 
-  // H and Ht matrices
+  // H matrix
   Matrix<float, 1, MEKF_WIND_COV_SIZE> H = Matrix<float, 1, MEKF_WIND_COV_SIZE>::Zero();
   H(0,MEKF_WIND_pz) = 1.0f; // TODO check index
   H(0,MEKF_WIND_bb) = -1.0f;
-  Matrix<float, MEKF_WIND_COV_SIZE, 1> Ht = H.transpose();
-  // S = H*P*Ht + Hn*N*Hnt -> only pos.z component
-  float S = mwp.P(MEKF_WIND_pz,MEKF_WIND_pz) - mwp.P(MEKF_WIND_bb,MEKF_WIND_bb) + mwp.R(MEKF_WIND_rb,MEKF_WIND_rb);
-  // K = P*Ht*S^-1
-  Matrix<float, MEKF_WIND_COV_SIZE, 1> K = mwp.P * Ht / S;
   // Residual z_m - h(z)
-  float res = mwp.measurements.baro_alt - (mwp.state.pos(2) - mwp.state.baro_bias);
-  // Update state
-  Quaternionf q_tmp;
-  q_tmp.w() = 1.f;
-  q_tmp.vec() = 0.5f * K.block<3,1>(MEKF_WIND_qx,0) * res;
-  q_tmp.normalize();
-  mwp.state.quat = q_tmp * mwp.state.quat;
-  mwp.state.quat.normalize();
-  mwp.state.speed       += K.block<3,1>(MEKF_WIND_vx,0) * res;
-  mwp.state.pos         += K.block<3,1>(MEKF_WIND_px,0) * res;
-  mwp.state.rates_bias  += K.block<3,1>(MEKF_WIND_rbp,0) * res;
-  mwp.state.accel_bias  += K.block<3,1>(MEKF_WIND_abx,0) * res;
-  mwp.state.baro_bias   += K(MEKF_WIND_bb,0) * res;
-  if (!ins_mekf_wind_params.disable_wind) {
-    mwp.state.wind        += K.block<3,1>(MEKF_WIND_wx,0) * res;
-  }
-  // Update covariance
-  mwp.P = (MEKFWCov::Identity() - K * H) * mwp.P;
+  const Matrix<float, 1, 1> res(mwp.measurements.baro_alt - (mwp.state.pos(2) - mwp.state.baro_bias));
+  const Matrix<float, 1, 1> r(mwp.R(MEKF_WIND_rb,MEKF_WIND_rb));
+  mekf_wind_correct(mekf_wind_update<1>(H, res, r), false);
 }
 
 void ins_mekf_wind_update_pos_speed(struct FloatVect3 *pos, struct FloatVect3 *speed)
@@ -581,34 +648,15 @@ void ins_mekf_wind_update_pos_speed(struct FloatVect3 *pos, struct FloatVect3 *s
   mwp.measurements.speed(1) = speed->y;
   mwp.measurements.speed(2) = speed->z;
 
-  // H and Ht matrices
+  // H matrix
   Matrix<float, 6, MEKF_WIND_COV_SIZE> H = Matrix<float, 6, MEKF_WIND_COV_SIZE>::Zero();
   H.block<6,6>(0,MEKF_WIND_vx) = Matrix<float,6,6>::Identity();
-  Matrix<float, MEKF_WIND_COV_SIZE, 6> Ht = H.transpose();
-  // S = H*P*Ht + Hn*N*Hnt
-  Matrix<float, 6, 6> S = mwp.P.block<6,6>(MEKF_WIND_vx,MEKF_WIND_vx) + mwp.R.block<6,6>(MEKF_WIND_rvx,MEKF_WIND_rvx);
-  // K = P*Ht*S^-1
-  Matrix<float, MEKF_WIND_COV_SIZE, 6> K = mwp.P * Ht * S.inverse();
   // Residual z_m - h(z)
-  Matrix<float, 6, 1> res = Matrix<float, 6, 1>::Zero();
-  res.block<3,1>(0,0) = mwp.measurements.speed - mwp.state.speed;
-  res.block<3,1>(3,0) = mwp.measurements.pos - mwp.state.pos;
-  // Update state
-  Quaternionf q_tmp;
-  q_tmp.w() = 1.f;
-  q_tmp.vec() = 0.5f * K.block<3,6>(MEKF_WIND_qx,0) * res;
-  q_tmp.normalize();
-  mwp.state.quat = q_tmp * mwp.state.quat;
-  mwp.state.speed       += K.block<3,6>(MEKF_WIND_vx,0) * res;
-  mwp.state.pos         += K.block<3,6>(MEKF_WIND_px,0) * res;
-  mwp.state.rates_bias  += K.block<3,6>(MEKF_WIND_rbp,0) * res;
-  mwp.state.accel_bias  += K.block<3,6>(MEKF_WIND_abx,0) * res;
-  mwp.state.baro_bias   += K.block<1,6>(MEKF_WIND_bb,0) * res;
-  if (!ins_mekf_wind_params.disable_wind) {
-    mwp.state.wind        += K.block<3,6>(MEKF_WIND_wx,0) * res;
-  }
-  // Update covariance
-  mwp.P = (MEKFWCov::Identity() - K * H) * mwp.P;
+  Matrix<float, 6, 1> res;
+  res.segment<3>(0) = mwp.measurements.speed - mwp.state.speed;
+  res.segment<3>(3) = mwp.measurements.pos - mwp.state.pos;
+  const Matrix<float, 6, 1> r = mwp.R.diagonal().segment<6>(MEKF_WIND_rvx);
+  mekf_wind_correct(mekf_wind_update<6>(H, res, r), false);
 }
 
 void ins_mekf_wind_update_airspeed(float airspeed)
@@ -616,37 +664,17 @@ void ins_mekf_wind_update_airspeed(float airspeed)
   mwp.measurements.airspeed = airspeed;
 
   if (ins_mekf_wind_params.disable_wind) return;
-  // H and Ht matrices
+  // H matrix
   const RowVector3f IuRqt = mwp.state.quat.toRotationMatrix().transpose().block<1,3>(0,0);
   const Vector3f va = mwp.state.speed - mwp.state.wind;
   Matrix<float, 1, MEKF_WIND_COV_SIZE> H = Matrix<float, 1, MEKF_WIND_COV_SIZE>::Zero();
   H.block<1,3>(0,MEKF_WIND_qx) = IuRqt * skew_sym(va);
   H.block<1,3>(0,MEKF_WIND_vx) = IuRqt;
   H.block<1,3>(0,MEKF_WIND_wx) = -IuRqt;
-  Matrix<float, MEKF_WIND_COV_SIZE, 1> Ht = H.transpose();
-  // S = H*P*Ht + Hn*N*Hnt
-  float S = H * mwp.P * Ht + mwp.R(MEKF_WIND_ras,MEKF_WIND_ras);
-  // K = P*Ht*S^-1
-  Matrix<float, MEKF_WIND_COV_SIZE, 1> K = mwp.P * Ht / S;
   // Residual z_m - h(z)
-  float res = mwp.measurements.airspeed - IuRqt * va;
-  // Update state
-  Quaternionf q_tmp;
-  q_tmp.w() = 1.f;
-  q_tmp.vec() = 0.5f * K.block<3,1>(MEKF_WIND_qx,0) * res;
-  q_tmp.normalize();
-  mwp.state.quat = q_tmp * mwp.state.quat;
-  mwp.state.quat.normalize();
-  mwp.state.speed       += K.block<3,1>(MEKF_WIND_vx,0) * res;
-  mwp.state.pos         += K.block<3,1>(MEKF_WIND_px,0) * res;
-  mwp.state.rates_bias  += K.block<3,1>(MEKF_WIND_rbp,0) * res;
-  mwp.state.accel_bias  += K.block<3,1>(MEKF_WIND_abx,0) * res;
-  mwp.state.baro_bias   += K(MEKF_WIND_bb,0) * res;
-  if (!ins_mekf_wind_params.disable_wind) {
-    mwp.state.wind        += K.block<3,1>(MEKF_WIND_wx,0) * res;
-  }
-  // Update covariance
-  mwp.P = (MEKFWCov::Identity() - K * H) * mwp.P;
+  const Matrix<float, 1, 1> res(mwp.measurements.airspeed - IuRqt * va);
+  const Matrix<float, 1, 1> r(mwp.R(MEKF_WIND_ras,MEKF_WIND_ras));
+  mekf_wind_correct(mekf_wind_update<1>(H, res, r), false);
 }
 
 void ins_mekf_wind_update_incidence(float aoa, float aos)
@@ -681,38 +709,17 @@ void ins_mekf_wind_update_incidence(float aoa, float aos)
   H.block<1,3>(1,MEKF_WIND_qx) = vBRqt * skew_sym(mwp.state.speed - mwp.state.wind);
   H.block<1,3>(1,MEKF_WIND_vx) = vBRqt;
   H.block<1,3>(1,MEKF_WIND_wx) = -vBRqt;
-  Matrix<float, MEKF_WIND_COV_SIZE, 2> Ht = H.transpose();
-  // Hn and Hnt matrices
-  Matrix2f Hn = Matrix2f::Identity();
-  Hn(0,0) = C(2) * va(0) - C(0) * va(2);
+  // Hn is diagonal, so is Hn*N*Hnt
   const float s_2aos = sinf(2.0f * aos);
-  Hn(1,1) = (RowVector3f(-s_2aos, 0.f, s_2aos) * va.asDiagonal()) * va;
-  Matrix2f Hnt = Hn.transpose();
-  // S = H*P*Ht + Hn*N*Hnt
-  Matrix2f S = H * mwp.P * Ht + Hn * mwp.R.block<2,2>(MEKF_WIND_raoa,MEKF_WIND_raoa) * Hnt;
-  // K = P*Ht*S^-1
-  Matrix<float, MEKF_WIND_COV_SIZE, 2> K = mwp.P * Ht * S.inverse();
+  Vector2f Hn;
+  Hn(0) = C(2) * va(0) - C(0) * va(2);
+  Hn(1) = (RowVector3f(-s_2aos, 0.f, s_2aos) * va.asDiagonal()) * va;
+  const Vector2f r = Hn.cwiseProduct(Hn).cwiseProduct(mwp.R.diagonal().segment<2>(MEKF_WIND_raoa));
   // Residual z_m - h(z)
   Vector2f res = Vector2f::Zero();
   res(0) = - C * va;
   res(1) = - va.transpose() * B * va;
-  // Update state
-  Quaternionf q_tmp;
-  q_tmp.w() = 1.f;
-  q_tmp.vec() = 0.5f * K.block<3,2>(MEKF_WIND_qx,0) * res;
-  q_tmp.normalize();
-  mwp.state.quat = q_tmp * mwp.state.quat;
-  mwp.state.quat.normalize();
-  mwp.state.speed       += K.block<3,2>(MEKF_WIND_vx,0) * res;
-  mwp.state.pos         += K.block<3,2>(MEKF_WIND_px,0) * res;
-  mwp.state.rates_bias  += K.block<3,2>(MEKF_WIND_rbp,0) * res;
-  mwp.state.accel_bias  += K.block<3,2>(MEKF_WIND_abx,0) * res;
-  mwp.state.baro_bias   += K.block<1,2>(MEKF_WIND_bb,0) * res;
-  if (!ins_mekf_wind_params.disable_wind) {
-    mwp.state.wind        += K.block<3,2>(MEKF_WIND_wx,0) * res;
-  }
-  // Update covariance
-  mwp.P = (MEKFWCov::Identity() - K * H) * mwp.P;
+  mekf_wind_correct(mekf_wind_update<2>(H, res, r), false);
 }
 
 /**
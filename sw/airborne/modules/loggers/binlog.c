@@ -0,0 +1,511 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/loggers/binlog.c
+ *
+ * Asynchronous binary log of fixed size records, for Linux.
+ */
+
+#define _GNU_SOURCE
+
+#include "modules/loggers/binlog.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+/** Writer thread sleep when the ring is empty */
+#define BINLOG_POLL_US 2000
+/** Alignment of the write buffer */
+#define BINLOG_ALIGN 4096
+
+const uint8_t binlog_type_size[BINLOG_TYPE_NB] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+
+static uint64_t binlog_now_us(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static inline void put_u16(uint8_t *p, uint16_t v)
+{
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static inline void put_u32(uint8_t *p, uint32_t v)
+{
+  put_u16(p, v & 0xFFFF);
+  put_u16(p + 2, v >> 16);
+}
+
+static inline uint16_t get_u16(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t get_u32(const uint8_t *p)
+{
+  return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+/** Adler-32 checksum of a stored block */
+static uint32_t binlog_adler32(const uint8_t *buf, uint32_t len)
+{
+  uint32_t a = 1, b = 0;
+  while (len > 0) {
+    // no modulo before 5552 bytes, the sums can't overflow
+    uint32_t n = len < 5552 ? len : 5552;
+    len -= n;
+    while (n-- > 0) {
+      a += *buf++;
+      b += a;
+    }
+    a %= 65521;
+    b %= 65521;
+  }
+  return (b << 16) | a;
+}
+
+/** Write the whole buffer, in spite of partial writes */
+static int binlog_write_all(struct Binlog *log, const uint8_t *buf, uint32_t len)
+{
+  uint64_t start = binlog_now_us();
+  uint32_t done = 0;
+  while (done < len) {
+    ssize_t ret = write(log->fd, buf + done, len - done);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    done += ret;
+  }
+  uint32_t dt = binlog_now_us() - start;
+  if (dt > log->max_write_us) {
+    log->max_write_us = dt;
+  }
+  log->nb_file_bytes += len;
+  return 0;
+}
+
+static void binlog_flush(struct Binlog *log)
+{
+  if (log->out_len > 0) {
+    if (binlog_write_all(log, log->out, log->out_len) < 0) {
+      fprintf(stderr, "[binlog] write error: %s\n", strerror(errno));
+    }
+    log->out_len = 0;
+  }
+}
+
+/**
+ * XOR with the previous record, then zero run length encoding.
+ * @return encoded size, 0 if it would not be smaller than the raw block
+ */
+static uint32_t binlog_encode_delta(const uint8_t *in, uint32_t len, uint16_t rs, uint8_t *out)
+{
+  uint32_t o = 0, i = 0;
+  while (i < len) {
+    if (o + 2 >= len) {
+      return 0;
+    }
+    uint8_t x = in[i] ^ (i >= rs ? in[i - rs] : 0);
+    if (x == 0) {
+      uint32_t n = 1;
+      while (i + n < len && n < 128 && (in[i + n] ^ (i + n >= rs ? in[i + n - rs] : 0)) == 0) {
+        n++;
+      }
+      out[o++] = 127 + n;
+      i += n;
+    } else {
+      uint32_t ctrl = o++;
+      uint32_t n = 0;
+      while (i < len && n < 128 && o < len) {
+        x = in[i] ^ (i >= rs ? in[i - rs] : 0);
+        if (x == 0) {
+          break;
+        }
+        out[o++] = x;
+        i++;
+        n++;
+      }
+      out[ctrl] = n - 1;
+    }
+  }
+  return o;
+}
+
+/** Inverse of binlog_encode_delta, returns -1 on corrupted data */
+static int binlog_decode_delta(const uint8_t *in, uint32_t len, uint16_t rs, uint8_t *out, uint32_t raw_len)
+{
+  uint32_t i = 0, o = 0;
+  while (i < len) {
+    uint8_t c = in[i++];
+    if (c >= 128) {
+      uint32_t n = c - 127;
+      if (o + n > raw_len) {
+        return -1;
+      }
+      memset(out + o, 0, n);
+      o += n;
+    } else {
+      uint32_t n = c + 1;
+      if (o + n > raw_len || i + n > len) {
+        return -1;
+      }
+      memcpy(out + o, in + i, n);
+      o += n;
+      i += n;
+    }
+  }
+  if (o != raw_len) {
+    return -1;
+  }
+  for (o = rs; o < raw_len; o++) {
+    out[o] ^= out[o - rs];
+  }
+  return 0;
+}
+
+/** Encode the current block in the write buffer */
+static void binlog_end_block(struct Binlog *log)
+{
+  if (log->block_len == 0) {
+    return;
+  }
+  if (log->out_len + BINLOG_BLOCK_HEADER_SIZE + log->block_len > BINLOG_WRITE_SIZE) {
+    binlog_flush(log);
+  }
+  uint8_t *hdr = log->out + log->out_len;
+  uint8_t *data = hdr + BINLOG_BLOCK_HEADER_SIZE;
+  uint8_t codec = log->codec;
+  uint32_t stored = 0;
+  if (codec == BINLOG_CODEC_DELTA) {
+    stored = binlog_encode_delta(log->block, log->block_len, log->record_size, data);
+  }
+  if (stored == 0) {
+    // raw, or not compressible
+    codec = BINLOG_CODEC_RAW;
+    memcpy(data, log->block, log->block_len);
+    stored = log->block_len;
+  }
+  put_u32(hdr, BINLOG_BLOCK_MAGIC);
+  put_u32(hdr + 4, log->block_len / log->record_size);
+  put_u32(hdr + 8, log->block_len);
+  put_u32(hdr + 12, stored);
+  hdr[16] = codec;
+  hdr[17] = hdr[18] = hdr[19] = 0;
+  put_u32(hdr + 20, binlog_adler32(data, stored));
+  log->out_len += BINLOG_BLOCK_HEADER_SIZE + stored;
+  log->nb_raw_bytes += log->block_len;
+  log->block_len = 0;
+}
+
+/** Move the committed records from the ring to the blocks */
+static uint32_t binlog_drain(struct Binlog *log)
+{
+  struct BinlogRing *ring = &log->ring;
+  uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  uint32_t n = 0;
+  while (ring->tail != head) {
+    memcpy(log->block + log->block_len, ring->buf + (ring->tail & (ring->nb_slots - 1)) * ring->record_size,
+           ring->record_size);
+    log->block_len += ring->record_size;
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+    if (log->block_len + ring->record_size > BINLOG_BLOCK_SIZE) {
+      binlog_end_block(log);
+    }
+    n++;
+  }
+  return n;
+}
+
+static void *binlog_thread(void *data)
+{
+  struct Binlog *log = (struct Binlog *)data;
+  uint64_t last_flush = binlog_now_us();
+  const struct timespec poll = { 0, BINLOG_POLL_US * 1000 };
+  for (;;) {
+    bool running = __atomic_load_n(&log->running, __ATOMIC_ACQUIRE);
+    uint32_t n = binlog_drain(log);
+    uint64_t now = binlog_now_us();
+    if (!running && n == 0) {
+      break;
+    }
+    if (now - last_flush >= BINLOG_FLUSH_MS * 1000ULL) {
+      binlog_end_block(log);
+      binlog_flush(log);
+      last_flush = now;
+    }
+    if (n == 0) {
+      nanosleep(&poll, NULL);
+    }
+  }
+  binlog_end_block(log);
+  binlog_flush(log);
+  return NULL;
+}
+
+int binlog_open(struct Binlog *log, const char *filename, const struct BinlogColumn *cols, uint16_t nb_cols,
+                uint32_t nb_slots, uint8_t codec)
+{
+  memset(log, 0, sizeof(struct Binlog));
+  log->codec = codec;
+
+  // header
+  uint32_t header_size = 20;
+  uint32_t record_size = 8;
+  for (uint16_t i = 0; i < nb_cols; i++) {
+    if (cols[i].type >= BINLOG_TYPE_NB) {
+      return -1;
+    }
+    header_size += 2 + strlen(cols[i].name);
+    record_size += binlog_type_size[cols[i].type];
+  }
+  if (record_size > BINLOG_BLOCK_SIZE || record_size > UINT16_MAX) {
+    return -1;
+  }
+  log->record_size = record_size;
+
+  uint32_t n = 1;
+  while (n < nb_slots) {
+    n <<= 1;
+  }
+  log->ring.nb_slots = n;
+  log->ring.record_size = record_size;
+  log->ring.buf = malloc((size_t)n * record_size);
+  log->block = malloc(BINLOG_BLOCK_SIZE);
+  if (log->ring.buf == NULL || log->block == NULL ||
+      posix_memalign((void **)&log->out, BINLOG_ALIGN, BINLOG_WRITE_SIZE) != 0) {
+    log->out = NULL;
+    goto error;
+  }
+
+  log->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (log->fd < 0) {
+    goto error;
+  }
+  uint8_t *h = log->out;
+  memcpy(h, BINLOG_MAGIC, 8);
+  put_u16(h + 8, BINLOG_VERSION);
+  put_u16(h + 10, nb_cols);
+  put_u16(h + 12, record_size);
+  put_u16(h + 14, 0);
+  put_u32(h + 16, header_size);
+  uint32_t p = 20;
+  for (uint16_t i = 0; i < nb_cols; i++) {
+    uint8_t len = strlen(cols[i].name);
+    h[p++] = cols[i].type;
+    h[p++] = len;
+    memcpy(h + p, cols[i].name, len);
+    p += len;
+  }
+  log->out_len = header_size;
+
+  log->running = true;
+  if (pthread_create(&log->thread, NULL, binlog_thread, log) != 0) {
+    close(log->fd);
+    goto error;
+  }
+#ifndef __APPLE__
+  pthread_setname_np(log->thread, "binlog");
+#endif
+  return 0;
+
+error:
+  free(log->ring.buf);
+  free(log->block);
+  free(log->out);
+  memset(log, 0, sizeof(struct Binlog));
+  log->fd = -1;
+  return -1;
+}
+
+uint8_t *binlog_reserve(struct Binlog *log, uint64_t time_us)
+{
+  struct BinlogRing *ring = &log->ring;
+  uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  if (ring->head - tail >= ring->nb_slots) {
+    log->nb_dropped++;
+    return NULL;
+  }
+  uint8_t *rec = ring->buf + (ring->head & (ring->nb_slots - 1)) * ring->record_size;
+  memcpy(rec, &time_us, 8);
+  return rec + 8;
+}
+
+void binlog_commit(struct Binlog *log)
+{
+  __atomic_store_n(&log->ring.head, log->ring.head + 1, __ATOMIC_RELEASE);
+  log->nb_records++;
+}
+
+void binlog_close(struct Binlog *log)
+{
+  if (!log->running) {
+    return;
+  }
+  __atomic_store_n(&log->running, false, __ATOMIC_RELEASE);
+  pthread_join(log->thread, NULL);
+  close(log->fd);
+  log->fd = -1;
+  free(log->ring.buf);
+  free(log->block);
+  free(log->out);
+  log->ring.buf = log->block = log->out = NULL;
+}
+
+int binlog_reader_open(struct BinlogReader *r, const char *filename)
+{
+  memset(r, 0, sizeof(struct BinlogReader));
+  r->fd = open(filename, O_RDONLY);
+  if (r->fd < 0) {
+    return -1;
+  }
+  uint8_t h[20];
+  if (read(r->fd, h, 20) != 20 || memcmp(h, BINLOG_MAGIC, 8) != 0 || get_u16(h + 8) != BINLOG_VERSION) {
+    goto error;
+  }
+  r->nb_cols = get_u16(h + 10);
+  r->record_size = get_u16(h + 12);
+  uint32_t header_size = get_u32(h + 16);
+  if (header_size < 20 || header_size > 20 + r->nb_cols * 257U || r->record_size == 0) {
+    goto error;
+  }
+  uint8_t *cols = malloc(header_size - 20);
+  r->cols = calloc(r->nb_cols, sizeof(struct BinlogColumn));
+  r->offsets = calloc(r->nb_cols, sizeof(uint16_t));
+  if (cols == NULL || r->cols == NULL || r->offsets == NULL ||
+      read(r->fd, cols, header_size - 20) != (ssize_t)(header_size - 20)) {
+    free(cols);
+    goto error;
+  }
+  uint32_t p = 0;
+  uint16_t offset = 8;
+  for (uint16_t i = 0; i < r->nb_cols; i++) {
+    uint8_t len;
+    if (p + 2 > header_size - 20 || cols[p] >= BINLOG_TYPE_NB ||
+        p + 2 + (len = cols[p + 1]) > header_size - 20) {
+      free(cols);
+      goto error;
+    }
+    r->cols[i].type = cols[p];
+    char *name = malloc(len + 1);
+    memcpy(name, cols + p + 2, len);
+    name[len] = '\0';
+    r->cols[i].name = name;
+    r->offsets[i] = offset;
+    offset += binlog_type_size[r->cols[i].type];
+    p += 2 + len;
+  }
+  free(cols);
+  if (offset != r->record_size) {
+    goto error;
+  }
+  return 0;
+
+error:
+  binlog_reader_close(r);
+  return -1;
+}
+
+/** Read and decode the next valid block, resynchronize on the block magic */
+static bool binlog_reader_block(struct BinlogReader *r)
+{
+  uint8_t h[BINLOG_BLOCK_HEADER_SIZE];
+  bool lost = false;
+  for (;;) {
+    off_t pos = lseek(r->fd, 0, SEEK_CUR);
+    if (read(r->fd, h, BINLOG_BLOCK_HEADER_SIZE) != BINLOG_BLOCK_HEADER_SIZE) {
+      return false;
+    }
+    uint32_t nb = get_u32(h + 4), raw = get_u32(h + 8), stored = get_u32(h + 12);
+    bool valid = get_u32(h) == BINLOG_BLOCK_MAGIC && raw == nb * r->record_size && raw <= 64 * BINLOG_BLOCK_SIZE &&
+                 stored <= raw && h[16] <= BINLOG_CODEC_DELTA;
+    if (valid) {
+      if (raw > r->block_size) {
+        r->block_size = raw;
+        free(r->block);
+        free(r->stored);
+        r->block = malloc(r->block_size);
+        r->stored = malloc(r->block_size);
+        if (r->block == NULL || r->stored == NULL) {
+          return false;
+        }
+      }
+      if (read(r->fd, r->stored, stored) != (ssize_t)stored) {
+        return false;
+      }
+      if (binlog_adler32(r->stored, stored) != get_u32(h + 20)) {
+        valid = false;
+      } else if (h[16] == BINLOG_CODEC_RAW) {
+        memcpy(r->block, r->stored, raw);
+        valid = true;
+      } else {
+        valid = (binlog_decode_delta(r->stored, stored, r->record_size, r->block, raw) == 0);
+      }
+      if (valid) {
+        r->nb_block_records = nb;
+        r->idx = 0;
+        return true;
+      }
+    }
+    // corrupted, look for the next block one byte further
+    if (!lost) {
+      r->nb_corrupted++;
+      lost = true;
+    }
+    lseek(r->fd, pos + 1, SEEK_SET);
+  }
+}
+
+const uint8_t *binlog_reader_next(struct BinlogReader *r)
+{
+  while (r->idx >= r->nb_block_records) {
+    if (!binlog_reader_block(r)) {
+      return NULL;
+    }
+  }
+  return r->block + (size_t)(r->idx++) * r->record_size;
+}
+
+void binlog_reader_close(struct BinlogReader *r)
+{
+  if (r->fd >= 0) {
+    close(r->fd);
+  }
+  for (uint16_t i = 0; r->cols != NULL && i < r->nb_cols; i++) {
+    free((char *)r->cols[i].name);
+  }
+  free(r->cols);
+  free(r->offsets);
+  free(r->block);
+  free(r->stored);
+  memset(r, 0, sizeof(struct BinlogReader));
+  r->fd = -1;
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file modules/loggers/binlog.h
+ *
+ * Asynchronous binary log of fixed size records, for Linux.
+ *
+ * The producer (autopilot thread) copies each record in a lock-free single
+ * producer / single consumer ring and never waits: when the ring is full the
+ * record is dropped and counted. A writer thread drains the ring into blocks
+ * of records, optionally compresses them, and writes them with large writes
+ * from an aligned buffer.
+ *
+ * File format, little endian:
+ * - header: magic "PPRZBLOG", u16 version, u16 number of columns,
+ *   u16 record size, u16 reserved, u32 header size, then for each column
+ *   u8 type, u8 name length and the name (not terminated),
+ * - blocks: u32 BINLOG_BLOCK_MAGIC, u32 number of records, u32 raw size,
+ *   u32 stored size, u8 codec, 3 bytes padding, u32 Adler-32 of the stored
+ *   bytes, then the stored bytes.
+ * A record is the time in microseconds (u64) followed by the columns,
+ * packed in header order.
+ *
+ * The BINLOG_CODEC_DELTA codec XORs each record with the previous one of
+ * the block and encodes the runs of zero bytes: a control byte c < 128 is
+ * followed by c + 1 literal bytes, c >= 128 stands for c - 127 zero bytes.
+ *
+ * See modules/loggers/file_logger_bin_parse.py to convert a log.
+ */
+
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include "std.h"
+
+#define BINLOG_MAGIC "PPRZBLOG"
+#define BINLOG_VERSION 1
+#define BINLOG_BLOCK_MAGIC 0x4B4C4250  ///< "PBLK"
+#define BINLOG_BLOCK_HEADER_SIZE 24
+
+/** Maximum raw size of a block */
+#ifndef BINLOG_BLOCK_SIZE
+#define BINLOG_BLOCK_SIZE (64 * 1024)
+#endif
+
+/** Size of the aligned write buffer, data is written when it is full */
+#ifndef BINLOG_WRITE_SIZE
+#define BINLOG_WRITE_SIZE (256 * 1024)
+#endif
+
+/** Maximum time in ms before buffered records are written to the file */
+#ifndef BINLOG_FLUSH_MS
+#define BINLOG_FLUSH_MS 1000
+#endif
+
+/** Column types */
+enum BinlogType {
+  BINLOG_U8,
+  BINLOG_I8,
+  BINLOG_U16,
+  BINLOG_I16,
+  BINLOG_U32,
+  BINLOG_I32,
+  BINLOG_F32,
+  BINLOG_F64,
+  BINLOG_TYPE_NB
+};
+
+/** Block codecs */
+enum BinlogCodec {
+  BINLOG_CODEC_RAW,
+  BINLOG_CODEC_DELTA
+};
+
+struct BinlogColumn {
+  const char *name;
+  uint8_t type;     ///< #BinlogType
+};
+
+/** Size of a value of each type */
+extern const uint8_t binlog_type_size[BINLOG_TYPE_NB];
+
+/** Single producer / single consumer ring of records */
+struct BinlogRing {
+  uint8_t *buf;
+  uint32_t nb_slots;      ///< power of two
+  uint16_t record_size;
+  uint32_t head;          ///< next slot written by the producer
+  uint32_t tail;          ///< next slot read by the consumer
+};
+
+struct Binlog {
+  int fd;
+  uint8_t codec;
+  uint16_t record_size;
+  struct BinlogRing ring;
+  pthread_t thread;
+  volatile bool running;
+  /* writer thread buffers */
+  uint8_t *block;         ///< raw records of the current block
+  uint32_t block_len;
+  uint8_t *out;           ///< aligned write buffer
+  uint32_t out_len;
+  /* statistics */
+  volatile uint32_t nb_records;   ///< records committed
+  volatile uint32_t nb_dropped;   ///< records dropped, ring full
+  uint64_t nb_raw_bytes;          ///< size of the records written
+  uint64_t nb_file_bytes;         ///< size of the file
+  uint32_t max_write_us;          ///< longest write call
+};
+
+/**
+ * Create a log file and start its writer thread.
+ * @param log the log
+ * @param filename file to create
+ * @param cols columns of a record, after the time
+ * @param nb_cols number of columns
+ * @param nb_slots ring size in records, rounded up to a power of two
+ * @param codec block codec (#BinlogCodec)
+ * @return 0 on success, -1 on error
+ */
+extern int binlog_open(struct Binlog *log, const char *filename, const struct BinlogColumn *cols, uint16_t nb_cols,
+                       uint32_t nb_slots, uint8_t codec);
+
+/**
+ * Reserve the next record, the columns are written in place.
+ * Never blocks, the record is dropped if the writer thread is late.
+ * @param time_us record time in microseconds
+ * @return pointer to the first column, NULL if the ring is full
+ */
+extern uint8_t *binlog_reserve(struct Binlog *log, uint64_t time_us);
+
+/** Publish the reserved record */
+extern void binlog_commit(struct Binlog *log);
+
+/** Stop the writer thread, write the remaining records and close the file */
+extern void binlog_close(struct Binlog *log);
+
+/** Sequential reader of a log file */
+struct BinlogReader {
+  int fd;
+  uint16_t nb_cols;
+  struct BinlogColumn *cols;
+  uint16_t *offsets;      ///< offset of each column in a record
+  uint16_t record_size;
+  uint8_t *stored;        ///< stored block
+  uint8_t *block;         ///< decoded block
+  uint32_t block_size;    ///< allocated size of the buffers
+  uint32_t nb_block_records;
+  uint32_t idx;           ///< next record of the block
+  uint32_t nb_corrupted;  ///< corrupted regions skipped
+};
+
+/**
+ * Open a log file and read its header.
+ * @return 0 on success, -1 on error
+ */
+extern int binlog_reader_open(struct BinlogReader *r, const char *filename);
+
+/**
+ * Get the next record.
+ * @return pointer to the record (time then columns), NULL at the end of the file
+ */
+extern const uint8_t *binlog_reader_next(struct BinlogReader *r);
+
+extern void binlog_reader_close(struct BinlogReader *r);
+
+#endif /* BINLOG_H */
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/** @file modules/loggers/file_logger_bin.c
+ *  @brief Binary file logger for Linux based autopilots
+ */
+
+#include "file_logger_bin.h"
+#include "modules/loggers/binlog.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "state.h"
+#include "subsystems/abi.h"
+#include "subsystems/commands.h"
+#include "generated/airframe.h"
+
+/** Set the default File logger path to the USB drive */
+#ifndef FILE_LOGGER_BIN_PATH
+#define FILE_LOGGER_BIN_PATH /data/video/usb
+#endif
+
+/** Logged groups of columns */
+#ifndef FILE_LOGGER_BIN_COLUMNS
+#define FILE_LOGGER_BIN_COLUMNS (FLB_POS_NED | FLB_SPEED_NED | FLB_ATT_EULER | FLB_RATES | FLB_COMMANDS)
+#endif
+
+/** Number of rows buffered for the writer thread */
+#ifndef FILE_LOGGER_BIN_RING_SLOTS
+#define FILE_LOGGER_BIN_RING_SLOTS 4096
+#endif
+
+/** Block codec, BINLOG_CODEC_RAW or BINLOG_CODEC_DELTA */
+#ifndef FILE_LOGGER_BIN_CODEC
+#define FILE_LOGGER_BIN_CODEC BINLOG_CODEC_DELTA
+#endif
+
+#ifndef FILE_LOGGER_BIN_ABI_ID
+#define FILE_LOGGER_BIN_ABI_ID ABI_BROADCAST
+#endif
+
+/** The binary log */
+static struct Binlog file_logger_bin;
+static bool file_logger_bin_running = false;
+
+/** Last values of the ABI messages */
+static struct Int32Rates flb_gyro;
+static struct Int32Vect3 flb_accel;
+static float flb_pressure;
+static float flb_agl;
+
+#if (FILE_LOGGER_BIN_COLUMNS) & FLB_GYRO
+static abi_event flb_gyro_ev;
+static void flb_gyro_cb(uint8_t sender_id __attribute__((unused)), uint32_t stamp __attribute__((unused)),
+                        struct Int32Rates *gyro)
+{
+  flb_gyro = *gyro;
+}
+#endif
+
+#if (FILE_LOGGER_BIN_COLUMNS) & FLB_ACCEL
+static abi_event flb_accel_ev;
+static void flb_accel_cb(uint8_t sender_id __attribute__((unused)), uint32_t stamp __attribute__((unused)),
+                         struct Int32Vect3 *accel)
+{
+  flb_accel = *accel;
+}
+#endif
+
+#if (FILE_LOGGER_BIN_COLUMNS) & FLB_BARO
+static abi_event flb_baro_ev;
+static void flb_baro_cb(uint8_t sender_id __attribute__((unused)), uint32_t stamp __attribute__((unused)),
+                        float pressure)
+{
+  flb_pressure = pressure;
+}
+#endif
+
+#if (FILE_LOGGER_BIN_COLUMNS) & FLB_AGL
+static abi_event flb_agl_ev;
+static void flb_agl_cb(uint8_t sender_id __attribute__((unused)), uint32_t stamp __attribute__((unused)),
+                       float distance)
+{
+  flb_agl = distance;
+}
+#endif
+
+/** Copy values in the row, returns the next position */
+static inline uint8_t *flb_put(uint8_t *p, const void *values, size_t size)
+{
+  memcpy(p, values, size);
+  return p + size;
+}
+
+static uint8_t *flb_fill_pos_ned(uint8_t *p) { return flb_put(p, stateGetPositionNed_f(), 3 * sizeof(float)); }
+static uint8_t *flb_fill_speed_ned(uint8_t *p) { return flb_put(p, stateGetSpeedNed_f(), 3 * sizeof(float)); }
+static uint8_t *flb_fill_accel_ned(uint8_t *p) { return flb_put(p, stateGetAccelNed_f(), 3 * sizeof(float)); }
+static uint8_t *flb_fill_att_euler(uint8_t *p) { return flb_put(p, stateGetNedToBodyEulers_f(), 3 * sizeof(float)); }
+static uint8_t *flb_fill_att_quat(uint8_t *p) { return flb_put(p, stateGetNedToBodyQuat_f(), 4 * sizeof(float)); }
+static uint8_t *flb_fill_rates(uint8_t *p) { return flb_put(p, stateGetBodyRates_f(), 3 * sizeof(float)); }
+static uint8_t *flb_fill_pos_lla(uint8_t *p) { return flb_put(p, stateGetPositionLla_i(), 3 * sizeof(int32_t)); }
+static uint8_t *flb_fill_commands(uint8_t *p) { return flb_put(p, commands, COMMANDS_NB * sizeof(pprz_t)); }
+static uint8_t *flb_fill_gyro(uint8_t *p) { return flb_put(p, &flb_gyro, 3 * sizeof(int32_t)); }
+static uint8_t *flb_fill_accel(uint8_t *p) { return flb_put(p, &flb_accel, 3 * sizeof(int32_t)); }
+static uint8_t *flb_fill_baro(uint8_t *p) { return flb_put(p, &flb_pressure, sizeof(float)); }
+static uint8_t *flb_fill_agl(uint8_t *p) { return flb_put(p, &flb_agl, sizeof(float)); }
+
+static uint8_t *flb_fill_airspeed(uint8_t *p)
+{
+  float airspeed = stateGetAirspeed_f();
+  return flb_put(p, &airspeed, sizeof(float));
+}
+
+/** Group of columns, written with a single copy of the state structure */
+struct flb_group {
+  uint32_t flag;
+  uint8_t type;
+  uint8_t nb;
+  const char *names[4];
+  uint8_t *(*fill)(uint8_t *p);
+};
+
+static const struct flb_group flb_groups[] = {
+  { FLB_POS_NED, BINLOG_F32, 3, { "pos_x", "pos_y", "pos_z" }, flb_fill_pos_ned },
+  { FLB_SPEED_NED, BINLOG_F32, 3, { "vel_x", "vel_y", "vel_z" }, flb_fill_speed_ned },
+  { FLB_ACCEL_NED, BINLOG_F32, 3, { "acc_x", "acc_y", "acc_z" }, flb_fill_accel_ned },
+  { FLB_ATT_EULER, BINLOG_F32, 3, { "att_phi", "att_theta", "att_psi" }, flb_fill_att_euler },
+  { FLB_ATT_QUAT, BINLOG_F32, 4, { "quat_qi", "quat_qx", "quat_qy", "quat_qz" }, flb_fill_att_quat },
+  { FLB_RATES, BINLOG_F32, 3, { "rate_p", "rate_q", "rate_r" }, flb_fill_rates },
+  { FLB_POS_LLA, BINLOG_I32, 3, { "lat", "lon", "alt" }, flb_fill_pos_lla },
+  { FLB_AIRSPEED, BINLOG_F32, 1, { "airspeed" }, flb_fill_airspeed },
+  { FLB_COMMANDS, BINLOG_I16, COMMANDS_NB, { NULL }, flb_fill_commands },
+  { FLB_GYRO, BINLOG_I32, 3, { "gyro_p", "gyro_q", "gyro_r" }, flb_fill_gyro },
+  { FLB_ACCEL, BINLOG_I32, 3, { "accel_x", "accel_y", "accel_z" }, flb_fill_accel },
+  { FLB_BARO, BINLOG_F32, 1, { "pressure" }, flb_fill_baro },
+  { FLB_AGL, BINLOG_F32, 1, { "agl" }, flb_fill_agl },
+};
+#define FLB_GROUPS_NB (sizeof(flb_groups) / sizeof(flb_groups[0]))
+
+/** Maximum number of columns */
+#define FLB_COLUMNS_MAX (4 * FLB_GROUPS_NB + COMMANDS_NB)
+
+/** Fill functions of the selected groups, in column order */
+static uint8_t *(*flb_fill[FLB_GROUPS_NB])(uint8_t *p);
+static uint8_t flb_nb_fill = 0;
+
+static uint64_t flb_time_us(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void file_logger_bin_init(void)
+{
+#if (FILE_LOGGER_BIN_COLUMNS) & FLB_GYRO
+  AbiBindMsgIMU_GYRO_INT32(FILE_LOGGER_BIN_ABI_ID, &flb_gyro_ev, flb_gyro_cb);
+#endif
+#if (FILE_LOGGER_BIN_COLUMNS) & FLB_ACCEL
+  AbiBindMsgIMU_ACCEL_INT32(FILE_LOGGER_BIN_ABI_ID, &flb_accel_ev, flb_accel_cb);
+#endif
+#if (FILE_LOGGER_BIN_COLUMNS) & FLB_BARO
+  AbiBindMsgBARO_ABS(FILE_LOGGER_BIN_ABI_ID, &flb_baro_ev, flb_baro_cb);
+#endif
+#if (FILE_LOGGER_BIN_COLUMNS) & FLB_AGL
+  AbiBindMsgAGL(FILE_LOGGER_BIN_ABI_ID, &flb_agl_ev, flb_agl_cb);
+#endif
+}
+
+/** Start the file logger and open a new file */
+void file_logger_bin_start(void)
+{
+  if (file_logger_bin_running) {
+    return;
+  }
+
+  // Create output folder if necessary
+  if (access(STRINGIFY(FILE_LOGGER_BIN_PATH), F_OK)) {
+    char save_dir_cmd[256];
+    sprintf(save_dir_cmd, "mkdir -p %s", STRINGIFY(FILE_LOGGER_BIN_PATH));
+    if (system(save_dir_cmd) != 0) {
+      printf("[file_logger_bin] Could not create log file directory %s.\n", STRINGIFY(FILE_LOGGER_BIN_PATH));
+      return;
+    }
+  }
+
+  // Get current date/time for filename
+  char date_time[80];
+  time_t now = time(0);
+  struct tm tstruct;
+  tstruct = *localtime(&now);
+  strftime(date_time, sizeof(date_time), "%Y%m%d-%H%M%S", &tstruct);
+
+  uint32_t counter = 0;
+  char filename[512];
+
+  // Check for available files
+  sprintf(filename, "%s/%s.blog", STRINGIFY(FILE_LOGGER_BIN_PATH), date_time);
+  while (access(filename, F_OK) == 0) {
+    sprintf(filename, "%s/%s_%05d.blog", STRINGIFY(FILE_LOGGER_BIN_PATH), date_time, counter);
+    counter++;
+  }
+
+  // Columns of the selected groups
+  static struct BinlogColumn cols[FLB_COLUMNS_MAX];
+  static char cmd_names[COMMANDS_NB][12];
+  uint16_t nb_cols = 0;
+  flb_nb_fill = 0;
+  for (uint8_t g = 0; g < FLB_GROUPS_NB; g++) {
+    if (!((FILE_LOGGER_BIN_COLUMNS) & flb_groups[g].flag)) {
+      continue;
+    }
+    for (uint8_t i = 0; i < flb_groups[g].nb; i++) {
+      cols[nb_cols].type = flb_groups[g].type;
+      if (flb_groups[g].flag == FLB_COMMANDS) {
+        snprintf(cmd_names[i], sizeof(cmd_names[i]), "cmd_%d", i);
+        cols[nb_cols].name = cmd_names[i];
+      } else {
+        cols[nb_cols].name = flb_groups[g].names[i];
+      }
+      nb_cols++;
+    }
+    flb_fill[flb_nb_fill++] = flb_groups[g].fill;
+  }
+
+  if (binlog_open(&file_logger_bin, filename, cols, nb_cols, FILE_LOGGER_BIN_RING_SLOTS,
+                  FILE_LOGGER_BIN_CODEC) < 0) {
+    printf("[file_logger_bin] ERROR opening log file %s!\n", filename);
+    return;
+  }
+  file_logger_bin_running = true;
+
+  printf("[file_logger_bin] Start logging %d columns to %s...\n", nb_cols, filename);
+}
+
+/** Stop the logger an nicely close the file */
+void file_logger_bin_stop(void)
+{
+  if (!file_logger_bin_running) {
+    return;
+  }
+  file_logger_bin_running = false;
+  binlog_close(&file_logger_bin);
+  printf("[file_logger_bin] Stop: %u rows, %u dropped, %llu bytes written (%llu raw), longest write %u us\n",
+         file_logger_bin.nb_records, file_logger_bin.nb_dropped,
+         (unsigned long long)file_logger_bin.nb_file_bytes, (unsigned long long)file_logger_bin.nb_raw_bytes,
+         file_logger_bin.max_write_us);
+}
+
+/** Log the values, the row is only copied to the ring */
+void file_logger_bin_periodic(void)
+{
+  if (!file_logger_bin_running) {
+    return;
+  }
+  uint8_t *p = binlog_reserve(&file_logger_bin, flb_time_us());
+  if (p == NULL) {
+    return;
+  }
+  for (uint8_t i = 0; i < flb_nb_fill; i++) {
+    p = flb_fill[i](p);
+  }
+  binlog_commit(&file_logger_bin);
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/** @file modules/loggers/file_logger_bin.h
+ *  @brief Binary file logger for Linux based autopilots
+ *
+ * Same use as file_logger, but the rows are copied in a ring and written
+ * to a binary file (see binlog.h) by a separate thread, so that the
+ * periodic function never waits for the storage.
+ *
+ * The logged values are selected by groups of columns, with
+ * FILE_LOGGER_BIN_COLUMNS set to an OR of the FLB_* flags below.
+ */
+
+#ifndef FILE_LOGGER_BIN_H_
+#define FILE_LOGGER_BIN_H_
+
+#include "std.h"
+
+/** Groups of columns */
+#define FLB_POS_NED     (1 << 0)   ///< pos_x, pos_y, pos_z (m)
+#define FLB_SPEED_NED   (1 << 1)   ///< vel_x, vel_y, vel_z (m/s)
+#define FLB_ACCEL_NED   (1 << 2)   ///< acc_x, acc_y, acc_z (m/s2)
+#define FLB_ATT_EULER   (1 << 3)   ///< att_phi, att_theta, att_psi (rad)
+#define FLB_ATT_QUAT    (1 << 4)   ///< quat_qi, quat_qx, quat_qy, quat_qz
+#define FLB_RATES       (1 << 5)   ///< rate_p, rate_q, rate_r (rad/s)
+#define FLB_POS_LLA     (1 << 6)   ///< lat, lon (1e-7 deg), alt (mm)
+#define FLB_AIRSPEED    (1 << 7)   ///< airspeed (m/s)
+#define FLB_COMMANDS    (1 << 8)   ///< cmd_0 to cmd_{COMMANDS_NB-1}
+#define FLB_GYRO        (1 << 9)   ///< last IMU_GYRO_INT32, gyro_p, gyro_q, gyro_r (BFP)
+#define FLB_ACCEL       (1 << 10)  ///< last IMU_ACCEL_INT32, accel_x, accel_y, accel_z (BFP)
+#define FLB_BARO        (1 << 11)  ///< last BARO_ABS, pressure (Pa)
+#define FLB_AGL         (1 << 12)  ///< last AGL, agl (m)
+
+extern void file_logger_bin_init(void);
+extern void file_logger_bin_start(void);
+extern void file_logger_bin_stop(void);
+extern void file_logger_bin_periodic(void);
+
+#endif /* FILE_LOGGER_BIN_H_ */
@@ -0,0 +1,164 @@
+#! /usr/bin/env python3
+#
+# Copyright (C) 2026 The Paparazzi Team
+#
+# This file is part of paparazzi.
+#
+# paparazzi is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2, or (at your option)
+# any later version.
+#
+# paparazzi is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with paparazzi; see the file COPYING.  If not, see
+# <http://www.gnu.org/licenses/>.
+
+"""
+Convert a binary log of file_logger_bin (see binlog.h for the format).
+
+  file_logger_bin_parse.py log.blog                 -> log.csv
+  file_logger_bin_parse.py log.blog -o out.csv
+  file_logger_bin_parse.py log.blog --columns dir   -> one little endian
+      array file per column (time.u64, pos_x.f32, ...) and dir/schema.json,
+      that can be loaded with numpy.fromfile
+
+Corrupted blocks are skipped, the reader looks for the next block magic.
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = b'PPRZBLOG'
+VERSION = 1
+BLOCK_MAGIC = struct.pack('<I', 0x4B4C4250)
+BLOCK_HEADER = struct.Struct('<IIIIB3xI')
+CODEC_RAW, CODEC_DELTA = 0, 1
+
+# binlog type -> (struct format, file suffix)
+TYPES = [('B', 'u8'), ('b', 'i8'), ('H', 'u16'), ('h', 'i16'),
+         ('I', 'u32'), ('i', 'i32'), ('f', 'f32'), ('d', 'f64')]
+
+
+def read_header(data):
+    if data[:8] != MAGIC:
+        raise ValueError("not a binary log")
+    version, nb_cols, record_size, _, header_size = struct.unpack_from('<HHHHI', data, 8)
+    if version != VERSION:
+        raise ValueError("unsupported version %d" % version)
+    cols = []
+    p = 20
+    for _ in range(nb_cols):
+        t, n = data[p], data[p + 1]
+        cols.append((data[p + 2:p + 2 + n].decode(), t))
+        p += 2 + n
+    fmt = '<Q' + ''.join(TYPES[t][0] for _, t in cols)
+    if struct.calcsize(fmt) != record_size:
+        raise ValueError("bad record size")
+    return cols, fmt, record_size, header_size
+
+
+def decode_delta(stored, raw_len, rs):
+    out = bytearray()
+    i = 0
+    while i < len(stored):
+        c = stored[i]
+        i += 1
+        if c >= 128:
+            out += bytes(c - 127)
+        else:
+            out += stored[i:i + c + 1]
+            i += c + 1
+    if len(out) != raw_len:
+        raise ValueError("bad block")
+    for o in range(rs, raw_len):
+        out[o] ^= out[o - rs]
+    return bytes(out)
+
+
+def blocks(data, pos, rs):
+    """Yield the decoded blocks, skip and count the corrupted regions"""
+    corrupted = [0]
+    lost = False
+    while pos + BLOCK_HEADER.size <= len(data):
+        magic, nb, raw, stored, codec, ck = BLOCK_HEADER.unpack_from(data, pos)
+        end = pos + BLOCK_HEADER.size + stored
+        block = None
+        if magic == 0x4B4C4250 and raw == nb * rs and stored <= raw and end <= len(data):
+            payload = data[pos + BLOCK_HEADER.size:end]
+            if zlib.adler32(payload) == ck:
+                try:
+                    block = payload if codec == CODEC_RAW else decode_delta(payload, raw, rs)
+                except (ValueError, IndexError):
+                    block = None
+        if block is None:
+            if not lost:
+                corrupted[0] += 1
+                lost = True
+            nxt = data.find(BLOCK_MAGIC, pos + 1)
+            if nxt < 0:
+                break
+            pos = nxt
+            continue
+        lost = False
+        pos = end
+        yield block
+    if corrupted[0] > 0:
+        print("%d corrupted region(s) skipped" % corrupted[0], file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a file_logger_bin log")
+    parser.add_argument('log', help="binary log (.blog)")
+    parser.add_argument('-o', '--output', help="CSV file, default: log name with .csv")
+    parser.add_argument('--columns', metavar='DIR', help="write one array file per column in DIR")
+    args = parser.parse_args()
+
+    with open(args.log, 'rb') as f:
+        data = f.read()
+    cols, fmt, rs, header_size = read_header(data)
+    rec = struct.Struct(fmt)
+    names = ['time'] + [n for n, _ in cols]
+    nb = 0
+
+    if args.columns:
+        os.makedirs(args.columns, exist_ok=True)
+        suffixes = ['u64'] + [TYPES[t][1] for _, t in cols]
+        files = [open(os.path.join(args.columns, '%s.%s' % (n, s)), 'wb') for n, s in zip(names, suffixes)]
+        sizes = [struct.calcsize('<' + c) for c in fmt[1:]]
+        for block in blocks(data, header_size, rs):
+            n = len(block) // rs
+            off = 0
+            # transpose the block: one slice per column
+            for f, size in zip(files, sizes):
+                f.write(b''.join(block[r * rs + off:r * rs + off + size] for r in range(n)))
+                off += size
+            nb += n
+        for f in files:
+            f.close()
+        schema = {'records': nb, 'columns': [{'name': n, 'type': s, 'file': '%s.%s' % (n, s)}
+                                             for n, s in zip(names, suffixes)]}
+        with open(os.path.join(args.columns, 'schema.json'), 'w') as f:
+            json.dump(schema, f, indent=2)
+    else:
+        out = args.output or os.path.splitext(args.log)[0] + '.csv'
+        with open(out, 'w') as f:
+            f.write(','.join(names) + '\n')
+            for block in blocks(data, header_size, rs):
+                for values in rec.iter_unpack(block):
+                    f.write('%.6f,' % (values[0] * 1e-6))
+                    f.write(','.join(repr(v) for v in values[1:]) + '\n')
+                    nb += 1
+    print("%d records" % nb, file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,403 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file "modules/meteo/wind_estimator_ukf.c"
+ *
+ * Square root UKF of the wind estimator, written by hand.
+ *
+ * The order of the floating point operations follows the generated code
+ * where it matters for the comparison, in particular for the weighted sums
+ * over the sigma points.
+ */
+
+#include "modules/meteo/wind_estimator_ukf.h"
+#include <math.h>
+#include <string.h>
+
+#define NX WE_UKF_NX
+#define NZ WE_UKF_NZ
+#define NS WE_UKF_NS
+#define NSP WE_UKF_NS_PAD
+
+/** sigma points and their images, by component */
+struct WeUkfSigmas {
+  float X[NX][NSP];   ///< sigma points
+  float Y[NX][NSP];   ///< propagated sigma points
+  float Z[NZ][NSP];   ///< predicted measurements
+};
+
+/**
+ * In place Cholesky factorization of the upper triangle of A, A = U' U.
+ * As the generated code, stops at the first non positive pivot.
+ * The lower triangle is set to zero.
+ * @return false if A is not positive definite
+ */
+static bool chol_upper(float *A, int n)
+{
+  bool ok = true;
+  for (int j = 0; j < n && ok; j++) {
+    float s = 0.f;
+    for (int k = 0; k < j; k++) {
+      s += A[k * n + j] * A[k * n + j];
+    }
+    float ajj = A[j * n + j] - s;
+    if (ajj > 0.f) {
+      ajj = sqrtf(ajj);
+      A[j * n + j] = ajj;
+      const float inv = 1.f / ajj;
+      for (int i = j + 1; i < n; i++) {
+        s = 0.f;
+        for (int k = 0; k < j; k++) {
+          s += A[k * n + i] * A[k * n + j];
+        }
+        A[j * n + i] = (A[j * n + i] - s) * inv;
+      }
+    } else {
+      A[j * n + j] = ajj;
+      ok = false;
+    }
+  }
+  for (int i = 1; i < n; i++) {
+    for (int j = 0; j < i; j++) {
+      A[i * n + j] = 0.f;
+    }
+  }
+  return ok;
+}
+
+/**
+ * Rank one downdate of an upper triangular factor, U' U - v v'.
+ * @return false if the result is not positive definite, U is then invalid
+ */
+static bool chol_downdate(float *U, float *v, int n)
+{
+  for (int k = 0; k < n; k++) {
+    const float ukk = U[k * n + k];
+    const float r2 = ukk * ukk - v[k] * v[k];
+    if (!(r2 > 0.f)) {
+      return false;
+    }
+    const float r = sqrtf(r2);
+    const float c = r / ukk;
+    const float s = v[k] / ukk;
+    const float inv_c = 1.f / c;
+    U[k * n + k] = r;
+    for (int j = k + 1; j < n; j++) {
+      U[k * n + j] = (U[k * n + j] - s * v[j]) * inv_c;
+      v[j] = c * v[j] - s * U[k * n + j];
+    }
+  }
+  return true;
+}
+
+/**
+ * Upper triangle of the weighted covariance of the sigma point deviations
+ * D (NSP columns), plus the square of the noise square root N and the
+ * central point correction: w D(:,1:) D(:,1:)' + N N' + sign(wc0) v v'.
+ */
+static void sigma_covariance(float *P, int n, const float *D, float w, const float *N,
+                             const float *v, bool negative)
+{
+  float A[NX][NSP];
+  for (int i = 0; i < n; i++) {
+    for (int s = 1; s < NS; s++) {
+      A[i][s] = D[i * NSP + s] * w;
+    }
+  }
+  for (int i = 0; i < n; i++) {
+    for (int k = i; k < n; k++) {
+      float g = 0.f;
+      for (int s = 1; s < NS; s++) {
+        g += A[i][s] * A[k][s];
+      }
+      float q = 0.f;
+      for (int m = 0; m < n; m++) {
+        q += N[i * n + m] * N[k * n + m];
+      }
+      g += q;
+      P[i * n + k] = negative ? g - v[i] * v[k] : g + v[i] * v[k];
+    }
+  }
+}
+
+/** Runge-Kutta 4 propagation of the airspeed components of all sigma points */
+static void propagate_sigmas(struct WeUkfSigmas *sig, const float u[6], float dt)
+{
+  float *restrict x0 = sig->X[0], *restrict x1 = sig->X[1], *restrict x2 = sig->X[2];
+  float k1[3][NSP], k2[3][NSP], k3[3][NSP], k4[3][NSP], b[3][NSP];
+  const float dt6 = dt / 6.0f;
+
+  for (int s = 0; s < NSP; s++) {
+    k1[0][s] = (u[2] * x1[s] + u[3]) - u[1] * x2[s];
+    k1[1][s] = (u[0] * x2[s] + u[4]) - u[2] * x0[s];
+    k1[2][s] = (u[1] * x0[s] + u[5]) - u[0] * x1[s];
+    b[0][s] = k1[0][s] / 2.0f * dt + x0[s];
+    b[1][s] = k1[1][s] / 2.0f * dt + x1[s];
+    b[2][s] = k1[2][s] / 2.0f * dt + x2[s];
+  }
+  for (int s = 0; s < NSP; s++) {
+    k2[0][s] = (u[2] * b[1][s] + u[3]) - u[1] * b[2][s];
+    k2[1][s] = (u[0] * b[2][s] + u[4]) - u[2] * b[0][s];
+    k2[2][s] = (u[1] * b[0][s] + u[5]) - u[0] * b[1][s];
+  }
+  for (int s = 0; s < NSP; s++) {
+    b[0][s] = k2[0][s] / 2.0f * dt + x0[s];
+    b[1][s] = k2[1][s] / 2.0f * dt + x1[s];
+    b[2][s] = k2[2][s] / 2.0f * dt + x2[s];
+  }
+  for (int s = 0; s < NSP; s++) {
+    k3[0][s] = (u[2] * b[1][s] + u[3]) - u[1] * b[2][s];
+    k3[1][s] = (u[0] * b[2][s] + u[4]) - u[2] * b[0][s];
+    k3[2][s] = (u[1] * b[0][s] + u[5]) - u[0] * b[1][s];
+  }
+  for (int s = 0; s < NSP; s++) {
+    b[0][s] = dt * k3[0][s] + x0[s];
+    b[1][s] = dt * k3[1][s] + x1[s];
+    b[2][s] = dt * k3[2][s] + x2[s];
+  }
+  for (int s = 0; s < NSP; s++) {
+    k4[0][s] = (u[2] * b[1][s] + u[3]) - u[1] * b[2][s];
+    k4[1][s] = (u[0] * b[2][s] + u[4]) - u[2] * b[0][s];
+    k4[2][s] = (u[1] * b[0][s] + u[5]) - u[0] * b[1][s];
+  }
+  for (int n = 0; n < 3; n++) {
+    for (int s = 0; s < NSP; s++) {
+      sig->Y[n][s] = (((k2[n][s] + k3[n][s]) * 2.0f + k1[n][s]) + k4[n][s]) * dt6 + sig->X[n][s];
+    }
+  }
+  // wind and airspeed scale are constant
+  for (int n = 3; n < NX; n++) {
+    memcpy(sig->Y[n], sig->X[n], sizeof(sig->Y[n]));
+  }
+}
+
+/** Observation model for all sigma points */
+static void observe_sigmas(struct WeUkfSigmas *sig, const float q[4])
+{
+  // rotation body to NED of q * v * q^-1, q is not assumed normalized
+  const float n2 = ((q[0] * q[0] + q[1] * q[1]) + q[2] * q[2]) + q[3] * q[3];
+  const float qq00 = q[0] * q[0], qq11 = q[1] * q[1], qq22 = q[2] * q[2], qq33 = q[3] * q[3];
+  const float qq01 = q[0] * q[1], qq02 = q[0] * q[2], qq03 = q[0] * q[3];
+  const float qq12 = q[1] * q[2], qq13 = q[1] * q[3], qq23 = q[2] * q[3];
+  const float R[3][3] = {
+    { (qq00 + qq11 - qq22 - qq33) / n2, 2.f * (qq12 - qq03) / n2, 2.f * (qq13 + qq02) / n2 },
+    { 2.f * (qq12 + qq03) / n2, (qq00 - qq11 + qq22 - qq33) / n2, 2.f * (qq23 - qq01) / n2 },
+    { 2.f * (qq13 - qq02) / n2, 2.f * (qq23 + qq01) / n2, (qq00 - qq11 - qq22 + qq33) / n2 }
+  };
+  float *restrict u = sig->Y[0], *restrict v = sig->Y[1], *restrict w = sig->Y[2];
+  float va[NSP];
+
+  for (int s = 0; s < NSP; s++) {
+    sig->Z[0][s] = (R[0][0] * u[s] + R[0][1] * v[s] + R[0][2] * w[s]) + sig->Y[3][s];
+    sig->Z[1][s] = (R[1][0] * u[s] + R[1][1] * v[s] + R[1][2] * w[s]) + sig->Y[4][s];
+    sig->Z[2][s] = (R[2][0] * u[s] + R[2][1] * v[s] + R[2][2] * w[s]) + sig->Y[5][s];
+    va[s] = sqrtf(u[s] * u[s] + v[s] * v[s] + w[s] * w[s]);
+    sig->Z[3][s] = sig->Y[6][s] * va[s];
+  }
+  for (int s = 0; s < NS; s++) {
+    if (va[s] > 0.0001) {
+      sig->Z[4][s] = atan2f(w[s], u[s]);
+      sig->Z[5][s] = asinf(v[s] / va[s]);
+    } else {
+      sig->Z[4][s] = 0.f;
+      sig->Z[5][s] = 0.f;
+    }
+  }
+}
+
+/** weighted mean of the sigma points, same summation order as the generated code */
+static void sigma_mean(float *mean, const float *M, int n, const float *Wm)
+{
+  for (int i = 0; i < n; i++) {
+    float m = 0.f;
+    for (int s = 0; s < NS; s++) {
+      m += M[i * NSP + s] * Wm[s];
+    }
+    mean[i] = m;
+  }
+}
+
+void we_ukf_init(struct WeUkf *ukf)
+{
+  memset(ukf, 0, sizeof(struct WeUkf));
+}
+
+void we_ukf_step(struct WeUkf *ukf, const ukf_init_type *init, const ukf_params_type *params,
+                 const ExtU *in, ExtY *out)
+{
+  struct WeUkfSigmas sig;
+  float Wm[NSP], Wc[NSP];
+  float xm[NX], zm[NZ];
+  float DX[NX][NSP], DZ[NZ][NSP];
+  float Sx[NX][NX], Sz[NZ][NZ], N[NX * NX];
+  float v[NX];
+
+  if (!ukf->initialized) {
+    // P0 is column major, its upper triangle is the transpose of the lower one
+    for (int i = 0; i < NX; i++) {
+      ukf->x[i] = init->x0[i];
+      for (int j = 0; j < NX; j++) {
+        ukf->S[i][j] = init->P0[i + NX * j];
+      }
+    }
+    chol_upper(&ukf->S[0][0], NX);
+    ukf->initialized = true;
+  }
+
+  // weights
+  float lambda = init->alpha * init->alpha * (7.0f + init->ki) - 7.0f;
+  const float wm = 0.5f / (7.0f + lambda);
+  Wm[0] = lambda / (7.0f + lambda);
+  for (int s = 1; s < NSP; s++) {
+    Wm[s] = (s < NS) ? wm : 0.f;
+  }
+  memcpy(Wc, Wm, sizeof(Wc));
+  Wc[0] = ((1.0f - init->alpha * init->alpha) + init->beta) + Wm[0];
+  const float c = sqrtf(7.0f + lambda);
+  const float sqrt_wm = sqrtf(wm);
+  // as in the generated code, the central point is weighted by sqrt(|Wc(0)|)
+  const float wc0_4 = powf(fabsf(Wc[0]), 0.25f);
+  const bool wc0_neg = Wc[0] < 0.f;
+
+  // sigma points, columns of the lower factor are the rows of S, last one is padding
+  for (int n = 0; n < NX; n++) {
+    sig.X[n][0] = ukf->x[n];
+    for (int j = 0; j < NX; j++) {
+      const float d = c * ukf->S[j][n];
+      sig.X[n][1 + j] = ukf->x[n] + d;
+      sig.X[n][1 + NX + j] = ukf->x[n] - d;
+    }
+    sig.X[n][NS] = ukf->x[n];
+  }
+
+  // prediction
+  const float u[6] = { in->rates[0], in->rates[1], in->rates[2], in->accel[0], in->accel[1], in->accel[2] };
+  propagate_sigmas(&sig, u, params->dt);
+  sigma_mean(xm, &sig.Y[0][0], NX, Wm);
+  for (int n = 0; n < NX; n++) {
+    for (int s = 0; s < NSP; s++) {
+      DX[n][s] = sig.Y[n][s] - xm[n];
+    }
+    v[n] = wc0_4 * DX[n][0];
+  }
+  for (int i = 0; i < NX; i++) {
+    for (int m = 0; m < NX; m++) {
+      N[i * NX + m] = sqrtf(params->Q[i + NX * m]);
+    }
+  }
+  sigma_covariance(&Sx[0][0], NX, &DX[0][0], sqrt_wm, N, v, wc0_neg);
+  chol_upper(&Sx[0][0], NX);
+
+  // predicted measurements
+  observe_sigmas(&sig, in->q);
+  sigma_mean(zm, &sig.Z[0][0], NZ, Wm);
+  for (int n = 0; n < NZ; n++) {
+    for (int s = 0; s < NSP; s++) {
+      DZ[n][s] = sig.Z[n][s] - zm[n];
+    }
+    v[n] = wc0_4 * DZ[n][0];
+  }
+  for (int i = 0; i < NZ; i++) {
+    for (int m = 0; m < NZ; m++) {
+      N[i * NZ + m] = sqrtf(params->R[i + NZ * m]);
+    }
+  }
+  sigma_covariance(&Sz[0][0], NZ, &DZ[0][0], sqrt_wm, N, v, wc0_neg);
+  chol_upper(&Sz[0][0], NZ);
+
+  // cross covariance and gain K = Pxz inv(Sz' Sz)
+  float K[NX][NZ];
+  for (int n = 0; n < NX; n++) {
+    float dxw[NSP];
+    for (int s = 0; s < NS; s++) {
+      dxw[s] = DX[n][s] * Wc[s];
+    }
+    for (int m = 0; m < NZ; m++) {
+      float k = 0.f;
+      for (int s = 0; s < NS; s++) {
+        k += dxw[s] * DZ[m][s];
+      }
+      K[n][m] = k;
+    }
+    // solve k Sz = pxz, then k Sz' = k
+    for (int m = 0; m < NZ; m++) {
+      float k = K[n][m];
+      for (int j = 0; j < m; j++) {
+        k -= K[n][j] * Sz[j][m];
+      }
+      K[n][m] = k / Sz[m][m];
+    }
+    for (int m = NZ - 1; m >= 0; m--) {
+      float k = K[n][m];
+      for (int j = m + 1; j < NZ; j++) {
+        k -= K[n][j] * Sz[m][j];
+      }
+      K[n][m] = k / Sz[m][m];
+    }
+  }
+
+  // covariance correction, downdate the predicted factor by the columns of K Sz'
+  for (int m = 0; m < NZ; m++) {
+    float Sx_prev[NX][NX];
+    float col[NX];
+    for (int n = 0; n < NX; n++) {
+      float a = 0.f;
+      for (int j = m; j < NZ; j++) {
+        a += K[n][j] * Sz[m][j];
+      }
+      col[n] = a;
+      v[n] = a;
+    }
+    memcpy(Sx_prev, Sx, sizeof(Sx));
+    if (!chol_downdate(&Sx[0][0], v, NX)) {
+      // not positive definite, factorize the downdated covariance as the generated code
+      for (int i = 0; i < NX; i++) {
+        for (int k = i; k < NX; k++) {
+          float p = 0.f;
+          for (int j = 0; j < NX; j++) {
+            p += Sx_prev[j][i] * Sx_prev[j][k];
+          }
+          Sx[i][k] = p - col[i] * col[k];
+        }
+      }
+      chol_upper(&Sx[0][0], NX);
+    }
+  }
+
+  // state correction
+  const float meas[NZ] = { in->vk[0], in->vk[1], in->vk[2], in->va, in->aoa, in->sideslip };
+  for (int n = 0; n < NX; n++) {
+    float dx = 0.f;
+    for (int m = 0; m < NZ; m++) {
+      dx += K[n][m] * (meas[m] - zm[m]);
+    }
+    ukf->x[n] = xm[n] + dx;
+  }
+  memcpy(ukf->S, Sx, sizeof(Sx));
+
+  // outputs as the generated filter: state and column major lower factor
+  for (int i = 0; i < NX; i++) {
+    out->xout[i] = ukf->x[i];
+    for (int j = 0; j < NX; j++) {
+      out->Pout[i + NX * j] = ukf->S[j][i];
+    }
+  }
+}
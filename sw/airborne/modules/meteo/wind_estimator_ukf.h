@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file "modules/meteo/wind_estimator_ukf.h"
+ *
+ * Square root UKF of the wind estimator, written by hand.
+ *
+ * Same filter as the code generated from the Simulink model
+ * (lib_ukf_wind_estimator), with the same inputs, parameters and outputs,
+ * but structured for speed:
+ * - the sigma points are stored by state component (structure of arrays),
+ *   so the Runge-Kutta propagation and the observation model run on all
+ *   sigma points at once and are vectorized by the compiler,
+ * - the attitude rotation of the observation model is computed once,
+ * - the covariances are built from their sigma point deviations and
+ *   factorized once, instead of QR then Cholesky,
+ * - the Kalman gain is solved with the measurement Cholesky factor and the
+ *   covariance correction is a sequence of rank one Cholesky downdates of
+ *   the predicted factor.
+ *
+ * Results are identical to the generated filter up to float rounding,
+ * as long as the covariances stay positive definite.
+ */
+
+#ifndef WIND_ESTIMATOR_UKF_H
+#define WIND_ESTIMATOR_UKF_H
+
+#include "std.h"
+#include "modules/meteo/lib_ukf_wind_estimator/UKF_Wind_Estimator.h"
+
+#define WE_UKF_NX 7         ///< state size: airspeed (body), wind (NED), airspeed scale
+#define WE_UKF_NZ 6         ///< measurement size: ground speed (NED), airspeed, aoa, sideslip
+#define WE_UKF_NS 15        ///< number of sigma points
+#define WE_UKF_NS_PAD 16    ///< sigma point storage, multiple of the SIMD width
+
+struct WeUkf {
+  float x[WE_UKF_NX];             ///< state
+  float S[WE_UKF_NX][WE_UKF_NX];  ///< upper triangular square root of the covariance, S' S = P
+  bool initialized;               ///< state and covariance initialized from ukf_init
+};
+
+/** Reset the filter, it is initialized from the init parameters on the next step */
+extern void we_ukf_init(struct WeUkf *ukf);
+
+/**
+ * Run one prediction and correction step.
+ * @param ukf filter
+ * @param init initial state and covariance, sigma point parameters
+ * @param params process and measurement noise, time step
+ * @param in inputs and measurements
+ * @param out state and lower triangular square root of the covariance,
+ *            column major as for the generated filter
+ */
+extern void we_ukf_step(struct WeUkf *ukf, const ukf_init_type *init, const ukf_params_type *params,
+                        const ExtU *in, ExtY *out);
+
+#endif /* WIND_ESTIMATOR_UKF_H */
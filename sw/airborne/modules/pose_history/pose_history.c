@@ -20,63 +20,123 @@
 /**
  * @file "modules/pose_history/pose_history.c"
  * @author Roland Meertens
- * Ask this module for the pose the drone had closest to a given timestamp
+ * Ask this module for the pose the drone had at a given timestamp
+ *
+ * The history is a ring buffer with a single writer (pose_periodic) and
+ * lock-free readers: samples are looked up by binary search on their
+ * timestamps and interpolated, readers retry if the samples they used
+ * were overwritten in the meantime.
  */
 
 #include "modules/pose_history/pose_history.h"
-#include <sys/time.h>
 #include "mcu_periph/sys_time.h"
 #include "state.h"
-#ifdef __linux__
-#include <pthread.h>
-#endif
 
 #ifndef POSE_HISTORY_SIZE
 #define POSE_HISTORY_SIZE 1024
 #endif
 
-struct rotation_history_ring_buffer_t {
-  uint32_t ring_index;
-  uint32_t ring_size;
-  struct pose_t ring_data[POSE_HISTORY_SIZE];
+struct pose_history_sample_t {
+  struct pose_t pose;
+  struct FloatQuat quat;    ///< attitude quaternion for interpolation
 };
 
-struct rotation_history_ring_buffer_t location_history;
+struct pose_history_ring_buffer_t {
+  uint32_t head;            ///< total number of samples written
+  struct pose_history_sample_t ring_data[POSE_HISTORY_SIZE];
+};
 
-#ifdef __linux__
-pthread_mutex_t pose_mutex;
-#endif
+static struct pose_history_ring_buffer_t pose_history;
+
+#define PoseHistorySample(_i) (&pose_history.ring_data[(_i) % POSE_HISTORY_SIZE])
+
+/** Time of a sample relative to a reference time, handles timestamp overflow */
+static inline int32_t pose_history_dt(uint32_t index, uint32_t ref)
+{
+  return (int32_t)(PoseHistorySample(index)->pose.timestamp - ref);
+}
+
+/** Interpolate between samples a and b at timestamp */
+static void pose_history_interpolate(struct pose_t *pose, struct pose_history_sample_t *a,
+                                     struct pose_history_sample_t *b, uint32_t timestamp)
+{
+  int32_t dt = (int32_t)(b->pose.timestamp - a->pose.timestamp);
+  float t = 0.f;
+  if (dt > 0) {
+    t = (float)(int32_t)(timestamp - a->pose.timestamp) / (float)dt;
+    Bound(t, 0.f, 1.f);
+  }
+
+  struct FloatQuat quat;
+  float_quat_slerp(&quat, &a->quat, &b->quat, t);
+  float_eulers_of_quat(&pose->eulers, &quat);
+
+  pose->rates.p = a->pose.rates.p + t * (b->pose.rates.p - a->pose.rates.p);
+  pose->rates.q = a->pose.rates.q + t * (b->pose.rates.q - a->pose.rates.q);
+  pose->rates.r = a->pose.rates.r + t * (b->pose.rates.r - a->pose.rates.r);
+  VECT3_DIFF(pose->pos, b->pose.pos, a->pose.pos);
+  VECT3_SMUL(pose->pos, pose->pos, t);
+  VECT3_ADD(pose->pos, a->pose.pos);
+  VECT3_DIFF(pose->speed, b->pose.speed, a->pose.speed);
+  VECT3_SMUL(pose->speed, pose->speed, t);
+  VECT3_ADD(pose->speed, a->pose.speed);
+  pose->timestamp = timestamp;
+}
 
 /**
- * Given a pprz timestamp in used (obtained with get_sys_time_usec) we return the pose in FloatEulers closest to that time.
+ * Given a pprz timestamp in usec (obtained with get_sys_time_usec) we return the pose interpolated at that time.
  */
-struct pose_t get_rotation_at_timestamp(uint32_t timestamp)
+bool pose_history_get(uint32_t timestamp, struct pose_t *pose)
 {
-#ifdef __linux__
-  pthread_mutex_lock(&pose_mutex);
-#endif
-  uint32_t index_history = 0;
-  uint32_t closestTimeDiff = abs(timestamp - location_history.ring_data[0].timestamp);
-  uint32_t closestIndex = 0;
-
-  // Seach for the timestamp closes to the timestamp argument of this function.
-  for (index_history = 0; index_history < location_history.ring_size; index_history++) {
-    uint32_t diff = abs(timestamp - location_history.ring_data[index_history].timestamp);
-    if (diff < closestTimeDiff) {
-      closestIndex = index_history;
-      closestTimeDiff = diff;
+  struct pose_history_sample_t a, b;
+
+  while (true) {
+    uint32_t head = __atomic_load_n(&pose_history.head, __ATOMIC_ACQUIRE);
+    if (head == 0) {
+      return false;
+    }
+    // keep one slot free as it may be written while searching
+    uint32_t nb = Min(head, POSE_HISTORY_SIZE - 1);
+    uint32_t lo = head - nb;
+    uint32_t hi = head - 1;
+
+    // binary search for the last sample before the timestamp
+    if (pose_history_dt(hi, timestamp) <= 0) {
+      lo = hi;
+    } else if (pose_history_dt(lo, timestamp) >= 0) {
+      hi = lo;
+    } else {
+      while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (pose_history_dt(mid, timestamp) <= 0) {
+          lo = mid;
+        } else {
+          hi = mid;
+        }
+      }
+    }
+    a = *PoseHistorySample(lo);
+    b = *PoseHistorySample(hi);
+
+    // check that the writer did not overwrite the samples we used
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint32_t head_end = __atomic_load_n(&pose_history.head, __ATOMIC_RELAXED);
+    if (head_end - lo < POSE_HISTORY_SIZE) {
+      break;
     }
   }
 
-  // Save the pose closest to the given timestamp and return this
-  struct pose_t closest_pose;
-  closest_pose.eulers = location_history.ring_data[closestIndex].eulers;
-  closest_pose.rates = location_history.ring_data[closestIndex].rates;
+  pose_history_interpolate(pose, &a, &b, timestamp);
+  return true;
+}
 
-#ifdef __linux__
-  pthread_mutex_unlock(&pose_mutex);
-#endif
-  return closest_pose;
+struct pose_t get_rotation_at_timestamp(uint32_t timestamp)
+{
+  struct pose_t pose;
+  if (!pose_history_get(timestamp, &pose)) {
+    memset(&pose, 0, sizeof(pose));
+  }
+  return pose;
 }
 
 /**
@@ -84,8 +144,7 @@ struct pose_t get_rotation_at_timestamp(uint32_t timestamp)
  */
 void pose_init()
 {
-  location_history.ring_index = 0;
-  location_history.ring_size = POSE_HISTORY_SIZE;
+  pose_history.head = 0;
 }
 
 
@@ -94,22 +153,21 @@ void pose_init()
  */
 void pose_periodic()
 {
-  uint32_t now_ts = get_sys_time_usec();
-#ifdef __linux__
-  pthread_mutex_lock(&pose_mutex);
-#endif
-  struct pose_t *current_time_and_rotation = &location_history.ring_data[location_history.ring_index];
-  current_time_and_rotation->eulers = *stateGetNedToBodyEulers_f();
-  current_time_and_rotation->rates = *stateGetBodyRates_f();
-
-  current_time_and_rotation->timestamp = now_ts;
-
-  // increase index location history
-  location_history.ring_index = (location_history.ring_index + 1) % location_history.ring_size;
-
-#ifdef __linux__
-  pthread_mutex_unlock(&pose_mutex);
-#endif
+  uint32_t head = pose_history.head;
+  struct pose_history_sample_t *sample = PoseHistorySample(head);
+
+  // as a seqlock writer: the previous head must be visible before the slot
+  // is overwritten, otherwise a reader could validate the samples it read
+  // from this slot against a stale head
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  sample->pose.timestamp = get_sys_time_usec();
+  sample->quat = *stateGetNedToBodyQuat_f();
+  sample->pose.eulers = *stateGetNedToBodyEulers_f();
+  sample->pose.rates = *stateGetBodyRates_f();
+  sample->pose.pos = *stateGetPositionNed_f();
+  sample->pose.speed = *stateGetSpeedNed_f();
+
+  // publish the new sample
+  __atomic_store_n(&pose_history.head, head + 1, __ATOMIC_RELEASE);
 }
-
-
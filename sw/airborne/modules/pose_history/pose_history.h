@@ -26,16 +26,36 @@
 #ifndef POSE_HISTORY_H
 #define POSE_HISTORY_H
 
+#include "std.h"
 #include "math/pprz_algebra_float.h"
+#include "math/pprz_geodetic_float.h"
 
 struct pose_t {
   uint32_t timestamp;
   struct FloatEulers eulers;
   struct FloatRates rates;
+  struct NedCoor_f pos;     ///< position in local NED frame in m
+  struct NedCoor_f speed;   ///< speed in local NED frame in m/s
 };
 
 extern void pose_init(void);
 extern void pose_periodic(void);
+
+/**
+ * Get the pose at a given timestamp, interpolated between the two
+ * closest recorded samples. Can be called from any thread.
+ * Timestamps outside of the recorded history return the oldest or
+ * newest sample.
+ * @param timestamp time in usec (from get_sys_time_usec)
+ * @param pose pose at timestamp
+ * @return false if the history is still empty
+ */
+extern bool pose_history_get(uint32_t timestamp, struct pose_t *pose);
+
+/**
+ * Get the interpolated pose at a given timestamp.
+ * Same as pose_history_get but returns a zero pose if the history is empty.
+ */
 extern struct pose_t get_rotation_at_timestamp(uint32_t timestamp);
 #endif
 
@@ -76,6 +76,9 @@ void mpu60x0_set_default_config(struct Mpu60x0Config *c)
   c->nb_slaves = 0;
   c->nb_slave_init = 0;
 
+  c->fifo_enabled = false;
+  c->fifo_read_samples = MPU60X0_FIFO_MAX_SAMPLES;
+
   c->i2c_bypass = false;
 }
 
@@ -137,6 +140,24 @@ void mpu60x0_send_config(Mpu60x0ConfigSet mpu_set, void *mpu, struct Mpu60x0Conf
         config->init_status++;
       }
       break;
+    case MPU60X0_CONF_FIFO_EN:
+      /* push accel and gyro samples to the FIFO */
+      if (mpu60x0_fifo_active(config)) {
+        mpu_set(mpu, MPU60X0_REG_FIFO_EN, ((1 << MPU60X0_XG_FIFO_EN) |
+                                           (1 << MPU60X0_YG_FIFO_EN) |
+                                           (1 << MPU60X0_ZG_FIFO_EN) |
+                                           (1 << MPU60X0_ACCEL_FIFO_EN)));
+      }
+      config->init_status++;
+      break;
+    case MPU60X0_CONF_FIFO_USER_CTRL:
+      /* enable and reset the FIFO */
+      if (mpu60x0_fifo_active(config)) {
+        mpu_set(mpu, MPU60X0_REG_USER_CTRL, ((1 << MPU60X0_FIFO_EN) |
+                                             (1 << MPU60X0_FIFO_RESET)));
+      }
+      config->init_status++;
+      break;
     case MPU60X0_CONF_INT_ENABLE:
       /* configure data ready interrupt */
       mpu_set(mpu, MPU60X0_REG_INT_ENABLE, (config->drdy_int_enable << 0));
@@ -156,3 +177,47 @@ void mpu60x0_send_config(Mpu60x0ConfigSet mpu_set, void *mpu, struct Mpu60x0Conf
       break;
   }
 }
+
+float mpu60x0_get_sample_rate(struct Mpu60x0Config *config)
+{
+  /* gyro internal sampling is 8kHz without DLPF, 1kHz otherwise */
+  float internal_rate = (config->dlpf_cfg == MPU60X0_DLPF_256HZ || config->dlpf_cfg == MPU60X0_DLPF_3600HZ) ? 8000.f : 1000.f;
+  return internal_rate / (1.f + config->smplrt_div);
+}
+
+#define Int16FromBuf(_buf,_idx) ((int16_t)((_buf[_idx]<<8) | _buf[_idx+1]))
+
+uint8_t mpu60x0_fifo_count(struct Mpu60x0Fifo *fifo, volatile uint8_t *buf, uint8_t max_samples)
+{
+  fifo->nb = 0;
+  fifo->count = (uint16_t)((buf[0] << 8) | buf[1]);
+  /* a nearly full FIFO can't be decoded reliably anymore */
+  if (fifo->count > MPU60X0_FIFO_RESET_THRESHOLD) {
+    fifo->reset = true;
+    return 0;
+  }
+  /* a partial sample twice in a row is a misaligned FIFO */
+  if (fifo->count % MPU60X0_FIFO_SAMPLE_SIZE != 0) {
+    if (fifo->misaligned) {
+      fifo->reset = true;
+    }
+    fifo->misaligned = true;
+    return 0;
+  }
+  fifo->misaligned = false;
+  return Min(fifo->count / MPU60X0_FIFO_SAMPLE_SIZE, Min(max_samples, MPU60X0_FIFO_MAX_SAMPLES));
+}
+
+void mpu60x0_fifo_decode(struct Mpu60x0Fifo *fifo, volatile uint8_t *buf, uint8_t nb)
+{
+  fifo->nb = Min(nb, MPU60X0_FIFO_MAX_SAMPLES);
+  for (uint8_t i = 0; i < fifo->nb; i++) {
+    volatile uint8_t *sample = &buf[i * MPU60X0_FIFO_SAMPLE_SIZE];
+    fifo->accel[i].x = Int16FromBuf(sample, 0);
+    fifo->accel[i].y = Int16FromBuf(sample, 2);
+    fifo->accel[i].z = Int16FromBuf(sample, 4);
+    fifo->gyro[i].p = Int16FromBuf(sample, 6);
+    fifo->gyro[i].q = Int16FromBuf(sample, 8);
+    fifo->gyro[i].r = Int16FromBuf(sample, 10);
+  }
+}
@@ -29,6 +29,7 @@
 #define MPU60X0_H
 
 #include "std.h"
+#include "math/pprz_algebra_int.h"
 
 /* Include address and register definition */
 #include "peripherals/mpu60x0_regs.h"
@@ -48,6 +49,20 @@
 /// Default clock: PLL with X gyro reference
 #define MPU60X0_DEFAULT_CLK_SEL 1
 
+/** Maximum number of samples read from the FIFO at once.
+ * Each sample holds accel and gyro data (MPU60X0_FIFO_SAMPLE_SIZE bytes).
+ */
+#ifndef MPU60X0_FIFO_MAX_SAMPLES
+#define MPU60X0_FIFO_MAX_SAMPLES 20
+#endif
+/// Size in bytes of one FIFO sample: accel then gyro
+#define MPU60X0_FIFO_SAMPLE_SIZE 12
+/** Reset the FIFO if it holds more bytes than this.
+ * It can store 1024 bytes on MPU60X0 and 1008 on ICM devices, and it is
+ * not reliable anymore once full.
+ */
+#define MPU60X0_FIFO_RESET_THRESHOLD (80 * MPU60X0_FIFO_SAMPLE_SIZE)
+
 // Default number of I2C slaves
 #ifndef MPU60X0_I2C_NB_SLAVES
 #define MPU60X0_I2C_NB_SLAVES 5
@@ -120,6 +135,8 @@ enum Mpu60x0ConfStatus {
   MPU60X0_CONF_ACCEL,
   MPU60X0_CONF_ACCEL2,
   MPU60X0_CONF_I2C_SLAVES,
+  MPU60X0_CONF_FIFO_EN,
+  MPU60X0_CONF_FIFO_USER_CTRL,
   MPU60X0_CONF_INT_ENABLE,
   MPU60X0_CONF_UNDOC1,
   MPU60X0_CONF_DONE
@@ -145,6 +162,11 @@ struct Mpu60x0Config {
   bool drdy_int_enable;               ///< Enable Data Ready Interrupt
   uint8_t clk_sel;                      ///< Clock select
   uint8_t nb_bytes;                     ///< number of bytes to read starting with MPU60X0_REG_INT_STATUS
+  /** Read accel and gyro samples from the FIFO instead of the data registers.
+   * Not compatible with I2C slaves read by the MPU, ignored if nb_slaves > 0.
+   */
+  bool fifo_enabled;
+  uint8_t fifo_read_samples;            ///< maximum number of samples read from the FIFO at once, at most MPU60X0_FIFO_MAX_SAMPLES, the others are read at the next cycle
   enum Mpu60x0ConfStatus init_status;   ///< init status
   bool initialized;                   ///< config done flag
 
@@ -160,8 +182,58 @@ struct Mpu60x0Config {
   uint8_t i2c_mst_delay;                ///< MPU I2C slaves delayed sample rate
 };
 
+/** Samples read from the FIFO
+ */
+struct Mpu60x0Fifo {
+  uint8_t nb;                                       ///< number of valid samples from the last read
+  uint16_t count;                                   ///< number of bytes in the FIFO at the last count read
+  bool misaligned;                                  ///< last count was not a whole number of samples
+  bool reset;                                       ///< FIFO needs to be reset (overflow or misaligned)
+  uint32_t nb_resets;                               ///< number of FIFO resets since init
+  struct Int16Vect3 accel[MPU60X0_FIFO_MAX_SAMPLES];  ///< accel samples, oldest first
+  struct Int16Rates gyro[MPU60X0_FIFO_MAX_SAMPLES];   ///< gyro samples, oldest first
+};
+
 extern void mpu60x0_set_default_config(struct Mpu60x0Config *c);
 
+/** FIFO reads are used, only if enabled and no I2C slave is read by the MPU
+ * @param c MPU configuration
+ * @return true if the FIFO is configured and read
+ */
+static inline bool mpu60x0_fifo_active(struct Mpu60x0Config *c)
+{
+  return c->fifo_enabled && c->nb_slaves == 0;
+}
+
+/** Output data rate of the samples in Hz
+ * @param config MPU configuration
+ * @return sample rate in Hz
+ */
+extern float mpu60x0_get_sample_rate(struct Mpu60x0Config *config);
+
+/**
+ * Number of samples to read after reading the FIFO count.
+ * The FIFO is read in two steps: the count, then exactly that many whole
+ * samples, as every byte clocked out of FIFO_R_W is popped from the FIFO.
+ * The samples written in the meantime stay in the FIFO for the next read.
+ * A count that is not a whole number of samples may be a sample being
+ * written, the read is skipped once. If it is still the case at the next
+ * count, or if the FIFO is nearly full, the reset flag is set.
+ * @param fifo FIFO state
+ * @param buf received FIFO_COUNT_H and FIFO_COUNT_L
+ * @param max_samples maximum number of samples to read
+ * @return number of samples to read
+ */
+extern uint8_t mpu60x0_fifo_count(struct Mpu60x0Fifo *fifo, volatile uint8_t *buf, uint8_t max_samples);
+
+/**
+ * Decode the samples read from FIFO_R_W.
+ * @param fifo FIFO samples
+ * @param buf received FIFO data
+ * @param nb number of samples read
+ */
+extern void mpu60x0_fifo_decode(struct Mpu60x0Fifo *fifo, volatile uint8_t *buf, uint8_t nb);
+
 /// Configuration sequence called once before normal use
 extern void mpu60x0_send_config(Mpu60x0ConfigSet mpu_set, void *mpu, struct Mpu60x0Config *config);
 
@@ -133,6 +133,13 @@
 #define MPU60X0_I2C_MST_EN          5
 #define MPU60X0_FIFO_EN             6
 
+// in MPU60X0_REG_FIFO_EN
+#define MPU60X0_ACCEL_FIFO_EN       3
+#define MPU60X0_ZG_FIFO_EN          4
+#define MPU60X0_YG_FIFO_EN          5
+#define MPU60X0_XG_FIFO_EN          6
+#define MPU60X0_TEMP_FIFO_EN        7
+
 // in MPU60X0_REG_I2C_MST_STATUS
 #define MPU60X0_I2C_SLV4_DONE       6
 
@@ -147,7 +154,8 @@ enum Mpu60x0DLPF {
   MPU60X0_DLPF_42HZ  = 0x3,
   MPU60X0_DLPF_20HZ  = 0x4,
   MPU60X0_DLPF_10HZ  = 0x5,
-  MPU60X0_DLPF_05HZ  = 0x6
+  MPU60X0_DLPF_05HZ  = 0x6,
+  MPU60X0_DLPF_3600HZ = 0x7  // reserved on MPU60x0, internal sampling rate 8kHz on ICM devices
 };
 
 /** Digital Low Pass Filter Options
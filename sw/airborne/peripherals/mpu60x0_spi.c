@@ -56,6 +56,10 @@ void mpu60x0_spi_init(struct Mpu60x0_Spi *mpu, struct spi_periph *spi_p, uint8_t
   mpu60x0_set_default_config(&(mpu->config));
 
   mpu->data_available = false;
+  mpu->fifo.nb = 0;
+  mpu->fifo.misaligned = false;
+  mpu->fifo.reset = false;
+  mpu->fifo.nb_resets = 0;
   mpu->config.initialized = false;
   mpu->config.init_status = MPU60X0_CONF_UNINIT;
 
@@ -115,11 +119,26 @@ void mpu60x0_spi_start_configure(struct Mpu60x0_Spi *mpu)
 void mpu60x0_spi_read(struct Mpu60x0_Spi *mpu)
 {
   if (mpu->config.initialized && mpu->spi_trans.status == SPITransDone) {
-    mpu->spi_trans.output_length = 1;
-    mpu->spi_trans.input_length = 1 + mpu->config.nb_bytes;
-    /* set read bit and multiple byte bit, then address */
-    mpu->tx_buf[0] = MPU60X0_REG_INT_STATUS | MPU60X0_SPI_READ;
-    spi_submit(mpu->spi_p, &(mpu->spi_trans));
+    if (mpu60x0_fifo_active(&mpu->config) && mpu->fifo.reset) {
+      /* flush the FIFO after an overflow or a misaligned read */
+      mpu60x0_spi_write_to_reg(mpu, MPU60X0_REG_USER_CTRL, ((1 << MPU60X0_FIFO_EN) |
+                               (1 << MPU60X0_FIFO_RESET)));
+      mpu->fifo.misaligned = false;
+      mpu->fifo.reset = false;
+      mpu->fifo.nb_resets++;
+    } else if (mpu60x0_fifo_active(&mpu->config)) {
+      /* read the FIFO count first, the samples are read from the event */
+      mpu->spi_trans.output_length = 1;
+      mpu->spi_trans.input_length = 3;
+      mpu->tx_buf[0] = MPU60X0_REG_FIFO_COUNT_H | MPU60X0_SPI_READ;
+      spi_submit(mpu->spi_p, &(mpu->spi_trans));
+    } else {
+      mpu->spi_trans.output_length = 1;
+      mpu->spi_trans.input_length = 1 + mpu->config.nb_bytes;
+      /* set read bit and multiple byte bit, then address */
+      mpu->tx_buf[0] = MPU60X0_REG_INT_STATUS | MPU60X0_SPI_READ;
+      spi_submit(mpu->spi_p, &(mpu->spi_trans));
+    }
   }
 }
 
@@ -129,6 +148,38 @@ void mpu60x0_spi_event(struct Mpu60x0_Spi *mpu)
 {
   if (mpu->config.initialized) {
     if (mpu->spi_trans.status == SPITransFailed) {
+      if (mpu->tx_buf[0] == (MPU60X0_REG_FIFO_R_W | MPU60X0_SPI_READ)) {
+        // an unknown number of bytes may have been popped from the FIFO
+        mpu->fifo.reset = true;
+      }
+      mpu->spi_trans.status = SPITransDone;
+    } else if (mpu->spi_trans.status == SPITransSuccess &&
+               mpu->tx_buf[0] == (MPU60X0_REG_FIFO_COUNT_H | MPU60X0_SPI_READ)) {
+      // FIFO count, then read exactly the counted samples,
+      // the FIFO_R_W register address is not incremented
+      uint8_t nb = mpu60x0_fifo_count(&mpu->fifo, &mpu->rx_buf[1], mpu->config.fifo_read_samples);
+      if (nb > 0) {
+        mpu->spi_trans.output_length = 1;
+        mpu->spi_trans.input_length = 1 + nb * MPU60X0_FIFO_SAMPLE_SIZE;
+        mpu->tx_buf[0] = MPU60X0_REG_FIFO_R_W | MPU60X0_SPI_READ;
+        spi_submit(mpu->spi_p, &(mpu->spi_trans));
+      } else {
+        mpu->spi_trans.status = SPITransDone;
+      }
+    } else if (mpu->spi_trans.status == SPITransSuccess &&
+               mpu->tx_buf[0] == (MPU60X0_REG_FIFO_R_W | MPU60X0_SPI_READ)) {
+      // FIFO samples, skip the command byte
+      mpu60x0_fifo_decode(&mpu->fifo, &mpu->rx_buf[1], (mpu->spi_trans.input_length - 1) / MPU60X0_FIFO_SAMPLE_SIZE);
+      if (mpu->fifo.nb > 0) {
+        // latest sample is also available as single data
+        mpu->data_accel.vect = mpu->fifo.accel[mpu->fifo.nb - 1];
+        mpu->data_rates.rates = mpu->fifo.gyro[mpu->fifo.nb - 1];
+        mpu->data_available = true;
+      }
+      mpu->spi_trans.status = SPITransDone;
+    } else if (mpu->spi_trans.status == SPITransSuccess &&
+               mpu->tx_buf[0] == MPU60X0_REG_USER_CTRL) {
+      // FIFO reset done
       mpu->spi_trans.status = SPITransDone;
     } else if (mpu->spi_trans.status == SPITransSuccess) {
       // Successfull reading
@@ -37,6 +37,9 @@
 
 
 #define MPU60X0_BUFFER_LEN 32
+/// FIFO data read: command byte and samples
+#define MPU60X0_SPI_FIFO_BUFFER_LEN (1 + MPU60X0_FIFO_MAX_SAMPLES * MPU60X0_FIFO_SAMPLE_SIZE)
+#define MPU60X0_SPI_BUFFER_LEN Max(MPU60X0_BUFFER_LEN, MPU60X0_SPI_FIFO_BUFFER_LEN)
 #define MPU60X0_BUFFER_EXT_LEN 16
 
 enum Mpu60x0SpiSlaveInitStatus {
@@ -52,7 +55,7 @@ struct Mpu60x0_Spi {
   struct spi_periph *spi_p;
   struct spi_transaction spi_trans;
   volatile uint8_t tx_buf[2];
-  volatile uint8_t rx_buf[MPU60X0_BUFFER_LEN];
+  volatile uint8_t rx_buf[MPU60X0_SPI_BUFFER_LEN];
   volatile bool data_available;     ///< data ready flag
   union {
     struct Int16Vect3 vect;           ///< accel data vector in accel coordinate system
@@ -63,6 +66,7 @@ struct Mpu60x0_Spi {
     int16_t value[3];                 ///< rates data values accessible by channel index
   } data_rates;
   float temp;                         ///< temperature in degrees Celcius
+  struct Mpu60x0Fifo fifo;            ///< samples from the last FIFO read, if config.fifo_enabled
   uint8_t data_ext[MPU60X0_BUFFER_EXT_LEN];
   struct Mpu60x0Config config;
   enum Mpu60x0SpiSlaveInitStatus slave_init_status;
@@ -1338,4 +1338,79 @@ void stateCalcAirspeed_f(void)
 }
 /** @}*/
 
+
+/******************************************************************************
+ *                                                                            *
+ * Thread-safe SNAPSHOT of the main states                                    *
+ *                                                                            *
+ ******************************************************************************/
+/** @addtogroup state_snapshot
+ *  @{ */
+
+/**
+ * Double buffered snapshot.
+ * seq is odd while the writer fills the next buffer, after n complete
+ * publications seq is 2n and the latest snapshot is in buf[n & 1].
+ */
+static struct {
+  uint32_t seq;
+  struct StateSnapshot buf[2];
+} state_snapshot;
+
+void stateSnapshotPublish(uint32_t timestamp)
+{
+  uint32_t seq = __atomic_load_n(&state_snapshot.seq, __ATOMIC_RELAXED);
+  struct StateSnapshot *snap = &state_snapshot.buf[((seq >> 1) + 1) & 1];
+
+  /* mark writing in progress */
+  __atomic_store_n(&state_snapshot.seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  snap->timestamp = timestamp;
+  snap->status = 0;
+  if (stateIsLocalCoordinateValid()) {
+    snap->ned_pos = *stateGetPositionNed_f();
+    SetBit(snap->status, STATE_SNAPSHOT_POS);
+  }
+  if (state.speed_status) {
+    snap->ned_speed = *stateGetSpeedNed_f();
+    SetBit(snap->status, STATE_SNAPSHOT_SPEED);
+  }
+  if (stateIsAccelValid()) {
+    snap->ned_accel = *stateGetAccelNed_f();
+    SetBit(snap->status, STATE_SNAPSHOT_ACCEL);
+  }
+  if (stateIsAttitudeValid()) {
+    snap->ned_to_body_quat = *stateGetNedToBodyQuat_f();
+    snap->ned_to_body_eulers = *stateGetNedToBodyEulers_f();
+    SetBit(snap->status, STATE_SNAPSHOT_ATT);
+  }
+  if (stateIsRateValid()) {
+    snap->body_rates = *stateGetBodyRates_f();
+    SetBit(snap->status, STATE_SNAPSHOT_RATES);
+  }
+
+  /* publish */
+  __atomic_store_n(&state_snapshot.seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+bool stateSnapshotGet(struct StateSnapshot *snapshot)
+{
+  while (true) {
+    uint32_t seq = __atomic_load_n(&state_snapshot.seq, __ATOMIC_ACQUIRE);
+    uint32_t n = seq >> 1;
+    if (n == 0) {
+      return false;
+    }
+    memcpy(snapshot, &state_snapshot.buf[n & 1], sizeof(struct StateSnapshot));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    /* buf[n & 1] is only overwritten once seq reaches 2n + 3 */
+    uint32_t seq_end = __atomic_load_n(&state_snapshot.seq, __ATOMIC_RELAXED);
+    if (seq_end - 2 * n < 3) {
+      return true;
+    }
+  }
+}
+/** @}*/
+
 /** @}*/
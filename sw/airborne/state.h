@@ -1432,6 +1432,80 @@ static inline float stateGetSideslip_f(void)
 
 /** @}*/
 
+
+/******************************************************************************
+ *                                                                            *
+ * Thread-safe SNAPSHOT of the main states                                    *
+ *                                                                            *
+ *****************************************************************************/
+/**
+ * @defgroup state_snapshot Thread-safe state snapshot
+ *
+ * The stateGet* functions write the converted representations back into
+ * the global #state and are therefore not safe to call from other threads
+ * (e.g. computer vision threads on Linux targets).
+ * Instead the autopilot thread periodically publishes a snapshot of the
+ * main states with stateSnapshotPublish() and other threads read a
+ * consistent copy with stateSnapshotGet().
+ *
+ * The snapshot is double buffered and protected by a sequence counter:
+ * the writer never blocks and readers don't take a lock, they only retry
+ * if the buffer they are copying was overwritten in the meantime.
+ * @{
+ */
+
+/** Publishing is enabled by default on Linux where other threads exist */
+#ifndef USE_STATE_SNAPSHOT
+#if defined(__linux__)
+#define USE_STATE_SNAPSHOT TRUE
+#else
+#define USE_STATE_SNAPSHOT FALSE
+#endif
+#endif
+
+#define STATE_SNAPSHOT_POS   0
+#define STATE_SNAPSHOT_SPEED 1
+#define STATE_SNAPSHOT_ACCEL 2
+#define STATE_SNAPSHOT_ATT   3
+#define STATE_SNAPSHOT_RATES 4
+
+/**
+ * Consistent copy of the main vehicle states.
+ */
+struct StateSnapshot {
+  uint32_t timestamp;                   ///< time of publication in usec
+  uint8_t status;                       ///< valid fields, see STATE_SNAPSHOT_*
+  struct NedCoor_f ned_pos;             ///< position in local NED frame in m
+  struct NedCoor_f ned_speed;           ///< speed in local NED frame in m/s
+  struct NedCoor_f ned_accel;           ///< acceleration in local NED frame in m/s^2
+  struct FloatQuat ned_to_body_quat;    ///< attitude quaternion
+  struct FloatEulers ned_to_body_eulers; ///< attitude euler angles in rad
+  struct FloatRates body_rates;         ///< body angular rates in rad/s
+};
+
+/**
+ * Publish a new snapshot of the current state.
+ * Must only be called from the thread owning #state (autopilot thread).
+ * @param timestamp time of the snapshot in usec
+ */
+extern void stateSnapshotPublish(uint32_t timestamp);
+
+/**
+ * Get the latest published snapshot, can be called from any thread.
+ * @param snapshot pointer to the snapshot to fill
+ * @return false if nothing was published yet
+ */
+extern bool stateSnapshotGet(struct StateSnapshot *snapshot);
+
+/** Call stateSnapshotPublish() if enabled, from the autopilot main loop */
+#if USE_STATE_SNAPSHOT
+#define StateSnapshotPeriodic(_stamp) stateSnapshotPublish(_stamp)
+#else
+#define StateSnapshotPeriodic(_stamp) {}
+#endif
+
+/** @}*/
+
 /** @}*/
 
 
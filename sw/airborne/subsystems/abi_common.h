@@ -33,6 +33,7 @@
 #include "math/pprz_algebra_int.h"
 #include "math/pprz_algebra_float.h"
 #include "subsystems/gps.h"
+#include "subsystems/imu/imu_batch.h"
 /* Include here headers with structure definition you may want to use with ABI
  * Ex: '#include "subsystems/gps.h"' in order to use the GpsState structure
  */
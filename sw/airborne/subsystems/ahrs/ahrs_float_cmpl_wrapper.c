@@ -129,6 +129,7 @@ PRINT_CONFIG_VAR(AHRS_FC_MAG_ID)
 PRINT_CONFIG_VAR(AHRS_FC_GPS_ID)
 static abi_event gyro_ev;
 static abi_event accel_ev;
+static abi_event imu_batch_ev;
 static abi_event mag_ev;
 static abi_event aligner_ev;
 static abi_event body_to_imu_ev;
@@ -136,9 +137,15 @@ static abi_event geo_mag_ev;
 static abi_event gps_ev;
 
 
+/** set once IMU batches are received, single samples are then ignored */
+static bool ahrs_fc_use_batch = false;
+
 static void gyro_cb(uint8_t __attribute__((unused)) sender_id,
                     uint32_t stamp, struct Int32Rates *gyro)
 {
+  if (ahrs_fc_use_batch) {
+    return;
+  }
   ahrs_fc_last_stamp = stamp;
   struct FloatRates gyro_f;
   RATES_FLOAT_OF_BFP(gyro_f, *gyro);
@@ -169,6 +176,9 @@ static void accel_cb(uint8_t __attribute__((unused)) sender_id,
                      uint32_t __attribute__((unused)) stamp,
                      struct Int32Vect3 *accel)
 {
+  if (ahrs_fc_use_batch) {
+    return;
+  }
   struct FloatVect3 accel_f;
   ACCELS_FLOAT_OF_BFP(accel_f, *accel);
 
@@ -190,6 +200,27 @@ static void accel_cb(uint8_t __attribute__((unused)) sender_id,
 #endif
 }
 
+/** Propagation and accel update once per batch of IMU samples,
+ * with the rates and accel integrated over the batch
+ */
+static void imu_batch_cb(uint8_t __attribute__((unused)) sender_id,
+                         uint32_t stamp, struct ImuBatchInt32 *batch)
+{
+  ahrs_fc_use_batch = true;
+  ahrs_fc_last_stamp = stamp;
+
+  struct ImuBatchDelta delta;
+  imu_batch_integrate(&delta, batch, true);
+  if (ahrs_fc.is_aligned && delta.dt > 0.f) {
+    struct FloatRates gyro_f;
+    struct FloatVect3 accel_f;
+    imu_batch_get_mean(&gyro_f, &accel_f, &delta);
+    ahrs_fc_propagate(&gyro_f, delta.dt);
+    ahrs_fc_update_accel(&accel_f, delta.dt);
+    compute_body_orientation_and_rates();
+  }
+}
+
 static void mag_cb(uint8_t __attribute__((unused)) sender_id,
                    uint32_t __attribute__((unused)) stamp,
                    struct Int32Vect3 *mag)
@@ -291,6 +322,7 @@ void ahrs_fc_register(void)
    */
   AbiBindMsgIMU_GYRO_INT32(AHRS_FC_IMU_ID, &gyro_ev, gyro_cb);
   AbiBindMsgIMU_ACCEL_INT32(AHRS_FC_IMU_ID, &accel_ev, accel_cb);
+  AbiBindMsgIMU_BATCH_INT32(AHRS_FC_IMU_ID, &imu_batch_ev, imu_batch_cb);
   AbiBindMsgIMU_MAG_INT32(AHRS_FC_MAG_ID, &mag_ev, mag_cb);
   AbiBindMsgIMU_LOWPASSED(ABI_BROADCAST, &aligner_ev, aligner_cb);
   AbiBindMsgBODY_TO_IMU_QUAT(ABI_BROADCAST, &body_to_imu_ev, body_to_imu_cb);
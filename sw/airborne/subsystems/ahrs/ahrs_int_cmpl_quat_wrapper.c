@@ -130,6 +130,7 @@ PRINT_CONFIG_VAR(AHRS_ICQ_MAG_ID)
 PRINT_CONFIG_VAR(AHRS_ICQ_GPS_ID)
 static abi_event gyro_ev;
 static abi_event accel_ev;
+static abi_event imu_batch_ev;
 static abi_event mag_ev;
 static abi_event aligner_ev;
 static abi_event body_to_imu_ev;
@@ -137,9 +138,15 @@ static abi_event geo_mag_ev;
 static abi_event gps_ev;
 
 
+/** set once IMU batches are received, single samples are then ignored */
+static bool ahrs_icq_use_batch = false;
+
 static void gyro_cb(uint8_t __attribute__((unused)) sender_id,
                     uint32_t stamp, struct Int32Rates *gyro)
 {
+  if (ahrs_icq_use_batch) {
+    return;
+  }
   ahrs_icq_last_stamp = stamp;
 #if USE_AUTO_AHRS_FREQ || !defined(AHRS_PROPAGATE_FREQUENCY)
   PRINT_CONFIG_MSG("Calculating dt for AHRS_ICQ propagation.")
@@ -167,6 +174,9 @@ static void accel_cb(uint8_t __attribute__((unused)) sender_id,
                      uint32_t __attribute__((unused)) stamp,
                      struct Int32Vect3 *accel)
 {
+  if (ahrs_icq_use_batch) {
+    return;
+  }
 #if USE_AUTO_AHRS_FREQ || !defined(AHRS_CORRECT_FREQUENCY)
   PRINT_CONFIG_MSG("Calculating dt for AHRS int_cmpl_quat accel update.")
   static uint32_t last_stamp = 0;
@@ -187,6 +197,31 @@ static void accel_cb(uint8_t __attribute__((unused)) sender_id,
 #endif
 }
 
+/** Propagation and accel update once per batch of IMU samples,
+ * with the rates and accel integrated over the batch
+ */
+static void imu_batch_cb(uint8_t __attribute__((unused)) sender_id,
+                         uint32_t stamp, struct ImuBatchInt32 *batch)
+{
+  ahrs_icq_use_batch = true;
+  ahrs_icq_last_stamp = stamp;
+
+  struct ImuBatchDelta delta;
+  imu_batch_integrate(&delta, batch, true);
+  if (ahrs_icq.is_aligned && delta.dt > 0.f) {
+    struct FloatRates gyro_f;
+    struct FloatVect3 accel_f;
+    imu_batch_get_mean(&gyro_f, &accel_f, &delta);
+    struct Int32Rates gyro;
+    struct Int32Vect3 accel;
+    RATES_BFP_OF_REAL(gyro, gyro_f);
+    ACCELS_BFP_OF_REAL(accel, accel_f);
+    ahrs_icq_propagate(&gyro, delta.dt);
+    ahrs_icq_update_accel(&accel, delta.dt);
+    set_body_state_from_quat();
+  }
+}
+
 static void mag_cb(uint8_t __attribute__((unused)) sender_id,
                    uint32_t __attribute__((unused)) stamp,
                    struct Int32Vect3 *mag)
@@ -279,6 +314,7 @@ void ahrs_icq_register(void)
    */
   AbiBindMsgIMU_GYRO_INT32(AHRS_ICQ_IMU_ID, &gyro_ev, gyro_cb);
   AbiBindMsgIMU_ACCEL_INT32(AHRS_ICQ_IMU_ID, &accel_ev, accel_cb);
+  AbiBindMsgIMU_BATCH_INT32(AHRS_ICQ_IMU_ID, &imu_batch_ev, imu_batch_cb);
   AbiBindMsgIMU_MAG_INT32(AHRS_ICQ_MAG_ID, &mag_ev, mag_cb);
   AbiBindMsgIMU_LOWPASSED(ABI_BROADCAST, &aligner_ev, aligner_cb);
   AbiBindMsgBODY_TO_IMU_QUAT(ABI_BROADCAST, &body_to_imu_ev, body_to_imu_cb);
@@ -23,12 +23,15 @@
  * @file subsystems/datalink/datalink.c
  * Handling of messages coming from ground and other A/Cs.
  *
+ * The messages are dispatched with the dl_dispatch table, to the handlers
+ * of this file and to the ones of the modules.
  */
 
 #define DATALINK_C
 #define MODULES_DATALINK_C
 
 #include "datalink.h"
+#include "subsystems/datalink/dl_dispatch.h"
 #include "subsystems/datalink/downlink.h"
 
 #include "generated/modules.h"
@@ -53,140 +56,168 @@ bool datalink_enabled = true;
 #endif
 
 
-void dl_parse_msg(struct link_device *dev, struct transport_tx *trans, uint8_t *buf)
-{
-  uint8_t sender_id = SenderIdOfPprzMsg(buf);
-  uint8_t msg_id = IdOfPprzMsg(buf);
-
-  /* parse telemetry messages coming from other AC */
-  if (sender_id != 0) {
-    switch (msg_id) {
-      default: {
-        break;
-      }
-    }
-  } else {
 #if PPRZLINK_DEFAULT_VER == 2
-    // Check that the message is really a datalink message
-    if (pprzlink_get_msg_class_id(buf) == DL_datalink_CLASS_ID) {
+/** Reply to the sender of the message */
+#define DlReplyInit(_msg, _sender_id) { \
+    _msg.trans = trans;                 \
+    _msg.dev = dev;                     \
+    _msg.sender_id = AC_ID;             \
+    _msg.receiver_id = _sender_id;      \
+    _msg.component_id = 0;              \
+  }
 #endif
-      /* parse datalink messages coming from ground station */
-      switch (msg_id) {
-        case  DL_PING: {
+
+static void dl_ping(uint8_t sender_id __attribute__((unused)), struct link_device *dev,
+                    struct transport_tx *trans, uint8_t *buf __attribute__((unused)))
+{
 #if PPRZLINK_DEFAULT_VER == 2
-          // Reply to the sender of the message
-          struct pprzlink_msg msg;
-          msg.trans = trans;
-          msg.dev = dev;
-          msg.sender_id = AC_ID;
-          msg.receiver_id = sender_id;
-          msg.component_id = 0;
-          pprzlink_msg_send_PONG(&msg);
+  struct pprzlink_msg msg;
+  DlReplyInit(msg, sender_id);
+  pprzlink_msg_send_PONG(&msg);
 #else
-          pprz_msg_send_PONG(trans, dev, AC_ID);
+  pprz_msg_send_PONG(trans, dev, AC_ID);
 #endif
-        }
-        break;
-
-        case DL_SETTING : {
-          if (DL_SETTING_ac_id(buf) != AC_ID) { break; }
-          uint8_t i = DL_SETTING_index(buf);
-          float var = DL_SETTING_value(buf);
-          DlSetting(i, var);
+}
+
+static void dl_setting(uint8_t sender_id __attribute__((unused)), struct link_device *dev,
+                       struct transport_tx *trans, uint8_t *buf)
+{
+  if (DL_SETTING_ac_id(buf) != AC_ID) { return; }
+  uint8_t i = DL_SETTING_index(buf);
+  float var = DL_SETTING_value(buf);
+  DlSetting(i, var);
 #if PPRZLINK_DEFAULT_VER == 2
-          // Reply to the sender of the message
-          struct pprzlink_msg msg;
-          msg.trans = trans;
-          msg.dev = dev;
-          msg.sender_id = AC_ID;
-          msg.receiver_id = sender_id;
-          msg.component_id = 0;
-          pprzlink_msg_send_DL_VALUE(&msg, &i, &var);
+  struct pprzlink_msg msg;
+  DlReplyInit(msg, sender_id);
+  pprzlink_msg_send_DL_VALUE(&msg, &i, &var);
 #else
-          pprz_msg_send_DL_VALUE(trans, dev, AC_ID, &i, &var);
+  pprz_msg_send_DL_VALUE(trans, dev, AC_ID, &i, &var);
 #endif
-        }
-        break;
+}
 
-        case DL_GET_SETTING : {
-          if (DL_GET_SETTING_ac_id(buf) != AC_ID) { break; }
-          uint8_t i = DL_GET_SETTING_index(buf);
-          float val = settings_get_value(i);
+static void dl_get_setting(uint8_t sender_id __attribute__((unused)), struct link_device *dev,
+                           struct transport_tx *trans, uint8_t *buf)
+{
+  if (DL_GET_SETTING_ac_id(buf) != AC_ID) { return; }
+  uint8_t i = DL_GET_SETTING_index(buf);
+  float val = settings_get_value(i);
 #if PPRZLINK_DEFAULT_VER == 2
-          // Reply to the sender of the message
-          struct pprzlink_msg msg;
-          msg.trans = trans;
-          msg.dev = dev;
-          msg.sender_id = AC_ID;
-          msg.receiver_id = sender_id;
-          msg.component_id = 0;
-          pprzlink_msg_send_DL_VALUE(&msg, &i, &val);
+  struct pprzlink_msg msg;
+  DlReplyInit(msg, sender_id);
+  pprzlink_msg_send_DL_VALUE(&msg, &i, &val);
 #else
-          pprz_msg_send_DL_VALUE(trans, dev, AC_ID, &i, &val);
+  pprz_msg_send_DL_VALUE(trans, dev, AC_ID, &i, &val);
 #endif
-        }
-        break;
+}
 
 #ifdef RADIO_CONTROL_TYPE_DATALINK
-        case DL_RC_3CH :
+static void dl_rc_3ch(uint8_t sender_id __attribute__((unused)), struct link_device *dev __attribute__((unused)),
+                      struct transport_tx *trans __attribute__((unused)), uint8_t *buf)
+{
 #ifdef RADIO_CONTROL_DATALINK_LED
-          LED_TOGGLE(RADIO_CONTROL_DATALINK_LED);
+  LED_TOGGLE(RADIO_CONTROL_DATALINK_LED);
 #endif
-          parse_rc_3ch_datalink(
-            DL_RC_3CH_throttle_mode(buf),
-            DL_RC_3CH_roll(buf),
-            DL_RC_3CH_pitch(buf));
-          break;
-        case DL_RC_4CH :
-          if (DL_RC_4CH_ac_id(buf) == AC_ID) {
+  parse_rc_3ch_datalink(
+    DL_RC_3CH_throttle_mode(buf),
+    DL_RC_3CH_roll(buf),
+    DL_RC_3CH_pitch(buf));
+}
+
+static void dl_rc_4ch(uint8_t sender_id __attribute__((unused)), struct link_device *dev __attribute__((unused)),
+                      struct transport_tx *trans __attribute__((unused)), uint8_t *buf)
+{
+  if (DL_RC_4CH_ac_id(buf) == AC_ID) {
 #ifdef RADIO_CONTROL_DATALINK_LED
-            LED_TOGGLE(RADIO_CONTROL_DATALINK_LED);
+    LED_TOGGLE(RADIO_CONTROL_DATALINK_LED);
 #endif
-            parse_rc_4ch_datalink(DL_RC_4CH_mode(buf),
-                                  DL_RC_4CH_throttle(buf),
-                                  DL_RC_4CH_roll(buf),
-                                  DL_RC_4CH_pitch(buf),
-                                  DL_RC_4CH_yaw(buf));
-          }
-          break;
+    parse_rc_4ch_datalink(DL_RC_4CH_mode(buf),
+                          DL_RC_4CH_throttle(buf),
+                          DL_RC_4CH_roll(buf),
+                          DL_RC_4CH_pitch(buf),
+                          DL_RC_4CH_yaw(buf));
+  }
+}
 #endif // RADIO_CONTROL_TYPE_DATALINK
 
 #if USE_GPS
-        case DL_GPS_INJECT : {
-          // Check if the GPS is for this AC
-          if (DL_GPS_INJECT_ac_id(buf) != AC_ID) { break; }
-
-          // GPS parse data
-          gps_inject_data(
-            DL_GPS_INJECT_packet_id(buf),
-            DL_GPS_INJECT_data_length(buf),
-            DL_GPS_INJECT_data(buf)
-          );
-        }
-        break;
+static void dl_gps_inject(uint8_t sender_id __attribute__((unused)), struct link_device *dev __attribute__((unused)),
+                          struct transport_tx *trans __attribute__((unused)), uint8_t *buf)
+{
+  // Check if the GPS is for this AC
+  if (DL_GPS_INJECT_ac_id(buf) != AC_ID) { return; }
+
+  // GPS parse data
+  gps_inject_data(
+    DL_GPS_INJECT_packet_id(buf),
+    DL_GPS_INJECT_data_length(buf),
+    DL_GPS_INJECT_data(buf)
+  );
+}
+
 #if USE_GPS_UBX_RTCM
-        case DL_RTCM_INJECT : {
-          // GPS parse data
-          gps_inject_data(DL_RTCM_INJECT_packet_id(buf),
-                          DL_RTCM_INJECT_data_length(buf),
-                          DL_RTCM_INJECT_data(buf));
-        }
-        break;
+static void dl_rtcm_inject(uint8_t sender_id __attribute__((unused)), struct link_device *dev __attribute__((unused)),
+                           struct transport_tx *trans __attribute__((unused)), uint8_t *buf)
+{
+  // GPS parse data
+  gps_inject_data(DL_RTCM_INJECT_packet_id(buf),
+                  DL_RTCM_INJECT_data_length(buf),
+                  DL_RTCM_INJECT_data(buf));
+}
 #endif  // USE_GPS_UBX_RTCM
 #endif  // USE_GPS
 
-        default:
-          break;
-      }
-#if PPRZLINK_DEFAULT_VER == 2
-    }
+/** datalink_init can be called by several telemetry modules */
+static bool datalink_initialized = false;
+
+void datalink_init(void)
+{
+  if (datalink_initialized) {
+    return;
+  }
+  datalink_initialized = true;
+
+  /* messages handled by the datalink itself */
+  dl_dispatch_register(DL_DISPATCH_DATALINK, DL_PING, dl_ping);
+  dl_dispatch_register(DL_DISPATCH_DATALINK, DL_SETTING, dl_setting);
+  dl_dispatch_register(DL_DISPATCH_DATALINK, DL_GET_SETTING, dl_get_setting);
+#ifdef RADIO_CONTROL_TYPE_DATALINK
+  dl_dispatch_register(DL_DISPATCH_DATALINK, DL_RC_3CH, dl_rc_3ch);
+  dl_dispatch_register(DL_DISPATCH_DATALINK, DL_RC_4CH, dl_rc_4ch);
 #endif
+#if USE_GPS
+  dl_dispatch_register(DL_DISPATCH_DATALINK, DL_GPS_INJECT, dl_gps_inject);
+#if USE_GPS_UBX_RTCM
+  dl_dispatch_register(DL_DISPATCH_DATALINK, DL_RTCM_INJECT, dl_rtcm_inject);
+#endif
+#endif
+
+  /* modules datalink */
+  modules_datalink_register();
+
+  dl_dispatch_init();
+}
+
+void dl_parse_msg(struct link_device *dev, struct transport_tx *trans, uint8_t *buf)
+{
+  uint8_t sender_id = SenderIdOfPprzMsg(buf);
+  uint8_t msg_id = IdOfPprzMsg(buf);
+
+  /* datalink messages come from the ground station, telemetry messages from other AC */
+#if PPRZLINK_DEFAULT_VER == 2
+  uint8_t class_id = pprzlink_get_msg_class_id(buf);
+  if (class_id == DL_datalink_CLASS_ID) {
+    dl_dispatch_msg(DL_DISPATCH_DATALINK, sender_id, msg_id, dl_msg_len, dev, trans, buf);
+  } else if (class_id == DL_telemetry_CLASS_ID) {
+    dl_dispatch_msg(DL_DISPATCH_TELEMETRY, sender_id, msg_id, dl_msg_len, dev, trans, buf);
   }
+#else
+  dl_dispatch_msg(sender_id == 0 ? DL_DISPATCH_DATALINK : DL_DISPATCH_TELEMETRY,
+                  sender_id, msg_id, dl_msg_len, dev, trans, buf);
+#endif
+  dl_msg_len = 0;
+
   /* Parse firmware specific datalink */
   firmware_parse_msg(dev, trans, buf);
-
-  /* Parse modules datalink */
-  modules_parse_datalink(msg_id, dev, trans, buf);
 }
 
 /* default empty WEAK implementation for firmwares without an extra firmware_parse_msg */
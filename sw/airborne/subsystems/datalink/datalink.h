@@ -55,6 +55,12 @@ EXTERN uint16_t datalink_nb_msgs;
 #define MSG_SIZE 256
 EXTERN uint8_t dl_buffer[MSG_SIZE]  __attribute__((aligned));
 
+/** length of the message in dl_buffer for the statistics, 0 if unknown */
+EXTERN uint8_t dl_msg_len;
+
+/** Register the message handlers, called by the init of the telemetry modules */
+EXTERN void datalink_init(void);
+
 /** Should be called when chars are available in dl_buffer */
 EXTERN void dl_parse_msg(struct link_device *dev, struct transport_tx *trans, uint8_t *buf);
 
@@ -72,6 +78,7 @@ EXTERN bool datalink_enabled;
   for (_i = 0; _i < _len; _i++) { \
     dl_buffer[_i] = _buf[_i]; \
   } \
+  dl_msg_len = _len; \
   dl_msg_available = true; \
 }
 
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file subsystems/datalink/dl_dispatch.c
+ *
+ * Table driven dispatch of the received datalink messages.
+ */
+
+#include "subsystems/datalink/dl_dispatch.h"
+#include "mcu_periph/sys_time.h"
+#include <string.h>
+
+struct DlDispatch dl_dispatch;
+
+/** Entry of a message, added if needed, NULL if the table is full.
+ * Only used by the registration, received messages never add entries.
+ */
+static struct DlDispatchEntry *dl_dispatch_entry(uint8_t class_id, uint8_t msg_id)
+{
+  uint8_t idx = dl_dispatch.index[class_id][msg_id];
+  if (idx != 0) {
+    return &dl_dispatch.entries[idx - 1];
+  }
+  if (dl_dispatch.nb_entries >= DL_DISPATCH_NB_ENTRIES) {
+    return NULL;
+  }
+  struct DlDispatchEntry *e = &dl_dispatch.entries[dl_dispatch.nb_entries++];
+  memset(e, 0, sizeof(struct DlDispatchEntry));
+  e->class_id = class_id;
+  e->msg_id = msg_id;
+  dl_dispatch.index[class_id][msg_id] = dl_dispatch.nb_entries;
+  return e;
+}
+
+bool dl_dispatch_register(uint8_t class_id, uint8_t msg_id, dl_handler_t cb)
+{
+  struct DlDispatchEntry *e = NULL;
+  if (class_id < DL_DISPATCH_NB_CLASSES && dl_dispatch.nb_handlers < DL_DISPATCH_NB_HANDLERS) {
+    e = dl_dispatch_entry(class_id, msg_id);
+  }
+  if (e == NULL) {
+    if (dl_dispatch.nb_failed < 255) {
+      dl_dispatch.nb_failed++;
+    }
+    return false;
+  }
+  // append, handlers are called in registration order
+  struct DlDispatchHandler *h = &dl_dispatch.handlers[dl_dispatch.nb_handlers++];
+  h->cb = cb;
+  h->next = 0;
+  if (e->handler == 0) {
+    e->handler = dl_dispatch.nb_handlers;
+  } else {
+    uint8_t i = e->handler;
+    while (dl_dispatch.handlers[i - 1].next != 0) {
+      i = dl_dispatch.handlers[i - 1].next;
+    }
+    dl_dispatch.handlers[i - 1].next = dl_dispatch.nb_handlers;
+  }
+  return true;
+}
+
+void dl_dispatch_msg(uint8_t class_id, uint8_t sender_id, uint8_t msg_id, uint8_t len,
+                     struct link_device *dev, struct transport_tx *trans, uint8_t *buf)
+{
+  uint8_t idx = class_id < DL_DISPATCH_NB_CLASSES ? dl_dispatch.index[class_id][msg_id] : 0;
+  if (idx == 0) {
+    dl_dispatch.nb_unhandled++;
+    return;
+  }
+  struct DlDispatchEntry *e = &dl_dispatch.entries[idx - 1];
+  uint32_t start = get_sys_time_usec();
+  for (uint8_t i = e->handler; i != 0; i = dl_dispatch.handlers[i - 1].next) {
+    dl_dispatch.handlers[i - 1].cb(sender_id, dev, trans, buf);
+  }
+  uint32_t dt = get_sys_time_usec() - start;
+  e->nb_msgs++;
+  e->nb_bytes += len;
+  e->time_us += dt;
+  if (dt > e->max_time_us) {
+    e->max_time_us = dt;
+  }
+}
+
+void dl_dispatch_reset_stats(void)
+{
+  for (uint8_t i = 0; i < dl_dispatch.nb_entries; i++) {
+    dl_dispatch.entries[i].nb_msgs = 0;
+    dl_dispatch.entries[i].nb_bytes = 0;
+    dl_dispatch.entries[i].time_us = 0;
+    dl_dispatch.entries[i].max_time_us = 0;
+  }
+  dl_dispatch.nb_unhandled = 0;
+}
+
+#if PERIODIC_TELEMETRY
+#include "subsystems/datalink/telemetry.h"
+
+/** Statistics of the next received message type */
+static void send_dl_dispatch(struct transport_tx *trans, struct link_device *dev)
+{
+  for (uint8_t n = 0; n < dl_dispatch.nb_entries; n++) {
+    struct DlDispatchEntry *e = &dl_dispatch.entries[dl_dispatch.report_idx];
+    dl_dispatch.report_idx = (dl_dispatch.report_idx + 1) % dl_dispatch.nb_entries;
+    if (e->nb_msgs > 0) {
+      float stats[9] = { TELEMETRY_PAYLOAD_TAG_DL_DISPATCH, e->class_id, e->msg_id, e->nb_msgs, e->nb_bytes,
+                         (float)e->time_us / e->nb_msgs, e->max_time_us, dl_dispatch.nb_unhandled, dl_dispatch.nb_failed
+                       };
+      pprz_msg_send_PAYLOAD_FLOAT(trans, dev, AC_ID, 9, stats);
+      return;
+    }
+  }
+}
+#endif
+
+void dl_dispatch_init(void)
+{
+#if PERIODIC_TELEMETRY
+  register_periodic_telemetry(DefaultPeriodic, PPRZ_MSG_ID_PAYLOAD_FLOAT, send_dl_dispatch);
+#endif
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file subsystems/datalink/dl_dispatch.h
+ *
+ * Table driven dispatch of the received datalink messages.
+ *
+ * Handlers are registered for a message id of a class: datalink messages
+ * (from the ground) or telemetry messages (from other aircraft). The message
+ * is dispatched with a lookup in a (class, id) table instead of testing
+ * each id, then the handlers registered for it are called in order.
+ *
+ * The entries are only added by the registration. Each received message
+ * with handlers is counted in its entry, with its size and the time spent in
+ * its handlers. The messages without handlers are only counted together in
+ * nb_unhandled, so that they can't fill the table. The statistics are sent
+ * with the PAYLOAD_FLOAT telemetry message, one message type per call:
+ * TELEMETRY_PAYLOAD_TAG_DL_DISPATCH, class, id, count, bytes, mean and max
+ * handler time in us, unhandled messages and failed registrations.
+ *
+ * The pools are checked at compile time against the number of module
+ * handlers generated in modules.h, a registration that fails anyway is
+ * counted in nb_failed.
+ */
+
+#ifndef DL_DISPATCH_H
+#define DL_DISPATCH_H
+
+#include "std.h"
+#include "pprzlink/pprzlink_device.h"
+#include "pprzlink/pprzlink_transport.h"
+
+/** Message classes of the dispatch table */
+#define DL_DISPATCH_DATALINK 0
+#define DL_DISPATCH_TELEMETRY 1
+#define DL_DISPATCH_NB_CLASSES 2
+
+/** Maximum number of different message types in the table */
+#ifndef DL_DISPATCH_NB_ENTRIES
+#define DL_DISPATCH_NB_ENTRIES 48
+#endif
+
+/** Maximum number of registered handlers */
+#ifndef DL_DISPATCH_NB_HANDLERS
+#define DL_DISPATCH_NB_HANDLERS 64
+#endif
+
+#if DL_DISPATCH_NB_ENTRIES > 255 || DL_DISPATCH_NB_HANDLERS > 255
+#error "DL_DISPATCH_NB_ENTRIES and DL_DISPATCH_NB_HANDLERS are limited to 255"
+#endif
+
+/** Handlers registered by datalink_init besides the modules ones */
+#define DL_DISPATCH_NB_CORE_HANDLERS 7
+
+/** Message handler, buf is the message payload starting with the sender id */
+typedef void (*dl_handler_t)(uint8_t sender_id, struct link_device *dev, struct transport_tx *trans, uint8_t *buf);
+
+struct DlDispatchEntry {
+  uint8_t class_id;         ///< DL_DISPATCH_DATALINK or DL_DISPATCH_TELEMETRY
+  uint8_t msg_id;           ///< message id
+  uint8_t handler;          ///< first handler (index + 1), 0 if none
+  uint32_t nb_msgs;         ///< number of received messages
+  uint32_t nb_bytes;        ///< received bytes, when the length is known
+  uint32_t time_us;         ///< total time in the handlers
+  uint32_t max_time_us;     ///< maximum time in the handlers
+};
+
+struct DlDispatchHandler {
+  dl_handler_t cb;          ///< handler function
+  uint8_t next;             ///< next handler of the same message (index + 1), 0 if last
+};
+
+struct DlDispatch {
+  uint8_t index[DL_DISPATCH_NB_CLASSES][256];                   ///< entry of each message (index + 1), 0 if none
+  struct DlDispatchEntry entries[DL_DISPATCH_NB_ENTRIES];
+  struct DlDispatchHandler handlers[DL_DISPATCH_NB_HANDLERS];
+  uint8_t nb_entries;
+  uint8_t nb_handlers;
+  uint32_t nb_unhandled;    ///< received messages without handler
+  uint8_t nb_failed;        ///< registrations that failed because the pools are full
+  uint8_t report_idx;       ///< next entry to send in the statistics
+};
+
+extern struct DlDispatch dl_dispatch;
+
+/**
+ * Register a handler for a message.
+ * @param class_id DL_DISPATCH_DATALINK or DL_DISPATCH_TELEMETRY
+ * @param msg_id message id
+ * @param cb handler
+ * @return false if the tables are full, the failure is counted in nb_failed
+ */
+extern bool dl_dispatch_register(uint8_t class_id, uint8_t msg_id, dl_handler_t cb);
+
+/**
+ * Call the handlers of a message and update its statistics,
+ * a message without handler is only counted in nb_unhandled.
+ * @param class_id DL_DISPATCH_DATALINK or DL_DISPATCH_TELEMETRY
+ * @param len message length, 0 if unknown
+ */
+extern void dl_dispatch_msg(uint8_t class_id, uint8_t sender_id, uint8_t msg_id, uint8_t len,
+                            struct link_device *dev, struct transport_tx *trans, uint8_t *buf);
+
+/** Reset the message statistics, the handlers are kept */
+extern void dl_dispatch_reset_stats(void);
+
+/** Register the statistics telemetry, needs PERIODIC_TELEMETRY */
+extern void dl_dispatch_init(void);
+
+#endif /* DL_DISPATCH_H */
@@ -84,3 +84,70 @@ void periodic_telemetry_err_report(uint8_t _process, uint8_t _mode, uint8_t _id)
 }
 
 #endif
+
+#if USE_PERIODIC_TELEMETRY_BUDGET
+
+#include "subsystems/datalink/downlink.h"
+#include "mcu_periph/sys_time.h"
+#include "mcu_periph/uart.h"
+
+/** Device of the budgeted link */
+#ifndef TELEMETRY_BUDGET_DEVICE
+#define TELEMETRY_BUDGET_DEVICE DefaultDevice
+#endif
+
+/** Nominal rate of the budgeted link in bytes/s, default is 90% of 57600 bauds */
+#ifndef TELEMETRY_BUDGET_BYTE_RATE
+#define TELEMETRY_BUDGET_BYTE_RATE 5184.f
+#endif
+
+/** Bucket depth in bytes, about the size of the TX buffer */
+#ifndef TELEMETRY_BUDGET_BURST
+#define TELEMETRY_BUDGET_BURST UART_TX_BUFFER_SIZE
+#endif
+
+static struct TelemetryBudgetMsg telemetry_budget_msgs[TELEMETRY_PPRZ_NB_MSG];
+struct TelemetryBudget telemetry_budget;
+static uint8_t telemetry_budget_report_idx = 0;
+
+/** Achieved rates of the next periodic message, sent with PAYLOAD_FLOAT in the link_stats mode:
+ *  TELEMETRY_PAYLOAD_TAG_BUDGET, id, priority, size, rate, skipped rate, allowed byte rate, throughput, overruns
+ */
+static void send_telemetry_budget(struct transport_tx *trans, struct link_device *dev)
+{
+  for (uint8_t n = 0; n < telemetry_budget.nb_msgs; n++) {
+    uint8_t i = telemetry_budget_report_idx;
+    telemetry_budget_report_idx = (telemetry_budget_report_idx + 1) % telemetry_budget.nb_msgs;
+    struct TelemetryBudgetMsg *m = &telemetry_budget.msgs[i];
+    if (m->rate > 0.f || m->skip_rate > 0.f) {
+      float stats[9] = { TELEMETRY_PAYLOAD_TAG_BUDGET, telemetry_cbs[i].id, m->prio, m->size, m->rate, m->skip_rate,
+                         telemetry_budget.byte_rate, telemetry_budget.throughput, telemetry_budget.nb_ovrn
+                       };
+      pprz_msg_send_PAYLOAD_FLOAT(trans, dev, AC_ID, 9, stats);
+      return;
+    }
+  }
+}
+
+bool periodic_telemetry_budget_check(struct link_device *_dev, uint8_t _idx, uint8_t _prio)
+{
+  if (_dev != &(TELEMETRY_BUDGET_DEVICE).device) {
+    return true;
+  }
+  if (telemetry_budget.msgs == NULL) {
+    telemetry_budget_init(&telemetry_budget, telemetry_budget_msgs, TELEMETRY_PPRZ_NB_MSG,
+                          TELEMETRY_BUDGET_BYTE_RATE, TELEMETRY_BUDGET_BURST);
+    register_periodic_telemetry(&pprz_telemetry, PPRZ_MSG_ID_PAYLOAD_FLOAT, send_telemetry_budget);
+  }
+  telemetry_budget_update(&telemetry_budget, get_sys_time_float(), _dev->nb_bytes, _dev->nb_ovrn);
+  return telemetry_budget_check(&telemetry_budget, _idx, _prio, _dev->nb_bytes);
+}
+
+void periodic_telemetry_budget_sent(struct link_device *_dev, uint8_t _idx)
+{
+  if (_dev == &(TELEMETRY_BUDGET_DEVICE).device) {
+    telemetry_budget_sent(&telemetry_budget, _idx, _dev->nb_bytes);
+  }
+}
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file subsystems/datalink/telemetry_budget.c
+ *
+ * Bandwidth budget of the periodic telemetry.
+ */
+
+#include "subsystems/datalink/telemetry_budget.h"
+#include <string.h>
+
+/** Part of the bucket kept free for the higher priorities */
+static const float telemetry_budget_reserve[TELEMETRY_PRIO_NB] = { 0.f, 0.f, 0.25f, 0.5f };
+
+void telemetry_budget_init(struct TelemetryBudget *b, struct TelemetryBudgetMsg *msgs, uint8_t nb_msgs,
+                           float nominal_rate, float burst)
+{
+  memset(b, 0, sizeof(struct TelemetryBudget));
+  memset(msgs, 0, nb_msgs * sizeof(struct TelemetryBudgetMsg));
+  b->msgs = msgs;
+  b->nb_msgs = nb_msgs;
+  b->nominal_rate = nominal_rate;
+  b->byte_rate = nominal_rate;
+  b->burst = burst;
+  b->tokens = burst;
+}
+
+/** End of a measurement window */
+static void telemetry_budget_window(struct TelemetryBudget *b, float dt, uint32_t nb_bytes)
+{
+  b->throughput = (float)(nb_bytes - b->window_bytes) / dt;
+  b->nb_ovrn = b->window_ovrn;
+  for (uint8_t i = 0; i < b->nb_msgs; i++) {
+    struct TelemetryBudgetMsg *m = &b->msgs[i];
+    m->rate = (float)m->nb_sent / dt;
+    m->skip_rate = (float)m->nb_skipped / dt;
+    m->nb_sent = 0;
+    m->nb_skipped = 0;
+  }
+  if (b->window_ovrn == 0) {
+    b->byte_rate += TELEMETRY_BUDGET_INCREASE * b->nominal_rate;
+    if (b->byte_rate > b->nominal_rate) {
+      b->byte_rate = b->nominal_rate;
+    }
+  }
+  b->window_bytes = nb_bytes;
+  b->window_ovrn = 0;
+}
+
+void telemetry_budget_update(struct TelemetryBudget *b, float now, uint32_t nb_bytes, uint8_t nb_ovrn)
+{
+  if (!b->initialized || nb_bytes < b->last_bytes) {
+    // first call or device counters reset
+    b->last_time = now;
+    b->last_bytes = nb_bytes;
+    b->last_ovrn = nb_ovrn;
+    b->window_start = now;
+    b->window_bytes = nb_bytes;
+    b->initialized = true;
+    return;
+  }
+
+  float dt = now - b->last_time;
+  if (dt > 0.f) {
+    b->tokens += b->byte_rate * dt;
+    b->last_time = now;
+  }
+  // every byte sent on the device uses the budget
+  b->tokens -= (float)(nb_bytes - b->last_bytes);
+  if (b->tokens > b->burst) {
+    b->tokens = b->burst;
+  }
+  b->last_bytes = nb_bytes;
+
+  uint8_t ovrn = nb_ovrn - b->last_ovrn;
+  if (ovrn > 0) {
+    // TX buffer full: the link is slower than expected, and the buffer must drain
+    b->byte_rate *= TELEMETRY_BUDGET_DECREASE;
+    if (b->byte_rate < 0.1f * b->nominal_rate) {
+      b->byte_rate = 0.1f * b->nominal_rate;
+    }
+    if (b->tokens > 0.f) {
+      b->tokens = 0.f;
+    }
+    b->window_ovrn += ovrn;
+    b->last_ovrn = nb_ovrn;
+  }
+
+  float w = now - b->window_start;
+  if (w >= TELEMETRY_BUDGET_WINDOW) {
+    telemetry_budget_window(b, w, nb_bytes);
+    b->window_start = now;
+  }
+}
+
+bool telemetry_budget_check(struct TelemetryBudget *b, uint8_t idx, uint8_t prio, uint32_t nb_bytes)
+{
+  if (idx >= b->nb_msgs) {
+    return true;
+  }
+  struct TelemetryBudgetMsg *m = &b->msgs[idx];
+  m->prio = prio;
+  if (prio != TELEMETRY_PRIO_CRITICAL && m->size > 0) {
+    float need = m->size + telemetry_budget_reserve[prio < TELEMETRY_PRIO_NB ? prio : TELEMETRY_PRIO_LOW] * b->burst;
+    if (need > b->burst) {
+      need = b->burst;
+    }
+    if (b->tokens < need) {
+      m->nb_skipped++;
+      return false;
+    }
+  }
+  b->msg_bytes = nb_bytes;
+  return true;
+}
+
+void telemetry_budget_sent(struct TelemetryBudget *b, uint8_t idx, uint32_t nb_bytes)
+{
+  if (idx >= b->nb_msgs) {
+    return;
+  }
+  if (nb_bytes < b->msg_bytes || nb_bytes < b->last_bytes) {
+    // device counters reset
+    return;
+  }
+  struct TelemetryBudgetMsg *m = &b->msgs[idx];
+  uint32_t size = nb_bytes - b->msg_bytes;
+  if (size > 0) {
+    // not measured if the message was dropped by the device
+    m->size = size > UINT16_MAX ? UINT16_MAX : size;
+    m->nb_sent++;
+  }
+  // consume the message now, before the next check of this round
+  b->tokens -= (float)(nb_bytes - b->last_bytes);
+  b->last_bytes = nb_bytes;
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file subsystems/datalink/telemetry_budget.h
+ *
+ * Bandwidth budget of the periodic telemetry.
+ *
+ * The link is modeled as a token bucket: it is filled at the allowed byte
+ * rate and emptied by every byte sent on the device, periodic or not.
+ * A periodic message is only sent if enough bytes are left for it, on top of
+ * a reserve that depends on its priority, so the low priority messages are
+ * thinned first and the critical ones are always sent.
+ *
+ * The allowed rate adapts to the link (AIMD): it is decreased each time the
+ * device reports an overrun (TX buffer full) and increased again slowly,
+ * up to the nominal link rate, while there is none.
+ *
+ * The size of each message is learned from the device byte counter and the
+ * achieved rates are measured on a sliding window.
+ */
+
+#ifndef TELEMETRY_BUDGET_H
+#define TELEMETRY_BUDGET_H
+
+#include "std.h"
+
+/** Priorities of the periodic messages, from the telemetry xml file */
+#define TELEMETRY_PRIO_CRITICAL 0   ///< always sent
+#define TELEMETRY_PRIO_HIGH     1
+#define TELEMETRY_PRIO_NORMAL   2   ///< default
+#define TELEMETRY_PRIO_LOW      3
+#define TELEMETRY_PRIO_NB       4
+
+/** Rate measurement window in seconds */
+#ifndef TELEMETRY_BUDGET_WINDOW
+#define TELEMETRY_BUDGET_WINDOW 1.f
+#endif
+
+/** Factor applied to the allowed rate on overrun */
+#ifndef TELEMETRY_BUDGET_DECREASE
+#define TELEMETRY_BUDGET_DECREASE 0.75f
+#endif
+
+/** Increase of the allowed rate after a window without overrun, ratio of the nominal rate */
+#ifndef TELEMETRY_BUDGET_INCREASE
+#define TELEMETRY_BUDGET_INCREASE 0.05f
+#endif
+
+/** Budget state of a periodic message */
+struct TelemetryBudgetMsg {
+  uint16_t size;        ///< last measured size in bytes, 0 if unknown
+  uint8_t prio;         ///< priority of the last request
+  uint16_t nb_sent;     ///< messages sent in the current window
+  uint16_t nb_skipped;  ///< messages skipped in the current window
+  float rate;           ///< achieved rate in Hz over the last window
+  float skip_rate;      ///< thinned rate in Hz over the last window
+};
+
+struct TelemetryBudget {
+  struct TelemetryBudgetMsg *msgs;  ///< messages, indexed as the periodic telemetry
+  uint8_t nb_msgs;                  ///< number of messages
+  float nominal_rate;               ///< nominal link rate in bytes/s
+  float byte_rate;                  ///< allowed rate in bytes/s
+  float burst;                      ///< bucket depth in bytes
+  float tokens;                     ///< bytes available, can be negative
+  float throughput;                 ///< measured link throughput in bytes/s
+  uint16_t nb_ovrn;                 ///< overruns over the last window
+  /* device counters and times of the last update */
+  float last_time;
+  uint32_t last_bytes;
+  uint8_t last_ovrn;
+  float window_start;
+  uint32_t window_bytes;
+  uint16_t window_ovrn;
+  uint32_t msg_bytes;               ///< byte counter before the current message
+  bool initialized;
+};
+
+/**
+ * Initialize a budget.
+ * @param b budget
+ * @param msgs message states
+ * @param nb_msgs number of messages
+ * @param nominal_rate nominal link rate in bytes/s
+ * @param burst bucket depth in bytes, about the TX buffer size
+ */
+extern void telemetry_budget_init(struct TelemetryBudget *b, struct TelemetryBudgetMsg *msgs, uint8_t nb_msgs,
+                                  float nominal_rate, float burst);
+
+/**
+ * Update the budget from the device counters.
+ * @param now time in seconds
+ * @param nb_bytes number of bytes sent by the device
+ * @param nb_ovrn number of overruns of the device
+ */
+extern void telemetry_budget_update(struct TelemetryBudget *b, float now, uint32_t nb_bytes, uint8_t nb_ovrn);
+
+/**
+ * Check if a periodic message can be sent now.
+ * @param idx message index
+ * @param prio message priority
+ * @param nb_bytes number of bytes sent by the device, to measure the message
+ * @return true if the message can be sent
+ */
+extern bool telemetry_budget_check(struct TelemetryBudget *b, uint8_t idx, uint8_t prio, uint32_t nb_bytes);
+
+/**
+ * Account a sent periodic message.
+ * @param idx message index
+ * @param nb_bytes number of bytes sent by the device, after the message
+ */
+extern void telemetry_budget_sent(struct TelemetryBudget *b, uint8_t idx, uint32_t nb_bytes);
+
+#endif /* TELEMETRY_BUDGET_H */
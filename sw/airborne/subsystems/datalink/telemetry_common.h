@@ -38,6 +38,7 @@ extern "C" {
 #include "pprzlink/pprzlink_device.h"
 #include "pprzlink/pprzlink_transport.h"
 #include "pprzlink/messages.h"
+#include "subsystems/datalink/telemetry_budget.h"
 
 /** Telemetry callback definition
  */
@@ -47,6 +48,10 @@ typedef void (*telemetry_cb)(struct transport_tx *trans, struct link_device *dev
  */
 typedef const char telemetry_msg[64];
 
+/** First element of the reports sent with PAYLOAD_FLOAT, to tell them apart */
+#define TELEMETRY_PAYLOAD_TAG_DL_DISPATCH 1
+#define TELEMETRY_PAYLOAD_TAG_BUDGET 2
+
 /** number of callbacks that can be registered per msg */
 #define TELEMETRY_NB_CBS 4
 
@@ -87,6 +92,26 @@ static inline int8_t register_periodic_telemetry(struct periodic_telemetry *_pt
 extern void periodic_telemetry_err_report(uint8_t _process, uint8_t _mode, uint8_t _id);
 #endif
 
+#if USE_PERIODIC_TELEMETRY_BUDGET
+/** Bandwidth budget of the periodic telemetry on TELEMETRY_BUDGET_DEVICE */
+extern struct TelemetryBudget telemetry_budget;
+
+/** Check if a periodic message can be sent on a device
+ * Messages sent on other devices than TELEMETRY_BUDGET_DEVICE are not limited.
+ * @param _dev device
+ * @param _idx index of the message in telemetry system
+ * @param _prio priority of the message (TELEMETRY_PRIO_x)
+ * @return true if the message can be sent
+ */
+extern bool periodic_telemetry_budget_check(struct link_device *_dev, uint8_t _idx, uint8_t _prio);
+
+/** Account a periodic message sent after periodic_telemetry_budget_check
+ * @param _dev device
+ * @param _idx index of the message in telemetry system
+ */
+extern void periodic_telemetry_budget_sent(struct link_device *_dev, uint8_t _idx);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
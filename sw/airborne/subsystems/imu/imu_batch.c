@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file subsystems/imu/imu_batch.c
+ *
+ * Integration of batches of IMU samples.
+ */
+
+#include "subsystems/imu/imu_batch.h"
+
+void imu_batch_integrate(struct ImuBatchDelta *delta, struct ImuBatchInt32 *batch, bool coning_sculling)
+{
+  struct FloatVect3 alpha = { 0.f, 0.f, 0.f };   // accumulated delta angle
+  struct FloatVect3 v = { 0.f, 0.f, 0.f };       // accumulated delta velocity
+  struct FloatVect3 beta = { 0.f, 0.f, 0.f };    // coning correction
+  struct FloatVect3 scul = { 0.f, 0.f, 0.f };    // sculling correction
+  struct FloatVect3 last_da = { 0.f, 0.f, 0.f };
+  struct FloatVect3 last_dv = { 0.f, 0.f, 0.f };
+  struct FloatVect3 tmp, a6, v6;
+  float t = 0.f;
+
+  for (uint8_t i = 0; i < batch->nb; i++) {
+    uint32_t dt_us = (i == 0) ? batch->period : batch->stamp[i] - batch->stamp[i - 1];
+    float dt = (float)dt_us * 1e-6f;
+    struct FloatRates gyro;
+    struct FloatVect3 accel, da, dv;
+    RATES_FLOAT_OF_BFP(gyro, batch->gyro[i]);
+    ACCELS_FLOAT_OF_BFP(accel, batch->accel[i]);
+    VECT3_ASSIGN(da, gyro.p * dt, gyro.q * dt, gyro.r * dt);
+    VECT3_SMUL(dv, accel, dt);
+
+    if (coning_sculling) {
+      // alpha + last_da / 6 and v + last_dv / 6
+      VECT3_SUM_SCALED(a6, alpha, last_da, 1.f / 6.f);
+      VECT3_SUM_SCALED(v6, v, last_dv, 1.f / 6.f);
+      // beta += 1/2 (alpha + last_da / 6) x da
+      VECT3_CROSS_PRODUCT(tmp, a6, da);
+      VECT3_ADD_SCALED(beta, tmp, 0.5f);
+      // scul += 1/2 ((alpha + last_da / 6) x dv + (v + last_dv / 6) x da)
+      VECT3_CROSS_PRODUCT(tmp, a6, dv);
+      VECT3_ADD_SCALED(scul, tmp, 0.5f);
+      VECT3_CROSS_PRODUCT(tmp, v6, da);
+      VECT3_ADD_SCALED(scul, tmp, 0.5f);
+    }
+    VECT3_ADD(alpha, da);
+    VECT3_ADD(v, dv);
+    VECT3_COPY(last_da, da);
+    VECT3_COPY(last_dv, dv);
+    t += dt;
+  }
+
+  VECT3_SUM(delta->angle, alpha, beta);
+  // velocity increment in the start frame: v + 1/2 alpha x v + sculling
+  struct FloatVect3 dv_start = v;
+  if (coning_sculling) {
+    VECT3_CROSS_PRODUCT(tmp, alpha, v);
+    VECT3_ADD_SCALED(dv_start, tmp, 0.5f);
+    VECT3_ADD(dv_start, scul);
+  }
+  // first order rotation to the end frame
+  VECT3_CROSS_PRODUCT(tmp, delta->angle, dv_start);
+  VECT3_DIFF(delta->vel, dv_start, tmp);
+  delta->dt = t;
+}
+
+void imu_batch_get_mean(struct FloatRates *rates, struct FloatVect3 *accel, struct ImuBatchDelta *delta)
+{
+  if (delta->dt > 0.f) {
+    const float inv_dt = 1.f / delta->dt;
+    RATES_ASSIGN(*rates, delta->angle.x * inv_dt, delta->angle.y * inv_dt, delta->angle.z * inv_dt);
+    VECT3_SMUL(*accel, delta->vel, inv_dt);
+  } else {
+    FLOAT_RATES_ZERO(*rates);
+    FLOAT_VECT3_ZERO(*accel);
+  }
+}
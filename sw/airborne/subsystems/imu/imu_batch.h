@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file subsystems/imu/imu_batch.h
+ *
+ * Batches of timestamped IMU samples, as read from a sensor FIFO.
+ *
+ * A batch is published at once with the IMU_BATCH_INT32 ABI message, so
+ * that the sensor can sample at several kHz with one bus transaction and
+ * one filter propagation per control cycle.
+ * The samples of a batch are integrated into a delta angle with coning
+ * correction and a delta velocity with rotation and sculling corrections
+ * (second order algorithms from Savage, "Strapdown Inertial Navigation
+ * Integration Algorithm Design").
+ */
+
+#ifndef IMU_BATCH_H
+#define IMU_BATCH_H
+
+#include "std.h"
+#include "math/pprz_algebra_int.h"
+#include "math/pprz_algebra_float.h"
+
+/// Maximum number of samples in a batch
+#ifndef IMU_BATCH_MAX_SAMPLES
+#define IMU_BATCH_MAX_SAMPLES 20
+#endif
+
+/** Scaled gyro and accel samples, oldest first
+ */
+struct ImuBatchInt32 {
+  uint8_t nb;                                     ///< number of samples
+  uint32_t period;                                ///< nominal sample period in usec
+  uint32_t stamp[IMU_BATCH_MAX_SAMPLES];          ///< sample timestamps in usec
+  struct Int32Rates gyro[IMU_BATCH_MAX_SAMPLES];  ///< gyro samples in BFP with #INT32_RATE_FRAC
+  struct Int32Vect3 accel[IMU_BATCH_MAX_SAMPLES]; ///< accel samples in BFP with #INT32_ACCEL_FRAC
+};
+
+/** Integrated batch
+ */
+struct ImuBatchDelta {
+  struct FloatVect3 angle;  ///< rotation vector from the body frame at the start of the batch to the one at the end, in rad
+  struct FloatVect3 vel;    ///< velocity increment from the specific force, in the body frame at the end of the batch, in m/s
+  float dt;                 ///< integration time in s
+};
+
+static inline void imu_batch_reset(struct ImuBatchInt32 *batch, uint32_t period)
+{
+  batch->nb = 0;
+  batch->period = period;
+}
+
+/** Add a sample to the batch
+ * @return false if the batch is full
+ */
+static inline bool imu_batch_add(struct ImuBatchInt32 *batch, uint32_t stamp,
+                                 struct Int32Rates *gyro, struct Int32Vect3 *accel)
+{
+  if (batch->nb >= IMU_BATCH_MAX_SAMPLES) {
+    return false;
+  }
+  batch->stamp[batch->nb] = stamp;
+  RATES_COPY(batch->gyro[batch->nb], *gyro);
+  VECT3_COPY(batch->accel[batch->nb], *accel);
+  batch->nb++;
+  return true;
+}
+
+/**
+ * Integrate the samples of a batch.
+ * Each sample is the mean over the interval since the previous one, the
+ * first interval is the nominal sample period.
+ * @param delta integrated delta angle and delta velocity
+ * @param batch samples
+ * @param coning_sculling apply the coning and sculling corrections
+ */
+extern void imu_batch_integrate(struct ImuBatchDelta *delta, struct ImuBatchInt32 *batch, bool coning_sculling);
+
+/**
+ * Equivalent constant rates and specific force over the integrated batch,
+ * for filters propagated with rates and accel over a time step.
+ * @param rates rotation vector divided by the integration time
+ * @param accel velocity increment divided by the integration time
+ * @param delta integrated batch
+ */
+extern void imu_batch_get_mean(struct FloatRates *rates, struct FloatVect3 *accel, struct ImuBatchDelta *delta);
+
+#endif /* IMU_BATCH_H */
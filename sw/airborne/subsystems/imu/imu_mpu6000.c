@@ -74,6 +74,16 @@ PRINT_CONFIG_VAR(IMU_MPU_SMPLRT_DIV)
 PRINT_CONFIG_VAR(IMU_MPU_GYRO_RANGE)
 PRINT_CONFIG_VAR(IMU_MPU_ACCEL_RANGE)
 
+/** Read all the samples from the MPU FIFO once per periodic call
+ * and publish them in an IMU_BATCH_INT32 message, so the MPU can sample
+ * faster than PERIODIC_FREQUENCY with two bus transactions per cycle
+ * (FIFO count, then the samples) instead of one per sample.
+ */
+#ifndef IMU_MPU_FIFO
+#define IMU_MPU_FIFO FALSE
+#endif
+PRINT_CONFIG_VAR(IMU_MPU_FIFO)
+
 // Default channels order
 #ifndef IMU_MPU_CHAN_X
 #define IMU_MPU_CHAN_X 0
@@ -114,6 +124,13 @@ void imu_mpu_spi_init(void)
   imu_mpu_spi.mpu.config.dlpf_cfg_acc = IMU_MPU_ACCEL_LOWPASS_FILTER; // only for ICM sensors
   imu_mpu_spi.mpu.config.gyro_range = IMU_MPU_GYRO_RANGE;
   imu_mpu_spi.mpu.config.accel_range = IMU_MPU_ACCEL_RANGE;
+#if IMU_MPU_FIFO
+  // the samples that don't fit in a batch stay in the FIFO for the next cycle
+  float rate = mpu60x0_get_sample_rate(&imu_mpu_spi.mpu.config);
+  imu_mpu_spi.mpu.config.fifo_enabled = true;
+  imu_mpu_spi.mpu.config.fifo_read_samples = Min(MPU60X0_FIFO_MAX_SAMPLES, IMU_BATCH_MAX_SAMPLES);
+  imu_batch_reset(&imu_mpu_spi.batch, (uint32_t)(1e6f / rate));
+#endif
 }
 
 
@@ -122,32 +139,55 @@ void imu_mpu_spi_periodic(void)
   mpu60x0_spi_periodic(&imu_mpu_spi.mpu);
 }
 
+static void imu_mpu_spi_set_unscaled(struct Int16Rates *gyro, struct Int16Vect3 *accel)
+{
+  int16_t *gyro_values = (int16_t *)gyro;
+  int16_t *accel_values = (int16_t *)accel;
+
+  // set channel order
+  struct Int32Vect3 accel_unscaled = {
+    IMU_MPU_X_SIGN * (int32_t)(accel_values[IMU_MPU_CHAN_X]),
+    IMU_MPU_Y_SIGN * (int32_t)(accel_values[IMU_MPU_CHAN_Y]),
+    IMU_MPU_Z_SIGN * (int32_t)(accel_values[IMU_MPU_CHAN_Z])
+  };
+  struct Int32Rates rates_unscaled = {
+    IMU_MPU_X_SIGN * (int32_t)(gyro_values[IMU_MPU_CHAN_X]),
+    IMU_MPU_Y_SIGN * (int32_t)(gyro_values[IMU_MPU_CHAN_Y]),
+    IMU_MPU_Z_SIGN * (int32_t)(gyro_values[IMU_MPU_CHAN_Z])
+  };
+  // unscaled vector
+  VECT3_COPY(imu.accel_unscaled, accel_unscaled);
+  RATES_COPY(imu.gyro_unscaled, rates_unscaled);
+}
+
 void imu_mpu_spi_event(void)
 {
   mpu60x0_spi_event(&imu_mpu_spi.mpu);
   if (imu_mpu_spi.mpu.data_available) {
     uint32_t now_ts = get_sys_time_usec();
 
-    // set channel order
-    struct Int32Vect3 accel = {
-      IMU_MPU_X_SIGN * (int32_t)(imu_mpu_spi.mpu.data_accel.value[IMU_MPU_CHAN_X]),
-      IMU_MPU_Y_SIGN * (int32_t)(imu_mpu_spi.mpu.data_accel.value[IMU_MPU_CHAN_Y]),
-      IMU_MPU_Z_SIGN * (int32_t)(imu_mpu_spi.mpu.data_accel.value[IMU_MPU_CHAN_Z])
-    };
-    struct Int32Rates rates = {
-      IMU_MPU_X_SIGN * (int32_t)(imu_mpu_spi.mpu.data_rates.value[IMU_MPU_CHAN_X]),
-      IMU_MPU_Y_SIGN * (int32_t)(imu_mpu_spi.mpu.data_rates.value[IMU_MPU_CHAN_Y]),
-      IMU_MPU_Z_SIGN * (int32_t)(imu_mpu_spi.mpu.data_rates.value[IMU_MPU_CHAN_Z])
-    };
-    // unscaled vector
-    VECT3_COPY(imu.accel_unscaled, accel);
-    RATES_COPY(imu.gyro_unscaled, rates);
+#if IMU_MPU_FIFO
+    // the last sample of the FIFO has just been acquired
+    struct Mpu60x0Fifo *fifo = &imu_mpu_spi.mpu.fifo;
+    imu_batch_reset(&imu_mpu_spi.batch, imu_mpu_spi.batch.period);
+    for (uint8_t i = 0; i < fifo->nb; i++) {
+      imu_mpu_spi_set_unscaled(&fifo->gyro[i], &fifo->accel[i]);
+      imu_scale_gyro(&imu);
+      imu_scale_accel(&imu);
+      uint32_t stamp = now_ts - (fifo->nb - 1 - i) * imu_mpu_spi.batch.period;
+      imu_batch_add(&imu_mpu_spi.batch, stamp, &imu.gyro, &imu.accel);
+    }
+    imu_mpu_spi.mpu.data_available = false;
 
+    AbiSendMsgIMU_BATCH_INT32(IMU_MPU6000_ID, now_ts, &imu_mpu_spi.batch);
+#else
+    imu_mpu_spi_set_unscaled(&imu_mpu_spi.mpu.data_rates.rates, &imu_mpu_spi.mpu.data_accel.vect);
     imu_mpu_spi.mpu.data_available = false;
 
     // Scale the gyro and accelerometer
     imu_scale_gyro(&imu);
     imu_scale_accel(&imu);
+#endif
 
     // Send the scaled values over ABI
     AbiSendMsgIMU_GYRO_INT32(IMU_MPU6000_ID, now_ts, &imu.gyro);
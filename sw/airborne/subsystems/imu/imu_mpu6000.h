@@ -32,6 +32,7 @@
 #include "subsystems/imu.h"
 
 #include "peripherals/mpu60x0_spi.h"
+#include "subsystems/imu/imu_batch.h"
 
 #ifndef IMU_MPU_GYRO_RANGE
 #define IMU_MPU_GYRO_RANGE MPU60X0_GYRO_RANGE_2000
@@ -70,6 +71,7 @@
 
 struct ImuMpu6000 {
   struct Mpu60x0_Spi mpu;
+  struct ImuBatchInt32 batch;   ///< samples of the last FIFO read, if IMU_MPU_FIFO
 };
 
 extern struct ImuMpu6000 imu_mpu_spi;
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file subsystems/ins/delayed_fusion.c
+ *
+ * Fusion of delayed measurements with a state history and re-propagation.
+ */
+
+#include "subsystems/ins/delayed_fusion.h"
+#include <string.h>
+
+#define DF_STATE(_df, _i) ((_df)->states + (uint32_t)(_i) * (_df)->state_size)
+#define DF_INPUT(_df, _i) ((_df)->inputs + (uint32_t)(_i) * (_df)->input_size)
+
+/** index of the entry before _i in the ring */
+static inline uint16_t df_prev(struct DelayedFusion *df, uint16_t i)
+{
+  return (i == 0) ? df->size - 1 : i - 1;
+}
+
+static inline uint16_t df_next(struct DelayedFusion *df, uint16_t i)
+{
+  return (i + 1 == df->size) ? 0 : i + 1;
+}
+
+void delayed_fusion_init(struct DelayedFusion *df, void *states, void *inputs, uint32_t *stamps,
+                         uint16_t size, uint16_t state_size, uint16_t input_size,
+                         delayed_fusion_step_t step)
+{
+  df->states = (uint8_t *)states;
+  df->inputs = (uint8_t *)inputs;
+  df->stamps = stamps;
+  df->size = size;
+  df->state_size = state_size;
+  df->input_size = input_size;
+  df->step = step;
+  df->nb_fused = 0;
+  df->nb_missed = 0;
+  delayed_fusion_reset(df);
+}
+
+void delayed_fusion_reset(struct DelayedFusion *df)
+{
+  df->head = 0;
+  df->nb = 0;
+  df->rewind_idx = df->size;
+}
+
+void delayed_fusion_push(struct DelayedFusion *df, uint32_t stamp, const void *state, const void *input)
+{
+  memcpy(DF_STATE(df, df->head), state, df->state_size);
+  memcpy(DF_INPUT(df, df->head), input, df->input_size);
+  df->stamps[df->head] = stamp;
+  df->head = df_next(df, df->head);
+  if (df->nb < df->size) {
+    df->nb++;
+  }
+}
+
+void *delayed_fusion_last_input(struct DelayedFusion *df)
+{
+  if (df->nb == 0) {
+    return NULL;
+  }
+  return DF_INPUT(df, df_prev(df, df->head));
+}
+
+bool delayed_fusion_rewind(struct DelayedFusion *df, uint32_t stamp, uint32_t tolerance, void *state)
+{
+  // search backwards from the newest state, the time difference decreases
+  // until the closest state is passed
+  uint16_t idx = df_prev(df, df->head);
+  uint16_t best = df->size;
+  uint32_t best_diff = UINT32_MAX;
+  for (uint16_t n = 0; n < df->nb; n++) {
+    int32_t d = (int32_t)(stamp - df->stamps[idx]);
+    uint32_t diff = (d < 0) ? (uint32_t)(-d) : (uint32_t)d;
+    if (diff > best_diff) {
+      break;
+    }
+    best_diff = diff;
+    best = idx;
+    if (d >= 0) {
+      // older states are further away
+      break;
+    }
+    idx = df_prev(df, idx);
+  }
+
+  if (best == df->size || best_diff > tolerance) {
+    df->nb_missed++;
+    return false;
+  }
+  memcpy(state, DF_STATE(df, best), df->state_size);
+  df->rewind_idx = best;
+  df->nb_fused++;
+  return true;
+}
+
+uint16_t delayed_fusion_replay(struct DelayedFusion *df, void *state)
+{
+  uint16_t nb_steps = 0;
+  if (df->rewind_idx == df->size) {
+    return 0;
+  }
+  for (uint16_t i = df->rewind_idx; nb_steps == 0 || i != df->head; i = df_next(df, i)) {
+    memcpy(DF_STATE(df, i), state, df->state_size);
+    df->step(state, DF_INPUT(df, i));
+    nb_steps++;
+  }
+  df->rewind_idx = df->size;
+  return nb_steps;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file subsystems/ins/delayed_fusion.h
+ *
+ * Fusion of delayed measurements with a state history and re-propagation.
+ *
+ * This is a generic version of the rollback ringbuffer of hf_float.
+ * Before each propagation step, the INS pushes a copy of its state (including
+ * the covariance) with the step input and the timestamp of the state.
+ * When a delayed measurement arrives, the stored state closest to the
+ * measurement time is restored, the measurement is fused as usual, then the
+ * stored steps are replayed up to the current time:
+ * @code
+ * if (delayed_fusion_rewind(&df, meas_stamp, tolerance, &filter)) {
+ *   filter_update(&filter, meas);
+ *   delayed_fusion_replay(&df, &filter);
+ * }
+ * @endcode
+ *
+ * The input of a step must hold everything needed to replay it. Measurements
+ * fused in real time after a propagation step are attached to the input of
+ * this step with delayed_fusion_last_input() and applied again by the step
+ * callback, otherwise they are lost when the history is replayed.
+ *
+ * The memory is reserved at compile time:
+ * @code
+ * DELAYED_FUSION_DECLARE(filter_hist, struct Filter, struct FilterStep, 64);
+ * struct DelayedFusion df;
+ * DELAYED_FUSION_INIT(&df, filter_hist, filter_step);
+ * @endcode
+ */
+
+#ifndef DELAYED_FUSION_H
+#define DELAYED_FUSION_H
+
+#include "std.h"
+
+/**
+ * Replay one step of the filter.
+ * @param state filter state, as passed to delayed_fusion_replay()
+ * @param input step input, as pushed with delayed_fusion_push()
+ */
+typedef void (*delayed_fusion_step_t)(void *state, const void *input);
+
+struct DelayedFusion {
+  uint8_t *states;              ///< state history, size entries of state_size bytes
+  uint8_t *inputs;              ///< step inputs, size entries of input_size bytes
+  uint32_t *stamps;             ///< timestamps of the stored states in usec
+  uint16_t size;                ///< number of entries
+  uint16_t state_size;          ///< size of a state in bytes
+  uint16_t input_size;          ///< size of a step input in bytes
+  uint16_t head;                ///< index of the next entry to write
+  uint16_t nb;                  ///< number of stored entries
+  uint16_t rewind_idx;          ///< index of the restored state, size if none
+  delayed_fusion_step_t step;   ///< step replay callback
+  uint32_t nb_fused;            ///< number of delayed measurements matched in the history
+  uint32_t nb_missed;           ///< number of delayed measurements without matching state
+};
+
+/** Reserve the history of a filter, the storage is static */
+#define DELAYED_FUSION_DECLARE(_name, _state_type, _input_type, _size) \
+  static _state_type _name##_states[_size];                            \
+  static _input_type _name##_inputs[_size];                            \
+  static uint32_t _name##_stamps[_size]
+
+/** Init a DelayedFusion with a history reserved by DELAYED_FUSION_DECLARE */
+#define DELAYED_FUSION_INIT(_df, _name, _step)                       \
+  delayed_fusion_init(_df, _name##_states, _name##_inputs, _name##_stamps, \
+                      sizeof(_name##_stamps) / sizeof(uint32_t),     \
+                      sizeof(_name##_states[0]), sizeof(_name##_inputs[0]), _step)
+
+extern void delayed_fusion_init(struct DelayedFusion *df, void *states, void *inputs, uint32_t *stamps,
+                                uint16_t size, uint16_t state_size, uint16_t input_size,
+                                delayed_fusion_step_t step);
+
+/** Clear the history, e.g. when the filter is realigned */
+extern void delayed_fusion_reset(struct DelayedFusion *df);
+
+/**
+ * Store the state before a propagation step, overwrites the oldest entry
+ * when the history is full.
+ * @param stamp time of the state in usec
+ * @param state filter state before the step
+ * @param input step input
+ */
+extern void delayed_fusion_push(struct DelayedFusion *df, uint32_t stamp, const void *state, const void *input);
+
+/**
+ * Input of the last pushed step, to attach the measurements fused after it.
+ * @return pointer to the stored input or NULL if the history is empty
+ */
+extern void *delayed_fusion_last_input(struct DelayedFusion *df);
+
+/**
+ * Restore the stored state closest to a measurement time.
+ * Must be followed by delayed_fusion_replay() when it succeeds.
+ * @param stamp measurement time in usec
+ * @param tolerance maximum time difference to the restored state in usec
+ * @param state filter state, overwritten with the stored one
+ * @return false if no stored state is close enough, the state is unchanged
+ */
+extern bool delayed_fusion_rewind(struct DelayedFusion *df, uint32_t stamp, uint32_t tolerance, void *state);
+
+/**
+ * Propagate the restored state again up to the current time.
+ * The stored states are replaced by the corrected ones.
+ * @param state filter state, updated since delayed_fusion_rewind()
+ * @return number of replayed steps
+ */
+extern uint16_t delayed_fusion_replay(struct DelayedFusion *df, void *state);
+
+#endif /* DELAYED_FUSION_H */
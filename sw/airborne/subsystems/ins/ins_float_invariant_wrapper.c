@@ -112,6 +112,7 @@ PRINT_CONFIG_VAR(INS_FINV_GPS_ID)
 static abi_event baro_ev;
 static abi_event gyro_ev;
 static abi_event accel_ev;
+static abi_event imu_batch_ev;
 static abi_event aligner_ev;
 static abi_event body_to_imu_ev;
 #if USE_MAGNETOMETER
@@ -120,6 +121,9 @@ static abi_event geo_mag_ev;
 #endif
 static abi_event gps_ev;
 
+/** set once IMU batches are received, single samples are then ignored */
+static bool ins_finv_use_batch = false;
+
 static void baro_cb(uint8_t __attribute__((unused)) sender_id, __attribute__((unused)) uint32_t stamp, float pressure)
 {
   ins_float_invariant_update_baro(pressure);
@@ -133,6 +137,9 @@ static void baro_cb(uint8_t __attribute__((unused)) sender_id, __attribute__((un
 static void gyro_cb(uint8_t sender_id __attribute__((unused)),
                    uint32_t stamp, struct Int32Rates *gyro)
 {
+  if (ins_finv_use_batch) {
+    return;
+  }
   struct FloatRates gyro_f;
   RATES_FLOAT_OF_BFP(gyro_f, *gyro);
 
@@ -160,9 +167,31 @@ static void accel_cb(uint8_t sender_id __attribute__((unused)),
                      uint32_t stamp __attribute__((unused)),
                      struct Int32Vect3 *accel)
 {
+  if (ins_finv_use_batch) {
+    return;
+  }
   ACCELS_FLOAT_OF_BFP(ins_finv_accel, *accel);
 }
 
+/** Propagation once per batch of IMU samples,
+ * with the rates and accel integrated over the batch
+ */
+static void imu_batch_cb(uint8_t __attribute__((unused)) sender_id,
+                         uint32_t stamp, struct ImuBatchInt32 *batch)
+{
+  ins_finv_use_batch = true;
+
+  struct ImuBatchDelta delta;
+  imu_batch_integrate(&delta, batch, true);
+  if (delta.dt > 0.f) {
+    struct FloatRates gyro_f;
+    imu_batch_get_mean(&gyro_f, &ins_finv_accel, &delta);
+    ins_float_invariant_propagate(&gyro_f, &ins_finv_accel, delta.dt);
+  }
+
+  ins_finv_last_stamp = stamp;
+}
+
 static void aligner_cb(uint8_t __attribute__((unused)) sender_id,
                        uint32_t stamp __attribute__((unused)),
                        struct Int32Rates *lp_gyro, struct Int32Vect3 *lp_accel,
@@ -225,6 +254,7 @@ void ins_float_invariant_wrapper_init(void)
   AbiBindMsgBARO_ABS(INS_FINV_BARO_ID, &baro_ev, baro_cb);
   AbiBindMsgIMU_GYRO_INT32(INS_FINV_IMU_ID, &gyro_ev, gyro_cb);
   AbiBindMsgIMU_ACCEL_INT32(INS_FINV_IMU_ID, &accel_ev, accel_cb);
+  AbiBindMsgIMU_BATCH_INT32(INS_FINV_IMU_ID, &imu_batch_ev, imu_batch_cb);
   AbiBindMsgIMU_LOWPASSED(INS_FINV_IMU_ID, &aligner_ev, aligner_cb);
   AbiBindMsgBODY_TO_IMU_QUAT(INS_FINV_IMU_ID, &body_to_imu_ev, body_to_imu_cb);
 #if USE_MAGNETOMETER
@@ -55,6 +55,98 @@
 #include "math/pprz_isa.h"
 #include "math/pprz_stat.h"
 
+/*
+ * Compensation of the GPS lag in the vertical filter
+ *
+ * INS_INT_VFF_GPS_LAG is the GPS delay in seconds. The vertical filter is
+ * restored at the time of the GPS measurement, updated, then propagated again
+ * up to the current time.
+ */
+#if USE_VFF_EXTENDED && defined INS_INT_VFF_GPS_LAG
+#define INS_INT_VFF_DELAYED 1
+#include "subsystems/ins/delayed_fusion.h"
+#include "mcu_periph/sys_time.h"
+
+/** number of stored propagation steps, must cover the lag at the IMU rate,
+ * a GPS measurement older than the history is fused as current
+ */
+#ifndef INS_INT_VFF_HIST_SIZE
+#define INS_INT_VFF_HIST_SIZE 128
+#endif
+
+/** maximum time difference between the GPS measurement and the restored state in seconds */
+#ifndef INS_INT_VFF_GPS_LAG_TOL
+#define INS_INT_VFF_GPS_LAG_TOL 0.01
+#endif
+
+/** measurements fused after a propagation step */
+enum InsIntVffUpdate {
+  VFF_UPDATE_BARO = 1,
+  VFF_UPDATE_AGL = 2,
+  VFF_UPDATE_VZ = 4,
+  VFF_UPDATE_Z = 8
+};
+
+/** propagation step of the vertical filter, with the measurements to replay */
+struct InsIntVffStep {
+  float accel;
+  float dt;
+  uint8_t updates;  ///< bits of #InsIntVffUpdate
+  float baro_z;
+  float agl_z, agl_r;
+  float vz, vz_r;
+  float z, z_r;
+};
+
+DELAYED_FUSION_DECLARE(vff_hist, struct VffExtended, struct InsIntVffStep, INS_INT_VFF_HIST_SIZE);
+static struct DelayedFusion vff_df;
+
+static void vff_replay_step(void *state __attribute__((unused)), const void *input)
+{
+  // state is the global vff
+  const struct InsIntVffStep *s = (const struct InsIntVffStep *)input;
+  vff_propagate(s->accel, s->dt);
+  if (s->updates & VFF_UPDATE_BARO) { vff_update_baro(s->baro_z); }
+  if (s->updates & VFF_UPDATE_AGL) { vff_update_agl(s->agl_z, s->agl_r); }
+  if (s->updates & VFF_UPDATE_VZ) { vff_update_vz_conf(s->vz, s->vz_r); }
+  if (s->updates & VFF_UPDATE_Z) { vff_update_z_conf(s->z, s->z_r); }
+}
+
+/** attach a measurement to the last propagation step, only the last one of each kind is kept */
+static void vff_record(enum InsIntVffUpdate update, float meas, float r)
+{
+  struct InsIntVffStep *s = (struct InsIntVffStep *)delayed_fusion_last_input(&vff_df);
+  if (s == NULL) {
+    return;
+  }
+  s->updates |= update;
+  switch (update) {
+    case VFF_UPDATE_BARO: s->baro_z = meas; break;
+    case VFF_UPDATE_AGL: s->agl_z = meas; s->agl_r = r; break;
+    case VFF_UPDATE_VZ: s->vz = meas; s->vz_r = r; break;
+    case VFF_UPDATE_Z: s->z = meas; s->z_r = r; break;
+    default: break;
+  }
+}
+
+/** restore the vertical filter at a past time, keeping the current tuning */
+static bool vff_rewind(uint32_t stamp)
+{
+  struct VffExtended now = vff;
+  if (!delayed_fusion_rewind(&vff_df, stamp, (uint32_t)(INS_INT_VFF_GPS_LAG_TOL * 1e6), &vff)) {
+    return false;
+  }
+  vff.accel_noise = now.accel_noise;
+  vff.r_baro = now.r_baro;
+  vff.r_alt = now.r_alt;
+  vff.r_obs_height = now.r_obs_height;
+  return true;
+}
+#define VffRecord(_u, _m, _r) vff_record(_u, _m, _r)
+#else
+#define VffRecord(_u, _m, _r) {}
+#endif
+
 #ifndef VFF_R_AGL
 #define VFF_R_AGL 0.2
 #endif
@@ -127,6 +219,10 @@ static void baro_cb(uint8_t sender_id, uint32_t stamp, float pressure);
 #endif
 static abi_event accel_ev;
 static void accel_cb(uint8_t sender_id, uint32_t stamp, struct Int32Vect3 *accel);
+static abi_event imu_batch_ev;
+static void imu_batch_cb(uint8_t sender_id, uint32_t stamp, struct ImuBatchInt32 *batch);
+/** set once IMU batches are received, single samples are then ignored */
+static bool ins_int_use_batch = false;
 
 #ifndef INS_INT_GPS_ID
 #define INS_INT_GPS_ID GPS_MULTI_ID
@@ -226,6 +322,9 @@ void ins_int_init(void)
 
   /* init vertical and horizontal filters */
   vff_init_zero();
+#if INS_INT_VFF_DELAYED
+  DELAYED_FUSION_INIT(&vff_df, vff_hist, vff_replay_step);
+#endif
 #if USE_HFF
   hff_init(0., 0., 0., 0.);
 #endif
@@ -244,6 +343,7 @@ void ins_int_init(void)
    * Subscribe to scaled IMU measurements and attach callbacks
    */
   AbiBindMsgIMU_ACCEL_INT32(INS_INT_IMU_ID, &accel_ev, accel_cb);
+  AbiBindMsgIMU_BATCH_INT32(INS_INT_IMU_ID, &imu_batch_ev, imu_batch_cb);
   AbiBindMsgGPS(INS_INT_GPS_ID, &gps_ev, gps_cb);
   AbiBindMsgVELOCITY_ESTIMATE(INS_INT_VEL_ID, &vel_est_ev, vel_est_cb);
   AbiBindMsgPOSITION_ESTIMATE(INS_INT_POS_ID, &pos_est_ev, pos_est_cb);
@@ -307,9 +407,16 @@ void ins_int_propagate(struct Int32Vect3 *accel, float dt)
    * and there is no gps fix yet...
    */
   if (ins_int.propagation_cnt < INS_MAX_PROPAGATION_STEPS) {
+#if INS_INT_VFF_DELAYED
+    struct InsIntVffStep step = { .accel = z_accel_meas_float, .dt = dt, .updates = 0 };
+    delayed_fusion_push(&vff_df, get_sys_time_usec(), &vff, &step);
+#endif
     vff_propagate(z_accel_meas_float, dt);
     ins_update_from_vff();
   } else {
+#if INS_INT_VFF_DELAYED
+    delayed_fusion_reset(&vff_df);
+#endif
     // feed accel from the sensors
     // subtract -9.81m/s2 (acceleration measured due to gravity,
     // but vehicle not accelerating in ltp)
@@ -373,6 +480,9 @@ static void baro_cb(uint8_t __attribute__((unused)) sender_id, __attribute__((un
       ins_int.vf_reset = false;
       ins_int.qfe = pressure;
       vff_realign(height_correction);
+#if INS_INT_VFF_DELAYED
+      delayed_fusion_reset(&vff_df);
+#endif
       ins_update_from_vff();
     }
 
@@ -383,6 +493,7 @@ static void baro_cb(uint8_t __attribute__((unused)) sender_id, __attribute__((un
 
 #if USE_VFF_EXTENDED
     vff_update_baro(ins_int.baro_z);
+    VffRecord(VFF_UPDATE_BARO, ins_int.baro_z, 0.f);
 #else
     vff_update(ins_int.baro_z);
 #endif
@@ -427,6 +538,10 @@ void ins_int_update_gps(struct GpsState *gps_s)
   struct NedCoor_i gps_speed_cm_s_ned;
   ned_of_ecef_vect_i(&gps_speed_cm_s_ned, &ins_int.ltp_def, &gps_s->ecef_vel);
 
+#if INS_INT_VFF_DELAYED
+  // fuse at the measurement time if it is still in the history, as current otherwise
+  bool vff_rewound = vff_rewind(get_sys_time_usec() - (uint32_t)(INS_INT_VFF_GPS_LAG * 1e6));
+#endif
 #if INS_USE_GPS_ALT
   vff_update_z_conf(((float)gps_pos_cm_ned.z) / 100.0, INS_VFF_R_GPS);
 #endif
@@ -434,6 +549,19 @@ void ins_int_update_gps(struct GpsState *gps_s)
   vff_update_vz_conf(((float)gps_speed_cm_s_ned.z) / 100.0, INS_VFF_VZ_R_GPS);
   ins_int.propagation_cnt = 0;
 #endif
+#if INS_INT_VFF_DELAYED
+  if (vff_rewound) {
+    delayed_fusion_replay(&vff_df, &vff);
+    ins_update_from_vff();
+  } else {
+#if INS_USE_GPS_ALT
+    VffRecord(VFF_UPDATE_Z, ((float)gps_pos_cm_ned.z) / 100.0, INS_VFF_R_GPS);
+#endif
+#if INS_USE_GPS_ALT_SPEED
+    VffRecord(VFF_UPDATE_VZ, ((float)gps_speed_cm_s_ned.z) / 100.0, INS_VFF_VZ_R_GPS);
+#endif
+  }
+#endif
 
 #if USE_HFF
   /* horizontal gps transformed to NED in meters as float */
@@ -499,9 +627,11 @@ static void agl_cb(uint8_t __attribute__((unused)) sender_id, __attribute__((unu
 
 #if USE_SONAR
   vff_update_agl(-distance, VFF_R_SONAR_0 + VFF_R_SONAR_OF_M * fabsf(distance));
+  VffRecord(VFF_UPDATE_AGL, -distance, VFF_R_SONAR_0 + VFF_R_SONAR_OF_M * fabsf(distance));
 #else
   // TODO: this assumes that you will either have sonar or other agl sensor never both
   vff_update_agl(-distance, VFF_R_AGL);
+  VffRecord(VFF_UPDATE_AGL, -distance, VFF_R_AGL);
 #endif
     /* reset the counter to indicate we just had a measurement update */
     ins_int.propagation_cnt = 0;
@@ -553,6 +683,9 @@ static void accel_cb(uint8_t sender_id __attribute__((unused)),
   /* timestamp in usec when last callback was received */
   static uint32_t last_stamp = 0;
 
+  if (ins_int_use_batch) {
+    return;
+  }
   if (last_stamp > 0) {
     float dt = (float)(stamp - last_stamp) * 1e-6;
     ins_int_propagate(accel, dt);
@@ -560,6 +693,26 @@ static void accel_cb(uint8_t sender_id __attribute__((unused)),
   last_stamp = stamp;
 }
 
+/** Propagation once per batch of IMU samples,
+ * with the mean specific force over the batch
+ */
+static void imu_batch_cb(uint8_t sender_id __attribute__((unused)),
+                         uint32_t stamp __attribute__((unused)), struct ImuBatchInt32 *batch)
+{
+  ins_int_use_batch = true;
+
+  struct ImuBatchDelta delta;
+  imu_batch_integrate(&delta, batch, true);
+  if (delta.dt > 0.f) {
+    struct FloatRates gyro_f;
+    struct FloatVect3 accel_f;
+    struct Int32Vect3 accel;
+    imu_batch_get_mean(&gyro_f, &accel_f, &delta);
+    ACCELS_BFP_OF_REAL(accel, accel_f);
+    ins_int_propagate(&accel, delta.dt);
+  }
+}
+
 static void gps_cb(uint8_t sender_id __attribute__((unused)),
                    uint32_t stamp __attribute__((unused)),
                    struct GpsState *gps_s)
@@ -623,6 +776,7 @@ static void vel_est_cb(uint8_t sender_id __attribute__((unused)),
 
   // abi message contains an update to the vertical velocity estimate
   vff_update_vz_conf(vel_ned.z, noise_z);
+  VffRecord(VFF_UPDATE_VZ, vel_ned.z, noise_z);
 
   ins_ned_to_state();
 
@@ -0,0 +1,454 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file bench_math.c
+ *
+ * Microbenchmarks of the math library kernels.
+ *
+ * Each kernel is first run in batches of increasing size until a batch
+ * takes at least the target time, then a few warm-up batches are run and
+ * the time per call is measured over a number of repetitions.
+ * The minimum, median, mean, standard deviation and maximum are reported.
+ *
+ * Usage: bench_math [-r reps] [-w warmup] [-T target_us] [-f filter] [-c]
+ *                   [-b baseline.csv] [-t tolerance_percent]
+ *  -c: print results as CSV, to be stored as a baseline
+ *  -b: compare the medians with a baseline CSV file, the program exits
+ *      with an error if a kernel is slower than the tolerance (default 10%).
+ *      With -c the comparison is printed on stderr, the CSV on stdout.
+ *
+ * Host: make bench_math && ./bench_math -c > baseline.csv
+ * ARM:  make bench_math CC=arm-linux-gnueabihf-gcc BENCH_CFLAGS="-O2 -static"
+ *       make run_bench_math BENCH_RUNNER=qemu-arm BENCH_ARGS="-b baseline_arm.csv"
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "std.h"
+#include "math/pprz_algebra_int.h"
+#include "math/pprz_algebra_float.h"
+#include "math/pprz_trig_int.h"
+#include "math/pprz_matrix_decomp_float.h"
+#include "firmwares/rotorcraft/stabilization/wls/wls_alloc.h"
+
+#define BENCH_MAX_REPS 1000
+
+/** Keep the compiler from optimizing away a result */
+#define BENCH_USE(_x) __asm__ volatile("" : : "g"(&(_x)) : "memory")
+
+static uint64_t bench_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Inputs of the kernels, slightly varied at each call
+ */
+
+#define BENCH_NB_INPUTS 16
+#define BENCH_INPUT(_i) ((_i) & (BENCH_NB_INPUTS - 1))
+
+static struct FloatQuat quat_f[BENCH_NB_INPUTS];
+static struct FloatRMat rmat_f[BENCH_NB_INPUTS];
+static struct FloatVect3 vect_f[BENCH_NB_INPUTS];
+static struct Int32Quat quat_i[BENCH_NB_INPUTS];
+static struct Int32Vect3 vect_i[BENCH_NB_INPUTS];
+static int32_t angle_i[BENCH_NB_INPUTS];
+
+static void bench_init_inputs(void)
+{
+  srand(0);
+  for (int i = 0; i < BENCH_NB_INPUTS; i++) {
+    struct FloatEulers e = {
+      (float)rand() / RAND_MAX - 0.5f,
+      (float)rand() / RAND_MAX - 0.5f,
+      6.f * (float)rand() / RAND_MAX - 3.f
+    };
+    float_quat_of_eulers(&quat_f[i], &e);
+    float_rmat_of_quat(&rmat_f[i], &quat_f[i]);
+    VECT3_ASSIGN(vect_f[i], (float)rand() / RAND_MAX, (float)rand() / RAND_MAX, (float)rand() / RAND_MAX);
+    QUAT_BFP_OF_REAL(quat_i[i], quat_f[i]);
+    VECT3_ASSIGN(vect_i[i], rand() % 4096, rand() % 4096, rand() % 4096);
+    angle_i[i] = ANGLE_BFP_OF_REAL(6.f * (float)rand() / RAND_MAX - 3.f);
+  }
+}
+
+/*
+ * Kernels, each one runs n calls
+ */
+
+static void bench_float_quat_comp(uint32_t n)
+{
+  struct FloatQuat q;
+  for (uint32_t i = 0; i < n; i++) {
+    float_quat_comp(&q, &quat_f[BENCH_INPUT(i)], &quat_f[BENCH_INPUT(i + 1)]);
+    BENCH_USE(q);
+  }
+}
+
+static void bench_float_quat_vmult(uint32_t n)
+{
+  struct FloatVect3 v;
+  for (uint32_t i = 0; i < n; i++) {
+    float_quat_vmult(&v, &quat_f[BENCH_INPUT(i)], &vect_f[BENCH_INPUT(i + 1)]);
+    BENCH_USE(v);
+  }
+}
+
+static void bench_float_rmat_of_quat(uint32_t n)
+{
+  struct FloatRMat m;
+  for (uint32_t i = 0; i < n; i++) {
+    float_rmat_of_quat(&m, &quat_f[BENCH_INPUT(i)]);
+    BENCH_USE(m);
+  }
+}
+
+static void bench_float_quat_of_rmat(uint32_t n)
+{
+  struct FloatQuat q;
+  for (uint32_t i = 0; i < n; i++) {
+    float_quat_of_rmat(&q, &rmat_f[BENCH_INPUT(i)]);
+    BENCH_USE(q);
+  }
+}
+
+static void bench_float_rmat_comp(uint32_t n)
+{
+  struct FloatRMat m;
+  for (uint32_t i = 0; i < n; i++) {
+    float_rmat_comp(&m, &rmat_f[BENCH_INPUT(i)], &rmat_f[BENCH_INPUT(i + 1)]);
+    BENCH_USE(m);
+  }
+}
+
+static void bench_float_eulers_of_quat(uint32_t n)
+{
+  struct FloatEulers e;
+  for (uint32_t i = 0; i < n; i++) {
+    float_eulers_of_quat(&e, &quat_f[BENCH_INPUT(i)]);
+    BENCH_USE(e);
+  }
+}
+
+static void bench_int32_quat_comp(uint32_t n)
+{
+  struct Int32Quat q;
+  for (uint32_t i = 0; i < n; i++) {
+    int32_quat_comp(&q, &quat_i[BENCH_INPUT(i)], &quat_i[BENCH_INPUT(i + 1)]);
+    BENCH_USE(q);
+  }
+}
+
+static void bench_int32_quat_vmult(uint32_t n)
+{
+  struct Int32Vect3 v;
+  for (uint32_t i = 0; i < n; i++) {
+    int32_quat_vmult(&v, &quat_i[BENCH_INPUT(i)], &vect_i[BENCH_INPUT(i + 1)]);
+    BENCH_USE(v);
+  }
+}
+
+static void bench_int32_rmat_of_quat(uint32_t n)
+{
+  struct Int32RMat m;
+  for (uint32_t i = 0; i < n; i++) {
+    int32_rmat_of_quat(&m, &quat_i[BENCH_INPUT(i)]);
+    BENCH_USE(m);
+  }
+}
+
+static void bench_int32_eulers_of_quat(uint32_t n)
+{
+  struct Int32Eulers e;
+  for (uint32_t i = 0; i < n; i++) {
+    int32_eulers_of_quat(&e, &quat_i[BENCH_INPUT(i)]);
+    BENCH_USE(e);
+  }
+}
+
+static void bench_pprz_itrig_sin(uint32_t n)
+{
+  int32_t s;
+  for (uint32_t i = 0; i < n; i++) {
+    s = pprz_itrig_sin(angle_i[BENCH_INPUT(i)]);
+    BENCH_USE(s);
+  }
+}
+
+static void bench_pprz_itrig_cos(uint32_t n)
+{
+  int32_t c;
+  for (uint32_t i = 0; i < n; i++) {
+    c = pprz_itrig_cos(angle_i[BENCH_INPUT(i)]);
+    BENCH_USE(c);
+  }
+}
+
+static void bench_int32_atan2(uint32_t n)
+{
+  int32_t a;
+  for (uint32_t i = 0; i < n; i++) {
+    a = int32_atan2(vect_i[BENCH_INPUT(i)].x - 2048, vect_i[BENCH_INPUT(i)].y - 2048);
+    BENCH_USE(a);
+  }
+}
+
+static void bench_pprz_svd_float(uint32_t n)
+{
+  float _a[6][4], w[4], _v[4][4];
+  MAKE_MATRIX_PTR(a, _a, 6);
+  MAKE_MATRIX_PTR(v, _v, 4);
+  for (uint32_t i = 0; i < n; i++) {
+    for (int r = 0; r < 6; r++) {
+      for (int c = 0; c < 4; c++) {
+        _a[r][c] = rmat_f[BENCH_INPUT(i + r)].m[c] + (r == c ? 1.f : 0.f);
+      }
+    }
+    pprz_svd_float(a, w, v, 6, 4);
+    BENCH_USE(w);
+  }
+}
+
+static void bench_wls_alloc(uint32_t n)
+{
+  static float g1g2[CA_N_V][CA_N_U] = {
+    {  0.0,  -0.015,  0.015,  0.0,  -0.015,   0.015 },
+    {  0.015,   -0.010, -0.010,   0.015,  -0.010,   -0.010 },
+    {   0.103,   0.103,    0.103,   -0.103,    -0.103,    -0.103 },
+    {-0.0009, -0.0009, -0.0009, -0.0009, -0.0009, -0.0009 }
+  };
+  float *B[CA_N_V];
+  for (int i = 0; i < CA_N_V; i++) {
+    B[i] = g1g2[i];
+  }
+  float u_min[CA_N_U], u_max[CA_N_U], u[CA_N_U];
+  for (int k = 0; k < CA_N_U; k++) {
+    u_min[k] = -4400.f;
+    u_max[k] = 5200.f;
+  }
+  float Wv[CA_N_V] = {100, 100, 1, 10};
+  for (uint32_t i = 0; i < n; i++) {
+    float v[CA_N_V] = {240.f * vect_f[BENCH_INPUT(i)].x, -240.f, 600.f * vect_f[BENCH_INPUT(i)].y, 1.8f};
+    wls_alloc(u, v, u_min, u_max, B, 0, 0, Wv, 0, 0, 10000, 10);
+    BENCH_USE(u);
+  }
+}
+
+struct bench_kernel {
+  const char *name;
+  void (*run)(uint32_t n);
+};
+
+static const struct bench_kernel bench_kernels[] = {
+  { "float_quat_comp", bench_float_quat_comp },
+  { "float_quat_vmult", bench_float_quat_vmult },
+  { "float_rmat_of_quat", bench_float_rmat_of_quat },
+  { "float_quat_of_rmat", bench_float_quat_of_rmat },
+  { "float_rmat_comp", bench_float_rmat_comp },
+  { "float_eulers_of_quat", bench_float_eulers_of_quat },
+  { "int32_quat_comp", bench_int32_quat_comp },
+  { "int32_quat_vmult", bench_int32_quat_vmult },
+  { "int32_rmat_of_quat", bench_int32_rmat_of_quat },
+  { "int32_eulers_of_quat", bench_int32_eulers_of_quat },
+  { "pprz_itrig_sin", bench_pprz_itrig_sin },
+  { "pprz_itrig_cos", bench_pprz_itrig_cos },
+  { "int32_atan2", bench_int32_atan2 },
+  { "pprz_svd_float_6x4", bench_pprz_svd_float },
+  { "wls_alloc_4x6", bench_wls_alloc },
+};
+
+#define BENCH_NB_KERNELS (sizeof(bench_kernels) / sizeof(bench_kernels[0]))
+
+/*
+ * Measurement and statistics
+ */
+
+struct bench_stats {
+  uint32_t reps;
+  uint32_t batch;
+  double min, median, mean, stddev, max;  ///< in ns per call
+};
+
+static int cmp_double(const void *a, const void *b)
+{
+  double da = *(const double *)a, db = *(const double *)b;
+  return (da > db) - (da < db);
+}
+
+static void bench_run(const struct bench_kernel *k, uint32_t reps, uint32_t warmup, uint64_t target_ns,
+                      struct bench_stats *s)
+{
+  static double t[BENCH_MAX_REPS];
+
+  // find a batch size lasting at least the target time, this also warms up caches
+  uint32_t batch = 1;
+  for (;;) {
+    uint64_t t0 = bench_now_ns();
+    k->run(batch);
+    uint64_t dt = bench_now_ns() - t0;
+    if (dt >= target_ns || batch >= (1u << 30)) {
+      break;
+    }
+    batch *= 2;
+  }
+  for (uint32_t i = 0; i < warmup; i++) {
+    k->run(batch);
+  }
+
+  double sum = 0.;
+  for (uint32_t i = 0; i < reps; i++) {
+    uint64_t t0 = bench_now_ns();
+    k->run(batch);
+    t[i] = (double)(bench_now_ns() - t0) / (double)batch;
+    sum += t[i];
+  }
+  s->reps = reps;
+  s->batch = batch;
+  s->mean = sum / reps;
+  double var = 0.;
+  for (uint32_t i = 0; i < reps; i++) {
+    var += (t[i] - s->mean) * (t[i] - s->mean);
+  }
+  s->stddev = reps > 1 ? sqrt(var / (reps - 1)) : 0.;
+  qsort(t, reps, sizeof(double), cmp_double);
+  s->min = t[0];
+  s->max = t[reps - 1];
+  s->median = (reps % 2) ? t[reps / 2] : 0.5 * (t[reps / 2 - 1] + t[reps / 2]);
+}
+
+/** Get the median of a kernel from a baseline CSV file, negative if not found */
+static double baseline_median(FILE *f, const char *name)
+{
+  char line[256];
+  rewind(f);
+  while (fgets(line, sizeof(line), f)) {
+    char kname[64];
+    unsigned reps, batch;
+    double min, median;
+    if (sscanf(line, "%63[^,],%u,%u,%lf,%lf", kname, &reps, &batch, &min, &median) == 5 &&
+        strcmp(kname, name) == 0) {
+      return median;
+    }
+  }
+  return -1.;
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t reps = 30;
+  uint32_t warmup = 3;
+  uint64_t target_ns = 1000000;
+  const char *filter = NULL;
+  const char *baseline = NULL;
+  double tolerance = 10.;
+  bool csv = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "r:w:T:f:cb:t:")) != -1) {
+    switch (opt) {
+      case 'r': reps = (uint32_t)atoi(optarg); break;
+      case 'w': warmup = (uint32_t)atoi(optarg); break;
+      case 'T': target_ns = 1000ULL * (uint64_t)atoi(optarg); break;
+      case 'f': filter = optarg; break;
+      case 'c': csv = true; break;
+      case 'b': baseline = optarg; break;
+      case 't': tolerance = atof(optarg); break;
+      default:
+        fprintf(stderr, "usage: %s [-r reps] [-w warmup] [-T target_us] [-f filter] [-c] "
+                "[-b baseline.csv] [-t tolerance_percent]\n", argv[0]);
+        return 2;
+    }
+  }
+  Bound(reps, 1, BENCH_MAX_REPS);
+
+  FILE *fb = NULL;
+  if (baseline) {
+    fb = fopen(baseline, "r");
+    if (fb == NULL) {
+      fprintf(stderr, "could not open baseline %s\n", baseline);
+      return 2;
+    }
+  }
+
+  bench_init_inputs();
+
+  if (csv) {
+    printf("kernel,reps,batch,min_ns,median_ns,mean_ns,stddev_ns,max_ns\n");
+  } else {
+    printf("%-22s %6s %9s %10s %10s %10s %9s %10s%s\n", "kernel", "reps", "batch",
+           "min_ns", "median_ns", "mean_ns", "stddev", "max_ns", fb ? "   vs baseline" : "");
+  }
+
+  int nb_regressions = 0;
+  for (unsigned i = 0; i < BENCH_NB_KERNELS; i++) {
+    const struct bench_kernel *k = &bench_kernels[i];
+    if (filter && strstr(k->name, filter) == NULL) {
+      continue;
+    }
+    struct bench_stats s;
+    bench_run(k, reps, warmup, target_ns, &s);
+
+    char cmp[48] = "";
+    if (fb) {
+      double ref = baseline_median(fb, k->name);
+      if (ref > 0.) {
+        double diff = 100. * (s.median - ref) / ref;
+        bool regression = diff > tolerance;
+        nb_regressions += regression ? 1 : 0;
+        snprintf(cmp, sizeof(cmp), "   %+6.1f%%%s", diff, regression ? " REGRESSION" : "");
+      } else {
+        snprintf(cmp, sizeof(cmp), "   new");
+      }
+    }
+
+    if (csv) {
+      printf("%s,%u,%u,%.3f,%.3f,%.3f,%.3f,%.3f\n", k->name, s.reps, s.batch,
+             s.min, s.median, s.mean, s.stddev, s.max);
+      // keep stdout a valid baseline, the comparison can still fail the run
+      if (fb) {
+        fprintf(stderr, "%-22s vs baseline%s\n", k->name, cmp);
+      }
+    } else {
+      printf("%-22s %6u %9u %10.2f %10.2f %10.2f %9.2f %10.2f%s\n", k->name, s.reps, s.batch,
+             s.min, s.median, s.mean, s.stddev, s.max, cmp);
+    }
+    fflush(stdout);
+  }
+
+  if (fb) {
+    fclose(fb);
+    if (nb_regressions > 0) {
+      fprintf(stderr, "%d kernel(s) slower than baseline by more than %.1f%%\n", nb_regressions, tolerance);
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file bench_mekf_wind.c
+ *
+ * Time per call of the MEKF wind propagation and measurement updates on a
+ * synthetic circular flight with wind: IMU at 500 Hz, mag and airspeed
+ * at 50 Hz, baro at 25 Hz, GPS at 5 Hz.
+ *
+ * bench_mekf_wind uses the structured covariance propagation and the
+ * sequential updates, bench_mekf_wind_dense the dense reference
+ * (INS_MEKF_WIND_DENSE). Both get the same inputs, so the final state
+ * written by one can be checked against the other:
+ *
+ * make run_bench_mekf_wind
+ *
+ * bench_mekf_wind [-n nb_steps] [-o state_file] [-c reference_state_file]
+ *
+ * Cycle counts are read from the TSC on x86 hosts only.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include "modules/ins/ins_mekf_wind.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_CYCLES 1
+static uint64_t cycles(void) { return __rdtsc(); }
+#else
+#define BENCH_HAS_CYCLES 0
+static uint64_t cycles(void) { return 0; }
+#endif
+
+#define IMU_FREQ 500
+#define NB_STATE 17
+
+static double now_s(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+/** deterministic noise in [-a, a] */
+static float noise(float a)
+{
+  return a * (2.f * (float)rand() / (float)RAND_MAX - 1.f);
+}
+
+enum BenchCall {
+  CALL_PROPAGATE, CALL_MAG, CALL_BARO, CALL_POS_SPEED, CALL_AIRSPEED, CALL_INCIDENCE, NB_CALLS
+};
+
+static const char *call_names[NB_CALLS] = {
+  "propagate", "update_mag", "update_baro", "update_pos_speed", "update_airspeed", "update_incidence"
+};
+
+struct BenchTiming {
+  uint32_t nb;
+  double time;
+  uint64_t cycles;
+};
+
+static struct BenchTiming timings[NB_CALLS];
+
+#define BENCH_CALL(_c, _call) {   \
+    double _t0 = now_s();         \
+    uint64_t _c0 = cycles();      \
+    _call;                        \
+    timings[_c].cycles += cycles() - _c0; \
+    timings[_c].time += now_s() - _t0;    \
+    timings[_c].nb++;             \
+  }
+
+static void get_state(float *s)
+{
+  struct FloatQuat q = ins_mekf_wind_get_quat();
+  struct NedCoor_f p = ins_mekf_wind_get_pos_ned();
+  struct NedCoor_f v = ins_mekf_wind_get_speed_ned();
+  struct NedCoor_f w = ins_mekf_wind_get_wind_ned();
+  struct FloatRates rb = ins_mekf_wind_get_rates_bias();
+  float state[NB_STATE] = { q.qi, q.qx, q.qy, q.qz, p.x, p.y, p.z, v.x, v.y, v.z,
+                            w.x, w.y, w.z, rb.p, rb.q, rb.r, ins_mekf_wind_get_baro_bias() };
+  memcpy(s, state, sizeof(state));
+}
+
+int main(int argc, char **argv)
+{
+  int n = 100000;
+  char *out_file = NULL;
+  char *ref_file = NULL;
+  for (int i = 1; i < argc - 1; i++) {
+    if (strcmp(argv[i], "-n") == 0) { n = atoi(argv[++i]); }
+    else if (strcmp(argv[i], "-o") == 0) { out_file = argv[++i]; }
+    else if (strcmp(argv[i], "-c") == 0) { ref_file = argv[++i]; }
+  }
+
+  // circle of 150 m at 18 m/s airspeed, 50 m above ground, constant wind
+  const float dt = 1.f / IMU_FREQ;
+  const float V = 18.f;
+  const float radius = 150.f;
+  const float omega = V / radius;
+  const float alt = 50.f;
+  const float wind[3] = { 3.f, -2.f, 0.f };
+  const struct FloatVect3 mag_h = { 0.5f, 0.f, 0.85f };
+  const float gyro_bias[3] = { 0.01f, -0.02f, 0.005f };
+
+  ins_mekf_wind_init();
+  ins_mekf_wind_set_mag_h(&mag_h);
+  ins_mekf_wind_params.disable_wind = false;
+  ins_mekf_wind_update_params();
+  struct FloatRates rb0 = { 0.f, 0.f, 0.f };
+  struct FloatQuat q0 = { 1.f, 0.f, 0.f, 0.f };
+  ins_mekf_wind_align(&rb0, &q0);
+  struct NedCoor_f p0 = { 0.f, 0.f, -alt };
+  struct NedCoor_f v0 = { V + wind[0], wind[1], 0.f };
+  ins_mekf_wind_set_pos_ned(&p0);
+  ins_mekf_wind_set_speed_ned(&v0);
+
+  srand(0);
+  memset(timings, 0, sizeof(timings));
+  for (int k = 1; k <= n; k++) {
+    // true state, level coordinated turn
+    const float t = k * dt;
+    const float psi = omega * t;
+    const float cpsi = cosf(psi), spsi = sinf(psi);
+    const float air[3] = { V * cpsi, V * spsi, 0.f };
+    const float speed[3] = { air[0] + wind[0], air[1] + wind[1], 0.f };
+    // the circle drifts with the wind
+    const float pos[3] = { radius * spsi + wind[0] * t, radius * (1.f - cpsi) + wind[1] * t, -alt };
+
+    // body frame = NED rotated by psi around z, centripetal accel along body y
+    struct FloatRates gyro = { gyro_bias[0] + noise(0.01f), gyro_bias[1] + noise(0.01f),
+                               omega + gyro_bias[2] + noise(0.01f) };
+    struct FloatVect3 accel = { noise(0.2f), V * omega + noise(0.2f), -9.81f + noise(0.2f) };
+    BENCH_CALL(CALL_PROPAGATE, ins_mekf_wind_propagate(&gyro, &accel, dt));
+
+    if (k % (IMU_FREQ / 50) == 0) {
+      struct FloatVect3 mag = { cpsi * mag_h.x + spsi * mag_h.y + noise(0.02f),
+                                -spsi * mag_h.x + cpsi * mag_h.y + noise(0.02f),
+                                mag_h.z + noise(0.02f) };
+      BENCH_CALL(CALL_MAG, ins_mekf_wind_update_mag(&mag, false));
+      BENCH_CALL(CALL_AIRSPEED, ins_mekf_wind_update_airspeed(V + noise(0.5f)));
+      BENCH_CALL(CALL_INCIDENCE, ins_mekf_wind_update_incidence(noise(0.01f), noise(0.01f)));
+    }
+    if (k % (IMU_FREQ / 25) == 0) {
+      BENCH_CALL(CALL_BARO, ins_mekf_wind_update_baro(pos[2] + noise(0.5f)));
+    }
+    if (k % (IMU_FREQ / 5) == 0) {
+      struct FloatVect3 gps_pos = { pos[0] + noise(1.f), pos[1] + noise(1.f), pos[2] + noise(2.f) };
+      struct FloatVect3 gps_speed = { speed[0] + noise(0.2f), speed[1] + noise(0.2f), speed[2] + noise(0.3f) };
+      BENCH_CALL(CALL_POS_SPEED, ins_mekf_wind_update_pos_speed(&gps_pos, &gps_speed));
+    }
+  }
+
+  printf("%s %s\n", "call                  nb     ns/call", BENCH_HAS_CYCLES ? " cycles/call" : "");
+  double total = 0.;
+  for (int c = 0; c < NB_CALLS; c++) {
+    struct BenchTiming *b = &timings[c];
+    if (b->nb == 0) { continue; }
+    printf("%-18s %7u %10.1f", call_names[c], b->nb, 1e9 * b->time / b->nb);
+    if (BENCH_HAS_CYCLES) {
+      printf(" %11.0f", (double)b->cycles / b->nb);
+    }
+    printf("\n");
+    total += b->time;
+  }
+  printf("filter load at %d Hz: %.2f%% of one core\n", IMU_FREQ, 100. * total / (n * dt));
+
+  float state[NB_STATE];
+  get_state(state);
+  struct NedCoor_f w = ins_mekf_wind_get_wind_ned();
+  printf("estimated wind: %.2f %.2f %.2f (true %.2f %.2f %.2f)\n", w.x, w.y, w.z, wind[0], wind[1], wind[2]);
+
+  int ok = 1;
+  for (int i = 0; i < NB_STATE; i++) {
+    if (isnan(state[i])) { ok = 0; }
+  }
+  if (out_file != NULL) {
+    FILE *f = fopen(out_file, "w");
+    if (f == NULL) {
+      printf("can't write %s\n", out_file);
+      return 1;
+    }
+    for (int i = 0; i < NB_STATE; i++) {
+      fprintf(f, "%.9g\n", state[i]);
+    }
+    fclose(f);
+  }
+  if (ref_file != NULL) {
+    FILE *f = fopen(ref_file, "r");
+    if (f == NULL) {
+      printf("can't read %s\n", ref_file);
+      return 1;
+    }
+    // float rounding differs between both implementations, allow for a small drift
+    float err = 0.f;
+    for (int i = 0; i < NB_STATE; i++) {
+      float r;
+      if (fscanf(f, "%f", &r) != 1) { ok = 0; break; }
+      float e = fabsf(state[i] - r) / (1.f + fabsf(r));
+      if (e > err) { err = e; }
+    }
+    fclose(f);
+    printf("max relative state difference to reference: %.2e\n", err);
+    if (err > 1e-3f) { ok = 0; }
+  }
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
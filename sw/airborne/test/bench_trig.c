@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file bench_trig.c
+ *
+ * Accuracy and speed of the fixed point sine implementations of
+ * pprz_trig_int.c: uncompressed table, compressed tables and polynomial.
+ * Built with PPRZ_TRIG_INT_TEST so that all of them are available.
+ *
+ * make bench_trig && ./bench_trig [nb_calls]
+ *
+ * For a cross-compiled build, e.g. for a Cortex-M target under qemu:
+ * make bench_trig CC=arm-linux-gnueabi-gcc BENCH_CFLAGS="-O2 -static" && qemu-arm ./bench_trig
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+
+#include "math/pprz_trig_int.h"
+#include "math/pprz_algebra_int.h"
+
+static double now_s(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static int16_t trig_table(int32_t angle) { return pprz_trig_int[angle]; }
+static int16_t trig_compr_4(int32_t angle) { return pprz_trig_int_4(angle); }
+static int16_t trig_compr_8(int32_t angle) { return pprz_trig_int_8(angle); }
+static int16_t trig_compr_12(int32_t angle) { return pprz_trig_int_12(angle); }
+static int16_t trig_compr_16(int32_t angle) { return pprz_trig_int_16(angle); }
+static int16_t trig_sinf(int32_t angle) { return (int16_t)TRIG_BFP_OF_REAL(sinf(ANGLE_FLOAT_OF_BFP(angle))); }
+
+struct TrigImpl {
+  const char *name;
+  int16_t (*sin)(int32_t angle);
+  int max_err;    ///< maximum error against the table, in LSB
+  size_t mem;     ///< data size in bytes
+};
+
+static struct TrigImpl impls[] = {
+  { "table",            trig_table,         0, TRIG_INT_SIZE * sizeof(int16_t) },
+  { "compr_highest",    trig_compr_4,       0, (TRIG_INT_SIZE * 4) / 8 + (1 << TREE_SIZE_4) * sizeof(uint16_t) },
+  { "compr_high",       trig_compr_8,       0, TRIG_INT_SIZE + (1 << TREE_SIZE_8) * sizeof(uint16_t) },
+  { "compr_low",        trig_compr_12,      0, (TRIG_INT_SIZE * 12) / 8 },
+  { "compr_none",       trig_compr_16,      0, TRIG_INT_SIZE * sizeof(int16_t) },
+  { "poly",             pprz_trig_int_poly, 1, 0 },
+  { "sinf",             trig_sinf,          1, 0 },
+};
+
+#define NB_IMPLS (sizeof(impls) / sizeof(impls[0]))
+
+int main(int argc, char **argv)
+{
+  int n = 1000000;
+  if (argc > 1) {
+    n = atoi(argv[1]);
+  }
+
+  pprz_trig_int_init();
+
+  /* random angles in the first quadrant, as used by pprz_itrig_sin */
+  int32_t *angles = malloc(n * sizeof(int32_t));
+  srand(0);
+  for (int i = 0; i < n; i++) {
+    angles[i] = rand() % TRIG_INT_SIZE;
+  }
+
+  int ok = 1;
+  printf("implementation      max err   data bytes   ns/call\n");
+  for (unsigned int k = 0; k < NB_IMPLS; k++) {
+    int err = 0;
+    for (int32_t a = 0; a < TRIG_INT_SIZE; a++) {
+      int e = abs(impls[k].sin(a) - pprz_trig_int[a]);
+      if (e > err) { err = e; }
+    }
+    /* warm up then time */
+    volatile int32_t sink = 0;
+    int32_t acc = 0;
+    for (int i = 0; i < n / 10; i++) {
+      acc += impls[k].sin(angles[i]);
+    }
+    double t0 = now_s();
+    for (int i = 0; i < n; i++) {
+      acc += impls[k].sin(angles[i]);
+    }
+    double t = now_s() - t0;
+    sink = acc;
+    (void)sink;
+    printf("%-18s %8d %12u %9.2f\n", impls[k].name, err, (unsigned int)impls[k].mem, 1e9 * t / n);
+    if (err > impls[k].max_err) {
+      ok = 0;
+    }
+  }
+
+  free(angles);
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
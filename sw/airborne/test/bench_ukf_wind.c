@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file bench_ukf_wind.c
+ *
+ * Compare the hand written wind estimator UKF (wind_estimator_ukf) with the
+ * code generated from the Simulink model, on the same inputs, and time both.
+ *
+ * The inputs are either a synthetic circular flight in a turbulent wind, or
+ * a wind estimator log recorded with LOG_WIND_ESTIMATOR (the inputs are the
+ * first 16 columns, the time in ms is the last one).
+ *
+ * make run_bench_ukf_wind
+ *
+ * bench_ukf_wind [-n nb_steps] [-f we_ukf_log.csv] [-t tolerance]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include "modules/meteo/lib_ukf_wind_estimator/UKF_Wind_Estimator.h"
+#include "modules/meteo/wind_estimator_ukf.h"
+
+#define MAT_EL(_m, _l, _c, _n) _m[_l + _c * _n]
+
+static double now_s(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+/** deterministic noise in [-a, a] */
+static float noise(float a)
+{
+  return a * (2.f * (float)rand() / (float)RAND_MAX - 1.f);
+}
+
+/** same parameters as the wind_estimator module defaults */
+static void init_params(void)
+{
+  memset(&ukf_U, 0, sizeof(ExtU));
+  memset(&ukf_Y, 0, sizeof(ExtY));
+  memset(&ukf_DW, 0, sizeof(DW));
+  memset(&ukf_init, 0, sizeof(ukf_init_type));
+  memset(&ukf_params, 0, sizeof(ukf_params_type));
+  ukf_init.x0[6] = 1.0f;
+  for (int i = 0; i < 7; i++) {
+    MAT_EL(ukf_init.P0, i, i, 7) = 0.2f;
+  }
+  const float r[6] = { 0.5f, 0.5f, 0.5f, 0.5f, 0.002f, 0.002f };
+  for (int i = 0; i < 6; i++) {
+    MAT_EL(ukf_params.R, i, i, 6) = r[i] * r[i];
+  }
+  const float q[7] = { 0.1f, 0.1f, 0.1f, 0.001f, 0.001f, 0.001f, 0.0001f };
+  for (int i = 0; i < 7; i++) {
+    MAT_EL(ukf_params.Q, i, i, 7) = q[i] * q[i];
+  }
+  ukf_init.ki = 0.f;
+  ukf_init.alpha = 0.5f;
+  ukf_init.beta = 2.f;
+  ukf_params.dt = 0.1f;
+}
+
+/** circle at constant airspeed and bank in a wind with some turbulence */
+static void synthetic_input(int k, float dt)
+{
+  const float V = 16.f;
+  const float phi = 0.35f;
+  const float omega = 9.81f * tanf(phi) / V;
+  const float psi = omega * k * dt;
+  const float wind[3] = { 4.f + noise(0.3f), -3.f + noise(0.3f), noise(0.2f) };
+  const float theta = 0.05f;
+  // body airspeed with a small angle of attack and sideslip
+  const float alpha = theta + noise(0.01f), beta = noise(0.01f);
+  const float u = V * cosf(alpha) * cosf(beta), v = V * sinf(beta), w = V * sinf(alpha) * cosf(beta);
+  // attitude quaternion from euler angles
+  const float cph = cosf(phi / 2), sph = sinf(phi / 2), cth = cosf(theta / 2), sth = sinf(theta / 2);
+  const float cps = cosf(psi / 2), sps = sinf(psi / 2);
+  ukf_U.q[0] = cph * cth * cps + sph * sth * sps;
+  ukf_U.q[1] = sph * cth * cps - cph * sth * sps;
+  ukf_U.q[2] = cph * sth * cps + sph * cth * sps;
+  ukf_U.q[3] = cph * cth * sps - sph * sth * cps;
+  ukf_U.rates[0] = noise(0.02f);
+  ukf_U.rates[1] = omega * sinf(phi) + noise(0.02f);
+  ukf_U.rates[2] = omega * cosf(phi) + noise(0.02f);
+  ukf_U.accel[0] = noise(0.3f);
+  ukf_U.accel[1] = noise(0.3f);
+  ukf_U.accel[2] = noise(0.3f);
+  // ground speed: air velocity rotated to NED plus wind
+  const float cp = cosf(psi), sp = sinf(psi);
+  const float cf = cosf(phi), sf = sinf(phi), ct = cosf(theta), st = sinf(theta);
+  const float an = ct * cp * u + (sf * st * cp - cf * sp) * v + (cf * st * cp + sf * sp) * w;
+  const float ae = ct * sp * u + (sf * st * sp + cf * cp) * v + (cf * st * sp - sf * cp) * w;
+  const float ad = -st * u + sf * ct * v + cf * ct * w;
+  ukf_U.vk[0] = an + wind[0] + noise(0.2f);
+  ukf_U.vk[1] = ae + wind[1] + noise(0.2f);
+  ukf_U.vk[2] = ad + wind[2] + noise(0.2f);
+  ukf_U.va = 1.05f * V + noise(0.3f);
+  ukf_U.aoa = alpha + noise(0.005f);
+  ukf_U.sideslip = beta + noise(0.005f);
+}
+
+/** read the inputs of a wind estimator log line, returns the time in ms or -1 */
+static long log_input(FILE *f)
+{
+  char line[1024];
+  while (fgets(line, sizeof(line), f) != NULL) {
+    if (line[0] == '#' || line[0] == 'p') {
+      continue;
+    }
+    float in[16];
+    char *p = line, *end;
+    int n = 0;
+    for (; n < 16; n++) {
+      in[n] = strtof(p, &end);
+      if (end == p) { break; }
+      p = end;
+    }
+    if (n < 16) {
+      continue;
+    }
+    // skip outputs, last column is the time
+    long t = -1;
+    for (;;) {
+      long v = strtol(p, &end, 10);
+      if (end == p) { break; }
+      t = v;
+      // jump to the next field
+      p = end;
+      while (*p != '\0' && *p != ' ' && *p != '\n') { p++; }
+    }
+    memcpy(ukf_U.rates, &in[0], 3 * sizeof(float));
+    memcpy(ukf_U.accel, &in[3], 3 * sizeof(float));
+    memcpy(ukf_U.q, &in[6], 4 * sizeof(float));
+    memcpy(ukf_U.vk, &in[10], 3 * sizeof(float));
+    ukf_U.va = in[13];
+    ukf_U.aoa = in[14];
+    ukf_U.sideslip = in[15];
+    return t;
+  }
+  return -1;
+}
+
+static float rel_err(float a, float b)
+{
+  return fabsf(a - b) / (1.f + fabsf(b));
+}
+
+int main(int argc, char **argv)
+{
+  int n = 20000;
+  char *log_file = NULL;
+  float tol = 1e-3f;
+  for (int i = 1; i < argc - 1; i++) {
+    if (strcmp(argv[i], "-n") == 0) { n = atoi(argv[++i]); }
+    else if (strcmp(argv[i], "-f") == 0) { log_file = argv[++i]; }
+    else if (strcmp(argv[i], "-t") == 0) { tol = atof(argv[++i]); }
+  }
+
+  FILE *f = NULL;
+  if (log_file != NULL) {
+    f = fopen(log_file, "r");
+    if (f == NULL) {
+      printf("can't read %s\n", log_file);
+      return 1;
+    }
+  }
+
+  init_params();
+  UKF_Wind_Estimator_initialize();
+  struct WeUkf ukf;
+  we_ukf_init(&ukf);
+  ExtY out;
+
+  srand(0);
+  double t_gen = 0., t_fast = 0.;
+  float err_x = 0.f, err_p = 0.f;
+  long last_t = -1;
+  int nb = 0;
+  for (int k = 0; k < n; k++) {
+    if (f != NULL) {
+      long t = log_input(f);
+      if (t < 0) { break; }
+      ukf_params.dt = (last_t < 0 || t <= last_t) ? 0.1f : (t - last_t) / 1000.f;
+      last_t = t;
+      if (ukf_U.va <= 5.f) { continue; }
+    } else {
+      synthetic_input(k, ukf_params.dt);
+    }
+
+    double t0 = now_s();
+    UKF_Wind_Estimator_step();
+    double t1 = now_s();
+    we_ukf_step(&ukf, &ukf_init, &ukf_params, &ukf_U, &out);
+    double t2 = now_s();
+    t_gen += t1 - t0;
+    t_fast += t2 - t1;
+    nb++;
+
+    for (int i = 0; i < 7; i++) {
+      err_x = fmaxf(err_x, rel_err(out.xout[i], ukf_Y.xout[i]));
+    }
+    for (int i = 0; i < 49; i++) {
+      err_p = fmaxf(err_p, rel_err(out.Pout[i], ukf_Y.Pout[i]));
+    }
+  }
+  if (f != NULL) {
+    fclose(f);
+  }
+
+  printf("%d steps\n", nb);
+  printf("generated   %8.0f ns/step\n", 1e9 * t_gen / nb);
+  printf("hand written %7.0f ns/step (x%.1f)\n", 1e9 * t_fast / nb, t_gen / t_fast);
+  printf("wind generated %.3f %.3f %.3f, hand written %.3f %.3f %.3f\n",
+         ukf_Y.xout[3], ukf_Y.xout[4], ukf_Y.xout[5], out.xout[3], out.xout[4], out.xout[5]);
+  printf("max relative difference: state %.2e, covariance factor %.2e\n", err_x, err_p);
+  bool ok = nb > 0 && err_x < tol && err_p < tol;
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
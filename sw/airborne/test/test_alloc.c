@@ -29,12 +29,15 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
 #include "std.h"
 #include "firmwares/rotorcraft/stabilization/wls/wls_alloc.h"
 
 #define INDI_OUTPUTS 4
 
 void test_overdetermined(void);
+bool test_warm_start(void);
 void calc_nu_out(float** Bwls, float* du, float* nu_out);
 
 int main(int argc, char **argv)
@@ -43,6 +46,7 @@ int main(int argc, char **argv)
   test_overdetermined();
 /*#define INDI_NUM_ACT 4*/
   /*test_four_by_four();*/
+  return test_warm_start() ? 0 : 1;
 }
 
 /*
@@ -151,6 +155,98 @@ void test_overdetermined(void)
   printf("u = %f, %f, %f, %f, %f, %f\n", indi_du[0]+u_c[0], indi_du[1]+u_c[1], indi_du[2]+u_c[2], indi_du[3]+u_c[3], indi_du[4]+u_c[4], indi_du[5]+u_c[5]);
   printf("nu_in = %f, %f, %f, %f\n", indi_v[0], indi_v[1], indi_v[2], indi_v[3]);
   printf("nu_out = %f, %f, %f, %f\n", nu_out[0], nu_out[1], nu_out[2], nu_out[3]);
+
+}
+
+static float rand_range(float min, float max)
+{
+  return min + (max - min) * (float)rand() / (float)RAND_MAX;
+}
+
+/*
+ * Cost of an allocation: ||gamma*Wv*(B*du - v)||^2 + ||du - du_pref||^2
+ */
+static double wls_cost(float** Bwls, float* v, float* Wv, float* up, float gamma_sq, float* du)
+{
+  double cost = 0.;
+  for (int i = 0; i < INDI_OUTPUTS; i++) {
+    double r = -v[i];
+    for (int j = 0; j < INDI_NUM_ACT; j++) {
+      r += Bwls[i][j] * du[j];
+    }
+    r *= gamma_sq * Wv[i];
+    cost += r * r;
+  }
+  for (int j = 0; j < INDI_NUM_ACT; j++) {
+    cost += (du[j] - up[j]) * (du[j] - up[j]);
+  }
+  return cost;
+}
+
+/*
+ * Random allocation problems solved in sequence as in the INDI loop, the
+ * working set of the previous cycle warm starts the next one. The warm
+ * started solution, also with an out of bounds initial guess, must cost
+ * the same as the cold started one.
+ */
+bool test_warm_start(void)
+{
+#define WARM_START_CYCLES 5000
+  float g1g2[INDI_OUTPUTS][INDI_NUM_ACT];
+  float *Bwls[INDI_OUTPUTS];
+  float v[INDI_OUTPUTS], Wv[INDI_OUTPUTS];
+  float du_min[INDI_NUM_ACT], du_max[INDI_NUM_ACT], u_p[INDI_NUM_ACT], u_guess[INDI_NUM_ACT];
+  float du_cold[INDI_NUM_ACT], du_warm[INDI_NUM_ACT], du_guess[INDI_NUM_ACT];
+  float W_ws[INDI_NUM_ACT] = {0};
+  float W_guess[INDI_NUM_ACT] = {0};
+  float gamma_sq = 10000;
+  int nb_bad = 0;
+  double worst = 1.;
+
+  srand(42);
+  for (int i = 0; i < INDI_OUTPUTS; i++) {
+    Bwls[i] = g1g2[i];
+  }
+  for (int cycle = 0; cycle < WARM_START_CYCLES; cycle++) {
+    // new effectiveness from time to time, slowly varying otherwise
+    for (int i = 0; i < INDI_OUTPUTS; i++) {
+      for (int j = 0; j < INDI_NUM_ACT; j++) {
+        if (cycle % 50 == 0) {
+          g1g2[i][j] = rand_range(-0.02, 0.02);
+        } else {
+          g1g2[i][j] += rand_range(-0.0005, 0.0005);
+        }
+      }
+      v[i] = rand_range(-300, 300);
+      Wv[i] = (i == INDI_OUTPUTS - 1) ? 1 : rand_range(1, 100);
+    }
+    for (int j = 0; j < INDI_NUM_ACT; j++) {
+      float u_c = rand_range(1000, 8600);
+      du_min[j] = -u_c;
+      du_max[j] = 9600 - u_c;
+      u_p[j] = du_min[j];
+      u_guess[j] = rand_range(-20000, 20000);
+    }
+
+    int n_cold = wls_alloc(du_cold, v, du_min, du_max, Bwls, 0, 0, Wv, 0, u_p, gamma_sq, 100);
+    int n_warm = wls_alloc(du_warm, v, du_min, du_max, Bwls, 0, W_ws, Wv, 0, u_p, gamma_sq, 100);
+    int n_guess = wls_alloc(du_guess, v, du_min, du_max, Bwls, u_guess, W_guess, Wv, 0, u_p, gamma_sq, 100);
+
+    double cost_cold = wls_cost(Bwls, v, Wv, u_p, gamma_sq, du_cold);
+    double cost_warm = wls_cost(Bwls, v, Wv, u_p, gamma_sq, du_warm);
+    double cost_guess = wls_cost(Bwls, v, Wv, u_p, gamma_sq, du_guess);
+    double tol = 1e-3 * cost_cold + 1.;
+    if (n_cold < 0 || n_warm < 0 || n_guess < 0
+        || fabs(cost_warm - cost_cold) > tol || fabs(cost_guess - cost_cold) > tol) {
+      nb_bad++;
+    }
+    if (cost_warm / cost_cold > worst) { worst = cost_warm / cost_cold; }
+    if (cost_guess / cost_cold > worst) { worst = cost_guess / cost_cold; }
+  }
+
+  printf("warm start: %d/%d cycles with a different cost, worst cost ratio %f\n", nb_bad, WARM_START_CYCLES, worst);
+  printf("%s\n", nb_bad == 0 ? "OK" : "FAILED");
+  return nb_bad == 0;
 }
 
 /*
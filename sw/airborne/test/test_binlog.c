@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_binlog.c
+ *
+ * Write a binary log with both codecs, read it back and compare, then
+ * corrupt the file and check that the reader skips the damaged block.
+ *
+ * make test_binlog && ./test_binlog [-n nb_records]
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "modules/loggers/binlog.h"
+
+static const struct BinlogColumn cols[] = {
+  { "seq", BINLOG_U32 },
+  { "phi", BINLOG_F32 },
+  { "theta", BINLOG_F32 },
+  { "alt", BINLOG_F64 },
+  { "cmd", BINLOG_I16 },
+  { "mode", BINLOG_U8 },
+};
+#define NB_COLS (sizeof(cols) / sizeof(cols[0]))
+
+struct Row {
+  uint32_t seq;
+  float phi, theta;
+  double alt;
+  int16_t cmd;
+  uint8_t mode;
+};
+
+static void make_row(uint32_t i, struct Row *r)
+{
+  r->seq = i;
+  r->phi = sinf(i * 0.01f);
+  r->theta = 0.1f;
+  r->alt = 100. + (i / 512) * 0.5;
+  r->cmd = (int16_t)(i % 9600);
+  r->mode = 2;
+}
+
+static double now_us(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec * 1e-3;
+}
+
+/** write n records at about 512 Hz in fast forward, returns the max producer time */
+static double write_log(const char *file, uint32_t n, uint8_t codec, struct Binlog *log)
+{
+  if (binlog_open(log, file, cols, NB_COLS, 4096, codec) < 0) {
+    printf("can't open %s\n", file);
+    exit(1);
+  }
+  double max_us = 0.;
+  const struct timespec pause = { 0, 20000 };
+  for (uint32_t i = 0; i < n; i++) {
+    struct Row r;
+    make_row(i, &r);
+    double t0 = now_us();
+    uint8_t *p = binlog_reserve(log, (uint64_t)i * 1953);
+    if (p != NULL) {
+      memcpy(p, &r.seq, 4);
+      memcpy(p + 4, &r.phi, 4);
+      memcpy(p + 8, &r.theta, 4);
+      memcpy(p + 12, &r.alt, 8);
+      memcpy(p + 20, &r.cmd, 2);
+      p[22] = r.mode;
+      binlog_commit(log);
+    }
+    double dt = now_us() - t0;
+    if (dt > max_us) {
+      max_us = dt;
+    }
+    if (i % 64 == 0) {
+      nanosleep(&pause, NULL);
+    }
+  }
+  binlog_close(log);
+  return max_us;
+}
+
+/** read back, returns the number of good records or -1 on mismatch */
+static int read_log(const char *file, uint32_t *nb_corrupted)
+{
+  struct BinlogReader r;
+  if (binlog_reader_open(&r, file) < 0 || r.nb_cols != NB_COLS || r.record_size != 31) {
+    printf("bad header\n");
+    return -1;
+  }
+  for (uint16_t i = 0; i < NB_COLS; i++) {
+    if (strcmp(r.cols[i].name, cols[i].name) != 0 || r.cols[i].type != cols[i].type) {
+      printf("bad column %d\n", i);
+      return -1;
+    }
+  }
+  const uint8_t *rec;
+  int nb = 0;
+  int64_t last = -1;
+  while ((rec = binlog_reader_next(&r)) != NULL) {
+    uint64_t t;
+    struct Row got, exp;
+    memcpy(&t, rec, 8);
+    memcpy(&got.seq, rec + r.offsets[0], 4);
+    memcpy(&got.phi, rec + r.offsets[1], 4);
+    memcpy(&got.theta, rec + r.offsets[2], 4);
+    memcpy(&got.alt, rec + r.offsets[3], 8);
+    memcpy(&got.cmd, rec + r.offsets[4], 2);
+    got.mode = rec[r.offsets[5]];
+    make_row(got.seq, &exp);
+    if ((int64_t)got.seq <= last || t != (uint64_t)got.seq * 1953 || got.phi != exp.phi || got.theta != exp.theta ||
+        got.alt != exp.alt || got.cmd != exp.cmd || got.mode != exp.mode) {
+      printf("bad record %u\n", got.seq);
+      binlog_reader_close(&r);
+      return -1;
+    }
+    last = got.seq;
+    nb++;
+  }
+  *nb_corrupted = r.nb_corrupted;
+  binlog_reader_close(&r);
+  return nb;
+}
+
+static long file_size(const char *file)
+{
+  FILE *f = fopen(file, "rb");
+  if (f == NULL) {
+    return -1;
+  }
+  fseek(f, 0, SEEK_END);
+  long s = ftell(f);
+  fclose(f);
+  return s;
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t n = 200000;
+  for (int i = 1; i < argc - 1; i++) {
+    if (strcmp(argv[i], "-n") == 0) { n = atoi(argv[++i]); }
+  }
+  const char *file = "test_binlog.bin";
+  bool ok = true;
+
+  for (uint8_t codec = BINLOG_CODEC_RAW; codec <= BINLOG_CODEC_DELTA; codec++) {
+    struct Binlog log;
+    double max_us = write_log(file, n, codec, &log);
+    uint32_t nb_corrupted = 0;
+    int nb = read_log(file, &nb_corrupted);
+    printf("%s: %u records, %u dropped, %d read back, file %ld bytes (%.0f%% of raw), "
+           "max producer time %.1f us, max write %u us\n",
+           codec == BINLOG_CODEC_RAW ? "raw  " : "delta", log.nb_records, log.nb_dropped, nb, file_size(file),
+           100. * log.nb_file_bytes / (log.nb_raw_bytes > 0 ? log.nb_raw_bytes : 1), max_us, log.max_write_us);
+    if (nb < 0 || (uint32_t)nb != log.nb_records || log.nb_records + log.nb_dropped != n || nb_corrupted != 0) {
+      ok = false;
+    }
+  }
+
+  // damage a block in the middle of the file, the others must still be read
+  long size = file_size(file);
+  int fd = open(file, O_RDWR);
+  uint8_t junk[64];
+  memset(junk, 0x55, sizeof(junk));
+  if (fd < 0 || pwrite(fd, junk, sizeof(junk), size / 2) != sizeof(junk)) {
+    ok = false;
+  }
+  close(fd);
+  uint32_t nb_corrupted = 0;
+  int nb = read_log(file, &nb_corrupted);
+  printf("corrupted file: %d records read back, %u corrupted region\n", nb, nb_corrupted);
+  if (nb <= 0 || (uint32_t)nb >= n || nb_corrupted != 1) {
+    ok = false;
+  }
+  unlink(file);
+
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_delayed_fusion.c
+ *
+ * Delayed GPS altitude fused in the extended vertical filter.
+ *
+ * The filter runs three times on the same vertical motion, with baro
+ * updates in real time and GPS altitude measurements received with a lag:
+ * - reference: the GPS is fused at the measurement time, as if not delayed,
+ * - current: the GPS is fused when received, as if it was current,
+ * - delayed: the GPS is fused with delayed_fusion rewind and replay.
+ * The delayed run must give the same result as the reference one.
+ *
+ * make test_delayed_fusion && ./test_delayed_fusion
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "subsystems/ins/vf_extended_float.h"
+#include "subsystems/ins/delayed_fusion.h"
+
+#define FREQ 500
+#define NB_STEPS (10 * FREQ)
+#define BARO_DECIM 10
+#define GPS_DECIM 100
+#define GPS_LAG 60
+#define GPS_R 0.5f
+#define HIST_SIZE 64
+#define ACCEL_BIAS 0.3f
+
+enum Run { RUN_REFERENCE, RUN_CURRENT, RUN_DELAYED, NB_RUNS };
+
+static const char *run_names[NB_RUNS] = { "reference", "current", "delayed" };
+
+struct Step {
+  float accel;
+  float dt;
+  bool baro;
+  float baro_z;
+};
+
+DELAYED_FUSION_DECLARE(hist, struct VffExtended, struct Step, HIST_SIZE);
+static struct DelayedFusion df;
+
+static void replay_step(void *state __attribute__((unused)), const void *input)
+{
+  const struct Step *s = (const struct Step *)input;
+  vff_propagate(s->accel, s->dt);
+  if (s->baro) {
+    vff_update_baro(s->baro_z);
+  }
+}
+
+/** vertical motion, z down */
+static float true_z(int k)
+{
+  const float t = (float)k / FREQ;
+  return -10.f - 5.f * sinf(2.f * (float)M_PI * 0.2f * t);
+}
+
+static float true_zdotdot(int k)
+{
+  const float t = (float)k / FREQ;
+  const float w = 2.f * (float)M_PI * 0.2f;
+  return 5.f * w * w * sinf(w * t);
+}
+
+/** deterministic baro noise */
+static float baro_noise(int k)
+{
+  return 0.3f * sinf(12.9898f * k) + 0.2f * cosf(78.233f * k);
+}
+
+static float run(enum Run r, float *rms)
+{
+  const float dt = 1.f / FREQ;
+  vff_init(true_z(0), 0.f, 0.f, 0.f, 0.f);
+  DELAYED_FUSION_INIT(&df, hist, replay_step);
+  double err2 = 0.;
+
+  for (int k = 0; k < NB_STEPS; k++) {
+    const uint32_t stamp = (uint32_t)k * (1000000 / FREQ);
+    // GPS measured at step m is received at step m + GPS_LAG
+    if (r == RUN_REFERENCE && k % GPS_DECIM == 0) {
+      vff_update_z_conf(true_z(k), GPS_R);
+    } else if (k >= GPS_LAG && (k - GPS_LAG) % GPS_DECIM == 0) {
+      const int m = k - GPS_LAG;
+      if (r == RUN_DELAYED) {
+        if (delayed_fusion_rewind(&df, (uint32_t)m * (1000000 / FREQ), 100, &vff)) {
+          vff_update_z_conf(true_z(m), GPS_R);
+          delayed_fusion_replay(&df, &vff);
+        }
+      } else if (r == RUN_CURRENT) {
+        vff_update_z_conf(true_z(m), GPS_R);
+      }
+    }
+
+    struct Step s = { .accel = true_zdotdot(k) - 9.81f + ACCEL_BIAS, .dt = dt, .baro = false };
+    if (r == RUN_DELAYED) {
+      delayed_fusion_push(&df, stamp, &vff, &s);
+    }
+    vff_propagate(s.accel, s.dt);
+    if (k % BARO_DECIM == 0) {
+      const float z = true_z(k + 1) + 2.f + baro_noise(k);
+      vff_update_baro(z);
+      if (r == RUN_DELAYED) {
+        struct Step *last = (struct Step *)delayed_fusion_last_input(&df);
+        last->baro = true;
+        last->baro_z = z;
+      }
+    }
+    const float e = vff.z - true_z(k + 1);
+    err2 += e * e;
+  }
+  *rms = sqrtf((float)(err2 / NB_STEPS));
+  return vff.z;
+}
+
+int main(void)
+{
+  bool ok = true;
+  float z[NB_RUNS], rms[NB_RUNS];
+  struct VffExtended final[NB_RUNS];
+  for (int r = 0; r < NB_RUNS; r++) {
+    z[r] = run(r, &rms[r]);
+    final[r] = vff;
+    printf("%-10s final z %.6f, rms z error %.4f m\n", run_names[r], z[r], rms[r]);
+  }
+  printf("%u delayed measurements fused, %u missed\n", df.nb_fused, df.nb_missed);
+
+  // replaying the same operations gives the same filter
+  ok &= (memcmp(&final[RUN_REFERENCE], &final[RUN_DELAYED], sizeof(struct VffExtended)) == 0);
+  ok &= (df.nb_missed == 0 && df.nb_fused == (NB_STEPS - GPS_LAG - 1) / GPS_DECIM + 1);
+  ok &= (rms[RUN_DELAYED] < rms[RUN_CURRENT]);
+
+  // measurements older than the history or far from any state are rejected
+  struct VffExtended before = vff;
+  ok &= !delayed_fusion_rewind(&df, 0, 100, &vff);
+  ok &= !delayed_fusion_rewind(&df, (NB_STEPS - 10) * (1000000 / FREQ) + 1000, 100, &vff);
+  ok &= (memcmp(&before, &vff, sizeof(struct VffExtended)) == 0);
+  ok &= (delayed_fusion_replay(&df, &vff) == 0);
+  // the oldest stored state is still reachable
+  ok &= delayed_fusion_rewind(&df, (NB_STEPS - HIST_SIZE) * (1000000 / FREQ), 0, &vff);
+  ok &= (delayed_fusion_replay(&df, &vff) == HIST_SIZE);
+  ok &= (memcmp(&before, &vff, sizeof(struct VffExtended)) == 0);
+
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_fast_transport.c
+ *
+ * Frames of pprz_fast_transport against the ones of pprz_transport.
+ *
+ * Messages are sent the way the generated pprzlink code does (header bytes
+ * with put_named_byte, fields with put_bytes) through both transports over
+ * a mock link_device that records the bytes. Checks that:
+ * - the frames are byte identical for all payload lengths, with random
+ *   payloads split in fields of random sizes,
+ * - a message longer than the frame buffer is dropped and counted as an
+ *   overrun instead of being written past the buffer, and still releases
+ *   the device, which is locked from check_free_space to send_message
+ *   like the ChibiOS UART.
+ *
+ * Needs the pprzlink C library (make pprzlink_protocol):
+ * make test_fast_transport && ./test_fast_transport
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pprzlink/pprz_transport.h"
+#include "modules/datalink/pprz_fast_transport.h"
+
+#define NB_RUNS 100
+
+/** mock device, records the bytes of the sent messages */
+struct mock_dev {
+  uint8_t buf[4096];
+  uint16_t len;
+  uint16_t nb_msgs;
+  bool locked;        ///< locked by check_free_space until send_message
+  uint16_t nb_deadlocks;
+};
+
+static int mock_check_free_space(void *p, long *fd __attribute__((unused)), uint16_t len)
+{
+  struct mock_dev *m = (struct mock_dev *)p;
+  if (m->locked) {
+    // the next message would wait forever for the lock
+    m->nb_deadlocks++;
+    return 0;
+  }
+  if (m->len + len <= (int)sizeof(m->buf)) {
+    m->locked = true;
+    return 1;
+  }
+  return 0;
+}
+
+static void mock_put_byte(void *p, long fd __attribute__((unused)), uint8_t b)
+{
+  struct mock_dev *m = (struct mock_dev *)p;
+  m->buf[m->len++] = b;
+}
+
+static void mock_put_buffer(void *p, long fd __attribute__((unused)), const uint8_t *b, uint16_t len)
+{
+  struct mock_dev *m = (struct mock_dev *)p;
+  memcpy(&m->buf[m->len], b, len);
+  m->len += len;
+}
+
+static void mock_send_message(void *p, long fd __attribute__((unused)))
+{
+  struct mock_dev *m = (struct mock_dev *)p;
+  m->nb_msgs++;
+  m->locked = false;
+}
+
+static void mock_init(struct mock_dev *m, struct link_device *dev)
+{
+  memset(m, 0, sizeof(struct mock_dev));
+  memset(dev, 0, sizeof(struct link_device));
+  dev->check_free_space = mock_check_free_space;
+  dev->put_byte = mock_put_byte;
+  dev->put_buffer = mock_put_buffer;
+  dev->send_message = mock_send_message;
+  dev->periph = (void *)m;
+}
+
+/** Send a message like the generated code, the payload is split in fields of the given sizes */
+static void send_msg(struct transport_tx *trans, struct link_device *dev, uint8_t msg_id,
+                     const uint8_t *payload, uint16_t len, const uint8_t *fields, uint8_t nb_fields)
+{
+  long fd = 0;
+  struct pprzlink_msg msg = { trans, dev, 1, 0, 0 };
+  // sender, receiver, class/component and message id
+  uint8_t size = trans->size_of(&msg, (uint8_t)(len + 4));
+  if (!trans->check_available_space(&msg, &fd, size)) {
+    trans->overrun(&msg);
+    return;
+  }
+  trans->count_bytes(&msg, size);
+  trans->start_message(&msg, fd, (uint8_t)(len + 4));
+  trans->put_named_byte(&msg, 0, DL_TYPE_UINT8, DL_FORMAT_SCALAR, msg.sender_id, "sender_id");
+  trans->put_named_byte(&msg, 0, DL_TYPE_UINT8, DL_FORMAT_SCALAR, msg.receiver_id, "receiver_id");
+  trans->put_named_byte(&msg, 0, DL_TYPE_UINT8, DL_FORMAT_SCALAR, 0x01, "class_id");
+  trans->put_named_byte(&msg, 0, DL_TYPE_UINT8, DL_FORMAT_SCALAR, msg_id, "msg_id");
+  uint16_t idx = 0;
+  for (uint8_t f = 0; f < nb_fields && idx < len; f++) {
+    uint16_t n = (idx + fields[f] <= len) ? fields[f] : len - idx;
+    trans->put_bytes(&msg, 0, DL_TYPE_UINT8, DL_FORMAT_ARRAY, &payload[idx], n);
+    idx += n;
+  }
+  if (idx < len) {
+    trans->put_bytes(&msg, 0, DL_TYPE_UINT8, DL_FORMAT_ARRAY, &payload[idx], len - idx);
+  }
+  trans->end_message(&msg, fd);
+}
+
+int main(void)
+{
+  struct pprz_transport pprz_tp;
+  struct pprz_fast_transport fast_tp;
+  struct mock_dev ref_mock, fast_mock;
+  struct link_device ref_dev, fast_dev;
+  uint8_t payload[300];
+  uint8_t fields[64];
+  bool ok = true;
+  int nb_frames = 0, nb_diff = 0;
+
+  pprz_transport_init(&pprz_tp);
+  pprz_fast_transport_init(&fast_tp);
+  srand(42);
+
+  // all the payload lengths that fit in a frame (the header takes 4 bytes)
+  for (int run = 0; run < NB_RUNS; run++) {
+    for (uint16_t len = 0; len + 8 <= 255; len++) {
+      for (uint16_t i = 0; i < len; i++) {
+        payload[i] = (uint8_t)rand();
+      }
+      uint8_t nb_fields = (uint8_t)(rand() % 64);
+      for (uint8_t f = 0; f < nb_fields; f++) {
+        fields[f] = (uint8_t)(1 + rand() % 8);
+      }
+      uint8_t msg_id = (uint8_t)rand();
+
+      mock_init(&ref_mock, &ref_dev);
+      mock_init(&fast_mock, &fast_dev);
+      send_msg(&pprz_tp.trans_tx, &ref_dev, msg_id, payload, len, fields, nb_fields);
+      send_msg(&fast_tp.trans_tx, &fast_dev, msg_id, payload, len, fields, nb_fields);
+      nb_frames++;
+
+      if (ref_mock.len != len + 8 || fast_mock.len != ref_mock.len ||
+          memcmp(ref_mock.buf, fast_mock.buf, ref_mock.len) != 0 ||
+          fast_mock.nb_msgs != 1 || fast_dev.nb_bytes != ref_dev.nb_bytes || fast_dev.nb_ovrn != 0 ||
+          fast_mock.locked || ref_mock.locked) {
+        if (nb_diff++ < 5) {
+          printf("frame of payload %u differs: %u / %u bytes\n", len, ref_mock.len, fast_mock.len);
+        }
+        ok = false;
+      }
+    }
+  }
+  printf("%d frames, %d different\n", nb_frames, nb_diff);
+
+  // payload too long for the length field and for the frame buffer
+  mock_init(&fast_mock, &fast_dev);
+  memset(payload, 0x55, sizeof(payload));
+  send_msg(&fast_tp.trans_tx, &fast_dev, 1, payload, 260, fields, 0);
+  if (fast_mock.len != 0 || fast_dev.nb_ovrn != 1) {
+    printf("oversized message not dropped: %u bytes sent, %u overruns\n", fast_mock.len, fast_dev.nb_ovrn);
+    ok = false;
+  }
+  if (fast_mock.locked) {
+    printf("device still locked after an oversized message\n");
+    ok = false;
+  }
+  // the next message is sent normally
+  send_msg(&fast_tp.trans_tx, &fast_dev, 1, payload, 10, fields, 0);
+  if (fast_mock.len != 18 || fast_mock.nb_deadlocks != 0 || fast_mock.locked) {
+    printf("message after an oversized one not sent\n");
+    ok = false;
+  }
+
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
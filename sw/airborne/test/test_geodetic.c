@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_geodetic.c
+ *
+ * Accuracy and throughput of the batched geodetic conversions of
+ * pprz_geodetic_batch_double.h against the scalar double functions.
+ *
+ * make test_geodetic && ./test_geodetic [nb_points]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "math/pprz_geodetic_double.h"
+#include "math/pprz_geodetic_batch_double.h"
+
+static double now_s(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static double rand_range(double min, double max)
+{
+  return min + (max - min) * (double)rand() / (double)RAND_MAX;
+}
+
+static double max_abs_diff(double *a, double *b, int n)
+{
+  double err = 0.;
+  for (int i = 0; i < n; i++) {
+    double e = fabs(a[i] - b[i]);
+    if (e > err) { err = e; }
+  }
+  return err;
+}
+
+static void print_speed(const char *name, double t_scalar, double t_batch, int n)
+{
+  printf("%-22s %9.1f ns %9.1f ns  x%5.2f\n", name, 1e9 * t_scalar / n, 1e9 * t_batch / n, t_scalar / t_batch);
+}
+
+#define NB_ARRAYS 12
+
+int main(int argc, char **argv)
+{
+  int n = 100000;
+  if (argc > 1) {
+    n = atoi(argv[1]);
+  }
+  srand(0);
+
+  double *buf[NB_ARRAYS];
+  for (int i = 0; i < NB_ARRAYS; i++) {
+    buf[i] = malloc(n * sizeof(double));
+  }
+  struct LlaCoorArray_d lla = { buf[0], buf[1], buf[2] };
+  struct EcefCoorArray_d ecef = { buf[3], buf[4], buf[5] };
+  struct LlaCoorArray_d lla_ref = { buf[6], buf[7], buf[8] };
+  struct NedCoorArray_d ned = { buf[9], buf[10], buf[11] };
+  struct NedCoorArray_d ned_ref = { buf[6], buf[7], buf[8] };
+  struct EcefCoorArray_d ecef_back = { buf[0], buf[1], buf[2] };
+
+  struct LlaCoor_d origin = { RadOfDeg(43.56), RadOfDeg(1.48), 150. };
+  struct LtpDef_d def;
+  ltp_def_from_lla_d(&def, &origin);
+
+  // random points from below the surface to 1000 km of altitude
+  for (int i = 0; i < n; i++) {
+    lla.lat[i] = rand_range(-M_PI_2, M_PI_2);
+    lla.lon[i] = rand_range(-M_PI, M_PI);
+    lla.alt[i] = rand_range(-1000., 1000000.);
+  }
+
+  bool ok = true;
+  printf("conversion              scalar      batch     speedup\n");
+
+  // ECEF of LLA
+  double t0 = now_s();
+  for (int i = 0; i < n; i++) {
+    struct LlaCoor_d l = { lla.lat[i], lla.lon[i], lla.alt[i] };
+    struct EcefCoor_d e;
+    ecef_of_lla_d(&e, &l);
+    ned.x[i] = e.x;
+    ned.y[i] = e.y;
+    ned.z[i] = e.z;
+  }
+  double t_scalar = now_s() - t0;
+  t0 = now_s();
+  ecef_of_lla_array_d(&ecef, &lla, n);
+  double t_batch = now_s() - t0;
+  print_speed("ecef_of_lla", t_scalar, t_batch, n);
+  double err = max_abs_diff(ned.x, ecef.x, n) + max_abs_diff(ned.y, ecef.y, n) + max_abs_diff(ned.z, ecef.z, n);
+  ok &= err < 1e-6;
+
+  // LLA of ECEF, exact closed form against fast Bowring
+  t0 = now_s();
+  for (int i = 0; i < n; i++) {
+    struct EcefCoor_d e = { ecef.x[i], ecef.y[i], ecef.z[i] };
+    struct LlaCoor_d l;
+    lla_of_ecef_d(&l, &e);
+    lla_ref.lat[i] = l.lat;
+    lla_ref.lon[i] = l.lon;
+    lla_ref.alt[i] = l.alt;
+  }
+  t_scalar = now_s() - t0;
+  struct LlaCoorArray_d lla_fast = { ned.x, ned.y, ned.z };
+  t0 = now_s();
+  lla_of_ecef_array_d(&lla_fast, &ecef, n);
+  t_batch = now_s() - t0;
+  print_speed("lla_of_ecef", t_scalar, t_batch, n);
+  double err_lat_ref = max_abs_diff(lla_ref.lat, lla.lat, n);
+  double err_alt_ref = max_abs_diff(lla_ref.alt, lla.alt, n);
+  double err_lat_fast = max_abs_diff(lla_fast.lat, lla.lat, n);
+  double err_lon_fast = max_abs_diff(lla_fast.lon, lla.lon, n);
+  double err_alt_fast = max_abs_diff(lla_fast.alt, lla.alt, n);
+  printf("  round trip error: exact lat %.2e rad alt %.2e m, fast lat %.2e rad lon %.2e rad alt %.2e m\n",
+         err_lat_ref, err_alt_ref, err_lat_fast, err_lon_fast, err_alt_fast);
+  ok &= err_lat_fast < 1e-10 && err_lon_fast < 1e-12 && err_alt_fast < 1e-3;
+
+  // NED of ECEF
+  t0 = now_s();
+  for (int i = 0; i < n; i++) {
+    struct EcefCoor_d e = { ecef.x[i], ecef.y[i], ecef.z[i] };
+    struct NedCoor_d nd;
+    ned_of_ecef_point_d(&nd, &def, &e);
+    ned_ref.x[i] = nd.x;
+    ned_ref.y[i] = nd.y;
+    ned_ref.z[i] = nd.z;
+  }
+  t_scalar = now_s() - t0;
+  t0 = now_s();
+  ned_of_ecef_point_array_d(&ned, &def, &ecef, n);
+  t_batch = now_s() - t0;
+  print_speed("ned_of_ecef_point", t_scalar, t_batch, n);
+  err = max_abs_diff(ned_ref.x, ned.x, n) + max_abs_diff(ned_ref.y, ned.y, n) + max_abs_diff(ned_ref.z, ned.z, n);
+  printf("  error %.2e m\n", err);
+  ok &= err < 1e-6;
+
+  // ECEF of NED
+  t0 = now_s();
+  for (int i = 0; i < n; i++) {
+    struct NedCoor_d nd = { ned.x[i], ned.y[i], ned.z[i] };
+    struct EcefCoor_d e;
+    ecef_of_ned_point_d(&e, &def, &nd);
+    ecef_back.x[i] = e.x;
+    ecef_back.y[i] = e.y;
+    ecef_back.z[i] = e.z;
+  }
+  t_scalar = now_s() - t0;
+  t0 = now_s();
+  ecef_of_ned_point_array_d(&ecef_back, &def, &ned, n);
+  t_batch = now_s() - t0;
+  print_speed("ecef_of_ned_point", t_scalar, t_batch, n);
+  err = max_abs_diff(ecef_back.x, ecef.x, n) + max_abs_diff(ecef_back.y, ecef.y, n) + max_abs_diff(ecef_back.z, ecef.z, n);
+  printf("  round trip error %.2e m\n", err);
+  ok &= err < 1e-6;
+
+  // UTM of LLA, points around the origin
+  for (int i = 0; i < n; i++) {
+    lla.lat[i] = origin.lat + rand_range(-0.01, 0.01);
+    lla.lon[i] = origin.lon + rand_range(-0.01, 0.01);
+    lla.alt[i] = rand_range(0., 1000.);
+  }
+  struct UtmCoor_d u = { .zone = 0 };
+  t0 = now_s();
+  for (int i = 0; i < n; i++) {
+    struct LlaCoor_d l = { lla.lat[i], lla.lon[i], lla.alt[i] };
+    utm_of_lla_d(&u, &l);
+    ned_ref.x[i] = u.north;
+    ned_ref.y[i] = u.east;
+  }
+  t_scalar = now_s() - t0;
+  struct UtmCoorArray_d utm = { ned.x, ned.y, ned.z, 0 };
+  t0 = now_s();
+  utm_of_lla_array_d(&utm, &lla, n);
+  t_batch = now_s() - t0;
+  print_speed("utm_of_lla", t_scalar, t_batch, n);
+  err = max_abs_diff(ned_ref.x, utm.north, n) + max_abs_diff(ned_ref.y, utm.east, n);
+  ok &= err < 1e-6;
+
+  for (int i = 0; i < NB_ARRAYS; i++) {
+    free(buf[i]);
+  }
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,409 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_imu_fifo.c
+ *
+ * MPU60x0 FIFO burst reads and IMU batch integration on the host.
+ *
+ * spi_submit is replaced by a mock MPU that fills its FIFO at 8 kHz with
+ * the samples of a coning motion and a constant specific force, while the
+ * driver is polled at 500 Hz. The transactions take bus time, so samples
+ * are written to the FIFO during the reads, and every byte clocked out of
+ * FIFO_R_W is popped. Checks that:
+ * - all samples are received in order, none is lost at 8 kHz, with at
+ *   most two transactions per cycle,
+ * - a misaligned FIFO is reset and the reads recover,
+ * - the coning and sculling corrections reduce the integration errors.
+ *
+ * make test_imu_fifo && ./test_imu_fifo
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "peripherals/mpu60x0_spi.h"
+#include "subsystems/imu/imu_batch.h"
+#include "math/pprz_algebra_double.h"
+
+#define SAMPLE_FREQ 8000
+#define PERIODIC_FREQ 500
+#define SUBSTEPS 32
+#define NB_SAMPLES (2 * SAMPLE_FREQ)
+#define SAMPLE_PERIOD_US (1e6 / SAMPLE_FREQ)
+/** SPI byte time in usec, the MPU60x0 data registers can be read up to 20 MHz */
+#define MOCK_BYTE_US 1.
+
+#define GYRO_SENS_NUM MPU60X0_GYRO_SENS_2000_NUM
+#define GYRO_SENS_DEN MPU60X0_GYRO_SENS_2000_DEN
+#define ACCEL_SENS_NUM MPU60X0_ACCEL_SENS_16G_NUM
+#define ACCEL_SENS_DEN MPU60X0_ACCEL_SENS_16G_DEN
+
+/* coning motion: body rates (A cos(W t), A sin(W t), 0) */
+#define CONING_A 2.
+#define CONING_W (2. * M_PI * 20.)
+
+/** raw samples pushed in the FIFO, to check the decoded ones */
+static int16_t sent[NB_SAMPLES][6];
+static int nb_sent = 0;
+/** index of the first sample pushed after the last FIFO reset */
+static int mock_reset_sample = 0;
+static int next_expected = 0;
+static int last_end = 0;
+
+/** mock MPU */
+static struct {
+  uint8_t regs[128];
+  uint8_t fifo[4096];
+  uint16_t count;
+  uint32_t nb_transactions;
+  uint32_t nb_resets;
+  double time_us;             ///< simulated time
+  double next_sample_us;      ///< time of the next sample
+  bool in_fifo_read;          ///< FIFO data being clocked out
+  uint32_t nb_during_read;    ///< samples written while the FIFO was read
+} mock;
+
+static void push_sample(void);
+
+static bool mock_fifo_enabled(void)
+{
+  return bit_is_set(mock.regs[MPU60X0_REG_USER_CTRL], MPU60X0_FIFO_EN) &&
+         mock.regs[MPU60X0_REG_FIFO_EN] == ((1 << MPU60X0_XG_FIFO_EN) | (1 << MPU60X0_YG_FIFO_EN) |
+                                            (1 << MPU60X0_ZG_FIFO_EN) | (1 << MPU60X0_ACCEL_FIFO_EN));
+}
+
+static void mock_push(int16_t v)
+{
+  if (mock.count + 2 <= (int)sizeof(mock.fifo)) {
+    mock.fifo[mock.count++] = (uint8_t)(v >> 8);
+    mock.fifo[mock.count++] = (uint8_t)(v & 0xFF);
+  }
+}
+
+/** advance the simulated time, the MPU writes its samples meanwhile */
+static void mock_advance(double us)
+{
+  mock.time_us += us;
+  while (nb_sent < NB_SAMPLES && mock.next_sample_us <= mock.time_us) {
+    push_sample();
+    mock.next_sample_us += SAMPLE_PERIOD_US;
+    if (mock.in_fifo_read) {
+      mock.nb_during_read++;
+    }
+  }
+}
+
+/** clock one byte out of FIFO_R_W, an empty FIFO reads 0xFF */
+static uint8_t mock_pop(void)
+{
+  mock_advance(MOCK_BYTE_US);
+  if (mock.count == 0) {
+    return 0xFF;
+  }
+  uint8_t b = mock.fifo[0];
+  memmove(mock.fifo, &mock.fifo[1], --mock.count);
+  return b;
+}
+
+bool spi_submit(struct spi_periph *p __attribute__((unused)), struct spi_transaction *t)
+{
+  uint8_t cmd = t->output_buf[0];
+  uint8_t reg = cmd & ~MPU60X0_SPI_READ;
+  mock.nb_transactions++;
+  mock_advance(MOCK_BYTE_US);
+  if (cmd & MPU60X0_SPI_READ) {
+    memset((uint8_t *)t->input_buf, 0, t->input_length);
+    if (reg == MPU60X0_REG_WHO_AM_I) {
+      t->input_buf[1] = MPU60X0_WHOAMI_REPLY;
+    } else if (reg == MPU60X0_REG_FIFO_COUNT_H) {
+      // count is latched, a longer burst continues on FIFO_R_W and pops the FIFO
+      t->input_buf[1] = (uint8_t)(mock.count >> 8);
+      t->input_buf[2] = (uint8_t)(mock.count & 0xFF);
+      mock_advance(2 * MOCK_BYTE_US);
+      mock.in_fifo_read = true;
+      for (uint16_t i = 3; i < t->input_length; i++) {
+        t->input_buf[i] = mock_pop();
+      }
+      mock.in_fifo_read = false;
+    } else if (reg == MPU60X0_REG_FIFO_R_W) {
+      mock.in_fifo_read = true;
+      for (uint16_t i = 1; i < t->input_length; i++) {
+        t->input_buf[i] = mock_pop();
+      }
+      mock.in_fifo_read = false;
+    }
+  } else {
+    mock_advance(MOCK_BYTE_US);
+    mock.regs[reg] = t->output_buf[1];
+    if (reg == MPU60X0_REG_USER_CTRL && bit_is_set(t->output_buf[1], MPU60X0_FIFO_RESET)) {
+      mock.count = 0;
+      mock.nb_resets++;
+      mock_reset_sample = nb_sent;
+    }
+  }
+  t->status = SPITransSuccess;
+  return true;
+}
+
+/** truth attitude from body to inertial frame, and specific force in inertial frame */
+static struct DoubleQuat truth_q;
+static struct DoubleQuat truth_hist[NB_SAMPLES + 1];
+static const struct DoubleVect3 force_i = { 1., -0.5, -9.81 };
+
+static void rates_at(struct DoubleRates *r, double t)
+{
+  r->p = CONING_A * cos(CONING_W * t);
+  r->q = CONING_A * sin(CONING_W * t);
+  r->r = 0.;
+}
+
+/** Hamilton product c = a * b */
+static void quat_mult(struct DoubleQuat *c, struct DoubleQuat *a, struct DoubleQuat *b)
+{
+  c->qi = a->qi * b->qi - a->qx * b->qx - a->qy * b->qy - a->qz * b->qz;
+  c->qx = a->qi * b->qx + a->qx * b->qi + a->qy * b->qz - a->qz * b->qy;
+  c->qy = a->qi * b->qy - a->qx * b->qz + a->qy * b->qi + a->qz * b->qx;
+  c->qz = a->qi * b->qz + a->qx * b->qy - a->qy * b->qx + a->qz * b->qi;
+}
+
+/** vo = q * v * q^-1 */
+static void quat_rotate(struct DoubleVect3 *vo, struct DoubleQuat *q, const struct DoubleVect3 *v)
+{
+  struct DoubleQuat qv = { 0., v->x, v->y, v->z };
+  struct DoubleQuat qc = { q->qi, -q->qx, -q->qy, -q->qz };
+  struct DoubleQuat tmp, res;
+  quat_mult(&tmp, q, &qv);
+  quat_mult(&res, &tmp, &qc);
+  VECT3_ASSIGN(*vo, res.qx, res.qy, res.qz);
+}
+
+/** body to inertial attitude q, rotated by the rotation vector rv in body frame */
+static void quat_integrate_rot_vect(struct DoubleQuat *q, struct DoubleVect3 *rv)
+{
+  double angle = sqrt(VECT3_NORM2(*rv));
+  struct DoubleQuat dq = { 1., 0., 0., 0. };
+  if (angle > 1e-15) {
+    double s = sin(angle / 2.) / angle;
+    QUAT_ASSIGN(dq, cos(angle / 2.), rv->x * s, rv->y * s, rv->z * s);
+  }
+  struct DoubleQuat tmp;
+  quat_mult(&tmp, q, &dq);
+  *q = tmp;
+  double_quat_normalize(q);
+}
+
+/** advance the truth over one sample, return mean rates and mean body specific force */
+static void truth_step(double t0, double dt, struct DoubleRates *gyro, struct DoubleVect3 *accel)
+{
+  // exact mean of the rates over the sample
+  gyro->p = CONING_A / CONING_W * (sin(CONING_W * (t0 + dt)) - sin(CONING_W * t0)) / dt;
+  gyro->q = -CONING_A / CONING_W * (cos(CONING_W * (t0 + dt)) - cos(CONING_W * t0)) / dt;
+  gyro->r = 0.;
+  VECT3_ASSIGN(*accel, 0., 0., 0.);
+  const double h = dt / SUBSTEPS;
+  for (int k = 0; k < SUBSTEPS; k++) {
+    struct DoubleRates r;
+    rates_at(&r, t0 + (k + 0.5) * h);
+    struct DoubleVect3 rv = { r.p * h, r.q * h, r.r * h };
+    // body specific force at the middle of the substep
+    struct DoubleQuat q_mid = truth_q;
+    struct DoubleVect3 half = { rv.x / 2., rv.y / 2., rv.z / 2. };
+    quat_integrate_rot_vect(&q_mid, &half);
+    struct DoubleVect3 fb;
+    struct DoubleQuat q_inv = { q_mid.qi, -q_mid.qx, -q_mid.qy, -q_mid.qz };
+    quat_rotate(&fb, &q_inv, &force_i);
+    VECT3_ADD_SCALED(*accel, fb, 1. / SUBSTEPS);
+    quat_integrate_rot_vect(&truth_q, &rv);
+  }
+}
+
+static double quat_angle_error(struct DoubleQuat *a, struct DoubleQuat *b)
+{
+  struct DoubleQuat inv = { a->qi, -a->qx, -a->qy, -a->qz };
+  struct DoubleQuat err;
+  quat_mult(&err, &inv, b);
+  return 2. * asin(Min(1., sqrt(err.qx * err.qx + err.qy * err.qy + err.qz * err.qz)));
+}
+
+/** advance the truth by one sample and write it to the FIFO */
+static void push_sample(void)
+{
+  const double dt = 1. / SAMPLE_FREQ;
+  struct DoubleRates gyro;
+  struct DoubleVect3 accel;
+  truth_step(nb_sent * dt, dt, &gyro, &accel);
+  truth_hist[nb_sent + 1] = truth_q;
+  int16_t raw[6] = {
+    (int16_t)lround(accel.x * (1 << INT32_ACCEL_FRAC) * ACCEL_SENS_DEN / ACCEL_SENS_NUM),
+    (int16_t)lround(accel.y * (1 << INT32_ACCEL_FRAC) * ACCEL_SENS_DEN / ACCEL_SENS_NUM),
+    (int16_t)lround(accel.z * (1 << INT32_ACCEL_FRAC) * ACCEL_SENS_DEN / ACCEL_SENS_NUM),
+    (int16_t)lround(gyro.p * (1 << INT32_RATE_FRAC) * GYRO_SENS_DEN / GYRO_SENS_NUM),
+    (int16_t)lround(gyro.q * (1 << INT32_RATE_FRAC) * GYRO_SENS_DEN / GYRO_SENS_NUM),
+    (int16_t)lround(gyro.r * (1 << INT32_RATE_FRAC) * GYRO_SENS_DEN / GYRO_SENS_NUM)
+  };
+  for (int j = 0; j < 6; j++) {
+    mock_push(raw[j]);
+    sent[nb_sent][j] = raw[j];
+  }
+  nb_sent++;
+  // corrupt the FIFO once with a partial sample
+  if (nb_sent == SAMPLE_FREQ / 2) {
+    mock_push(0);
+  }
+}
+
+int main(void)
+{
+  struct spi_periph spi;
+  struct Mpu60x0_Spi mpu;
+  memset(&mock, 0, sizeof(mock));
+  // no sample before the end of the configuration
+  mock.next_sample_us = HUGE_VAL;
+  mpu60x0_spi_init(&mpu, &spi, 0);
+  mpu.config.smplrt_div = 0;
+  mpu.config.dlpf_cfg = MPU60X0_DLPF_256HZ;
+  mpu.config.gyro_range = MPU60X0_GYRO_RANGE_2000;
+  mpu.config.accel_range = MPU60X0_ACCEL_RANGE_16G;
+  mpu.config.fifo_enabled = true;
+
+  bool ok = true;
+  for (int i = 0; i < 100 && !mpu.config.initialized; i++) {
+    mpu60x0_spi_periodic(&mpu);
+    mpu60x0_spi_event(&mpu);
+  }
+  if (!mpu.config.initialized || !mock_fifo_enabled()) {
+    printf("configuration failed\n");
+    return 1;
+  }
+  const float rate = mpu60x0_get_sample_rate(&mpu.config);
+  printf("sample rate %.0f Hz, at most %d samples per read\n", rate, mpu.config.fifo_read_samples);
+  ok &= (rate == SAMPLE_FREQ);
+
+  const uint32_t resets_at_config = mock.nb_resets;
+  const uint32_t transactions_at_config = mock.nb_transactions;
+  int nb_received = 0, nb_mismatch = 0, nb_reads = 0, nb_lost = 0;
+
+  struct DoubleQuat q_corr, q_raw;
+  double att_err_corr = 0., att_err_raw = 0.;
+  double dv_err_corr = 0., dv_err_raw = 0.;
+  int nb_batches = 0;
+
+  // the truth starts with the sampling, after the configuration
+  QUAT_ASSIGN(truth_q, 1., 0., 0., 0.);
+  truth_hist[0] = truth_q;
+  q_corr = truth_q;
+  q_raw = truth_q;
+  mock.count = 0;
+  mock.next_sample_us = mock.time_us + SAMPLE_PERIOD_US;
+
+  const uint32_t period = 1000000 / SAMPLE_FREQ;
+  double next_read_us = mock.time_us + 1e6 / PERIODIC_FREQ;
+  struct ImuBatchInt32 batch;
+  while (nb_sent < NB_SAMPLES) {
+    if (next_read_us > mock.time_us) {
+      mock_advance(next_read_us - mock.time_us);
+    }
+    // periodic read with some jitter
+    next_read_us += 1e6 / PERIODIC_FREQ + ((nb_reads % 3) - 1) * 1.5 * SAMPLE_PERIOD_US;
+    nb_reads++;
+    mpu60x0_spi_periodic(&mpu);
+    // FIFO count, then FIFO data
+    for (int e = 0; e < 3 && !mpu.data_available; e++) {
+      mpu60x0_spi_event(&mpu);
+    }
+    if (!mpu.data_available) {
+      continue;
+    }
+    mpu.data_available = false;
+
+    // the FIFO holds the samples pushed since the last reset
+    if (next_expected < mock_reset_sample) {
+      nb_lost += mock_reset_sample - next_expected;
+      next_expected = mock_reset_sample;
+    }
+    const int first = next_expected;
+    imu_batch_reset(&batch, period);
+    for (uint8_t i = 0; i < mpu.fifo.nb; i++, next_expected++, nb_received++) {
+      struct Int16Vect3 *a = &mpu.fifo.accel[i];
+      struct Int16Rates *g = &mpu.fifo.gyro[i];
+      int16_t *ref = sent[next_expected];
+      if (a->x != ref[0] || a->y != ref[1] || a->z != ref[2] || g->p != ref[3] || g->q != ref[4] || g->r != ref[5]) {
+        nb_mismatch++;
+      }
+      struct Int32Rates gi = { g->p * GYRO_SENS_NUM / GYRO_SENS_DEN, g->q * GYRO_SENS_NUM / GYRO_SENS_DEN,
+                               g->r * GYRO_SENS_NUM / GYRO_SENS_DEN };
+      struct Int32Vect3 ai = { a->x * ACCEL_SENS_NUM / ACCEL_SENS_DEN, a->y * ACCEL_SENS_NUM / ACCEL_SENS_DEN,
+                               a->z * ACCEL_SENS_NUM / ACCEL_SENS_DEN };
+      imu_batch_add(&batch, (uint32_t)(next_expected * period), &gi, &ai);
+    }
+
+    // integrate the batches, restart from the truth after lost samples
+    if (first != last_end) {
+      q_corr = truth_hist[first];
+      q_raw = truth_hist[first];
+    }
+    last_end = next_expected;
+    struct ImuBatchDelta d_corr, d_raw;
+    imu_batch_integrate(&d_corr, &batch, true);
+    imu_batch_integrate(&d_raw, &batch, false);
+    struct DoubleVect3 rv_corr = { d_corr.angle.x, d_corr.angle.y, d_corr.angle.z };
+    struct DoubleVect3 rv_raw = { d_raw.angle.x, d_raw.angle.y, d_raw.angle.z };
+    quat_integrate_rot_vect(&q_corr, &rv_corr);
+    quat_integrate_rot_vect(&q_raw, &rv_raw);
+    att_err_corr = Max(att_err_corr, quat_angle_error(&q_corr, &truth_hist[last_end]));
+    att_err_raw = Max(att_err_raw, quat_angle_error(&q_raw, &truth_hist[last_end]));
+    // velocity increment in inertial frame with the true end attitude
+    struct DoubleVect3 dv_b, dv_i;
+    VECT3_COPY(dv_b, d_corr.vel);
+    quat_rotate(&dv_i, &truth_hist[last_end], &dv_b);
+    VECT3_ADD_SCALED(dv_i, force_i, -d_corr.dt);
+    dv_err_corr += sqrt(VECT3_NORM2(dv_i));
+    VECT3_COPY(dv_b, d_raw.vel);
+    quat_rotate(&dv_i, &truth_hist[last_end], &dv_b);
+    VECT3_ADD_SCALED(dv_i, force_i, -d_raw.dt);
+    dv_err_raw += sqrt(VECT3_NORM2(dv_i));
+    nb_batches++;
+  }
+
+  const uint32_t nb_transactions = mock.nb_transactions - transactions_at_config;
+  const int nb_pending = mock.count / MPU60X0_FIFO_SAMPLE_SIZE;
+  printf("%d samples sent, %d received in %d reads, %u bus transactions\n",
+         nb_sent, nb_received, nb_reads, nb_transactions);
+  printf("%u samples written during FIFO reads\n", mock.nb_during_read);
+  printf("%d lost after %u FIFO reset, %d still in the FIFO, %d mismatches\n",
+         nb_lost, mock.nb_resets - resets_at_config, nb_pending, nb_mismatch);
+  ok &= (nb_mismatch == 0 && mock.nb_resets - resets_at_config == 1 && mpu.fifo.nb_resets == 1);
+  ok &= (nb_transactions <= 2 * (uint32_t)nb_reads);
+  ok &= (mock.nb_during_read > 0);
+  // no sample is lost, except the ones in the FIFO when it is reset
+  ok &= (nb_received + nb_lost + nb_pending == nb_sent);
+  ok &= (nb_lost <= 3 * SAMPLE_FREQ / PERIODIC_FREQ);
+
+  printf("%d batches integrated\n", nb_batches);
+  printf("max attitude error with coning correction %.2e rad, without %.2e rad\n", att_err_corr, att_err_raw);
+  printf("mean delta velocity error with sculling correction %.2e m/s, without %.2e m/s\n",
+         dv_err_corr / nb_batches, dv_err_raw / nb_batches);
+  ok &= (nb_batches > 0 && att_err_corr < 0.2 * att_err_raw && dv_err_corr < 0.5 * dv_err_raw);
+
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_matrix_fixed.c
+ *
+ * Check the fixed-size matrix functions of pprz_matrix_fixed_float.h
+ * against the generic float ** functions and compare their speed.
+ * The specialized products (unrolled, or NEON when available) are also
+ * checked against the generic fixed-size loops.
+ *
+ * make test_matrix_fixed && ./test_matrix_fixed [nb_iterations]
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "math/pprz_algebra_float.h"
+#include "math/pprz_matrix_fixed_float.h"
+
+static double now_s(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+/** diagonally dominant random matrix so that inversion is well conditioned */
+static void rand_mat(float *m, int n)
+{
+  for (int i = 0; i < n; i++) {
+    for (int j = 0; j < n; j++) {
+      m[i * n + j] = (float)rand() / (float)RAND_MAX - 0.5f + (i == j ? (float)n : 0.f);
+    }
+  }
+}
+
+static float max_err(float *a, float *b, int nb)
+{
+  float err = 0.f;
+  for (int i = 0; i < nb; i++) {
+    float e = fabsf(a[i] - b[i]);
+    if (e > err) { err = e; }
+  }
+  return err;
+}
+
+static volatile float sink;
+
+/** Compare one matrix size, returns false if results differ */
+#define BENCH_SIZE(N, _nb) ({ \
+  float a[N][N], b[N][N], o_ref[N][N], o_fix[N][N], v[N], ov_ref[N], ov_fix[N]; \
+  MAKE_MATRIX_PTR(_a, a, N); \
+  MAKE_MATRIX_PTR(_b, b, N); \
+  MAKE_MATRIX_PTR(_o, o_ref, N); \
+  rand_mat(&a[0][0], N); \
+  rand_mat(&b[0][0], N); \
+  for (int i = 0; i < N; i++) { v[i] = a[i][0]; } \
+  \
+  float_mat_mul(_o, _a, _b, N, N, N); \
+  float_mat##N##_mul(o_fix, a, b); \
+  float err_mul = max_err(&o_ref[0][0], &o_fix[0][0], N * N); \
+  float_mat_vect_mul(ov_ref, _a, v, N, N); \
+  float_mat##N##_vect_mul(ov_fix, a, v); \
+  float err_vect = max_err(ov_ref, ov_fix, N); \
+  float_mat##N##_mul_generic(o_ref, a, b); \
+  float_mat##N##_mul(o_fix, a, b); \
+  float err_gen = max_err(&o_ref[0][0], &o_fix[0][0], N * N); \
+  float_mat##N##_vect_mul_generic(ov_ref, a, v); \
+  float_mat##N##_vect_mul(ov_fix, a, v); \
+  err_gen = Max(err_gen, max_err(ov_ref, ov_fix, N)); \
+  float_mat_invert(_o, _a, N); \
+  float_mat##N##_invert(o_fix, a); \
+  float err_inv = max_err(&o_ref[0][0], &o_fix[0][0], N * N); \
+  \
+  double t0 = now_s(); \
+  for (int k = 0; k < _nb; k++) { \
+    a[k % N][0] += 1e-6f; \
+    float_mat_mul(_o, _a, _b, N, N, N); \
+    sink += o_ref[0][k % N]; \
+  } \
+  double t_mul_ref = now_s() - t0; \
+  t0 = now_s(); \
+  for (int k = 0; k < _nb; k++) { \
+    a[k % N][0] += 1e-6f; \
+    float_mat##N##_mul(o_fix, a, b); \
+    sink += o_fix[0][k % N]; \
+  } \
+  double t_mul_fix = now_s() - t0; \
+  t0 = now_s(); \
+  for (int k = 0; k < _nb; k++) { \
+    v[k % N] += 1e-6f; \
+    float_mat_vect_mul(ov_ref, _a, v, N, N); \
+    sink += ov_ref[k % N]; \
+  } \
+  double t_vect_ref = now_s() - t0; \
+  t0 = now_s(); \
+  for (int k = 0; k < _nb; k++) { \
+    v[k % N] += 1e-6f; \
+    float_mat##N##_vect_mul(ov_fix, a, v); \
+    sink += ov_fix[k % N]; \
+  } \
+  double t_vect_fix = now_s() - t0; \
+  t0 = now_s(); \
+  for (int k = 0; k < _nb / 10; k++) { \
+    a[k % N][0] += 1e-6f; \
+    float_mat_invert(_o, _a, N); \
+    sink += o_ref[0][k % N]; \
+  } \
+  double t_inv_ref = now_s() - t0; \
+  t0 = now_s(); \
+  for (int k = 0; k < _nb / 10; k++) { \
+    a[k % N][0] += 1e-6f; \
+    float_mat##N##_invert(o_fix, a); \
+    sink += o_fix[0][k % N]; \
+  } \
+  double t_inv_fix = now_s() - t0; \
+  \
+  double ns = 1e9 / (double)_nb; \
+  printf("%dx%d mul    %8.1f ns %8.1f ns  x%5.2f  err %g\n", N, N, \
+         t_mul_ref * ns, t_mul_fix * ns, t_mul_ref / t_mul_fix, err_mul); \
+  printf("%dx%d vect   %8.1f ns %8.1f ns  x%5.2f  err %g\n", N, N, \
+         t_vect_ref * ns, t_vect_fix * ns, t_vect_ref / t_vect_fix, err_vect); \
+  printf("%dx%d invert %8.1f ns %8.1f ns  x%5.2f  err %g\n", N, N, \
+         t_inv_ref * ns * 10., t_inv_fix * ns * 10., t_inv_ref / t_inv_fix, err_inv); \
+  printf("%dx%d specialized vs generic err %g\n", N, N, err_gen); \
+  (err_mul < 1e-4f && err_vect < 1e-4f && err_inv < 1e-4f && err_gen < 1e-4f); \
+})
+
+int main(int argc, char **argv)
+{
+  int nb = 1000000;
+  if (argc > 1) {
+    nb = atoi(argv[1]);
+  }
+  srand(0);
+
+#if PPRZ_MAT_FIXED_NEON
+  printf("NEON products\n");
+#endif
+  printf("size op        float **       fixed   speedup\n");
+  bool ok = true;
+  ok &= BENCH_SIZE(3, nb);
+  ok &= BENCH_SIZE(4, nb);
+  ok &= BENCH_SIZE(6, nb);
+  ok &= BENCH_SIZE(9, nb);
+
+  float p[6][6], l[6][6], llt[6][6];
+  rand_mat(&p[0][0], 6);
+  float_mat6_mul_transp(llt, p, p);
+  float_mat6_cholesky(l, llt);
+  float_mat6_mul_transp(p, l, l);
+  float err_chol = max_err(&p[0][0], &llt[0][0], 36);
+  printf("6x6 cholesky err %g\n", err_chol);
+  ok &= err_chol < 1e-3f;
+
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
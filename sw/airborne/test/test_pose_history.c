@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_pose_history.c
+ *
+ * Interpolation of pose_history_get on a ring that wrapped around.
+ *
+ * The state follows a trajectory that linear interpolation and slerp
+ * reproduce exactly (linear position, speed, rates and heading, constant
+ * roll and pitch) and is recorded with a mocked clock whose timestamps
+ * overflow in the middle of the history. The ring is built with a small
+ * POSE_HISTORY_SIZE and filled more than twice. Checks the queries:
+ * - with an empty history,
+ * - at a sample, between samples and across the timestamp overflow,
+ * - before the oldest kept sample and after the newest one.
+ *
+ * make test_pose_history && ./test_pose_history
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+#include "modules/pose_history/pose_history.h"
+#include "state.h"
+
+/** sample period in usec */
+#define DT_US 2000
+/** number of recorded samples, more than twice the ring size */
+#define NB_SAMPLES (3 * POSE_HISTORY_SIZE - 8)
+/** last sample before the timestamp overflow */
+#define WRAP_SAMPLE (NB_SAMPLES - 8)
+
+#define EPS 1e-4f
+
+static uint32_t now_us;
+
+uint32_t get_sys_time_usec(void)
+{
+  return now_us;
+}
+
+/** Timestamp of sample n, n can be fractional, overflows after WRAP_SAMPLE */
+static uint32_t timestamp_of(float n)
+{
+  return (uint32_t)(-(int32_t)(WRAP_SAMPLE * DT_US + DT_US / 2)) + (uint32_t)(int32_t)lroundf(n * DT_US);
+}
+
+/** Pose of the trajectory at sample n */
+static void pose_of(struct pose_t *p, struct FloatQuat *q, float n)
+{
+  float t = n * DT_US * 1e-6f;
+  p->timestamp = timestamp_of(n);
+  p->eulers.phi = 0.1f;
+  p->eulers.theta = -0.2f;
+  p->eulers.psi = 0.3f + 2.f * t;
+  p->rates.p = 1.f + t;
+  p->rates.q = -0.5f * t;
+  p->rates.r = 2.f - 3.f * t;
+  p->pos.x = 10.f + 2.f * t;
+  p->pos.y = -5.f - 3.f * t;
+  p->pos.z = -1.f + 0.5f * t;
+  p->speed.x = 2.f + t;
+  p->speed.y = -3.f + 2.f * t;
+  p->speed.z = 0.5f - t;
+  if (q != NULL) {
+    float_quat_of_eulers(q, &p->eulers);
+  }
+}
+
+static float pose_err(struct pose_t *a, struct pose_t *b)
+{
+  float err = 0.f;
+  float e[] = {
+    a->eulers.phi - b->eulers.phi, a->eulers.theta - b->eulers.theta, a->eulers.psi - b->eulers.psi,
+    a->rates.p - b->rates.p, a->rates.q - b->rates.q, a->rates.r - b->rates.r,
+    a->pos.x - b->pos.x, a->pos.y - b->pos.y, a->pos.z - b->pos.z,
+    a->speed.x - b->speed.x, a->speed.y - b->speed.y, a->speed.z - b->speed.z
+  };
+  for (unsigned int i = 0; i < sizeof(e) / sizeof(e[0]); i++) {
+    err = Max(err, fabsf(e[i]));
+  }
+  return err;
+}
+
+/** Query at sample n, the result must be the pose of sample expected */
+static bool check_query(const char *name, float n, float expected)
+{
+  struct pose_t pose, truth;
+  uint32_t ts = timestamp_of(n);
+  pose_of(&truth, NULL, expected);
+  if (!pose_history_get(ts, &pose)) {
+    printf("%-22s no pose\n", name);
+    return false;
+  }
+  float err = pose_err(&pose, &truth);
+  bool ok = err < EPS && pose.timestamp == ts;
+  printf("%-22s ts %10u err %g %s\n", name, ts, err, ok ? "" : "FAILED");
+  return ok;
+}
+
+int main(void)
+{
+  bool ok = true;
+  struct pose_t pose;
+  struct FloatQuat q;
+
+  pose_init();
+  if (pose_history_get(0, &pose)) {
+    printf("pose from an empty history\n");
+    ok = false;
+  }
+  pose = get_rotation_at_timestamp(0);
+  if (pose.timestamp != 0 || pose.pos.x != 0.f || pose.eulers.psi != 0.f) {
+    printf("non zero pose from an empty history\n");
+    ok = false;
+  }
+
+  for (int n = 0; n < NB_SAMPLES; n++) {
+    pose_of(&pose, &q, (float)n);
+    now_us = pose.timestamp;
+    stateSetNedToBodyQuat_f(&q);
+    stateSetBodyRates_f(&pose.rates);
+    stateSetPositionNed_f(&pose.pos);
+    stateSetSpeedNed_f(&pose.speed);
+    pose_periodic();
+  }
+  printf("%d samples in a ring of %d, timestamp overflow after sample %d\n",
+         NB_SAMPLES, POSE_HISTORY_SIZE, WRAP_SAMPLE);
+
+  // one slot of the ring is kept free for the writer
+  float oldest = (float)(NB_SAMPLES - (POSE_HISTORY_SIZE - 1));
+  float newest = (float)(NB_SAMPLES - 1);
+
+  ok &= check_query("at a sample", oldest + 3.f, oldest + 3.f);
+  ok &= check_query("between samples", oldest + 4.3f, oldest + 4.3f);
+  ok &= check_query("at the oldest sample", oldest, oldest);
+  ok &= check_query("at the newest sample", newest, newest);
+  ok &= check_query("before the overflow", WRAP_SAMPLE + 0.25f, WRAP_SAMPLE + 0.25f);
+  ok &= check_query("at the overflow", WRAP_SAMPLE + 0.5f, WRAP_SAMPLE + 0.5f);
+  ok &= check_query("after the overflow", WRAP_SAMPLE + 0.75f, WRAP_SAMPLE + 0.75f);
+  ok &= check_query("across the overflow", WRAP_SAMPLE + 1.6f, WRAP_SAMPLE + 1.6f);
+  // outside of the history, the closest sample is returned
+  ok &= check_query("overwritten sample", oldest - 5.f, oldest);
+  ok &= check_query("before the oldest", oldest - 0.5f, oldest);
+  ok &= check_query("after the newest", newest + 3.f, newest);
+
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
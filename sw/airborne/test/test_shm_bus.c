@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_shm_bus.c
+ *
+ * Shared memory message bus between processes.
+ *
+ * - a subscriber which doesn't read loses the oldest messages and restarts
+ *   from the oldest one still in the ring,
+ * - publishers in child processes send numbered messages, the subscriber
+ *   checks that each message it accepts is complete and in order, and that
+ *   every message is either received or counted as dropped.
+ *
+ * make test_shm_bus && ./test_shm_bus
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/wait.h>
+
+#include "arch/linux/shm_bus.h"
+
+#define NB_PUBLISHERS 2
+#define NB_MSGS 200000
+#define MSG_LEN 64
+
+static double now_s(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+/** message: publisher id, number, then bytes depending on both */
+static void fill(uint8_t *buf, uint32_t pub, uint32_t n)
+{
+  memcpy(buf, &pub, 4);
+  memcpy(buf + 4, &n, 4);
+  for (int i = 8; i < MSG_LEN; i++) {
+    buf[i] = (uint8_t)(n * 7 + pub * 13 + i);
+  }
+}
+
+static bool check(const uint8_t *buf, uint32_t len, uint32_t *pub, uint32_t *n)
+{
+  uint8_t ref[MSG_LEN];
+  if (len != MSG_LEN) {
+    return false;
+  }
+  memcpy(pub, buf, 4);
+  memcpy(n, buf + 4, 4);
+  fill(ref, *pub, *n);
+  return (*pub < NB_PUBLISHERS && memcmp(ref, buf, MSG_LEN) == 0);
+}
+
+static bool test_overrun(const char *topic)
+{
+  struct ShmBus pub, sub;
+  bool ok = (shm_bus_open(&pub, topic, 16, MSG_LEN) == 0);
+  ok &= (shm_bus_open(&sub, topic, 1024, 1024) == 0);
+  ok &= (sub.hdr->nb_slots == 16 && sub.hdr->slot_size == MSG_LEN);
+  uint8_t buf[MSG_LEN];
+  ok &= (shm_bus_read(&sub, buf, sizeof(buf)) == 0);
+  for (uint32_t n = 0; n < 40; n++) {
+    fill(buf, 0, n);
+    ok &= (shm_bus_publish(&pub, buf, MSG_LEN) == 0);
+  }
+  ok &= (shm_bus_publish(&pub, buf, MSG_LEN + 1) < 0);
+  // messages 0..39 were published in a ring of 16, restart from 25
+  uint32_t p, n, len;
+  const uint8_t *m = shm_bus_peek(&sub, &len);
+  ok &= (m != NULL && check(m, len, &p, &n) && n == 25 && shm_bus_release(&sub));
+  ok &= (sub.nb_dropped == 25);
+  int nb = 0;
+  while (shm_bus_read(&sub, buf, sizeof(buf)) == MSG_LEN) {
+    nb++;
+  }
+  ok &= (nb == 14 && check(buf, MSG_LEN, &p, &n) && n == 39);
+  // a message overwritten while used in place is rejected
+  ok &= (shm_bus_publish(&pub, buf, MSG_LEN) == 0);
+  m = shm_bus_peek(&sub, &len);
+  for (int i = 0; i < 16; i++) {
+    ok &= (shm_bus_publish(&pub, buf, MSG_LEN) == 0);
+  }
+  ok &= (m != NULL && !shm_bus_release(&sub));
+  shm_bus_close(&sub, false);
+  shm_bus_close(&pub, true);
+  printf("overrun: %s\n", ok ? "OK" : "FAILED");
+  return ok;
+}
+
+static void publisher(const char *topic, uint32_t id)
+{
+  struct ShmBus bus;
+  if (shm_bus_open(&bus, topic, 0, 0) < 0) {
+    _exit(1);
+  }
+  for (uint32_t n = 0; n < NB_MSGS; n++) {
+    fill(shm_bus_reserve(&bus), id, n);
+    shm_bus_commit(&bus, MSG_LEN);
+    // let the subscriber keep up most of the time
+    if (n % 64 == 63) {
+      sched_yield();
+    }
+  }
+  shm_bus_close(&bus, false);
+  _exit(0);
+}
+
+static bool test_processes(const char *topic)
+{
+  struct ShmBus sub;
+  bool ok = (shm_bus_open(&sub, topic, SHM_BUS_NB_SLOTS, MSG_LEN) == 0);
+  if (!ok) {
+    printf("processes: can't open the topic\n");
+    return false;
+  }
+  pid_t pids[NB_PUBLISHERS];
+  for (uint32_t i = 0; i < NB_PUBLISHERS; i++) {
+    pids[i] = fork();
+    if (pids[i] == 0) {
+      publisher(topic, i);
+    }
+  }
+
+  uint32_t last[NB_PUBLISHERS] = { 0 };
+  bool first[NB_PUBLISHERS] = { true, true };
+  uint32_t nb_bad = 0, nb_running = NB_PUBLISHERS;
+  double t0 = now_s();
+  while (nb_running > 0 || shm_bus_wait(&sub, 0)) {
+    uint32_t len, p, n;
+    const uint8_t *m = shm_bus_peek(&sub, &len);
+    if (m == NULL) {
+      if (!shm_bus_wait(&sub, 10000)) {
+        int status;
+        while (waitpid(-1, &status, WNOHANG) > 0) {
+          ok &= (WIFEXITED(status) && WEXITSTATUS(status) == 0);
+          nb_running--;
+        }
+      }
+      continue;
+    }
+    // decode in place, only trusted if not overwritten meanwhile
+    bool good = check(m, len, &p, &n);
+    if (shm_bus_release(&sub)) {
+      if (!good || (!first[p] && n <= last[p])) {
+        nb_bad++;
+      } else {
+        first[p] = false;
+        last[p] = n;
+      }
+    }
+  }
+  double dt = now_s() - t0;
+  uint32_t nb_sent = NB_PUBLISHERS * NB_MSGS;
+  printf("processes: %u messages sent by %d publishers in %.3f s (%.1f M/s), %u received, %u dropped, %u bad\n",
+         nb_sent, NB_PUBLISHERS, dt, nb_sent / dt / 1e6, sub.nb_received, sub.nb_dropped, nb_bad);
+  ok &= (nb_bad == 0 && sub.nb_received + sub.nb_dropped == nb_sent && sub.nb_received > 0);
+  for (uint32_t i = 0; i < NB_PUBLISHERS; i++) {
+    ok &= (last[i] == NB_MSGS - 1);
+  }
+  shm_bus_close(&sub, true);
+  printf("processes: %s\n", ok ? "OK" : "FAILED");
+  return ok;
+}
+
+int main(void)
+{
+  char topic[32];
+  bool ok = true;
+  snprintf(topic, sizeof(topic), "test_%d_a", (int)getpid());
+  ok &= test_overrun(topic);
+  snprintf(topic, sizeof(topic), "test_%d_b", (int)getpid());
+  ok &= test_processes(topic);
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file test_telemetry_budget.c
+ *
+ * Periodic telemetry on a simulated 57600 bauds UART with a small TX buffer,
+ * with twice more messages than the link can send, with and without the
+ * bandwidth budget. The nominal rate of the budget is set too high on
+ * purpose, it has to adapt from the overruns.
+ *
+ * make test_telemetry_budget && ./test_telemetry_budget
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "subsystems/datalink/telemetry_budget.h"
+
+#define FREQ 60                 ///< telemetry frequency
+#define DURATION 60             ///< simulated time in seconds
+#define LINK_RATE 5760.f        ///< 57600 bauds, bytes/s
+#define TX_BUFFER 256           ///< UART TX buffer size (STM32F4)
+#define NB_MSG 12
+
+struct TestMsg {
+  const char *name;
+  float period;
+  uint8_t size;
+  uint8_t prio;
+  uint32_t nb_demand, nb_sent;
+};
+
+static struct TestMsg msgs[NB_MSG] = {
+  { "ALIVE",       1.f,   24, TELEMETRY_PRIO_CRITICAL, 0, 0 },
+  { "STATUS",      0.5f,  30, TELEMETRY_PRIO_CRITICAL, 0, 0 },
+  { "FP",          0.1f,  40, TELEMETRY_PRIO_CRITICAL, 0, 0 },
+  { "GPS",         0.1f,  50, TELEMETRY_PRIO_HIGH, 0, 0 },
+  { "ATTITUDE",    0.05f, 20, TELEMETRY_PRIO_HIGH, 0, 0 },
+  { "ENERGY",      0.2f,  30, TELEMETRY_PRIO_NORMAL, 0, 0 },
+  { "INS",         0.05f, 40, TELEMETRY_PRIO_NORMAL, 0, 0 },
+  { "AIR_DATA",    0.1f,  36, TELEMETRY_PRIO_NORMAL, 0, 0 },
+  { "IMU_GYRO",    0.05f, 24, TELEMETRY_PRIO_LOW, 0, 0 },
+  { "IMU_ACCEL",   0.05f, 24, TELEMETRY_PRIO_LOW, 0, 0 },
+  { "OPTIC_FLOW",  0.02f, 40, TELEMETRY_PRIO_LOW, 0, 0 },
+  { "DEBUG",       0.02f, 60, TELEMETRY_PRIO_LOW, 0, 0 },
+};
+
+/** UART model */
+struct TestUart {
+  float fill;
+  uint32_t nb_bytes;
+  uint8_t nb_ovrn;
+  uint32_t total_ovrn;
+};
+
+static void uart_send(struct TestUart *u, struct TestMsg *m)
+{
+  if (u->fill + m->size > TX_BUFFER) {
+    u->nb_ovrn++;
+    u->total_ovrn++;
+    return;
+  }
+  u->fill += m->size;
+  u->nb_bytes += m->size;
+  m->nb_sent++;
+}
+
+/** Run the telemetry loop, returns the number of overruns in the last half */
+/** Number of ticks between two messages, the period is truncated like in the generated periodic code */
+static uint32_t ticks(struct TestMsg *m)
+{
+  uint32_t p = (uint32_t)(m->period * FREQ);
+  return p > 0 ? p : 1;
+}
+
+/** Rate at which a message is actually scheduled */
+static float scheduled_rate(struct TestMsg *m)
+{
+  return (float)FREQ / ticks(m);
+}
+
+static uint32_t run(bool use_budget, struct TelemetryBudget *b, struct TelemetryBudgetMsg *bm)
+{
+  struct TestUart u;
+  memset(&u, 0, sizeof(u));
+  for (int i = 0; i < NB_MSG; i++) {
+    msgs[i].nb_demand = 0;
+    msgs[i].nb_sent = 0;
+  }
+  // nominal rate 30% higher than the actual link
+  telemetry_budget_init(b, bm, NB_MSG, 1.3f * LINK_RATE, TX_BUFFER);
+
+  uint32_t ovrn_first_half = 0;
+  for (uint32_t k = 0; k < DURATION * FREQ; k++) {
+    float now = (float)k / FREQ;
+    u.fill -= LINK_RATE / FREQ;
+    if (u.fill < 0.f) { u.fill = 0.f; }
+    if (k == DURATION * FREQ / 2) {
+      ovrn_first_half = u.total_ovrn;
+      for (int i = 0; i < NB_MSG; i++) {
+        msgs[i].nb_demand = 0;
+        msgs[i].nb_sent = 0;
+      }
+    }
+    for (int i = 0; i < NB_MSG; i++) {
+      uint32_t p = ticks(&msgs[i]);
+      if (k % p != (uint32_t)i % p) {
+        continue;
+      }
+      msgs[i].nb_demand++;
+      if (use_budget) {
+        telemetry_budget_update(b, now, u.nb_bytes, u.nb_ovrn);
+        if (!telemetry_budget_check(b, i, msgs[i].prio, u.nb_bytes)) {
+          continue;
+        }
+      }
+      uart_send(&u, &msgs[i]);
+      if (use_budget) {
+        telemetry_budget_sent(b, i, u.nb_bytes);
+      }
+    }
+  }
+  return u.total_ovrn - ovrn_first_half;
+}
+
+int main(void)
+{
+  struct TelemetryBudget b;
+  struct TelemetryBudgetMsg bm[NB_MSG];
+  bool ok = true;
+
+  float demand = 0.f;
+  for (int i = 0; i < NB_MSG; i++) {
+    demand += msgs[i].size * scheduled_rate(&msgs[i]);
+  }
+  printf("demand %.0f bytes/s, link %.0f bytes/s\n", demand, LINK_RATE);
+
+  uint32_t ovrn_raw = run(false, &b, bm);
+  float crit_raw = 1.f;
+  for (int i = 0; i < NB_MSG; i++) {
+    if (msgs[i].prio == TELEMETRY_PRIO_CRITICAL) {
+      float r = (float)msgs[i].nb_sent / msgs[i].nb_demand;
+      crit_raw = r < crit_raw ? r : crit_raw;
+    }
+  }
+  printf("without budget: %u overruns, worst critical message %.0f%%\n", ovrn_raw, 100.f * crit_raw);
+
+  uint32_t ovrn = run(true, &b, bm);
+  printf("with budget:    %u overruns, allowed %.0f bytes/s, throughput %.0f bytes/s\n",
+         ovrn, b.byte_rate, b.throughput);
+
+  float ratio[TELEMETRY_PRIO_NB] = { 1.f, 1.f, 1.f, 1.f };
+  for (int i = 0; i < NB_MSG; i++) {
+    float r = (float)msgs[i].nb_sent / msgs[i].nb_demand;
+    printf("  %-12s prio %d size %3u: %5.1f Hz / %5.1f Hz, skipped %5.1f Hz\n", msgs[i].name, msgs[i].prio,
+           bm[i].size, bm[i].rate, scheduled_rate(&msgs[i]), bm[i].skip_rate);
+    if (r < ratio[msgs[i].prio]) {
+      ratio[msgs[i].prio] = r;
+    }
+    if (bm[i].size != msgs[i].size) {
+      printf("wrong size for %s\n", msgs[i].name);
+      ok = false;
+    }
+  }
+
+  // critical messages are all sent, the others are thinned by priority
+  if (ratio[TELEMETRY_PRIO_CRITICAL] < 0.99f) {
+    printf("critical messages lost\n");
+    ok = false;
+  }
+  if (!(ratio[TELEMETRY_PRIO_LOW] < ratio[TELEMETRY_PRIO_NORMAL] &&
+        ratio[TELEMETRY_PRIO_NORMAL] <= ratio[TELEMETRY_PRIO_HIGH])) {
+    printf("priorities not respected\n");
+    ok = false;
+  }
+  // few overruns once adapted, and the link is still used
+  if (ovrn * 10 > ovrn_raw || b.throughput < 0.8f * LINK_RATE) {
+    printf("link not adapted\n");
+    ok = false;
+  }
+
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -26,6 +26,12 @@
 * NatNet UDP stream and forwards it to the ivy bus. An aircraft with the gps
 * subsystem "datalink" is then able to parse the GPS position and use it to
 * navigate inside the Optitrack system.
+*
+*   In event mode (-event), each rigid body is sent as a REMOTE_GPS_LOCAL
+* message as soon as its frame is parsed instead of on a timer. The pose is
+* extrapolated with constant velocity and rotation rate to the expected
+* reception time, and it can be sent as a binary pprzlink frame directly to
+* the aircraft over UDP (-dl_udp) instead of going through ivy and link.
 */
 
 #include <glib.h>
@@ -44,6 +50,8 @@
 #include "arch/linux/udp_socket.h"
 #include "math/pprz_geodetic_double.h"
 #include "math/pprz_algebra_double.h"
+#include "pprzlink/pprz_transport.h"
+#include "pprzlink/dl_protocol.h"
 
 /** Debugging options */
 uint8_t verbose = 0;
@@ -79,6 +87,21 @@ bool small_packets              = FALSE;
 /** Connection timeout when not receiving **/
 #define CONNECTION_TIMEOUT          .5
 
+/** Event mode defaults */
+bool event_mode                 = FALSE;  ///< Transmit each rigid body when its frame is parsed
+double link_delay               = 0.;     ///< Expected delay from transmit to aircraft in seconds
+char *dl_udp_host               = NULL;   ///< Aircraft address for direct binary datalink
+uint16_t dl_udp_port            = 4242;   ///< Aircraft datalink UDP port
+
+/** Time constant of the velocity and rate filters in seconds */
+#define EXTRAPOLATION_TAU           0.02
+/** Maximum time between two frames to differentiate them */
+#define EXTRAPOLATION_MAX_DT        0.5
+/** Maximum extrapolation horizon in seconds */
+#define EXTRAPOLATION_MAX_HORIZON   0.1
+/** Latency statistics period in seconds */
+#define STATS_PERIOD                5.
+
 /** NatNet parsing defines */
 #define MAX_PACKETSIZE    100000
 #define MAX_NAMELENGTH    256
@@ -111,6 +134,13 @@ struct RigidBody {
   int nVelocitySamples;             ///< Number of velocity samples gathered
   int totalVelocitySamples;         ///< Total amount of velocity samples possible
   int nVelocityTransmit;            ///< Amount of transmits since last valid velocity transmit
+
+  bool evValid;                     ///< Event mode: previous pose is valid
+  double evStamp;                   ///< Event mode: NatNet timestamp of the previous pose
+  struct DoubleVect3 evPos;         ///< Event mode: previous position
+  struct DoubleQuat evQuat;         ///< Event mode: previous orientation
+  struct DoubleVect3 evVel;         ///< Event mode: filtered velocity
+  struct DoubleRates evRates;       ///< Event mode: filtered rotation rate
 };
 struct RigidBody rigidBodies[MAX_RIGIDBODIES];    ///< All rigid bodies which are tracked
 
@@ -132,6 +162,29 @@ double tracking_offset_angle;       ///< The offset from the tracking system to
 /** Save the latency from natnet */
 float natnet_latency;
 
+/** Timestamp and number of rigid bodies of the last NatNet frame */
+double natnet_timestamp;
+int natnet_nb_rigid;
+
+/** Direct binary datalink to the aircraft */
+struct DlUdp {
+  struct link_device device;        ///< pprzlink device, writes into the buffer
+  struct UdpSocket socket;          ///< socket to the aircraft
+  uint8_t buf[256];                 ///< frame being built
+  uint16_t len;                     ///< length of the frame
+};
+struct DlUdp dl_udp;
+struct pprz_transport dl_tp;
+
+/** Latency statistics in seconds */
+struct LatencyStats {
+  uint32_t nb;
+  double sum, min, max;
+};
+struct LatencyStats stats_processing;   ///< From frame reception to transmit
+struct LatencyStats stats_horizon;      ///< Extrapolation horizon
+double stats_start;
+
 /** Parse the packet from NatNet */
 void natnet_parse(unsigned char *in)
 {
@@ -204,6 +257,7 @@ void natnet_parse(unsigned char *in)
               MAX_RIGIDBODIES);
       exit(EXIT_FAILURE);
     }
+    natnet_nb_rigid = nRigidBodies;
 
     for (j = 0; j < nRigidBodies; j++) {
       // rigid body pos/ori
@@ -244,6 +298,7 @@ void natnet_parse(unsigned char *in)
 
       // When marker id changed, reset the velocity
       if (old_rigid.id != rigidBodies[j].id) {
+        rigidBodies[j].evValid = FALSE;
         rigidBodies[j].vel_x = 0;
         rigidBodies[j].vel_y = 0;
         rigidBodies[j].vel_z = 0;
@@ -463,6 +518,7 @@ void natnet_parse(unsigned char *in)
       memcpy(&fTemp, ptr, 4); ptr += 4;
       timestamp = (double)fTemp;
     }
+    natnet_timestamp = timestamp;
 
     // frame params
     short params = 0;  memcpy(&params, ptr, 2); ptr += 2;
@@ -713,6 +769,171 @@ gboolean timeout_transmit_callback(gpointer data)
   return TRUE;
 }
 
+/** Monotonic time in seconds */
+static double get_time(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static void latency_stats_add(struct LatencyStats *st, double v)
+{
+  if (st->nb == 0 || v < st->min) { st->min = v; }
+  if (st->nb == 0 || v > st->max) { st->max = v; }
+  st->sum += v;
+  st->nb++;
+}
+
+static void latency_stats_print(const char *name, struct LatencyStats *st)
+{
+  if (st->nb > 0) {
+    fprintf(stderr, "  %-12s mean %6.2f ms  min %6.2f ms  max %6.2f ms\n", name,
+            1000. * st->sum / st->nb, 1000. * st->min, 1000. * st->max);
+  }
+  memset(st, 0, sizeof(struct LatencyStats));
+}
+
+/** Hamilton product of two quaternions */
+static void quat_comp(struct DoubleQuat *c, struct DoubleQuat *a, struct DoubleQuat *b)
+{
+  c->qi = a->qi * b->qi - a->qx * b->qx - a->qy * b->qy - a->qz * b->qz;
+  c->qx = a->qi * b->qx + a->qx * b->qi + a->qy * b->qz - a->qz * b->qy;
+  c->qy = a->qi * b->qy - a->qx * b->qz + a->qy * b->qi + a->qz * b->qx;
+  c->qz = a->qi * b->qz + a->qx * b->qy - a->qy * b->qx + a->qz * b->qi;
+}
+
+/** Direct datalink device, the frame is sent in a single datagram */
+static int dl_udp_check_free_space(struct DlUdp *p, long *fd __attribute__((unused)), uint16_t len)
+{
+  return (p->len + len <= sizeof(p->buf));
+}
+
+static void dl_udp_put_byte(struct DlUdp *p, long fd __attribute__((unused)), uint8_t data)
+{
+  p->buf[p->len++] = data;
+}
+
+static void dl_udp_put_buffer(struct DlUdp *p, long fd __attribute__((unused)), const uint8_t *data, uint16_t len)
+{
+  memcpy(&p->buf[p->len], data, len);
+  p->len += len;
+}
+
+static void dl_udp_send_message(struct DlUdp *p, long fd __attribute__((unused)))
+{
+  udp_socket_send_dontwait(&p->socket, p->buf, p->len);
+  p->len = 0;
+}
+
+static int dl_udp_char_available(struct DlUdp *p __attribute__((unused)))
+{
+  return 0;
+}
+
+static uint8_t dl_udp_get_byte(struct DlUdp *p __attribute__((unused)))
+{
+  return 0;
+}
+
+/** Transmit the rigid bodies of the last frame, extrapolated to the expected reception time */
+static void transmit_event(double rx_time)
+{
+  int i;
+
+  for (i = 0; i < natnet_nb_rigid; i++) {
+    struct RigidBody *rb = &rigidBodies[i];
+    if (rb->id < 0 || rb->id >= MAX_RIGIDBODIES || aircrafts[rb->id].ac_id == 0 || !rb->posSampled) {
+      continue;
+    }
+    rb->nSamples = 0;
+
+    struct DoubleVect3 p = { rb->x, rb->y, rb->z };
+    struct DoubleQuat q = { rb->qw, rb->qx, rb->qy, rb->qz };
+
+    // Differentiate position and orientation with the NatNet time, low pass filtered
+    double dt = natnet_timestamp - rb->evStamp;
+    if (rb->evValid && dt > 0. && dt < EXTRAPOLATION_MAX_DT) {
+      double k = dt / (dt + EXTRAPOLATION_TAU);
+      struct DoubleQuat q_prev_inv = { rb->evQuat.qi, -rb->evQuat.qx, -rb->evQuat.qy, -rb->evQuat.qz };
+      struct DoubleQuat dq;
+      quat_comp(&dq, &q_prev_inv, &q);
+      if (dq.qi < 0.) {
+        QUAT_EXPLEMENTARY(dq, dq);
+      }
+      rb->evVel.x += k * ((p.x - rb->evPos.x) / dt - rb->evVel.x);
+      rb->evVel.y += k * ((p.y - rb->evPos.y) / dt - rb->evVel.y);
+      rb->evVel.z += k * ((p.z - rb->evPos.z) / dt - rb->evVel.z);
+      rb->evRates.p += k * (2. * dq.qx / dt - rb->evRates.p);
+      rb->evRates.q += k * (2. * dq.qy / dt - rb->evRates.q);
+      rb->evRates.r += k * (2. * dq.qz / dt - rb->evRates.r);
+    } else {
+      FLOAT_VECT3_ZERO(rb->evVel);
+      FLOAT_RATES_ZERO(rb->evRates);
+    }
+    rb->evValid = TRUE;
+    rb->evStamp = natnet_timestamp;
+    rb->evPos = p;
+    rb->evQuat = q;
+
+    // Extrapolate to the expected reception time by the aircraft,
+    // the NatNet latency field is not a delay (used as a time for the connection timeout)
+    double horizon = (get_time() - rx_time) + link_delay;
+    Bound(horizon, 0., EXTRAPOLATION_MAX_HORIZON);
+    p.x += rb->evVel.x * horizon;
+    p.y += rb->evVel.y * horizon;
+    p.z += rb->evVel.z * horizon;
+    struct DoubleQuat q_rot = { 1., rb->evRates.p * horizon / 2., rb->evRates.q * horizon / 2., rb->evRates.r * horizon / 2. };
+    struct DoubleQuat q_ext;
+    quat_comp(&q_ext, &q, &q_rot);
+    double_quat_normalize(&q_ext);
+
+    // Add the Optitrack angle to the x and y positions and velocities
+    struct EnuCoor_d pos, speed;
+    pos.x = cos(tracking_offset_angle) * p.x - sin(tracking_offset_angle) * p.y;
+    pos.y = sin(tracking_offset_angle) * p.x + cos(tracking_offset_angle) * p.y;
+    pos.z = p.z;
+    speed.x = cos(tracking_offset_angle) * rb->evVel.x - sin(tracking_offset_angle) * rb->evVel.y;
+    speed.y = sin(tracking_offset_angle) * rb->evVel.x + cos(tracking_offset_angle) * rb->evVel.y;
+    speed.z = rb->evVel.z;
+
+    // Heading as for the timer mode
+    struct DoubleEulers eulers;
+    double_eulers_of_quat(&eulers, &q_ext);
+    double heading = -eulers.psi + 90.0 / 57.6 - tracking_offset_angle;
+    NormRadAngle(heading);
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    struct tm *ts = localtime(&now.tv_sec);
+    uint32_t tow = ts->tm_wday * (24 * 60 * 60 * 1000) + ts->tm_hour * (60 * 60 * 1000) + ts->tm_min *
+                   (60 * 1000) + ts->tm_sec * 1000 + now.tv_usec / 1000 ;
+
+    uint8_t ac_id = aircrafts[rb->id].ac_id;
+    float enu_x = pos.x, enu_y = pos.y, enu_z = pos.z;
+    float enu_xd = speed.x, enu_yd = speed.y, enu_zd = speed.z;
+    float course = DegOfRad(heading);
+    if (dl_udp_host != NULL) {
+      uint8_t pad = 0;
+      pprz_msg_send_REMOTE_GPS_LOCAL(&dl_tp.trans_tx, &dl_udp.device, 0, &ac_id, &pad,
+                                     &enu_x, &enu_y, &enu_z, &enu_xd, &enu_yd, &enu_zd, &tow, &course);
+    } else {
+      IvySendMsg("0 REMOTE_GPS_LOCAL %d 0 %f %f %f %f %f %f %d %f", ac_id,
+                 enu_x, enu_y, enu_z, enu_xd, enu_yd, enu_zd, tow, course);
+    }
+
+    latency_stats_add(&stats_processing, get_time() - rx_time);
+    latency_stats_add(&stats_horizon, horizon);
+  }
+
+  if (verbose > 0 && rx_time - stats_start > STATS_PERIOD) {
+    fprintf(stderr, "Latency over the last %.0f s:\n", rx_time - stats_start);
+    latency_stats_print("processing", &stats_processing);
+    latency_stats_print("horizon", &stats_horizon);
+    stats_start = rx_time;
+  }
+}
+
 /** The NatNet sampler periodic function */
 static gboolean sample_data(GIOChannel *chan, GIOCondition cond, gpointer data)
 {
@@ -721,12 +942,19 @@ static gboolean sample_data(GIOChannel *chan, GIOCondition cond, gpointer data)
 
   // Keep on reading until we have the whole packet
   bytes_data += udp_socket_recv(&natnet_data, buffer_data, MAX_PACKETSIZE);
+  double rx_time = get_time();
 
   // Parse NatNet data
   if (bytes_data >= 2) {
     uint16_t packet_size = ((uint16_t)buffer_data[3])<<8 | (uint16_t)buffer_data[2];
     if( bytes_data - 4 >= packet_size) {  // 4 bytes for message id and packet size
+      natnet_nb_rigid = 0;
+      uint16_t msg_id = ((uint16_t)buffer_data[1])<<8 | (uint16_t)buffer_data[0];
       natnet_parse(buffer_data);
+      // only frames carry new poses, the statistics are for frames only
+      if (event_mode && msg_id == NAT_FRAMEOFDATA) {
+        transmit_event(rx_time);
+      }
     }
     bytes_data = 0;
   }
@@ -760,6 +988,10 @@ void print_help(char *filename)
     "   -vel_samples <samples>    Minimum amount of samples for the velocity differentiator (4)\n"
     "   -small                    Send small packets instead of bigger (FALSE)\n\n"
 
+    "   -event                    Send REMOTE_GPS_LOCAL as soon as a frame is received, extrapolated (FALSE)\n"
+    "   -extrapolate <ms>         Event mode: expected delay to the aircraft, added to the processing time (0)\n"
+    "   -dl_udp <ip> <port>       Event mode: send binary messages directly to the aircraft instead of ivy\n\n"
+
     "   -ivy_bus <address:port>   Ivy bus address and port (127.255.255.255:2010)\n";
   fprintf(stderr, usage, filename);
 }
@@ -892,6 +1124,24 @@ static void parse_options(int argc, char **argv)
       small_packets = TRUE;
     }
 
+    // Set the event driven transmission
+    else if (strcmp(argv[i], "-event") == 0) {
+      event_mode = TRUE;
+    }
+    // Set the expected delay to the aircraft
+    else if (strcmp(argv[i], "-extrapolate") == 0) {
+      check_argcount(argc, argv, i, 1);
+
+      link_delay = atof(argv[++i]) / 1000.;
+    }
+    // Set the direct datalink
+    else if (strcmp(argv[i], "-dl_udp") == 0) {
+      check_argcount(argc, argv, i, 2);
+
+      dl_udp_host = argv[++i];
+      dl_udp_port = atoi(argv[++i]);
+    }
+
     // Set the ivy bus
     else if (strcmp(argv[i], "-ivy_bus") == 0) {
       check_argcount(argc, argv, i, 1);
@@ -946,10 +1196,30 @@ int main(int argc, char **argv)
   IvyInit("natnet2ivy", "natnet2ivy READY", 0, 0, 0, 0);
   IvyStart(ivy_bus);
 
+  // Create the direct datalink
+  if (dl_udp_host != NULL) {
+    printf_debug("Starting direct datalink (aircraft address: %s, port: %d)\n", dl_udp_host, dl_udp_port);
+    udp_socket_create(&dl_udp.socket, dl_udp_host, dl_udp_port, -1, 0);
+    dl_udp.len = 0;
+    dl_udp.device.periph = (void *)&dl_udp;
+    dl_udp.device.check_free_space = (check_free_space_t) dl_udp_check_free_space;
+    dl_udp.device.put_byte = (put_byte_t) dl_udp_put_byte;
+    dl_udp.device.put_buffer = (put_buffer_t) dl_udp_put_buffer;
+    dl_udp.device.send_message = (send_message_t) dl_udp_send_message;
+    dl_udp.device.char_available = (char_available_t) dl_udp_char_available;
+    dl_udp.device.get_byte = (get_byte_t) dl_udp_get_byte;
+    pprz_transport_init(&dl_tp);
+  }
+
   // Create the main timers
-  printf_debug("Starting transmitting and sampling timeouts (transmitting frequency: %dHz, minimum velocity samples: %d)\n",
-               freq_transmit, min_velocity_samples);
-  g_timeout_add(1000 / freq_transmit, timeout_transmit_callback, NULL);
+  if (event_mode) {
+    printf_debug("Transmitting on each frame (expected delay to the aircraft: %.1f ms)\n", link_delay * 1000.);
+    stats_start = get_time();
+  } else {
+    printf_debug("Starting transmitting and sampling timeouts (transmitting frequency: %dHz, minimum velocity samples: %d)\n",
+                 freq_transmit, min_velocity_samples);
+    g_timeout_add(1000 / freq_transmit, timeout_transmit_callback, NULL);
+  }
 
   GIOChannel *sk = g_io_channel_unix_new(natnet_data.sockfd);
   g_io_add_watch(sk, G_IO_IN | G_IO_NVAL | G_IO_HUP,
@@ -0,0 +1,160 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2026 The Paparazzi Team
+#
+# This file is part of paparazzi.
+#
+# paparazzi is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2, or (at your option)
+# any later version.
+#
+# paparazzi is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with paparazzi; see the file COPYING.  If not, see
+# <http://www.gnu.org/licenses/>.
+#
+
+'''
+Bridge from the shared memory message bus (sw/airborne/arch/linux/shm_bus.h)
+to Ivy, for the tools which only listen to Ivy (GCS, messages, plotter...).
+
+The binary pprzlink messages of one or several topics are decoded with the
+messages definition and sent on Ivy as text, as if they came from link.
+Topics are polled; a subscriber which is too slow loses the oldest messages,
+they are reported with -v.
+
+usage examples:
+    ./shm2ivy.py --topic=nps
+    ./shm2ivy.py --topic=nps --topic=telemetry -b 127.255.255.255 -v
+'''
+
+from __future__ import print_function
+
+import os
+import sys
+import mmap
+import struct
+import time
+import argparse
+
+# if PAPARAZZI_SRC not set, then assume the tree containing this
+# file is a reasonable substitute
+PAPARAZZI_HOME = os.getenv("PAPARAZZI_HOME", os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)),'../../../../')))
+sys.path.append(PAPARAZZI_HOME + "/var/lib/python")
+
+import pprzlink.ivy
+import pprzlink.messages_xml_map as messages_xml_map
+import pprzlink.message as message
+
+SHM_BUS_MAGIC = 0x50505A42
+SHM_BUS_VERSION = 1
+HEADER_SIZE = 64
+HEADER = struct.Struct('<IIIIQII')
+SLOT = struct.Struct('<QII')
+
+
+class ShmBusReader:
+    '''Subscriber of a shared memory topic, same protocol as shm_bus.c'''
+    def __init__(self, topic):
+        self.topic = topic
+        with open('/dev/shm/pprz_bus_' + topic, 'r+b') as f:
+            self.mem = mmap.mmap(f.fileno(), 0)
+        magic, version, self.nb_slots, self.slot_size, write_seq, _, _ = HEADER.unpack_from(self.mem, 0)
+        if magic != SHM_BUS_MAGIC or version != SHM_BUS_VERSION:
+            raise ValueError('%s is not a shared memory bus topic' % topic)
+        self.stride = (SLOT.size + self.slot_size + 63) & ~63
+        self.read_seq = write_seq
+        self.nb_received = 0
+        self.nb_dropped = 0
+
+    def write_seq(self):
+        return HEADER.unpack_from(self.mem, 0)[4]
+
+    def read(self):
+        '''Return the next message payload or None'''
+        while True:
+            offset = HEADER_SIZE + (self.read_seq & (self.nb_slots - 1)) * self.stride
+            stamp, length, _ = SLOT.unpack_from(self.mem, offset)
+            if stamp < 2 * (self.read_seq + 1):
+                return None
+            if stamp == 2 * (self.read_seq + 1):
+                length = min(length, self.slot_size)
+                data = self.mem[offset + SLOT.size:offset + SLOT.size + length]
+                valid = SLOT.unpack_from(self.mem, offset)[0] == stamp
+                self.read_seq += 1
+                if valid:
+                    self.nb_received += 1
+                    return data
+                self.nb_dropped += 1
+                continue
+            # overwritten by the publishers, skip to the oldest message left
+            oldest = max(self.write_seq() - self.nb_slots + 1, self.read_seq + 1)
+            self.nb_dropped += oldest - self.read_seq
+            self.read_seq = oldest
+
+
+class Shm2Ivy:
+    def __init__(self, topics, bus, verbose=False):
+        messages_xml_map.parse_messages()
+        self.readers = [ShmBusReader(t) for t in topics]
+        self.ivy = pprzlink.ivy.IvyMessagesInterface("shm2ivy", start_ivy=False, ivy_bus=bus)
+        self.verbose = verbose
+        self.v2 = messages_xml_map.PROTOCOL_VERSION == "2.0"
+
+    def decode(self, data):
+        '''Decode a bus payload: sender, (receiver, class and component,) message id, fields'''
+        if self.v2:
+            sender_id, receiver_id, cc, msg_id = struct.unpack_from('<BBBB', data)
+            class_name = messages_xml_map.get_class_name(cc & 0x0F)
+            offset = 4
+        else:
+            sender_id, msg_id = struct.unpack_from('<BB', data)
+            receiver_id, class_name = None, "telemetry"
+            offset = 2
+        msg = message.PprzMessage(class_name, msg_id)
+        msg.binary_to_payload(data[offset:])
+        return sender_id, receiver_id, msg
+
+    def run(self, period):
+        self.ivy.start()
+        last_report = time.time()
+        try:
+            while True:
+                nb = 0
+                for reader in self.readers:
+                    data = reader.read()
+                    while data is not None:
+                        try:
+                            sender_id, receiver_id, msg = self.decode(data)
+                            self.ivy.send(msg, sender_id, receiver_id)
+                        except Exception as e:
+                            if self.verbose:
+                                print("%s: can't decode message (%s)" % (reader.topic, e))
+                        nb += 1
+                        data = reader.read()
+                if self.verbose and time.time() - last_report > 5.:
+                    for reader in self.readers:
+                        print("%s: %d messages, %d dropped" % (reader.topic, reader.nb_received, reader.nb_dropped))
+                    last_report = time.time()
+                if nb == 0:
+                    time.sleep(period)
+        except KeyboardInterrupt:
+            print("Stopping shm2ivy.")
+            self.ivy.stop()
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="Bridge from the shared memory message bus to Ivy")
+    parser.add_argument('-t', '--topic', dest='topics', action='append', help="shared memory topic, can be repeated")
+    parser.add_argument('-b', '--bus', dest='bus', default=None, help="Ivy bus address")
+    parser.add_argument('-p', '--period', dest='period', type=float, default=0.002, help="polling period when idle in seconds")
+    parser.add_argument('-v', '--verbose', dest='verbose', action='store_true', help="print statistics")
+    args = parser.parse_args()
+    if not args.topics:
+        parser.error("at least one topic is needed")
+    Shm2Ivy(args.topics, args.bus, args.verbose).run(args.period)
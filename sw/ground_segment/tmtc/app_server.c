@@ -50,6 +50,8 @@ char* AppPass;
 #define MAXIPLEN 50
 #define MAXNAMELENGTH 500
 #define MAXDEVICENUMB 255
+#define MAXDATAGRAM 1400 //Coalesced messages per datagram (fits the usual MTU)
+#define MAXPENDING 65536 //Data waiting for a slow tcp client (drop messages above)
 
 #define MAXWPNUMB 50  //NUMBER OF WP PER AC (MAX)
 #define MAXWPNUMB 50  //NUMBER OF WP PER AC (MAX)
@@ -75,6 +77,18 @@ int verbose = 0;
 //TCP flag
 int uTCP = 0;
 
+//Coalescing period of ivy messages in ms (0: send each message when received)
+int batch_period = 0;
+//Per client rate limit in bytes/s (0: unlimited)
+int client_rate = 0;
+
+//Coalesced messages, sent to all clients at once
+char batch_buffer[BUFLEN];
+gsize batch_len = 0;
+
+//Shared udp socket for all clients
+GSocket *udpSocket = NULL;
+
 int ProcessID;
 int RequestID;
 
@@ -114,6 +128,15 @@ typedef struct {
   char client_ip[MAXIPLEN];
   //Pointer for tcp connection;
   gpointer ClientTcpData;
+  //Udp destination, created once when client is added
+  GSocketAddress *udp_address;
+  //Tcp data not yet accepted by the client socket
+  GString *pending;
+  //Rate limit (token bucket in bytes)
+  gdouble tokens;
+  gint64 last_refill;
+  //Number of messages dropped for this client
+  guint dropped;
 } client_data;
 
 client_data ConnectedClients[MAXCLIENT];  //Holds all status of devices
@@ -142,8 +165,17 @@ void remove_client(char* RemClientIpAd) {
         //record found clean it!!
         ConnectedClients[i].client_ip[0]='\0';
         ConnectedClients[i].used=0;
+        if (ConnectedClients[i].udp_address != NULL) {
+          g_object_unref(ConnectedClients[i].udp_address);
+          ConnectedClients[i].udp_address = NULL;
+        }
+        if (ConnectedClients[i].pending != NULL) {
+          g_string_free(ConnectedClients[i].pending, TRUE);
+          ConnectedClients[i].pending = NULL;
+        }
         if (verbose) {
-          printf("App Server: Client removed from client list %s\n", RemClientIpAd);
+          printf("App Server: Client removed from client list %s (%u messages dropped)\n",
+              RemClientIpAd, ConnectedClients[i].dropped);
           fflush(stdout);
         }
         return;
@@ -176,6 +208,22 @@ void add_client(char* ClientIpAd, gpointer connection_in) {
     //record new client ip
     g_stpcpy(ConnectedClients[i].client_ip,ClientIpAd);
     ConnectedClients[i].ClientTcpData = connection_in;
+    //persistent destination and buffers
+    if (uTCP) {
+      ConnectedClients[i].udp_address = NULL;
+      ConnectedClients[i].pending = g_string_sized_new(BUFLEN);
+    } else {
+      GInetAddress *udpAddress = g_inet_address_new_from_string(ClientIpAd);
+      ConnectedClients[i].udp_address = NULL;
+      if (udpAddress != NULL) {
+        ConnectedClients[i].udp_address = g_inet_socket_address_new(udpAddress, udp_port);
+        g_object_unref(udpAddress);
+      }
+      ConnectedClients[i].pending = NULL;
+    }
+    ConnectedClients[i].tokens = client_rate;
+    ConnectedClients[i].last_refill = g_get_monotonic_time();
+    ConnectedClients[i].dropped = 0;
     //
     ConnectedClients[i].used = 1;
     if (verbose) {
@@ -272,59 +320,156 @@ int get_bl_data(char* InStr, char* RetBuf) {
   return AcID;
 }
 
+//Check client rate limit, consume tokens if data can be sent
+gboolean client_rate_ok(client_data *client, gsize len) {
+  if (client_rate <= 0) {
+    return TRUE;
+  }
+  gint64 now = g_get_monotonic_time();
+  client->tokens += (gdouble)client_rate * (now - client->last_refill) / G_USEC_PER_SEC;
+  client->last_refill = now;
+  //allow a burst of one second of data
+  if (client->tokens > client_rate) {
+    client->tokens = client_rate;
+  }
+  if (client->tokens < len) {
+    return FALSE;
+  }
+  client->tokens -= len;
+  return TRUE;
+}
+
+//Write pending tcp data without blocking
+void flush_tcp_client(client_data *client) {
+  if (client->pending->len == 0) {
+    return;
+  }
+  GSocket *socket = g_socket_connection_get_socket(client->ClientTcpData);
+  gssize sent = g_socket_send_with_blocking(socket, client->pending->str, client->pending->len,
+      FALSE, NULL, NULL);
+  if (sent > 0) {
+    g_string_erase(client->pending, 0, sent);
+  }
+}
+
+//Reply to a client request, after the data already queued for it
+void reply_to_client(gpointer connection, const gchar *buffer, gsize len) {
+  int i;
+  for (i = 0; i < MAXCLIENT; i++) {
+    if (ConnectedClients[i].used > 0 && ConnectedClients[i].ClientTcpData == connection &&
+        ConnectedClients[i].pending != NULL) {
+      g_string_append_len(ConnectedClients[i].pending, buffer, len);
+      flush_tcp_client(&ConnectedClients[i]);
+      return;
+    }
+  }
+  GOutputStream * ostream = g_io_stream_get_output_stream (connection);
+  g_output_stream_write(ostream, buffer, len, NULL, NULL);
+}
+
+//A udp message could not be sent, it is dropped for this client only
+void udp_send_failed(client_data *client, GError **error) {
+  client->dropped++;
+  if (verbose && *error != NULL) {
+    printf("App Server: stg wrong with send func: %s\n", (*error)->message);
+    fflush(stdout);
+  }
+  g_clear_error(error);
+}
+
 //Bfoadcast ivy msgs to clients
-void broadcast_to_clients () {
+void broadcast_to_clients (const gchar *buffer, gsize len) {
 
   int i;
 
   if (uTCP) {
     //broadcast using tcp connection
-    GError *error = NULL;
-
+    //the ivy loop never waits for a client, data is queued and sent when possible
     for (i = 0; i < MAXCLIENT; i++) {
       if (ConnectedClients[i].used > 0) {
-        GOutputStream * ostream = g_io_stream_get_output_stream (ConnectedClients[i].ClientTcpData);
-        g_output_stream_write(ostream, ivybuffer, strlen(ivybuffer), NULL, &error);
+        client_data *client = &ConnectedClients[i];
+        if (client->pending->len + len > MAXPENDING || !client_rate_ok(client, len)) {
+          client->dropped++;
+        } else {
+          g_string_append_len(client->pending, buffer, len);
+        }
+        flush_tcp_client(client);
       }
-
     }
     return;
   }
 
-  i=0;
+  //same payload to all clients with persistent addresses
+  client_data *dest[MAXCLIENT];
+  guint nb = 0, m;
   for (i = 0; i < MAXCLIENT; i++) {
-    if (ConnectedClients[i].used > 0) {
-
-      //Send data
-      GInetAddress *udpAddress;
-      GSocketAddress *udpSocketAddress;
-      GSocket *udpSocket;
+    if (ConnectedClients[i].used > 0 && ConnectedClients[i].udp_address != NULL) {
+      if (!client_rate_ok(&ConnectedClients[i], len)) {
+        ConnectedClients[i].dropped++;
+        continue;
+      }
+      dest[nb++] = &ConnectedClients[i];
+    }
+  }
+  if (nb == 0) {
+    return;
+  }
 
-      udpAddress = g_inet_address_new_from_string(ConnectedClients[i].client_ip);
+  GError *error = NULL;
+#if GLIB_CHECK_VERSION (2, 44, 0)
+  //all clients in a single call (sendmmsg where available)
+  GOutputVector vector = { buffer, len };
+  GOutputMessage messages[MAXCLIENT];
+  for (m = 0; m < nb; m++) {
+    messages[m].address = dest[m]->udp_address;
+    messages[m].vectors = &vector;
+    messages[m].num_vectors = 1;
+    messages[m].bytes_sent = 0;
+    messages[m].control_messages = NULL;
+    messages[m].num_control_messages = 0;
+  }
+  //the call can send only the first messages, the others are sent again
+  m = 0;
+  while (m < nb) {
+    gint sent = g_socket_send_messages(udpSocket, messages + m, nb - m, 0, NULL, &error);
+    if (sent > 0) {
+      m += sent;
+    } else {
+      //the first remaining message failed, skip its client
+      udp_send_failed(dest[m++], &error);
+    }
+  }
+#else
+  for (m = 0; m < nb; m++) {
+    if (g_socket_send_to(udpSocket, dest[m]->udp_address, buffer, len, NULL, &error) < 0) {
+      udp_send_failed(dest[m], &error);
+    }
+  }
+#endif
 
-      udpSocketAddress = g_inet_socket_address_new(udpAddress, udp_port);
+}
 
-      udpSocket = g_socket_new(G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM, 17, NULL);
+//Send coalesced messages
+void flush_batch(void) {
+  if (batch_len > 0) {
+    broadcast_to_clients(batch_buffer, batch_len);
+    batch_len = 0;
+  }
+}
 
-      if (g_socket_connect(udpSocket, udpSocketAddress, NULL, NULL) == FALSE) {
-        printf("App Server: stg wrong with socket connect\n");
-        fflush(stdout);
-      }
-      if (g_socket_send(udpSocket, ivybuffer, strlen(ivybuffer) , NULL, NULL) < 0) {
-        printf("App Server: stg wrong with send func\n");
-        fflush(stdout);
-      }
-      if (g_socket_close(udpSocket, NULL) == FALSE) {
-        printf("App Server: stg wrong with socket close\n");
-        fflush(stdout);
+//Periodic sending of coalesced messages
+gboolean batch_timeout(gpointer data) {
+  flush_batch();
+  //retry slow tcp clients even when there is no new message
+  if (uTCP) {
+    int i;
+    for (i = 0; i < MAXCLIENT; i++) {
+      if (ConnectedClients[i].used > 0) {
+        flush_tcp_client(&ConnectedClients[i]);
       }
-      //Unref objects
-      g_object_unref(udpAddress);
-      g_object_unref(udpSocketAddress);
-      g_object_unref(udpSocket);
     }
   }
-
+  return TRUE;
 }
 
 //Read tcp requests of connected clients
@@ -375,8 +520,7 @@ gboolean network_read(GIOChannel *source, GIOCondition cond, gpointer data) {
       //Read ac data
       if (get_ac_data(RecString, AcData)) {
         //Send requested data to client
-        GOutputStream * ostream = g_io_stream_get_output_stream (data);
-        g_output_stream_write(ostream, AcData, strlen(AcData), NULL, &error);
+        reply_to_client(data, AcData, strlen(AcData));
       }
     }
     //Waypoint data request (Ignore client password)
@@ -385,8 +529,7 @@ gboolean network_read(GIOChannel *source, GIOCondition cond, gpointer data) {
       //Read wp data of ac
       if (get_wp_data(RecString, AcData)) {
         //Send requested data to client
-        GOutputStream * ostream = g_io_stream_get_output_stream (data);
-        g_output_stream_write(ostream, AcData, strlen(AcData), NULL, &error);
+        reply_to_client(data, AcData, strlen(AcData));
       }
     }
     //Waypoint data request (Ignore client password)
@@ -395,8 +538,7 @@ gboolean network_read(GIOChannel *source, GIOCondition cond, gpointer data) {
       //Read block data of AC
       if (get_bl_data(RecString, AcData)) {
         //Send requested data to client
-        GOutputStream * ostream = g_io_stream_get_output_stream (data);
-        g_output_stream_write(ostream, AcData, strlen(AcData), NULL, &error);
+        reply_to_client(data, AcData, strlen(AcData));
       }
     }
 
@@ -488,11 +630,27 @@ void request_ac_config(int ac_id_req) {
 void Ivy_All_Msgs(IvyClientPtr app, void *user_data, int argc, char *argv[]){
 
   //For compatibility.. This will be joined in upcoming releases..
-  if (uTCP) sprintf(ivybuffer, "%s\n", argv[0]);
-  else sprintf(ivybuffer, "%s", argv[0]);
+  //Coalesced udp messages are separated by new lines
+  int len;
+  if (uTCP || batch_period > 0) len = snprintf(ivybuffer, BUFLEN, "%s\n", argv[0]);
+  else len = snprintf(ivybuffer, BUFLEN, "%s", argv[0]);
+  if (len >= BUFLEN) {
+    //truncated, drop it
+    return;
+  }
+
+  if (batch_period <= 0) {
+    //Ivy msg received broadcast to clients..
+    broadcast_to_clients(ivybuffer, len);
+    return;
+  }
 
-  //Ivy msg received broadcast to clients..
-  broadcast_to_clients();
+  //Ivy msg received, add it to the next datagram
+  if (batch_len + len > MAXDATAGRAM) {
+    flush_batch();
+  }
+  memcpy(batch_buffer + batch_len, ivybuffer, len);
+  batch_len += len;
 
 }
 
@@ -819,6 +977,8 @@ void print_help() {
   printf("   -b <Ivy bus>\tdefault is %s\n", defaultIvyBus);
   printf("   -p <password>\tpassword for connection with control capabilities (default is %s)\n", defaultAppPass);
   printf("   -utcp \t\tUse TCP communication to send ivy messages (default: UDP )\n");
+  printf("   -batch <ms>\tcoalesce ivy messages and send them every <ms> (default: send immediately)\n");
+  printf("   -r <bytes/s>\tmaximum data rate for each client, messages above are dropped (default: unlimited)\n");
   printf("   -v\tverbose\n");
   printf("   -h --help show this help\n");
 }
@@ -866,6 +1026,12 @@ int main(int argc, char **argv) {
     else if (strcmp(argv[i], "-utcp") == 0) {
       uTCP = 1;
     }
+    else if (strcmp(argv[i], "-batch") == 0) {
+      batch_period = atoi(argv[++i]);
+    }
+    else if (strcmp(argv[i], "-r") == 0) {
+      client_rate = atoi(argv[++i]);
+    }
     else {
       printf("App Server: Unknown option\n");
       print_help();
@@ -881,6 +1047,12 @@ int main(int argc, char **argv) {
     }else{
       printf("Server broadcast port (UDP) : %d\n", udp_port);
     }
+    if (batch_period > 0) {
+      printf("Coalescing period           : %d ms\n", batch_period);
+    }
+    if (client_rate > 0) {
+      printf("Client rate limit           : %d bytes/s\n", client_rate);
+    }
     printf("Control Pass                : %s\n", AppPass);
     printf("Ivy Bus                     : %s\n", IvyBus);
     fflush(stdout);
@@ -907,6 +1079,16 @@ int main(int argc, char **argv) {
   //Connect listening signal
   g_signal_connect(service, "incoming", G_CALLBACK(new_connection), NULL);
 
+  //Udp socket shared by all clients, never blocks the ivy loop
+  if (!uTCP) {
+    udpSocket = g_socket_new(G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM, G_SOCKET_PROTOCOL_UDP, NULL);
+    if (udpSocket == NULL) {
+      printf("App Server: can't create udp socket\n");
+      exit(1);
+    }
+    g_socket_set_blocking(udpSocket, FALSE);
+  }
+
   //Here comes the ivy bindings
   IvyInit ("PPRZ_App_Server", "Papparazzi App Server Ready!", NULL, NULL, NULL, NULL);
 
@@ -925,6 +1107,11 @@ int main(int argc, char **argv) {
   IvySendMsg("app_server");
 
   g_timeout_add(100, request_ac_list, NULL);
+  if (batch_period > 0) {
+    g_timeout_add(batch_period, batch_timeout, NULL);
+  } else if (uTCP) {
+    g_timeout_add(20, batch_timeout, NULL);
+  }
 
   g_main_loop_run(loop);
 
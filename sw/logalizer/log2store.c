@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file log2store.c
+ *
+ * Convert a .data log to an indexed columnar store (see log_store.h) and
+ * query it.
+ *
+ *   log2store [-l file.log] file.data [file.pcol]
+ *       convert, the .log with the same name is used by default
+ *   log2store -i file.pcol
+ *       time range and messages of a store
+ *   log2store -q file.pcol [sender:]MSG.field [t0 [t1]]
+ *       print "time value" of a field between t0 and t1
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "log_store.h"
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "usage: %s [-l file.log] file.data [file.pcol]\n"
+          "       %s -i file.pcol\n"
+          "       %s -q file.pcol [sender:]MSG.field [t0 [t1]]\n", name, name, name);
+}
+
+/** Same name with another extension, malloc'ed */
+static char *change_ext(const char *file, const char *ext)
+{
+  const char *dot = strrchr(file, '.');
+  const char *slash = strrchr(file, '/');
+  size_t n = (dot != NULL && (slash == NULL || dot > slash)) ? (size_t)(dot - file) : strlen(file);
+  char *out = malloc(n + strlen(ext) + 1);
+  memcpy(out, file, n);
+  strcpy(out + n, ext);
+  return out;
+}
+
+static int convert(const char *data_file, const char *log_file, const char *out_file)
+{
+  char *log = NULL, *out = NULL;
+  if (log_file == NULL) {
+    log = change_ext(data_file, ".log");
+    if (access(log, R_OK) == 0) {
+      log_file = log;
+    } else {
+      fprintf(stderr, "No %s, fields are named f0, f1, ...\n", log);
+    }
+  }
+  if (out_file == NULL) {
+    out = change_ext(data_file, ".pcol");
+    out_file = out;
+  }
+  int ret = log_store_convert(data_file, log_file, out_file);
+  if (ret < 0) {
+    fprintf(stderr, "Conversion of %s failed: %s\n", data_file, strerror(errno));
+  } else {
+    printf("%s written\n", out_file);
+  }
+  free(log);
+  free(out);
+  return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+static int info(const struct LogStore *s)
+{
+  printf("time: %.3f to %.3f, %llu messages\n", s->header->t_min, s->header->t_max,
+         (unsigned long long)s->header->nb_rows);
+  for (uint32_t i = 0; i < s->header->nb_msgs; i++) {
+    const struct LogStoreMsg *m = &s->msgs[i];
+    const struct LogStoreField *f = log_store_fields(s, m);
+    printf("%s:%s %llu", log_store_name(s, m->sender), log_store_name(s, m->name), (unsigned long long)m->nb_rows);
+    for (uint32_t j = 0; j < m->nb_fields; j++) {
+      printf(" %s", log_store_name(s, f[j].name));
+    }
+    printf("\n");
+  }
+  return EXIT_SUCCESS;
+}
+
+static int query(const struct LogStore *s, char *spec, double t0, double t1)
+{
+  char *sender = NULL;
+  char *name = spec;
+  char *colon = strchr(spec, ':');
+  if (colon != NULL) {
+    *colon = '\0';
+    sender = spec;
+    name = colon + 1;
+  }
+  char *dot = strchr(name, '.');
+  if (dot == NULL) {
+    fprintf(stderr, "Field expected: MSG.field\n");
+    return EXIT_FAILURE;
+  }
+  *dot = '\0';
+  const struct LogStoreMsg *m = log_store_find_msg(s, sender, name);
+  if (m == NULL) {
+    fprintf(stderr, "No message %s\n", name);
+    return EXIT_FAILURE;
+  }
+  int field = log_store_find_field(s, m, dot + 1);
+  if (field < 0) {
+    fprintf(stderr, "No field %s in %s\n", dot + 1, name);
+    return EXIT_FAILURE;
+  }
+  size_t first;
+  size_t n = log_store_range(s, m, t0, t1, &first);
+  const double *time = log_store_time(s, m);
+  const double *col = log_store_column(s, m, field);
+  for (size_t i = first; i < first + n; i++) {
+    if (col != NULL) {
+      printf("%.4f %.10g\n", time[i], col[i]);
+    } else {
+      size_t len;
+      const char *text = log_store_text(s, m, field, i, &len);
+      printf("%.4f %.*s\n", time[i], (int)len, text);
+    }
+  }
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+  const char *log_file = NULL;
+  int mode = 'c';
+  int opt;
+  while ((opt = getopt(argc, argv, "l:iqh")) != -1) {
+    switch (opt) {
+      case 'l':
+        log_file = optarg;
+        break;
+      case 'i':
+      case 'q':
+        mode = opt;
+        break;
+      default:
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  int nb = argc - optind;
+  if (mode == 'c') {
+    if (nb < 1 || nb > 2) {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    return convert(argv[optind], log_file, nb == 2 ? argv[optind + 1] : NULL);
+  }
+
+  if ((mode == 'i' && nb != 1) || (mode == 'q' && (nb < 2 || nb > 4))) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  struct LogStore s;
+  if (log_store_open(&s, argv[optind]) < 0) {
+    fprintf(stderr, "Can't open %s: %s\n", argv[optind], strerror(errno));
+    return EXIT_FAILURE;
+  }
+  int ret;
+  if (mode == 'i') {
+    ret = info(&s);
+  } else {
+    double t0 = nb > 2 ? atof(argv[optind + 2]) : s.header->t_min;
+    double t1 = nb > 3 ? atof(argv[optind + 3]) : s.header->t_max;
+    ret = query(&s, argv[optind + 1], t0, t1);
+  }
+  log_store_close(&s);
+  return ret;
+}
@@ -0,0 +1,766 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file log_store.c
+ *
+ * Indexed columnar store of a .data flight log.
+ */
+
+#include "log_store.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/** Longest line of a .data file */
+#define LOG_STORE_LINE_MAX 65536
+
+/*
+ * Mapped input files
+ */
+
+struct mapped {
+  const char *data;
+  size_t size;
+};
+
+static int map_file(struct mapped *m, const char *file)
+{
+  struct stat st;
+  int fd = open(file, O_RDONLY);
+  if (fd < 0) {
+    return -1;
+  }
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    return -1;
+  }
+  m->size = st.st_size;
+  m->data = NULL;
+  if (m->size > 0) {
+    void *p = mmap(NULL, m->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      close(fd);
+      return -1;
+    }
+    madvise(p, m->size, MADV_SEQUENTIAL);
+    m->data = p;
+  }
+  close(fd);
+  return 0;
+}
+
+static void unmap_file(struct mapped *m)
+{
+  if (m->data != NULL) {
+    munmap((void *)m->data, m->size);
+  }
+  m->data = NULL;
+}
+
+/*
+ * Message definitions from the .log file
+ */
+
+struct field_def {
+  char *name;
+  uint8_t type;
+};
+
+struct msg_def {
+  char *name;
+  int telemetry;          ///< defined in the telemetry class
+  uint32_t nb_fields;
+  struct field_def *fields;
+};
+
+struct defs {
+  struct msg_def *msgs;
+  uint32_t nb, cap;
+};
+
+/** Value of an attribute in the tag [p, end[, malloc'ed */
+static char *xml_attr(const char *p, const char *end, const char *attr)
+{
+  size_t n = strlen(attr);
+  for (; p + n + 2 < end; p++) {
+    if (memcmp(p, attr, n) == 0 && p[n] == '=' && (p[n + 1] == '"' || p[n + 1] == '\'') &&
+        (p[-1] == ' ' || p[-1] == '\t' || p[-1] == '\n')) {
+      const char *v = p + n + 2;
+      const char *q = memchr(v, p[n + 1], end - v);
+      if (q == NULL) {
+        return NULL;
+      }
+      return strndup(v, q - v);
+    }
+  }
+  return NULL;
+}
+
+static void read_defs(struct defs *d, const char *log_file)
+{
+  struct mapped m;
+  memset(d, 0, sizeof(struct defs));
+  if (log_file == NULL || map_file(&m, log_file) < 0) {
+    return;
+  }
+  const char *p = m.data, *end = m.data + m.size;
+  int telemetry = 0;
+  struct msg_def *cur = NULL;
+  while (p != NULL && p < end) {
+    p = memchr(p, '<', end - p);
+    if (p == NULL) {
+      break;
+    }
+    const char *tag_end = memchr(p, '>', end - p);
+    if (tag_end == NULL) {
+      break;
+    }
+    if (strncmp(p, "<msg_class ", 11) == 0 || strncmp(p, "<class ", 7) == 0) {
+      char *name = xml_attr(p, tag_end, "name");
+      telemetry = (name != NULL && strcmp(name, "telemetry") == 0);
+      free(name);
+    } else if (strncmp(p, "<message ", 9) == 0) {
+      char *name = xml_attr(p, tag_end, "name");
+      cur = NULL;
+      if (name != NULL) {
+        // keep the telemetry definition if the name is used in several classes
+        for (uint32_t i = 0; i < d->nb; i++) {
+          if (strcmp(d->msgs[i].name, name) == 0) {
+            cur = &d->msgs[i];
+            break;
+          }
+        }
+        if (cur != NULL && (cur->telemetry || !telemetry)) {
+          free(name);
+          cur = NULL;
+        } else {
+          if (cur == NULL) {
+            if (d->nb == d->cap) {
+              d->cap = d->cap ? 2 * d->cap : 256;
+              d->msgs = realloc(d->msgs, d->cap * sizeof(struct msg_def));
+            }
+            cur = &d->msgs[d->nb++];
+          } else {
+            free(cur->name);
+            for (uint32_t i = 0; i < cur->nb_fields; i++) {
+              free(cur->fields[i].name);
+            }
+            free(cur->fields);
+          }
+          memset(cur, 0, sizeof(struct msg_def));
+          cur->name = name;
+          cur->telemetry = telemetry;
+        }
+      }
+      if (tag_end[-1] == '/') {
+        cur = NULL;
+      }
+    } else if (strncmp(p, "</message", 9) == 0) {
+      cur = NULL;
+    } else if (cur != NULL && strncmp(p, "<field ", 7) == 0) {
+      char *name = xml_attr(p, tag_end, "name");
+      char *type = xml_attr(p, tag_end, "type");
+      if (name != NULL) {
+        cur->fields = realloc(cur->fields, (cur->nb_fields + 1) * sizeof(struct field_def));
+        cur->fields[cur->nb_fields].name = name;
+        cur->fields[cur->nb_fields].type = (type == NULL || strchr(type, '[') != NULL || strcmp(type, "string") == 0) ?
+                                           LOG_STORE_TEXT : LOG_STORE_NUM;
+        cur->nb_fields++;
+      }
+      free(type);
+    }
+    p = tag_end + 1;
+  }
+  unmap_file(&m);
+}
+
+static const struct msg_def *find_def(const struct defs *d, const char *name)
+{
+  for (uint32_t i = 0; i < d->nb; i++) {
+    if (strcmp(d->msgs[i].name, name) == 0) {
+      return &d->msgs[i];
+    }
+  }
+  return NULL;
+}
+
+static void free_defs(struct defs *d)
+{
+  for (uint32_t i = 0; i < d->nb; i++) {
+    for (uint32_t j = 0; j < d->msgs[i].nb_fields; j++) {
+      free(d->msgs[i].fields[j].name);
+    }
+    free(d->msgs[i].fields);
+    free(d->msgs[i].name);
+  }
+  free(d->msgs);
+}
+
+/*
+ * Columns being built
+ */
+
+struct column {
+  char *name;
+  uint8_t type;
+  double *num;
+  uint64_t *text_offsets; ///< end offset of each row text
+  char *text;
+  size_t text_len, text_cap;
+};
+
+struct message {
+  char *name;
+  char *sender;
+  size_t nb_rows, cap;
+  double *time;
+  uint64_t *src;
+  uint32_t nb_fields;
+  struct column *cols;
+};
+
+struct builder {
+  struct message *msgs;
+  uint32_t nb_msgs, cap_msgs;
+  uint32_t *table;        ///< hash table of message index + 1
+  uint32_t table_size;
+  struct defs defs;
+};
+
+static uint32_t hash_key(const char *sender, const char *name)
+{
+  uint32_t h = 2166136261u;
+  for (const char *c = sender; *c; c++) {
+    h = (h ^ (uint8_t)*c) * 16777619u;
+  }
+  h = (h ^ ' ') * 16777619u;
+  for (const char *c = name; *c; c++) {
+    h = (h ^ (uint8_t)*c) * 16777619u;
+  }
+  return h;
+}
+
+static void builder_rehash(struct builder *b)
+{
+  free(b->table);
+  b->table_size = b->table_size ? 2 * b->table_size : 256;
+  b->table = calloc(b->table_size, sizeof(uint32_t));
+  for (uint32_t i = 0; i < b->nb_msgs; i++) {
+    uint32_t h = hash_key(b->msgs[i].sender, b->msgs[i].name) & (b->table_size - 1);
+    while (b->table[h] != 0) {
+      h = (h + 1) & (b->table_size - 1);
+    }
+    b->table[h] = i + 1;
+  }
+}
+
+static void column_init(struct column *c, const char *name, uint8_t type, size_t cap, size_t nb_rows)
+{
+  memset(c, 0, sizeof(struct column));
+  c->name = strdup(name);
+  c->type = type;
+  if (type == LOG_STORE_NUM) {
+    c->num = malloc(cap * sizeof(double));
+    for (size_t i = 0; i < nb_rows; i++) {
+      c->num[i] = NAN;
+    }
+  } else {
+    c->text_offsets = calloc(cap, sizeof(uint64_t));
+  }
+}
+
+static struct message *builder_get(struct builder *b, const char *sender, const char *name)
+{
+  if (b->table_size == 0) {
+    builder_rehash(b);
+  }
+  uint32_t h = hash_key(sender, name) & (b->table_size - 1);
+  while (b->table[h] != 0) {
+    struct message *m = &b->msgs[b->table[h] - 1];
+    if (strcmp(m->name, name) == 0 && strcmp(m->sender, sender) == 0) {
+      return m;
+    }
+    h = (h + 1) & (b->table_size - 1);
+  }
+  if (b->nb_msgs == b->cap_msgs) {
+    b->cap_msgs = b->cap_msgs ? 2 * b->cap_msgs : 64;
+    b->msgs = realloc(b->msgs, b->cap_msgs * sizeof(struct message));
+  }
+  struct message *m = &b->msgs[b->nb_msgs++];
+  memset(m, 0, sizeof(struct message));
+  m->name = strdup(name);
+  m->sender = strdup(sender);
+  m->cap = 64;
+  m->time = malloc(m->cap * sizeof(double));
+  m->src = malloc(m->cap * sizeof(uint64_t));
+  const struct msg_def *def = find_def(&b->defs, name);
+  if (def != NULL) {
+    m->nb_fields = def->nb_fields;
+    m->cols = malloc(def->nb_fields * sizeof(struct column));
+    for (uint32_t i = 0; i < def->nb_fields; i++) {
+      column_init(&m->cols[i], def->fields[i].name, def->fields[i].type, m->cap, 0);
+    }
+  }
+  if (2 * b->nb_msgs > b->table_size) {
+    builder_rehash(b);
+  } else {
+    b->table[h] = b->nb_msgs;
+  }
+  return m;
+}
+
+static void message_grow(struct message *m)
+{
+  m->cap *= 2;
+  m->time = realloc(m->time, m->cap * sizeof(double));
+  m->src = realloc(m->src, m->cap * sizeof(uint64_t));
+  for (uint32_t i = 0; i < m->nb_fields; i++) {
+    struct column *c = &m->cols[i];
+    if (c->type == LOG_STORE_NUM) {
+      c->num = realloc(c->num, m->cap * sizeof(double));
+    } else {
+      c->text_offsets = realloc(c->text_offsets, m->cap * sizeof(uint64_t));
+    }
+  }
+}
+
+static void column_put_text(struct column *c, size_t row, const char *v, size_t len)
+{
+  if (c->text_len + len > c->text_cap) {
+    c->text_cap = 2 * (c->text_len + len) + 256;
+    c->text = realloc(c->text, c->text_cap);
+  }
+  memcpy(c->text + c->text_len, v, len);
+  c->text_len += len;
+  c->text_offsets[row] = c->text_len;
+}
+
+/** Parse a whole token as a number */
+static int parse_num(const char *v, size_t len, double *x)
+{
+  char *e;
+  *x = strtod(v, &e);
+  return len > 0 && e == v + len;
+}
+
+/** Add a line, NUL terminated, returns -1 if it is not a message */
+static int builder_add_line(struct builder *b, char *line, uint64_t src)
+{
+  char *p = line, *e;
+  double t = strtod(p, &e);
+  if (e == p) {
+    return -1;
+  }
+  p = e;
+  char *tok[2];
+  for (int i = 0; i < 2; i++) {
+    while (*p == ' ' || *p == '\t') { p++; }
+    tok[i] = p;
+    while (*p != ' ' && *p != '\t' && *p != '\0') { p++; }
+    if (p == tok[i]) {
+      return -1;
+    }
+    if (*p != '\0') { *p++ = '\0'; }
+  }
+  struct message *m = builder_get(b, tok[0], tok[1]);
+  if (m->nb_rows == m->cap) {
+    message_grow(m);
+  }
+  size_t row = m->nb_rows;
+  m->time[row] = t;
+  m->src[row] = src;
+
+  uint32_t f = 0;
+  for (;;) {
+    while (*p == ' ' || *p == '\t') { p++; }
+    if (*p == '\0') {
+      break;
+    }
+    const char *v = p;
+    if (*p == '"') {
+      // quoted string, keep the quotes
+      char *q = strchr(p + 1, '"');
+      p = q ? q + 1 : p + strlen(p);
+    }
+    while (*p != ' ' && *p != '\t' && *p != '\0') { p++; }
+    size_t len = p - v;
+    if (f == m->nb_fields) {
+      // field not in the .log, the type is guessed from its first value
+      double x;
+      char name[16];
+      snprintf(name, sizeof(name), "f%u", f);
+      m->cols = realloc(m->cols, (f + 1) * sizeof(struct column));
+      column_init(&m->cols[f], name, parse_num(v, len, &x) ? LOG_STORE_NUM : LOG_STORE_TEXT, m->cap, row);
+      m->nb_fields++;
+    }
+    struct column *c = &m->cols[f];
+    if (c->type == LOG_STORE_NUM) {
+      if (!parse_num(v, len, &c->num[row])) {
+        c->num[row] = NAN;
+      }
+    } else {
+      column_put_text(c, row, v, len);
+    }
+    f++;
+  }
+  // missing fields
+  for (; f < m->nb_fields; f++) {
+    struct column *c = &m->cols[f];
+    if (c->type == LOG_STORE_NUM) {
+      c->num[row] = NAN;
+    } else {
+      column_put_text(c, row, "", 0);
+    }
+  }
+  m->nb_rows++;
+  return 0;
+}
+
+static void builder_free(struct builder *b)
+{
+  for (uint32_t i = 0; i < b->nb_msgs; i++) {
+    struct message *m = &b->msgs[i];
+    for (uint32_t j = 0; j < m->nb_fields; j++) {
+      free(m->cols[j].name);
+      free(m->cols[j].num);
+      free(m->cols[j].text_offsets);
+      free(m->cols[j].text);
+    }
+    free(m->cols);
+    free(m->name);
+    free(m->sender);
+    free(m->time);
+    free(m->src);
+  }
+  free(b->msgs);
+  free(b->table);
+  free_defs(&b->defs);
+}
+
+/*
+ * Writer
+ */
+
+struct writer {
+  FILE *f;
+  uint64_t pos;
+  char *names;
+  uint32_t names_len, names_cap;
+};
+
+static void put(struct writer *w, const void *data, size_t size)
+{
+  fwrite(data, 1, size, w->f);
+  w->pos += size;
+}
+
+static void align8(struct writer *w)
+{
+  static const uint8_t zero[8] = { 0 };
+  if (w->pos & 7) {
+    put(w, zero, 8 - (w->pos & 7));
+  }
+}
+
+static uint32_t add_name(struct writer *w, const char *name)
+{
+  size_t n = strlen(name) + 1;
+  if (w->names_len + n > w->names_cap) {
+    w->names_cap = 2 * (w->names_len + n) + 1024;
+    w->names = realloc(w->names, w->names_cap);
+  }
+  uint32_t offset = w->names_len;
+  memcpy(w->names + offset, name, n);
+  w->names_len += n;
+  return offset;
+}
+
+static const double *sort_time;
+
+static int cmp_rows(const void *a, const void *b)
+{
+  size_t i = *(const size_t *)a, j = *(const size_t *)b;
+  if (sort_time[i] != sort_time[j]) {
+    return sort_time[i] < sort_time[j] ? -1 : 1;
+  }
+  return i < j ? -1 : (i > j);
+}
+
+/** Row order sorted by time, NULL if the rows are already sorted */
+static size_t *sort_rows(const struct message *m)
+{
+  size_t i;
+  for (i = 1; i < m->nb_rows && m->time[i] >= m->time[i - 1]; i++);
+  if (i >= m->nb_rows) {
+    return NULL;
+  }
+  size_t *order = malloc(m->nb_rows * sizeof(size_t));
+  for (i = 0; i < m->nb_rows; i++) {
+    order[i] = i;
+  }
+  sort_time = m->time;
+  qsort(order, m->nb_rows, sizeof(size_t), cmp_rows);
+  return order;
+}
+
+#define ROW(_i) (order ? order[_i] : (_i))
+
+static void write_message(struct writer *w, const struct message *m, struct LogStoreMsg *msg,
+                          struct LogStoreField *fields)
+{
+  size_t *order = sort_rows(m);
+  msg->nb_rows = m->nb_rows;
+  msg->nb_fields = m->nb_fields;
+  msg->name = add_name(w, m->name);
+  msg->sender = add_name(w, m->sender);
+
+  align8(w);
+  msg->time_offset = w->pos;
+  for (size_t i = 0; i < m->nb_rows; i++) {
+    put(w, &m->time[ROW(i)], sizeof(double));
+  }
+  msg->src_offset = w->pos;
+  for (size_t i = 0; i < m->nb_rows; i++) {
+    put(w, &m->src[ROW(i)], sizeof(uint64_t));
+  }
+  for (uint32_t j = 0; j < m->nb_fields; j++) {
+    const struct column *c = &m->cols[j];
+    fields[j].name = add_name(w, c->name);
+    fields[j].type = c->type;
+    fields[j].offset = w->pos;
+    if (c->type == LOG_STORE_NUM) {
+      if (order == NULL) {
+        put(w, c->num, m->nb_rows * sizeof(double));
+      } else {
+        for (size_t i = 0; i < m->nb_rows; i++) {
+          put(w, &c->num[order[i]], sizeof(double));
+        }
+      }
+    } else {
+      // offsets of the texts in the new order, then the texts
+      uint64_t o = 0;
+      put(w, &o, sizeof(uint64_t));
+      for (size_t i = 0; i < m->nb_rows; i++) {
+        size_t r = ROW(i);
+        o += c->text_offsets[r] - (r > 0 ? c->text_offsets[r - 1] : 0);
+        put(w, &o, sizeof(uint64_t));
+      }
+      for (size_t i = 0; i < m->nb_rows; i++) {
+        size_t r = ROW(i);
+        uint64_t start = r > 0 ? c->text_offsets[r - 1] : 0;
+        put(w, c->text + start, c->text_offsets[r] - start);
+      }
+      align8(w);
+    }
+  }
+  free(order);
+}
+
+int log_store_convert(const char *data_file, const char *log_file, const char *out_file)
+{
+  struct mapped in;
+  if (map_file(&in, data_file) < 0) {
+    return -1;
+  }
+  struct builder b;
+  memset(&b, 0, sizeof(struct builder));
+  read_defs(&b.defs, log_file);
+
+  // parse the lines, each one is copied to be NUL terminated
+  char *line = malloc(LOG_STORE_LINE_MAX);
+  struct LogStoreHeader h;
+  memset(&h, 0, sizeof(struct LogStoreHeader));
+  h.t_min = INFINITY;
+  h.t_max = -INFINITY;
+  size_t pos = 0;
+  while (pos < in.size) {
+    const char *nl = memchr(in.data + pos, '\n', in.size - pos);
+    size_t len = (nl ? (size_t)(nl - in.data) : in.size) - pos;
+    if (len < LOG_STORE_LINE_MAX) {
+      memcpy(line, in.data + pos, len);
+      line[len] = '\0';
+      if (builder_add_line(&b, line, pos) == 0) {
+        h.nb_rows++;
+      }
+    }
+    pos += len + 1;
+  }
+  free(line);
+  h.data_size = in.size;
+  unmap_file(&in);
+
+  struct writer w;
+  memset(&w, 0, sizeof(struct writer));
+  w.f = fopen(out_file, "wb");
+  if (w.f == NULL) {
+    builder_free(&b);
+    return -1;
+  }
+  setvbuf(w.f, NULL, _IOFBF, 1 << 20);
+  put(&w, &h, sizeof(struct LogStoreHeader));
+
+  struct LogStoreMsg *msgs = calloc(b.nb_msgs, sizeof(struct LogStoreMsg));
+  struct LogStoreField **fields = calloc(b.nb_msgs, sizeof(struct LogStoreField *));
+  for (uint32_t i = 0; i < b.nb_msgs; i++) {
+    fields[i] = calloc(b.msgs[i].nb_fields + 1, sizeof(struct LogStoreField));
+    write_message(&w, &b.msgs[i], &msgs[i], fields[i]);
+    if (b.msgs[i].nb_rows > 0) {
+      const double *t = (const double *)b.msgs[i].time;
+      for (size_t r = 0; r < b.msgs[i].nb_rows; r++) {
+        if (t[r] < h.t_min) { h.t_min = t[r]; }
+        if (t[r] > h.t_max) { h.t_max = t[r]; }
+      }
+    }
+  }
+  // field tables, message table, names
+  align8(&w);
+  for (uint32_t i = 0; i < b.nb_msgs; i++) {
+    msgs[i].fields_offset = w.pos;
+    put(&w, fields[i], msgs[i].nb_fields * sizeof(struct LogStoreField));
+    free(fields[i]);
+  }
+  free(fields);
+  h.msgs_offset = w.pos;
+  put(&w, msgs, b.nb_msgs * sizeof(struct LogStoreMsg));
+  free(msgs);
+  h.names_offset = w.pos;
+  put(&w, w.names, w.names_len);
+  free(w.names);
+
+  memcpy(h.magic, LOG_STORE_MAGIC, 8);
+  h.version = LOG_STORE_VERSION;
+  h.nb_msgs = b.nb_msgs;
+  if (h.nb_rows == 0) {
+    h.t_min = h.t_max = 0.;
+  }
+  fseek(w.f, 0, SEEK_SET);
+  fwrite(&h, sizeof(struct LogStoreHeader), 1, w.f);
+  builder_free(&b);
+  int err = ferror(w.f);
+  if (fclose(w.f) != 0 || err) {
+    return -1;
+  }
+  return 0;
+}
+
+/*
+ * Reader
+ */
+
+int log_store_open(struct LogStore *s, const char *file)
+{
+  struct mapped m;
+  memset(s, 0, sizeof(struct LogStore));
+  if (map_file(&m, file) < 0) {
+    return -1;
+  }
+  const struct LogStoreHeader *h = (const struct LogStoreHeader *)m.data;
+  if (m.size < sizeof(struct LogStoreHeader) || memcmp(h->magic, LOG_STORE_MAGIC, 8) != 0 ||
+      h->version != LOG_STORE_VERSION || h->msgs_offset + h->nb_msgs * sizeof(struct LogStoreMsg) > m.size ||
+      h->names_offset > m.size || (h->names_offset < m.size && m.data[m.size - 1] != '\0')) {
+    unmap_file(&m);
+    errno = EINVAL;
+    return -1;
+  }
+  // random access from now on
+  madvise((void *)m.data, m.size, MADV_RANDOM);
+  s->base = (const uint8_t *)m.data;
+  s->size = m.size;
+  s->header = h;
+  s->msgs = (const struct LogStoreMsg *)(s->base + h->msgs_offset);
+  s->names = (const char *)(s->base + h->names_offset);
+  return 0;
+}
+
+void log_store_close(struct LogStore *s)
+{
+  if (s->base != NULL) {
+    munmap((void *)s->base, s->size);
+  }
+  memset(s, 0, sizeof(struct LogStore));
+}
+
+const struct LogStoreMsg *log_store_find_msg(const struct LogStore *s, const char *sender, const char *name)
+{
+  for (uint32_t i = 0; i < s->header->nb_msgs; i++) {
+    const struct LogStoreMsg *m = &s->msgs[i];
+    if (strcmp(log_store_name(s, m->name), name) == 0 &&
+        (sender == NULL || strcmp(log_store_name(s, m->sender), sender) == 0)) {
+      return m;
+    }
+  }
+  return NULL;
+}
+
+int log_store_find_field(const struct LogStore *s, const struct LogStoreMsg *msg, const char *name)
+{
+  const struct LogStoreField *f = log_store_fields(s, msg);
+  for (uint32_t i = 0; i < msg->nb_fields; i++) {
+    if (strcmp(log_store_name(s, f[i].name), name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/** First row with time >= t (or > t if after is set) */
+static size_t lower_bound(const double *time, size_t n, double t, int after)
+{
+  size_t lo = 0, hi = n;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (time[mid] < t || (after && time[mid] == t)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+size_t log_store_range(const struct LogStore *s, const struct LogStoreMsg *msg, double t0, double t1, size_t *first)
+{
+  const double *time = log_store_time(s, msg);
+  *first = lower_bound(time, msg->nb_rows, t0, 0);
+  size_t end = lower_bound(time, msg->nb_rows, t1, 1);
+  return end > *first ? end - *first : 0;
+}
+
+const char *log_store_text(const struct LogStore *s, const struct LogStoreMsg *msg, int field, size_t row,
+                           size_t *len)
+{
+  const struct LogStoreField *f = &log_store_fields(s, msg)[field];
+  if (f->type == LOG_STORE_NUM) {
+    *len = 0;
+    return NULL;
+  }
+  const uint64_t *offsets = (const uint64_t *)(s->base + f->offset);
+  const char *text = (const char *)(offsets + msg->nb_rows + 1);
+  *len = offsets[row + 1] - offsets[row];
+  return text + offsets[row];
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file log_store.h
+ *
+ * Indexed columnar store of a .data flight log.
+ *
+ * A text log (lines "time sender MSG_NAME field1 field2 ...") is converted
+ * once into a file that is then memory mapped: each message (sender and
+ * name) has its own time column, sorted, and one column per field, so that
+ * e.g. all ATTITUDE.phi between t0 and t1 are found with a binary search on
+ * the time column, then read as a contiguous array, without reading the
+ * rest of the log.
+ *
+ * Numeric fields are stored as doubles. Strings and arrays are stored as
+ * text, with an offset table. Each row also keeps the byte offset of its
+ * line in the .data file, to go back to the original text.
+ *
+ * File layout, native endianness, all the arrays 8 bytes aligned:
+ * - header (struct LogStoreHeader),
+ * - for each message: time column (double), source offsets (uint64_t),
+ *   then for each field its column (double or uint64_t text offsets
+ *   followed by the text),
+ * - message table (struct LogStoreMsg), field tables (struct LogStoreField),
+ * - names (NUL terminated strings).
+ */
+
+#ifndef LOG_STORE_H
+#define LOG_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LOG_STORE_MAGIC "PPRZCOLS"
+#define LOG_STORE_VERSION 1
+
+enum LogStoreType {
+  LOG_STORE_NUM,    ///< double column
+  LOG_STORE_TEXT    ///< nb_rows + 1 uint64_t offsets, then the text
+};
+
+struct LogStoreHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t nb_msgs;
+  double t_min;           ///< first time of the log
+  double t_max;           ///< last time of the log
+  uint64_t nb_rows;       ///< total number of messages
+  uint64_t msgs_offset;   ///< message table
+  uint64_t names_offset;  ///< names
+  uint64_t data_size;     ///< size of the source .data file
+};
+
+struct LogStoreMsg {
+  uint32_t name;          ///< offset in the names
+  uint32_t sender;        ///< offset in the names
+  uint32_t nb_fields;
+  uint32_t reserved;
+  uint64_t nb_rows;
+  uint64_t time_offset;   ///< nb_rows double, sorted
+  uint64_t src_offset;    ///< nb_rows uint64_t, offsets of the lines in the .data file
+  uint64_t fields_offset; ///< nb_fields struct LogStoreField
+};
+
+struct LogStoreField {
+  uint32_t name;          ///< offset in the names
+  uint32_t type;          ///< #LogStoreType
+  uint64_t offset;        ///< column
+};
+
+/** Opened (mapped) store */
+struct LogStore {
+  const uint8_t *base;
+  size_t size;
+  const struct LogStoreHeader *header;
+  const struct LogStoreMsg *msgs;
+  const char *names;
+};
+
+/**
+ * Convert a .data log.
+ * @param data_file text log
+ * @param log_file .log file with the message definitions (field names and
+ *        types), NULL to name the fields f0, f1, ...
+ * @param out_file store to create
+ * @return 0 on success, -1 on error (errno set)
+ */
+extern int log_store_convert(const char *data_file, const char *log_file, const char *out_file);
+
+/**
+ * Map a store.
+ * @return 0 on success, -1 on error
+ */
+extern int log_store_open(struct LogStore *s, const char *file);
+extern void log_store_close(struct LogStore *s);
+
+/**
+ * Find a message.
+ * @param sender sender (aircraft id), NULL for the first one
+ * @return the message or NULL
+ */
+extern const struct LogStoreMsg *log_store_find_msg(const struct LogStore *s, const char *sender, const char *name);
+
+/** Index of a field by name, -1 if not found */
+extern int log_store_find_field(const struct LogStore *s, const struct LogStoreMsg *msg, const char *name);
+
+/**
+ * Rows of a message between two times, with a binary search.
+ * @param[out] first first row with time >= t0
+ * @return number of rows with t0 <= time <= t1
+ */
+extern size_t log_store_range(const struct LogStore *s, const struct LogStoreMsg *msg, double t0, double t1,
+                              size_t *first);
+
+static inline const char *log_store_name(const struct LogStore *s, uint32_t offset)
+{
+  return s->names + offset;
+}
+
+static inline const struct LogStoreField *log_store_fields(const struct LogStore *s, const struct LogStoreMsg *msg)
+{
+  return (const struct LogStoreField *)(s->base + msg->fields_offset);
+}
+
+static inline const double *log_store_time(const struct LogStore *s, const struct LogStoreMsg *msg)
+{
+  return (const double *)(s->base + msg->time_offset);
+}
+
+static inline const uint64_t *log_store_src(const struct LogStore *s, const struct LogStoreMsg *msg)
+{
+  return (const uint64_t *)(s->base + msg->src_offset);
+}
+
+/** Column of a numeric field, NULL for a text field */
+static inline const double *log_store_column(const struct LogStore *s, const struct LogStoreMsg *msg, int field)
+{
+  const struct LogStoreField *f = &log_store_fields(s, msg)[field];
+  return f->type == LOG_STORE_NUM ? (const double *)(s->base + f->offset) : NULL;
+}
+
+/**
+ * Value of a field as text (not NUL terminated).
+ * @param[out] len text length
+ */
+extern const char *log_store_text(const struct LogStore *s, const struct LogStoreMsg *msg, int field, size_t row,
+                                  size_t *len);
+
+#endif /* LOG_STORE_H */
@@ -0,0 +1,441 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pprz_stream.c
+ *
+ * Decoder of binary pprzlink streams, for the log import tools.
+ */
+
+#include "pprz_stream.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/** Size of the file chunks decoded by each thread */
+#define PPRZ_STREAM_CHUNK_SIZE (4 << 20)
+
+/**
+ * Receiver of the decoded frames and corrupted bytes: either the user
+ * callbacks, or the records of a chunk decoded by a thread.
+ */
+struct sink {
+  int (*frame)(void *ctx, const uint8_t *data, uint64_t offset, uint16_t size);
+  void (*corrupt)(void *ctx, uint64_t offset, uint64_t len);
+  void *ctx;
+};
+
+/**
+ * Size of the frame at the start of buf.
+ * @return frame size, 0 if more bytes are needed, -1 if the length is invalid
+ */
+static int frame_size(enum PprzStreamFormat format, const uint8_t *buf, size_t len)
+{
+  if (len < 2) {
+    return 0;
+  }
+  if (format == PPRZ_STREAM_PPRZ) {
+    // at least a v1 header (sender, id)
+    return buf[1] >= 6 ? buf[1] : -1;
+  }
+  return buf[1] >= 2 ? buf[1] + 8 : -1;
+}
+
+static bool frame_check(enum PprzStreamFormat format, const uint8_t *buf, int size)
+{
+  uint8_t ck_a = 0, ck_b = 0;
+  if (format == PPRZ_STREAM_PPRZ) {
+    for (int i = 1; i < size - 2; i++) {
+      ck_a += buf[i];
+      ck_b += ck_a;
+    }
+    return ck_a == buf[size - 2] && ck_b == buf[size - 1];
+  }
+  for (int i = 1; i < size - 1; i++) {
+    ck_a += buf[i];
+  }
+  return ck_a == buf[size - 1];
+}
+
+/**
+ * Decode the frames starting before limit.
+ * @param final end of the stream, an incomplete frame is corrupted
+ * @param[out] stopped set if the sink stopped the decoding
+ * @return number of bytes processed, an incomplete frame is left if not final
+ */
+static size_t decode(enum PprzStreamFormat format, const uint8_t *buf, size_t len, size_t limit, uint64_t offset,
+                     bool final, struct sink *sink, bool *stopped)
+{
+  size_t i = 0;
+  *stopped = false;
+  while (i < limit) {
+    if (buf[i] != PPRZ_STREAM_STX) {
+      const uint8_t *stx = memchr(buf + i, PPRZ_STREAM_STX, limit - i);
+      size_t next = stx != NULL ? (size_t)(stx - buf) : limit;
+      sink->corrupt(sink->ctx, offset + i, next - i);
+      i = next;
+      continue;
+    }
+    int size = frame_size(format, buf + i, len - i);
+    if (size == 0 || (size > 0 && i + size > len)) {
+      if (!final) {
+        break;
+      }
+      size = -1;
+    }
+    if (size > 0 && frame_check(format, buf + i, size)) {
+      if (sink->frame(sink->ctx, buf + i, offset + i, size)) {
+        *stopped = true;
+        return i + size;
+      }
+      i += size;
+    } else {
+      // not a frame, look for the next STX
+      sink->corrupt(sink->ctx, offset + i, 1);
+      i++;
+    }
+  }
+  return i;
+}
+
+/*
+ * Direct sink: user callbacks, contiguous corrupted bytes in one span
+ */
+
+static void flush_span(struct PprzStream *s)
+{
+  if (s->in_span) {
+    s->in_span = false;
+    s->nb_spans++;
+    if (s->on_corrupt != NULL) {
+      s->on_corrupt(s->user, s->span_start, s->span_end);
+    }
+  }
+}
+
+static void direct_corrupt(void *ctx, uint64_t offset, uint64_t len)
+{
+  struct PprzStream *s = (struct PprzStream *)ctx;
+  if (s->in_span && s->span_end == offset) {
+    s->span_end += len;
+  } else {
+    flush_span(s);
+    s->in_span = true;
+    s->span_start = offset;
+    s->span_end = offset + len;
+  }
+  s->nb_corrupted_bytes += len;
+}
+
+static int direct_frame(void *ctx, const uint8_t *data, uint64_t offset, uint16_t size)
+{
+  struct PprzStream *s = (struct PprzStream *)ctx;
+  struct PprzFrame f;
+  flush_span(s);
+  f.offset = offset;
+  f.data = data;
+  f.size = size;
+  if (s->format == PPRZ_STREAM_PPRZ) {
+    f.payload = data + 2;
+    f.payload_len = size - 4;
+    f.source = 0;
+    f.timestamp = 0;
+  } else {
+    f.payload = data + 7;
+    f.payload_len = data[1];
+    f.source = data[2];
+    f.timestamp = data[3] | (data[4] << 8) | (data[5] << 16) | ((uint32_t)data[6] << 24);
+  }
+  s->nb_frames++;
+  return s->on_frame(s->user, &f);
+}
+
+static void direct_sink(struct PprzStream *s, struct sink *sink)
+{
+  sink->frame = direct_frame;
+  sink->corrupt = direct_corrupt;
+  sink->ctx = s;
+}
+
+void pprz_stream_init(struct PprzStream *s, enum PprzStreamFormat format, pprz_stream_frame_cb on_frame,
+                      pprz_stream_corrupt_cb on_corrupt, void *user)
+{
+  memset(s, 0, sizeof(struct PprzStream));
+  s->format = format;
+  s->on_frame = on_frame;
+  s->on_corrupt = on_corrupt;
+  s->user = user;
+}
+
+size_t pprz_stream_feed(struct PprzStream *s, const uint8_t *data, size_t len)
+{
+  struct sink sink;
+  bool stopped;
+  direct_sink(s, &sink);
+  size_t used = 0;
+
+  if (s->len > 0) {
+    // complete the frame kept from the previous call, it is shorter than a frame
+    size_t old_len = s->len;
+    size_t n = sizeof(s->buf) - s->len;
+    if (n > len) {
+      n = len;
+    }
+    memcpy(s->buf + s->len, data, n);
+    s->len += n;
+    size_t done = decode(s->format, s->buf, s->len, s->len, s->offset, false, &sink, &stopped);
+    s->offset += done;
+    if (done < old_len) {
+      if (stopped) {
+        // stopped before the new data, only the previous bytes are kept
+        s->len = old_len - done;
+        memmove(s->buf, s->buf + done, s->len);
+        return 0;
+      }
+      // still incomplete, all the data is in the buffer
+      memmove(s->buf, s->buf + done, s->len - done);
+      s->len -= done;
+      return len;
+    }
+    // the rest of the buffer is new data, decoded in place below
+    s->len = 0;
+    used = done - old_len;
+    if (stopped) {
+      return used;
+    }
+  }
+
+  size_t done = decode(s->format, data + used, len - used, len - used, s->offset, false, &sink, &stopped);
+  s->offset += done;
+  used += done;
+  if (!stopped) {
+    // keep the incomplete frame
+    s->len = len - used;
+    memcpy(s->buf, data + used, s->len);
+    used = len;
+  }
+  return used;
+}
+
+size_t pprz_stream_take_kept(struct PprzStream *s, uint8_t *data)
+{
+  size_t len = s->len;
+  memcpy(data, s->buf, len);
+  s->offset += len;
+  s->len = 0;
+  return len;
+}
+
+void pprz_stream_end(struct PprzStream *s)
+{
+  struct sink sink;
+  bool stopped = false;
+  direct_sink(s, &sink);
+  while (s->len > 0 && !stopped) {
+    size_t done = decode(s->format, s->buf, s->len, s->len, s->offset, true, &sink, &stopped);
+    memmove(s->buf, s->buf + done, s->len - done);
+    s->len -= done;
+    s->offset += done;
+  }
+  s->len = 0;
+  flush_span(s);
+}
+
+/*
+ * Multi-threaded decoding of a file
+ */
+
+/** Frame (size > 0) or corrupted span (size == 0) found by a thread */
+struct record {
+  uint64_t offset;
+  uint64_t end;
+  uint16_t size;
+};
+
+struct chunk {
+  enum PprzStreamFormat format;
+  const uint8_t *base;
+  size_t file_size;
+  size_t start, end;        ///< frames starting in [start, end[
+  struct record *records;
+  size_t nb, cap;
+  pthread_t thread;
+};
+
+static struct record *chunk_add(struct chunk *c)
+{
+  if (c->nb == c->cap) {
+    c->cap = c->cap ? 2 * c->cap : 4096;
+    c->records = realloc(c->records, c->cap * sizeof(struct record));
+  }
+  return &c->records[c->nb++];
+}
+
+static int chunk_frame(void *ctx, const uint8_t *data __attribute__((unused)), uint64_t offset, uint16_t size)
+{
+  struct record *r = chunk_add((struct chunk *)ctx);
+  r->offset = offset;
+  r->end = offset + size;
+  r->size = size;
+  return 0;
+}
+
+static void chunk_corrupt(void *ctx, uint64_t offset, uint64_t len)
+{
+  struct chunk *c = (struct chunk *)ctx;
+  if (c->nb > 0 && c->records[c->nb - 1].size == 0 && c->records[c->nb - 1].end == offset) {
+    c->records[c->nb - 1].end += len;
+    return;
+  }
+  struct record *r = chunk_add(c);
+  r->offset = offset;
+  r->end = offset + len;
+  r->size = 0;
+}
+
+static void *chunk_thread(void *data)
+{
+  struct chunk *c = (struct chunk *)data;
+  struct sink sink = { chunk_frame, chunk_corrupt, c };
+  bool stopped;
+  decode(c->format, c->base + c->start, c->file_size - c->start, c->end - c->start, c->start, true, &sink, &stopped);
+  return NULL;
+}
+
+/**
+ * Report the records of a chunk from the stream position pos.
+ * A thread starts at an arbitrary position of the file, so its first
+ * records can be out of sync: they are skipped while they are behind pos,
+ * and the gaps are decoded again from pos until both agree.
+ * @return new stream position, or the stop position + 1 if a callback stopped
+ */
+static size_t merge_chunk(struct PprzStream *s, struct chunk *c, size_t pos, bool *stopped)
+{
+  struct sink sink;
+  direct_sink(s, &sink);
+  *stopped = false;
+  size_t j = 0;
+  while (j < c->nb && !*stopped) {
+    const struct record *r = &c->records[j];
+    if (r->offset < pos) {
+      j++;
+    } else if (r->offset == pos) {
+      if (r->size > 0) {
+        *stopped = direct_frame(s, c->base + r->offset, r->offset, r->size) != 0;
+      } else {
+        direct_corrupt(s, r->offset, r->end - r->offset);
+      }
+      pos = r->end;
+      j++;
+    } else {
+      pos += decode(s->format, c->base + pos, c->file_size - pos, r->offset - pos, pos, true, &sink, stopped);
+    }
+  }
+  if (pos < c->end && !*stopped) {
+    pos += decode(s->format, c->base + pos, c->file_size - pos, c->end - pos, pos, true, &sink, stopped);
+  }
+  return pos;
+}
+
+int pprz_stream_decode_file(struct PprzStream *s, const char *file, int nb_threads)
+{
+  struct stat st;
+  int fd = open(file, O_RDONLY);
+  if (fd < 0) {
+    return -1;
+  }
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    return -1;
+  }
+  size_t size = st.st_size;
+  if (size == 0) {
+    close(fd);
+    return 0;
+  }
+  const uint8_t *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    return -1;
+  }
+  madvise((void *)base, size, MADV_SEQUENTIAL);
+
+  if (nb_threads < 1) {
+    nb_threads = 1;
+  }
+  if ((size_t)nb_threads * PPRZ_STREAM_CHUNK_SIZE > size) {
+    nb_threads = size / PPRZ_STREAM_CHUNK_SIZE + 1;
+  }
+
+  size_t pos = 0;
+  bool stopped = false;
+  if (nb_threads == 1) {
+    struct sink sink;
+    direct_sink(s, &sink);
+    pos = decode(s->format, base, size, size, 0, true, &sink, &stopped);
+  } else {
+    // rounds of nb_threads chunks, the memory used for the records is bounded
+    struct chunk *chunks = calloc(nb_threads, sizeof(struct chunk));
+    for (size_t round = 0; round < size && !stopped; round += (size_t)nb_threads * PPRZ_STREAM_CHUNK_SIZE) {
+      int n = 0;
+      for (int k = 0; k < nb_threads; k++) {
+        size_t start = round + (size_t)k * PPRZ_STREAM_CHUNK_SIZE;
+        if (start >= size) {
+          break;
+        }
+        struct chunk *c = &chunks[k];
+        c->format = s->format;
+        c->base = base;
+        c->file_size = size;
+        c->start = start;
+        c->end = start + PPRZ_STREAM_CHUNK_SIZE < size ? start + PPRZ_STREAM_CHUNK_SIZE : size;
+        c->nb = 0;
+        if (pthread_create(&c->thread, NULL, chunk_thread, c) != 0) {
+          chunk_thread(c);
+          c->thread = 0;
+        }
+        n++;
+      }
+      for (int k = 0; k < n; k++) {
+        if (chunks[k].thread != 0) {
+          pthread_join(chunks[k].thread, NULL);
+        }
+      }
+      for (int k = 0; k < n && !stopped; k++) {
+        pos = merge_chunk(s, &chunks[k], pos, &stopped);
+      }
+    }
+    for (int k = 0; k < nb_threads; k++) {
+      free(chunks[k].records);
+    }
+    free(chunks);
+  }
+  if (!stopped) {
+    flush_span(s);
+  }
+  s->offset = pos;
+  munmap((void *)base, size);
+  return 0;
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file pprz_stream.h
+ *
+ * Decoder of binary pprzlink streams, for the log import tools.
+ *
+ * Two framings are supported, both starting with the 0x99 STX:
+ * - PPRZ_STREAM_PPRZ: STX, length of the whole frame, payload, ck_a, ck_b
+ *   (pprz_transport, e.g. OpenLog captures or serial links),
+ * - PPRZ_STREAM_PPRZLOG: STX, payload length, source, timestamp (4 bytes,
+ *   1e-4 s), payload, checksum (pprzlog_transport, .tlm files).
+ * The payload is a pprzlink v1 or v2 message, see pprz_frame_msg_id().
+ *
+ * A frame is only accepted if its checksum is correct. Otherwise the
+ * decoder moves one byte further and looks for the next STX, and the bytes
+ * skipped are reported as corrupted spans [start, end[ of stream offsets,
+ * contiguous bytes in a single span.
+ *
+ * Streams are fed by buffers of any size (pprz_stream_feed) or decoded
+ * from a mapped file (pprz_stream_decode_file), optionally with several
+ * threads working on chunks of the file. The callbacks are always called
+ * from the calling thread, in stream order.
+ */
+
+#ifndef PPRZ_STREAM_H
+#define PPRZ_STREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define PPRZ_STREAM_STX 0x99
+
+/** Largest frame */
+#define PPRZ_STREAM_FRAME_MAX (255 + 8)
+
+enum PprzStreamFormat {
+  PPRZ_STREAM_PPRZ,
+  PPRZ_STREAM_PPRZLOG
+};
+
+struct PprzFrame {
+  uint64_t offset;          ///< offset of the STX in the stream
+  const uint8_t *data;      ///< whole frame
+  uint16_t size;            ///< whole frame size
+  const uint8_t *payload;   ///< pprzlink message
+  uint8_t payload_len;
+  uint8_t source;           ///< PPRZLOG only
+  uint32_t timestamp;       ///< PPRZLOG only, 1e-4 s
+};
+
+/**
+ * Called for each valid frame.
+ * @return non zero to stop the decoding after this frame
+ */
+typedef int (*pprz_stream_frame_cb)(void *user, const struct PprzFrame *frame);
+
+/** Called for each corrupted span [start, end[ */
+typedef void (*pprz_stream_corrupt_cb)(void *user, uint64_t start, uint64_t end);
+
+struct PprzStream {
+  enum PprzStreamFormat format;
+  pprz_stream_frame_cb on_frame;
+  pprz_stream_corrupt_cb on_corrupt;  ///< can be NULL
+  void *user;
+  /* incomplete frame of the previous feed */
+  uint8_t buf[2 * PPRZ_STREAM_FRAME_MAX];
+  size_t len;
+  uint64_t offset;          ///< stream offset of buf[0]
+  /* pending corrupted span */
+  bool in_span;
+  uint64_t span_start, span_end;
+  /* statistics */
+  uint64_t nb_frames;
+  uint64_t nb_spans;
+  uint64_t nb_corrupted_bytes;
+};
+
+extern void pprz_stream_init(struct PprzStream *s, enum PprzStreamFormat format, pprz_stream_frame_cb on_frame,
+                             pprz_stream_corrupt_cb on_corrupt, void *user);
+
+/**
+ * Decode the next bytes of a stream.
+ * An incomplete frame at the end is kept for the next call.
+ * @return number of bytes used, less than len only if a callback stopped the decoding,
+ *         0 if it stopped in the bytes kept from the previous call
+ */
+extern size_t pprz_stream_feed(struct PprzStream *s, const uint8_t *data, size_t len);
+
+/**
+ * Take the bytes kept by the stream, not decoded yet.
+ * After a callback stopped the decoding, these are the bytes that
+ * followed the stop in the previous feeds.
+ * @param data buffer of at least 2 * PPRZ_STREAM_FRAME_MAX bytes
+ * @return number of bytes copied
+ */
+extern size_t pprz_stream_take_kept(struct PprzStream *s, uint8_t *data);
+
+/** End of the stream, the remaining bytes are reported as corrupted */
+extern void pprz_stream_end(struct PprzStream *s);
+
+/**
+ * Decode a whole file, mapped in memory.
+ * @param nb_threads number of decoding threads, chunks of the file are
+ *        decoded in parallel and the frames reported in order
+ * @return 0 on success, -1 if the file can't be read
+ */
+extern int pprz_stream_decode_file(struct PprzStream *s, const char *file, int nb_threads);
+
+/** Sender of a pprzlink v1 or v2 message */
+static inline uint8_t pprz_frame_sender(const struct PprzFrame *f)
+{
+  return f->payload[0];
+}
+
+/** Message id of a pprzlink v1 (sender, id) or v2 (sender, dest, class, id) message */
+static inline uint8_t pprz_frame_msg_id(const struct PprzFrame *f, int version)
+{
+  if (version == 2) {
+    return f->payload_len > 3 ? f->payload[3] : 0;
+  }
+  return f->payload_len > 1 ? f->payload[1] : 0;
+}
+
+/** First byte of the message fields */
+static inline const uint8_t *pprz_frame_fields(const struct PprzFrame *f, int version)
+{
+  return f->payload + (version == 2 ? 4 : 2);
+}
+
+#endif /* PPRZ_STREAM_H */
@@ -9,6 +9,8 @@
 #include <string.h>
 #include <time.h>
 
+#include "pprz_stream.h"
+
 #ifdef __APPLE__
 #include <libkern/OSByteOrder.h>
 #define be32toh(x) OSSwapBigToHostInt32(x)
@@ -50,29 +52,8 @@ enum global_states global_state = Idle;
 /* Counter for reading bytes in the index block */
 int index_cnt = 0;
 
-/* PPRZ message parser states */
-enum normal_parser_states {
-  SearchingPPRZ_STX,
-  ParsingLength,
-  ParsingSenderId,
-  ParsingMsgId,
-  ParsingMsgPayload,
-  CheckingCRCA,
-  CheckingCRCB
-};
-
-struct normal_parser_t {
-  enum normal_parser_states state;
-  unsigned char length;
-  int counter;
-  unsigned char sender_id;
-  unsigned char msg_id;
-  unsigned char payload[100];
-  unsigned char crc_a;
-  unsigned char crc_b;
-};
-
-struct normal_parser_t parser;
+/* PPRZ message parser */
+struct PprzStream parser;
 
 /* Struct and definition of log info (read from index block) */
 struct log_info_t {
@@ -320,99 +301,31 @@ void write_command(float value)
       . DATA (messages.xml)
     D PPRZ_CHECKSUM_A (sum[B->C])
     E PPRZ_CHECKSUM_B (sum[ck_a])
+  Decoded by pprz_stream, returns 1 to stop the decoding when the next
+  bytes are not messages anymore.
 */
-void parse_single_byte(unsigned char byte)
+int parse_message(void *user __attribute__((unused)), const struct PprzFrame *frame)
 {
-  switch (parser.state) {
-
-    case SearchingPPRZ_STX:
-      if (byte == PPRZ_STX) {
-        //printf("Got PPRZ_STX\n");
-        parser.crc_a = 0;
-        parser.crc_b = 0;
-        parser.counter = 1;
-        parser.state = ParsingLength;
-      }
-      break;
-
-    case ParsingLength:
-      parser.length = byte;
-      parser.crc_a += byte;
-      parser.crc_b += parser.crc_a;
-      parser.counter++;
-      parser.state = ParsingSenderId;
-      break;
-
-    case ParsingSenderId:
-      parser.sender_id = byte;
-      parser.crc_a += byte;
-      parser.crc_b += parser.crc_a;
-      parser.counter++;
-      parser.state = ParsingMsgId;
-      break;
-
-    case ParsingMsgId:
-      parser.msg_id = byte;
-      parser.crc_a += byte;
-      parser.crc_b += parser.crc_a;
-      parser.counter++;
-      parser.state = ParsingMsgPayload;
-      break;
-
-    case ParsingMsgPayload:
-      parser.payload[parser.counter-4] = byte;
-      parser.crc_a += byte;
-      parser.crc_b += parser.crc_a;
-      parser.counter++;
-      if (parser.counter == parser.length - 2) {
-        parser.state = CheckingCRCA;
-      }
-      break;
-
-    case CheckingCRCA:
-      //printf("CRCA: %d vs %d\n", byte, parser.crc_a);
-      if (byte == parser.crc_a) {
-        parser.state = CheckingCRCB;
-      }
-      else {
-        parser.state = SearchingPPRZ_STX;
-      }
-      break;
-
-    case CheckingCRCB:
-      //printf("CRCB: %d vs %d\n", byte, parser.crc_b);
-      if (byte == parser.crc_b && parser.msg_id == 31) {
-        /*printf("MSG ID: %d \t"
-               "SENDER_ID: %d\t"
-               "LEN: %d\t"
-               "SETTING: %d\n",
-               parser.msg_id,
-               parser.sender_id,
-               parser.length,
-               parser.payload[0]);*/
-        //printf("Request confirmed\n");
-
-        /* Check what to do next if the command was received */
-        if (global_state == WaitingForIndexRequestConfirmation
-            && parser.payload[0] == setting) {
-          global_state = ReadingIndexBlock;
-          index_cnt = 0;
-        }
-        if (global_state == GotIndex
-            && parser.payload[0] == setting) {
-          global_state = Downloading;
-          new_logfile();
-          index_cnt = 0;
-        }
-      }
-      parser.state = SearchingPPRZ_STX;
-      break;
-
-    default:
-      /* Should never get here */
-      break;
+  if (pprz_frame_msg_id(frame, 1) != 31 || frame->payload_len < 3) {
+    return 0;
   }
-
+  const uint8_t *payload = pprz_frame_fields(frame, 1);
+
+  /* Check what to do next if the command was received */
+  if (global_state == WaitingForIndexRequestConfirmation
+      && payload[0] == setting) {
+    global_state = ReadingIndexBlock;
+    index_cnt = 0;
+    return 1;
+  }
+  if (global_state == GotIndex
+      && payload[0] == setting) {
+    global_state = Downloading;
+    new_logfile();
+    index_cnt = 0;
+    return 1;
+  }
+  return 0;
 }
 
 void parse_index_byte(unsigned char byte)
@@ -476,27 +389,35 @@ void parse_download_byte(unsigned char byte)
 void parse_bytes(const unsigned char *buff, int len)
 {
   /* For each received byte call the appropriate function */
-  for (int i = 0; i < len; i++) {
+  int i = 0;
+  while (i < len) {
     switch (global_state) {
 
-      /* Parse as pprz message */
+      /* Parse as pprz messages, until the state changes */
       case Idle:
       case GotIndex:
       case WaitingForIndexRequestConfirmation:
-        parse_single_byte(buff[i]);
+        /* can use 0 bytes if the parsing stopped in the bytes the parser kept */
+        i += pprz_stream_feed(&parser, buff + i, len - i);
+        if (i < len) {
+          /* the state changed, the kept bytes come before the rest of buff */
+          unsigned char kept[2 * PPRZ_STREAM_FRAME_MAX];
+          parse_bytes(kept, pprz_stream_take_kept(&parser, kept));
+        }
         break;
 
       /* Read as index-block format */
       case ReadingIndexBlock:
-        parse_index_byte(buff[i]);
+        parse_index_byte(buff[i++]);
         break;
 
       /* Download raw log data */
       case Downloading:
-        parse_download_byte(buff[i]);
+        parse_download_byte(buff[i++]);
         break;
 
       default:
+        i++;
         break;
     }
   }
@@ -628,6 +549,8 @@ int main ( int argc, char** argv)
     exit(0);
   }
 
+  pprz_stream_init(&parser, PPRZ_STREAM_PPRZ, parse_message, NULL, NULL);
+
   /* Enable Ctrl+C */
   signal(SIGINT, intHandler);
 
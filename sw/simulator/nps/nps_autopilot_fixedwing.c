@@ -40,6 +40,7 @@
 #include "nps_radio_control.h"
 #include "nps_electrical.h"
 #include "nps_fdm.h"
+#include "nps_profiler.h"
 
 #include "subsystems/radio_control.h"
 #include "subsystems/imu.h"
@@ -77,6 +78,15 @@ bool nps_bypass_ins;
 #error NPS does not currently support dual processor simulation for FBW and AP on fixedwing!
 #endif
 
+/** Run the event tasks of both FBW and AP and profile them */
+static inline void nps_autopilot_event_tasks(void)
+{
+  uint64_t tic = nps_profiler_tic();
+  Fbw(event_task);
+  Ap(event_task);
+  nps_profiler_toc(NPS_PROF_AP_EVENT, tic);
+}
+
 void nps_autopilot_init(enum NpsRadioControlType type_rc, int num_rc_script, char *rc_dev)
 {
 
@@ -117,22 +127,19 @@ void nps_autopilot_run_step(double time)
 
   if (nps_sensors_gyro_available()) {
     imu_feed_gyro_accel();
-    Fbw(event_task);
-    Ap(event_task);
+    nps_autopilot_event_tasks();
   }
 
   if (nps_sensors_mag_available()) {
     imu_feed_mag();
-    Fbw(event_task);
-    Ap(event_task);
+    nps_autopilot_event_tasks();
   }
 
   if (nps_sensors_baro_available()) {
     uint32_t now_ts = get_sys_time_usec();
     float pressure = (float) sensors.baro.value;
     AbiSendMsgBARO_ABS(BARO_SIM_SENDER_ID, now_ts, pressure);
-    Fbw(event_task);
-    Ap(event_task);
+    nps_autopilot_event_tasks();
   }
 
   if (nps_sensors_temperature_available()) {
@@ -142,15 +149,13 @@ void nps_autopilot_run_step(double time)
 #if USE_AIRSPEED || USE_NPS_AIRSPEED
   if (nps_sensors_airspeed_available()) {
     AbiSendMsgAIRSPEED(AIRSPEED_NPS_ID, (float)sensors.airspeed.value);
-    Fbw(event_task);
-    Ap(event_task);
+    nps_autopilot_event_tasks();
   }
 #endif
 
   if (nps_sensors_gps_available()) {
     gps_feed_value();
-    Fbw(event_task);
-    Ap(event_task);
+    nps_autopilot_event_tasks();
   }
 
 #if USE_SONAR
@@ -164,8 +169,7 @@ void nps_autopilot_run_step(double time)
     DOWNLINK_SEND_SONAR(DefaultChannel, DefaultDevice, &foo, &dist);
 #endif
 
-    Fbw(event_task);
-    Ap(event_task);
+    nps_autopilot_event_tasks();
   }
 #endif
 
@@ -173,8 +177,7 @@ void nps_autopilot_run_step(double time)
 #if USE_NPS_AOA && !NPS_SYNC_INCIDENCE
   if (nps_sensors_aoa_available()) {
     AbiSendMsgINCIDENCE(INCIDENCE_NPS_ID, 1, (float)sensors.aoa.value, 0.f);
-    Fbw(event_task);
-    Ap(event_task);
+    nps_autopilot_event_tasks();
   }
 #endif
 
@@ -182,8 +185,7 @@ void nps_autopilot_run_step(double time)
 #if USE_NPS_SIDESLIP && !NPS_SYNC_INCIDENCE
   if (nps_sensors_sideslip_available()) {
     AbiSendMsgINCIDENCE(INCIDENCE_NPS_ID, 2, 0.f, (float)sensors.sideslip.value);
-    Fbw(event_task);
-    Ap(event_task);
+    nps_autopilot_event_tasks();
   }
 #endif
 
@@ -199,8 +201,7 @@ void nps_autopilot_run_step(double time)
   if (flag == 3) {
     // both sensors are updated
     AbiSendMsgINCIDENCE(INCIDENCE_NPS_ID, 3, (float)sensors.aoa.value, (float)sensors.sideslip.value);
-    Fbw(event_task);
-    Ap(event_task);
+    nps_autopilot_event_tasks();
     flag = 0;
   }
 #endif
@@ -215,8 +216,10 @@ void nps_autopilot_run_step(double time)
     sim_overwrite_ins();
   }
 
+  uint64_t tic = nps_profiler_tic();
   Fbw(handle_periodic_tasks);
   Ap(handle_periodic_tasks);
+  nps_profiler_toc(NPS_PROF_AP_PERIODIC, tic);
 
   /* scale final motor commands to 0-1 for feeding the fdm */
 #ifdef NPS_ACTUATOR_NAMES
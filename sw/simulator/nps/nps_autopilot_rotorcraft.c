@@ -26,6 +26,7 @@
 #include "nps_radio_control.h"
 #include "nps_electrical.h"
 #include "nps_fdm.h"
+#include "nps_profiler.h"
 
 #include "subsystems/radio_control.h"
 #include "subsystems/imu.h"
@@ -68,6 +69,14 @@ bool nps_bypass_ins;
 #error "INDI_RPM_FEEDBACK can not be used in simulation!"
 #endif
 
+/** Run the autopilot event loop and profile it */
+static inline void nps_main_event(void)
+{
+  uint64_t tic = nps_profiler_tic();
+  main_event();
+  nps_profiler_toc(NPS_PROF_AP_EVENT, tic);
+}
+
 void nps_autopilot_init(enum NpsRadioControlType type_rc, int num_rc_script, char *rc_dev)
 {
   nps_autopilot.launch = TRUE;
@@ -98,25 +107,25 @@ void nps_autopilot_run_step(double time)
 #if RADIO_CONTROL && !RADIO_CONTROL_TYPE_DATALINK
   if (nps_radio_control_available(time)) {
     radio_control_feed();
-    main_event();
+    nps_main_event();
   }
 #endif
 
   if (nps_sensors_gyro_available()) {
     imu_feed_gyro_accel();
-    main_event();
+    nps_main_event();
   }
 
   if (nps_sensors_mag_available()) {
     imu_feed_mag();
-    main_event();
+    nps_main_event();
   }
 
   if (nps_sensors_baro_available()) {
     uint32_t now_ts = get_sys_time_usec();
     float pressure = (float) sensors.baro.value;
     AbiSendMsgBARO_ABS(BARO_SIM_SENDER_ID, now_ts, pressure);
-    main_event();
+    nps_main_event();
   }
 
   if (nps_sensors_temperature_available()) {
@@ -143,14 +152,14 @@ void nps_autopilot_run_step(double time)
     DOWNLINK_SEND_SONAR(DefaultChannel, DefaultDevice, &foo, &dist);
 #endif
 
-    main_event();
+    nps_main_event();
   }
 #endif
 
 #if USE_GPS
   if (nps_sensors_gps_available()) {
     gps_feed_value();
-    main_event();
+    nps_main_event();
   }
 #endif
 
@@ -162,7 +171,9 @@ void nps_autopilot_run_step(double time)
     sim_overwrite_ins();
   }
 
+  uint64_t tic = nps_profiler_tic();
   handle_periodic_tasks();
+  nps_profiler_toc(NPS_PROF_AP_PERIODIC, tic);
 
   /* scale final motor commands to 0-1 for feeding the fdm */
   for (uint8_t i = 0; i < NPS_COMMANDS_NB; i++) {
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file nps_checkpoint.c
+ *
+ * Checkpoint the NPS simulation and resume several branches from it.
+ */
+
+#include "nps_checkpoint.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "nps_main.h"
+#include "nps_random.h"
+#if USE_UDP
+#include "mcu_periph/udp.h"
+#endif
+
+/** Ports of the UDP links of branch i are shifted by (i + 1) * NPS_CHECKPOINT_PORT_STEP */
+#ifndef NPS_CHECKPOINT_PORT_STEP
+#define NPS_CHECKPOINT_PORT_STEP 10
+#endif
+
+struct NpsCheckpoint nps_checkpoint;
+
+void nps_checkpoint_init(double time, int nb_branches, double duration, unsigned long int seed)
+{
+  nps_checkpoint.time = time;
+  nps_checkpoint.nb_branches = nb_branches > 0 ? nb_branches : 1;
+  nps_checkpoint.duration = duration > 0. ? duration : 0.;
+  nps_checkpoint.seed = seed;
+  nps_checkpoint.branch = -1;
+
+  if (nps_checkpoint.time >= 0.) {
+    printf("Checkpoint at t=%f, running %d branches", nps_checkpoint.time, nps_checkpoint.nb_branches);
+    if (nps_checkpoint.duration > 0.) {
+      printf(" for %f s", nps_checkpoint.duration);
+    }
+    printf("\n");
+  }
+}
+
+/** Setup a branch process right after fork */
+static void nps_checkpoint_start_branch(int branch)
+{
+  nps_checkpoint.branch = branch;
+
+  char branch_str[16];
+  snprintf(branch_str, sizeof(branch_str), "%d", branch);
+  setenv("NPS_BRANCH", branch_str, 1);
+
+  nps_random_seed(nps_checkpoint.seed + (unsigned long int)branch);
+
+#if USE_UDP
+  // each branch gets its own telemetry link
+  udp_arch_reopen((branch + 1) * NPS_CHECKPOINT_PORT_STEP);
+#endif
+
+  // each branch writes its own profile
+  if (nps_profiler.filename) {
+    size_t len = strlen(nps_profiler.filename) + sizeof(branch_str) + 1;
+    char *filename = malloc(len);
+    if (filename) {
+      snprintf(filename, len, "%s.%d", nps_profiler.filename, branch);
+      nps_profiler.filename = filename;
+    }
+  }
+
+  // resume from the checkpoint sim time in real time
+  struct timeval t;
+  gettimeofday(&t, NULL);
+  double now = time_to_double(&t);
+  nps_main.scaled_initial_time = now - nps_main.sim_time / nps_main.host_time_factor;
+  nps_main.real_initial_time = now - nps_main.sim_time;
+}
+
+void nps_checkpoint_periodic(double sim_time)
+{
+  // running a branch, stop when its duration is over
+  if (nps_checkpoint.branch >= 0 && nps_checkpoint.duration > 0. &&
+      sim_time >= nps_checkpoint.time + nps_checkpoint.duration) {
+    printf("Branch %d done at t=%f\n", nps_checkpoint.branch, sim_time);
+    exit(0);
+  }
+}
+
+void nps_checkpoint_fork(double sim_time)
+{
+  printf("Checkpoint reached at t=%f\n", sim_time);
+  fflush(stdout);
+
+  int nb_started = 0;
+  for (int i = 0; i < nps_checkpoint.nb_branches; i++) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      nps_checkpoint_start_branch(i);
+      return;
+    } else if (pid < 0) {
+      perror("nps checkpoint fork");
+      break;
+    }
+    printf("Branch %d started (pid %d)\n", i, (int)pid);
+    nb_started++;
+  }
+
+  // parent keeps the checkpoint until all branches are done
+  int nb_failed = 0;
+  for (int i = 0; i < nb_started; i++) {
+    int status;
+    if (wait(&status) < 0) {
+      break;
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      nb_failed++;
+    }
+  }
+  printf("All branches done, %d failed\n", nb_failed);
+  exit(nb_failed == 0 ? 0 : 1);
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file nps_checkpoint.h
+ *
+ * Checkpoint the NPS simulation at a given sim time and resume several
+ * branches from it.
+ *
+ * The complete process state (FDM, sensors, state interface, modules,
+ * RNG and sys_time) is captured by forking the simulation process once
+ * the checkpoint time is reached. The parent process keeps the frozen
+ * checkpoint and each child resumes from it as a separate branch.
+ * Every branch gets its own RNG seed and can query its index with
+ * nps_checkpoint_get_branch() (or the NPS_BRANCH environment variable)
+ * to select which fault to inject.
+ *
+ * The simulation runs headless, from the main thread and as fast as
+ * possible, up to the checkpoint: the display, Ivy and FlightGear threads
+ * are never started, so no other thread holds a lock when forking. The
+ * branches are headless too, they run with the time factor and an
+ * optional duration after which each branch exits. The UDP telemetry
+ * link of branch i is reopened with its ports shifted by
+ * (i + 1) * NPS_CHECKPOINT_PORT_STEP (10 by default), so that the branches
+ * do not share the link of the checkpoint.
+ */
+
+#ifndef NPS_CHECKPOINT_H
+#define NPS_CHECKPOINT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+struct NpsCheckpoint {
+  double time;            ///< sim time of the checkpoint, negative if disabled
+  int nb_branches;        ///< number of branches resumed from the checkpoint
+  double duration;        ///< sim time each branch runs, 0 to run forever
+  unsigned long int seed; ///< base RNG seed of the branches
+  int branch;             ///< branch index, -1 before the checkpoint
+};
+
+extern struct NpsCheckpoint nps_checkpoint;
+
+/**
+ * Init checkpoint parameters.
+ * @param time sim time of the checkpoint, negative to disable
+ * @param nb_branches number of branches to run from the checkpoint
+ * @param duration sim time to run each branch for, 0 for no limit
+ * @param seed base RNG seed, branch i is seeded with seed + i
+ */
+extern void nps_checkpoint_init(double time, int nb_branches, double duration, unsigned long int seed);
+
+/**
+ * Fork the branches from the checkpoint.
+ * Must be called before the helper threads are started.
+ * Only returns in the branch processes, the parent waits for all branches
+ * and exits.
+ * @param sim_time current simulation time
+ */
+extern void nps_checkpoint_fork(double sim_time);
+
+/**
+ * Exit the branch when its duration is over.
+ * @param sim_time current simulation time
+ */
+extern void nps_checkpoint_periodic(double sim_time);
+
+/** Get the branch index, -1 before the checkpoint or when disabled */
+static inline int nps_checkpoint_get_branch(void)
+{
+  return nps_checkpoint.branch;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NPS_CHECKPOINT_H */
@@ -8,6 +8,9 @@
 #include "nps_atmosphere.h"
 #include "nps_sensors.h"
 #include "nps_autopilot.h"
+#include "nps_profiler.h"
+#include "nps_checkpoint.h"
+#include "nps_replay.h"
 
 #ifdef __MACH__ // OS X does not have clock_gettime, use clock_get_time
 #include <mach/clock.h>
@@ -34,6 +37,8 @@ bool nps_main_parse_options(int argc, char **argv);
 int nps_main_init(int argc, char **argv);
 void nps_radio_and_autopilot_init(void);
 void nps_main_run_sim_step(void);
+void nps_main_replay_loop(void);
+void nps_main_checkpoint_loop(void);
 void nps_set_time_factor(float time_factor);
 
 void* nps_main_loop(void* data __attribute__((unused)));
@@ -65,6 +70,14 @@ struct NpsMain {
   bool norc;
   char *ivy_bus;
   bool nodisplay;
+  char *profile_file;
+  double checkpoint_time;
+  int checkpoint_branches;
+  double checkpoint_duration;
+  unsigned long int checkpoint_seed;
+  char *replay_file;
+  char *replay_out_file;
+  char *shm_bus;
 };
 
 struct NpsMain nps_main;
@@ -29,6 +29,7 @@
 #include "nps_flightgear.h"
 
 #include "nps_ivy.h"
+#include "nps_shm_bus.h"
 
 #ifdef __MACH__
 pthread_mutex_t clock_mutex; // mutex for clock
@@ -97,6 +98,14 @@ int nps_main_init(int argc, char **argv)
   nps_main.real_initial_time = time_to_double(&t);
   nps_main.scaled_initial_time = time_to_double(&t);
 
+  // replaying a log is meant to measure the estimator cost, always profile it
+  if (nps_main.replay_file != NULL && nps_main.profile_file == NULL) {
+    nps_main.profile_file = strdup("nps_replay_profile.csv");
+  }
+  nps_profiler_init(nps_main.profile_file);
+  nps_checkpoint_init(nps_main.checkpoint_time, nps_main.checkpoint_branches,
+                      nps_main.checkpoint_duration, nps_main.checkpoint_seed);
+
   nps_fdm_init(SIM_DT);
   nps_atmosphere_init();
   nps_sensors_init(nps_main.sim_time);
@@ -104,6 +113,10 @@ int nps_main_init(int argc, char **argv)
 
   nps_radio_and_autopilot_init();
 
+  if (nps_main.replay_file != NULL && !nps_replay_init(nps_main.replay_file, nps_main.replay_out_file)) {
+    return 1;
+  }
+
 #if DEBUG_NPS_TIME
   printf("host_time_factor,host_time_elapsed,host_time_now,scaled_initial_time,sim_time_before,display_time_before,sim_time_after,display_time_after\n");
 #endif
@@ -159,6 +172,14 @@ bool nps_main_parse_options(int argc, char **argv)
   nps_main.host_time_factor = 1.0;
   nps_main.fg_fdm = 0;
   nps_main.nodisplay = false;
+  nps_main.profile_file = NULL;
+  nps_main.checkpoint_time = -1.;
+  nps_main.checkpoint_branches = 1;
+  nps_main.checkpoint_duration = 0.;
+  nps_main.checkpoint_seed = 1;
+  nps_main.replay_file = NULL;
+  nps_main.replay_out_file = NULL;
+  nps_main.shm_bus = NULL;
 
   static const char *usage =
     "Usage: %s [options]\n"
@@ -175,6 +196,14 @@ bool nps_main_parse_options(int argc, char **argv)
     "   --ivy_bus <ivy bus>                    e.g. 127.255.255.255\n"
     "   --time_factor <factor>                 e.g. 2.5\n"
     "   --nodisplay                            e.g. disable NPS ivy messages\n"
+    "   --profile <file>                       e.g. nps_profile.csv, time simulation steps\n"
+    "   --checkpoint <sim time in seconds>     e.g. 120, run headless to this time and fork branches\n"
+    "   --branches <number>                    e.g. 10, number of branches (default 1)\n"
+    "   --branch_duration <seconds>            e.g. 30, sim time to run each branch\n"
+    "   --branch_seed <seed>                   e.g. 42, base RNG seed of the branches\n"
+    "   --replay <sensor log>                  e.g. flight.log, feed the AHRS/INS from a log as fast as possible\n"
+    "   --replay_out <file>                    e.g. replay.csv, estimate and error at each reference record\n"
+    "   --shm_bus <topic>                      e.g. nps, send NPS messages on a shared memory topic instead of ivy\n"
     "   --fg_fdm";
 
 
@@ -193,6 +222,14 @@ bool nps_main_parse_options(int argc, char **argv)
       {"fg_fdm", 0, NULL, 0},
       {"fg_port_in", 1, NULL, 0},
       {"nodisplay", 0, NULL, 0},
+      {"profile", 1, NULL, 0},
+      {"checkpoint", 1, NULL, 0},
+      {"branches", 1, NULL, 0},
+      {"branch_duration", 1, NULL, 0},
+      {"branch_seed", 1, NULL, 0},
+      {"replay", 1, NULL, 0},
+      {"replay_out", 1, NULL, 0},
+      {"shm_bus", 1, NULL, 0},
       {0, 0, 0, 0}
     };
     int option_index = 0;
@@ -231,6 +268,22 @@ bool nps_main_parse_options(int argc, char **argv)
             nps_main.fg_port_in = atoi(optarg); break;
           case 11:
             nps_main.nodisplay = true; break;
+          case 12:
+            nps_main.profile_file = strdup(optarg); break;
+          case 13:
+            nps_main.checkpoint_time = atof(optarg); break;
+          case 14:
+            nps_main.checkpoint_branches = atoi(optarg); break;
+          case 15:
+            nps_main.checkpoint_duration = atof(optarg); break;
+          case 16:
+            nps_main.checkpoint_seed = strtoul(optarg, NULL, 10); break;
+          case 17:
+            nps_main.replay_file = strdup(optarg); break;
+          case 18:
+            nps_main.replay_out_file = strdup(optarg); break;
+          case 19:
+            nps_main.shm_bus = strdup(optarg); break;
           default:
             break;
         }
@@ -315,18 +368,28 @@ void *nps_main_display(void *data __attribute__((unused)))
   struct NpsSensors sensors_ivy;
 
   nps_ivy_init(nps_main.ivy_bus);
+  bool use_shm_bus = (nps_main.shm_bus != NULL && nps_shm_bus_init(nps_main.shm_bus));
 
   // start the loop only if no_display is false
   if (!nps_main.nodisplay) {
     while (TRUE) {
       clock_get_current_time(&requestStart);
+      uint64_t tic = nps_profiler_tic();
 
       pthread_mutex_lock(&fdm_mutex);
       memcpy(&fdm_ivy, &fdm, sizeof(fdm));
       memcpy(&sensors_ivy, &sensors, sizeof(sensors));
       pthread_mutex_unlock(&fdm_mutex);
 
-      nps_ivy_display(&fdm_ivy, &sensors_ivy);
+      if (use_shm_bus) {
+        nps_shm_bus_display(&fdm_ivy, &sensors_ivy);
+        if (nps_ivy_send_world_env) {
+          nps_ivy_send_WORLD_ENV_REQ();
+        }
+      } else {
+        nps_ivy_display(&fdm_ivy, &sensors_ivy);
+      }
+      nps_profiler_toc(NPS_PROF_DISPLAY, tic);
 
       clock_get_current_time(&requestEnd);
 
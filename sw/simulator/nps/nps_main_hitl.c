@@ -98,11 +98,19 @@ void nps_update_launch_from_dl(uint8_t value)
 
 void nps_main_run_sim_step(void)
 {
+  uint64_t tic_step = nps_profiler_tic();
+
   nps_atmosphere_update(SIM_DT);
 
+  uint64_t tic = nps_profiler_tic();
   nps_fdm_run_step(nps_autopilot.launch, nps_autopilot.commands, NPS_COMMANDS_NB);
+  nps_profiler_toc(NPS_PROF_FDM, tic);
 
+  tic = nps_profiler_tic();
   nps_sensors_run_step(nps_main.sim_time);
+  nps_profiler_toc(NPS_PROF_SENSORS, tic);
+
+  nps_profiler_toc(NPS_PROF_STEP, tic_step);
 }
 
 void *nps_ins_data_loop(void *data __attribute__((unused)))
@@ -320,7 +328,7 @@ void *nps_main_loop(void *data __attribute__((unused)))
   double real_time = 0;
   static int guard;
 
-  while (TRUE) {
+  while (!nps_profiler_stop) {
     clock_get_current_time(&requestStart);
 
     pthread_mutex_lock(&fdm_mutex);
@@ -38,10 +38,20 @@ int main(int argc, char **argv)
     return 1;
   }
 
-  if (nps_main.fg_host) {
-    pthread_create(&th_flight_gear, NULL, nps_flight_gear_loop, NULL);
+  if (nps_main.replay_file) {
+    nps_main_replay_loop();
+    return 0;
+  }
+
+  if (nps_checkpoint.time >= 0.) {
+    // only returns in the branches, which stay headless
+    nps_main_checkpoint_loop();
+  } else {
+    if (nps_main.fg_host) {
+      pthread_create(&th_flight_gear, NULL, nps_flight_gear_loop, NULL);
+    }
+    pthread_create(&th_display_ivy, NULL, nps_main_display, NULL);
   }
-  pthread_create(&th_display_ivy, NULL, nps_main_display, NULL);
   pthread_create(&th_main_loop, NULL, nps_main_loop, NULL);
   pthread_join(th_main_loop, NULL);
 
@@ -73,16 +83,68 @@ void nps_radio_and_autopilot_init(void)
 
 void nps_main_run_sim_step(void)
 {
+  uint64_t tic_step = nps_profiler_tic();
+
   nps_atmosphere_update(SIM_DT);
 
   nps_autopilot_run_systime_step();
 
+  uint64_t tic = nps_profiler_tic();
   nps_fdm_run_step(nps_autopilot.launch, nps_autopilot.commands, NPS_COMMANDS_NB);
+  nps_profiler_toc(NPS_PROF_FDM, tic);
 
+  tic = nps_profiler_tic();
   nps_sensors_run_step(nps_main.sim_time);
+  nps_profiler_toc(NPS_PROF_SENSORS, tic);
+
+  tic = nps_profiler_tic();
+  nps_autopilot_run_step(nps_main.sim_time);
+  nps_profiler_toc(NPS_PROF_AUTOPILOT, tic);
+
+  nps_profiler_toc(NPS_PROF_STEP, tic_step);
+}
+
+
+/** Simulation step driven by a sensor log instead of the FDM and sensor models */
+static void nps_main_run_replay_step(void)
+{
+  uint64_t tic_step = nps_profiler_tic();
+
+  nps_autopilot_run_systime_step();
+
+  nps_replay_run_step(nps_main.sim_time);
 
+  uint64_t tic = nps_profiler_tic();
   nps_autopilot_run_step(nps_main.sim_time);
+  nps_profiler_toc(NPS_PROF_AUTOPILOT, tic);
+
+  nps_profiler_toc(NPS_PROF_STEP, tic_step);
+}
 
+
+void nps_main_replay_loop(void)
+{
+  // no display and no real time, run as fast as possible until the end of the log
+  while (!nps_replay.end && !nps_profiler_stop) {
+    nps_main_run_replay_step();
+    nps_main.sim_time += SIM_DT;
+  }
+  nps_replay_report();
+  nps_profiler_report();
+}
+
+
+void nps_main_checkpoint_loop(void)
+{
+  // no other simulation thread yet, run as fast as possible
+  while (nps_main.sim_time < nps_checkpoint.time) {
+    if (nps_profiler_stop) {
+      exit(0);
+    }
+    nps_main_run_sim_step();
+    nps_main.sim_time += SIM_DT;
+  }
+  nps_checkpoint_fork(nps_main.sim_time);
 }
 
 
@@ -97,7 +159,7 @@ void *nps_main_loop(void *data __attribute__((unused)))
   struct timeval tv_now;
   double  host_time_now;
 
-  while (TRUE) {
+  while (!nps_profiler_stop) {
     if (pauseSignal) {
       char line[128];
       double tf = 1.0;
@@ -148,6 +210,7 @@ void *nps_main_loop(void *data __attribute__((unused)))
       nps_main_run_sim_step();
       nps_main.sim_time += SIM_DT;
       pthread_mutex_unlock(&fdm_mutex);
+      nps_checkpoint_periodic(nps_main.sim_time);
       cnt++;
     }
 
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file nps_profiler.c
+ *
+ * Per-step timing of the NPS simulation loop.
+ */
+
+#include "nps_profiler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/time.h>
+
+struct NpsProfiler nps_profiler;
+volatile sig_atomic_t nps_profiler_stop = 0;
+
+static const char *nps_profiler_names[NPS_PROF_NB] = {
+  "step",
+  "fdm",
+  "sensors",
+  "autopilot",
+  "ap_event",
+  "ap_periodic",
+  "display",
+  "rp_imu",
+  "rp_mag",
+  "rp_gps",
+  "rp_baro",
+  "rp_airspeed"
+};
+
+#define NPS_PROF_SUB_MASK ((1 << NPS_PROF_SUB_BITS) - 1)
+
+/** Log-linear bin index of a duration */
+static inline int bin_of_ns(uint64_t ns)
+{
+  if (ns <= NPS_PROF_SUB_MASK) {
+    return (int)ns;
+  }
+  int msb = 63 - __builtin_clzll(ns);
+  return ((msb - NPS_PROF_SUB_BITS + 1) << NPS_PROF_SUB_BITS) |
+         (int)((ns >> (msb - NPS_PROF_SUB_BITS)) & NPS_PROF_SUB_MASK);
+}
+
+/** Lower bound in ns of a histogram bin */
+static uint64_t bin_low_ns(int bin)
+{
+  if (bin <= NPS_PROF_SUB_MASK) {
+    return (uint64_t)bin;
+  }
+  int msb = (bin >> NPS_PROF_SUB_BITS) - 1 + NPS_PROF_SUB_BITS;
+  uint64_t mantissa = (1 << NPS_PROF_SUB_BITS) + (bin & NPS_PROF_SUB_MASK);
+  return mantissa << (msb - NPS_PROF_SUB_BITS);
+}
+
+/** Approximate quantile from the histogram, bin center clamped to min/max */
+static double quantile_ns(struct NpsProfilerStats *s, double q)
+{
+  if (s->count == 0) {
+    return 0.;
+  }
+  uint64_t target = (uint64_t)(q * (double)s->count);
+  uint64_t cumul = 0;
+  for (int i = 0; i < NPS_PROF_NB_BINS; i++) {
+    cumul += s->hist[i];
+    if (cumul > target) {
+      double v = 0.5 * (double)(bin_low_ns(i) + bin_low_ns(i + 1));
+      if (v < (double)s->min_ns) { v = (double)s->min_ns; }
+      if (v > (double)s->max_ns) { v = (double)s->max_ns; }
+      return v;
+    }
+  }
+  return (double)s->max_ns;
+}
+
+static void nps_profiler_at_exit(void)
+{
+  nps_profiler_report();
+}
+
+/** NPS is usually stopped with a signal, only request the simulation loops to stop
+ *  so that the report is written in normal context when NPS exits
+ */
+static void nps_profiler_sig_hdl(int n)
+{
+  nps_profiler_stop = 1;
+  // a second signal stops NPS immediately
+  signal(n, SIG_DFL);
+}
+
+void nps_profiler_init(char *filename)
+{
+  memset(&nps_profiler, 0, sizeof(nps_profiler));
+  if (filename == NULL) {
+    return;
+  }
+  for (int i = 0; i < NPS_PROF_NB; i++) {
+    nps_profiler.stats[i].min_ns = UINT64_MAX;
+  }
+  nps_profiler.filename = filename;
+  nps_profiler.enabled = true;
+  atexit(nps_profiler_at_exit);
+  signal(SIGINT, nps_profiler_sig_hdl);
+  signal(SIGTERM, nps_profiler_sig_hdl);
+  printf("Profiling simulation steps, histograms will be written to %s\n", filename);
+}
+
+uint64_t nps_profiler_tic(void)
+{
+  if (!nps_profiler.enabled) {
+    return 0;
+  }
+#ifdef __MACH__
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (uint64_t)tv.tv_sec * 1000000000ULL + (uint64_t)tv.tv_usec * 1000ULL;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void nps_profiler_toc(enum NpsProfilerSection section, uint64_t tic)
+{
+  if (!nps_profiler.enabled) {
+    return;
+  }
+  uint64_t toc = nps_profiler_tic();
+  uint64_t dt = toc > tic ? toc - tic : 0;
+  struct NpsProfilerStats *s = &nps_profiler.stats[section];
+  s->count++;
+  s->total_ns += dt;
+  if (dt < s->min_ns) { s->min_ns = dt; }
+  if (dt > s->max_ns) { s->max_ns = dt; }
+  s->hist[bin_of_ns(dt)]++;
+}
+
+void nps_profiler_report(void)
+{
+  if (!nps_profiler.enabled) {
+    return;
+  }
+  // stats are read while other threads may still update them,
+  // this is only a report so a slightly inconsistent view is acceptable
+  double step_total = (double)nps_profiler.stats[NPS_PROF_STEP].total_ns;
+
+  printf("\nNPS profile (host time per call in us)\n");
+  printf("%-12s %10s %10s %9s %9s %9s %9s %9s %7s\n",
+         "section", "calls", "total_ms", "mean", "min", "p50", "p99", "max", "%step");
+  for (int i = 0; i < NPS_PROF_NB; i++) {
+    struct NpsProfilerStats *s = &nps_profiler.stats[i];
+    if (s->count == 0) {
+      continue;
+    }
+    double share = (step_total > 0. && i != NPS_PROF_DISPLAY) ? 100. * (double)s->total_ns / step_total : 0.;
+    printf("%-12s %10llu %10.1f %9.2f %9.2f %9.2f %9.2f %9.2f %7.1f\n",
+           nps_profiler_names[i], (unsigned long long)s->count,
+           (double)s->total_ns / 1e6,
+           (double)s->total_ns / (double)s->count / 1e3,
+           (double)s->min_ns / 1e3,
+           quantile_ns(s, 0.5) / 1e3,
+           quantile_ns(s, 0.99) / 1e3,
+           (double)s->max_ns / 1e3,
+           share);
+  }
+
+  FILE *f = fopen(nps_profiler.filename, "w");
+  if (f == NULL) {
+    fprintf(stderr, "NPS profiler: could not open %s\n", nps_profiler.filename);
+    return;
+  }
+  fprintf(f, "section,bin_low_ns,bin_high_ns,count\n");
+  for (int i = 0; i < NPS_PROF_NB; i++) {
+    struct NpsProfilerStats *s = &nps_profiler.stats[i];
+    for (int b = 0; b < NPS_PROF_NB_BINS; b++) {
+      if (s->hist[b] > 0) {
+        fprintf(f, "%s,%llu,%llu,%llu\n", nps_profiler_names[i],
+                (unsigned long long)bin_low_ns(b), (unsigned long long)bin_low_ns(b + 1),
+                (unsigned long long)s->hist[b]);
+      }
+    }
+  }
+  fclose(f);
+  nps_profiler.enabled = false;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file nps_profiler.h
+ *
+ * Per-step timing of the NPS simulation loop.
+ *
+ * Host CPU time spent in the FDM, the sensor models, the autopilot code
+ * and the Ivy display thread is accumulated in log-linear histograms.
+ * When replaying a sensor log, the estimator updates triggered by each
+ * kind of replayed measurement are profiled as well.
+ * Profiling is enabled with the --profile option, the histograms are
+ * written to the given file and a summary is printed when NPS exits.
+ * While profiling, SIGINT and SIGTERM only set nps_profiler_stop: the
+ * simulation loops return and the report is written from the normal exit
+ * path, a second signal kills NPS without report.
+ */
+
+#ifndef NPS_PROFILER_H
+#define NPS_PROFILER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+
+/** Profiled sections, each one is only written by a single thread */
+enum NpsProfilerSection {
+  NPS_PROF_STEP,        ///< complete simulation step
+  NPS_PROF_FDM,         ///< nps_fdm_run_step
+  NPS_PROF_SENSORS,     ///< nps_sensors_run_step
+  NPS_PROF_AUTOPILOT,   ///< nps_autopilot_run_step
+  NPS_PROF_AP_EVENT,    ///< event handlers called from nps_autopilot_run_step
+  NPS_PROF_AP_PERIODIC, ///< periodic tasks called from nps_autopilot_run_step
+  NPS_PROF_DISPLAY,     ///< Ivy display thread iteration
+  NPS_PROF_REPLAY_IMU,      ///< ABI dispatch of a replayed gyro or accel sample
+  NPS_PROF_REPLAY_MAG,      ///< ABI dispatch of a replayed mag sample
+  NPS_PROF_REPLAY_GPS,      ///< ABI dispatch of a replayed GPS fix
+  NPS_PROF_REPLAY_BARO,     ///< ABI dispatch of a replayed pressure
+  NPS_PROF_REPLAY_AIRSPEED, ///< ABI dispatch of a replayed airspeed
+  NPS_PROF_NB
+};
+
+/** Histogram resolution: 2^NPS_PROF_SUB_BITS bins per power of two */
+#define NPS_PROF_SUB_BITS 2
+#define NPS_PROF_NB_BINS (64 << NPS_PROF_SUB_BITS)
+
+struct NpsProfilerStats {
+  uint64_t count;
+  uint64_t total_ns;
+  uint64_t min_ns;
+  uint64_t max_ns;
+  uint64_t hist[NPS_PROF_NB_BINS];
+};
+
+struct NpsProfiler {
+  bool enabled;
+  char *filename;   ///< histogram output file
+  struct NpsProfilerStats stats[NPS_PROF_NB];
+};
+
+extern struct NpsProfiler nps_profiler;
+
+/** Set by SIGINT or SIGTERM when profiling, the simulation loops stop when set */
+extern volatile sig_atomic_t nps_profiler_stop;
+
+/**
+ * Init the profiler.
+ * @param filename file to write the histograms to at exit,
+ *                 NULL to disable profiling
+ */
+extern void nps_profiler_init(char *filename);
+
+/**
+ * Get a monotonic timestamp in nanoseconds.
+ * Returns 0 if profiling is disabled.
+ */
+extern uint64_t nps_profiler_tic(void);
+
+/**
+ * Add the time elapsed since tic to a section.
+ * @param section profiled section
+ * @param tic timestamp from nps_profiler_tic
+ */
+extern void nps_profiler_toc(enum NpsProfilerSection section, uint64_t tic);
+
+/** Print the summary to stdout and write the histograms file */
+extern void nps_profiler_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NPS_PROFILER_H */
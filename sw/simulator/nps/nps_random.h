@@ -4,6 +4,7 @@
 #include "math/pprz_algebra_double.h"
 
 extern double get_gaussian_noise(void);
+extern void nps_random_seed(unsigned long int seed);
 extern void double_vect3_add_gaussian_noise(struct DoubleVect3 *vect, struct DoubleVect3 *std_dev);
 extern void double_vect3_get_gaussian_noise(struct DoubleVect3 *vect, struct DoubleVect3 *std_dev);
 extern void double_vect3_update_random_walk(struct DoubleVect3 *rw, struct DoubleVect3 *std_dev, double dt,
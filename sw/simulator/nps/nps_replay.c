@@ -0,0 +1,345 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file nps_replay.c
+ *
+ * Replay a sensor log into the AHRS/INS of the simulated airframe.
+ */
+
+#include "nps_replay.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "nps_profiler.h"
+
+#include "generated/airframe.h"
+#include "mcu_periph/sys_time.h"
+#include "subsystems/abi.h"
+#include "subsystems/imu.h"
+#include "subsystems/gps.h"
+#include "state.h"
+#include "math/pprz_algebra_int.h"
+#include "math/pprz_geodetic_double.h"
+
+struct NpsReplay nps_replay;
+
+enum NpsReplayType {
+  REPLAY_GYRO,
+  REPLAY_ACCEL,
+  REPLAY_MAG,
+  REPLAY_GPS,
+  REPLAY_BARO,
+  REPLAY_AIRSPEED,
+  REPLAY_TRUTH,
+  REPLAY_NB
+};
+
+static const char *replay_names[REPLAY_NB] = {
+  "GYRO", "ACCEL", "MAG", "GPS", "BARO", "AIRSPEED", "TRUTH"
+};
+
+/** number of values of each record type */
+static const int replay_nb_values[REPLAY_NB] = { 3, 3, 3, 8, 1, 1, 10 };
+
+#define REPLAY_MAX_VALUES 10
+#define REPLAY_LINE_LEN 512
+
+struct NpsReplayRecord {
+  double time;      ///< sim time of the record
+  enum NpsReplayType type;
+  double v[REPLAY_MAX_VALUES];
+};
+
+static struct NpsReplayRecord record;
+static struct GpsState gps_replay;
+
+/** Read the next record, return false at the end of the log */
+static bool replay_read_record(void)
+{
+  char line[REPLAY_LINE_LEN];
+  while (fgets(line, sizeof(line), nps_replay.log) != NULL) {
+    nps_replay.line++;
+    double t;
+    char type[16];
+    int n;
+    if (line[0] == '#' || sscanf(line, "%lf %15s %n", &t, type, &n) != 2) {
+      continue;
+    }
+    int i;
+    for (i = 0; i < REPLAY_NB; i++) {
+      if (strcmp(type, replay_names[i]) == 0) {
+        break;
+      }
+    }
+    if (i == REPLAY_NB) {
+      fprintf(stderr, "NPS replay: unknown record %s line %u\n", type, nps_replay.line);
+      continue;
+    }
+    record.type = (enum NpsReplayType)i;
+    char *p = line + n;
+    int k;
+    for (k = 0; k < replay_nb_values[i]; k++) {
+      char *end;
+      record.v[k] = strtod(p, &end);
+      if (end == p) {
+        break;
+      }
+      p = end;
+    }
+    if (k < replay_nb_values[i]) {
+      fprintf(stderr, "NPS replay: truncated %s record line %u\n", type, nps_replay.line);
+      continue;
+    }
+    if (nps_replay.nb_records == 0 && !nps_replay.pending) {
+      nps_replay.time_offset = t;
+    }
+    record.time = t - nps_replay.time_offset;
+    return true;
+  }
+  return false;
+}
+
+/** ABI timestamp of the current record in usec */
+static inline uint32_t replay_stamp(void)
+{
+  return (uint32_t)(record.time * 1e6);
+}
+
+static void replay_gps(void)
+{
+  struct LlaCoor_d lla = { RadOfDeg(record.v[2]), RadOfDeg(record.v[3]), record.v[4] };
+  struct NedCoor_d ned_vel = { record.v[5], record.v[6], record.v[7] };
+  struct EcefCoor_d ecef_pos, ecef_vel;
+  struct LtpDef_d ltp;
+  ecef_of_lla_d(&ecef_pos, &lla);
+  ltp_def_from_lla_d(&ltp, &lla);
+  ecef_of_ned_vect_d(&ecef_vel, &ltp, &ned_vel);
+
+  gps_replay.valid_fields = 0;
+  gps_replay.tow = (uint32_t)(record.time * 1000.);
+  gps_replay.ecef_pos.x = ecef_pos.x * 100.;
+  gps_replay.ecef_pos.y = ecef_pos.y * 100.;
+  gps_replay.ecef_pos.z = ecef_pos.z * 100.;
+  SetBit(gps_replay.valid_fields, GPS_VALID_POS_ECEF_BIT);
+  gps_replay.ecef_vel.x = ecef_vel.x * 100.;
+  gps_replay.ecef_vel.y = ecef_vel.y * 100.;
+  gps_replay.ecef_vel.z = ecef_vel.z * 100.;
+  SetBit(gps_replay.valid_fields, GPS_VALID_VEL_ECEF_BIT);
+  gps_replay.lla_pos.lat = record.v[2] * 1e7;
+  gps_replay.lla_pos.lon = record.v[3] * 1e7;
+  gps_replay.lla_pos.alt = record.v[4] * 1000.;
+  SetBit(gps_replay.valid_fields, GPS_VALID_POS_LLA_BIT);
+  // no geoid model, logs are expected to use the ellipsoid height
+  gps_replay.hmsl = record.v[4] * 1000.;
+  SetBit(gps_replay.valid_fields, GPS_VALID_HMSL_BIT);
+  gps_replay.ned_vel.x = ned_vel.x * 100.;
+  gps_replay.ned_vel.y = ned_vel.y * 100.;
+  gps_replay.ned_vel.z = ned_vel.z * 100.;
+  SetBit(gps_replay.valid_fields, GPS_VALID_VEL_NED_BIT);
+  gps_replay.gspeed = sqrt(ned_vel.x * ned_vel.x + ned_vel.y * ned_vel.y) * 100.;
+  gps_replay.speed_3d = sqrt(ned_vel.x * ned_vel.x + ned_vel.y * ned_vel.y + ned_vel.z * ned_vel.z) * 100.;
+  gps_replay.course = atan2(ned_vel.y, ned_vel.x) * 1e7;
+  SetBit(gps_replay.valid_fields, GPS_VALID_COURSE_BIT);
+
+  gps_replay.pacc = 650;
+  gps_replay.hacc = 450;
+  gps_replay.vacc = 200;
+  gps_replay.sacc = 100;
+  gps_replay.pdop = 650;
+  gps_replay.fix = (uint8_t)record.v[0];
+  gps_replay.num_sv = (uint8_t)record.v[1];
+
+  gps_replay.last_msg_ticks = sys_time.nb_sec_rem;
+  gps_replay.last_msg_time = sys_time.nb_sec;
+  if (gps_replay.fix == GPS_FIX_3D) {
+    gps_replay.last_3dfix_ticks = sys_time.nb_sec_rem;
+    gps_replay.last_3dfix_time = sys_time.nb_sec;
+  }
+  AbiSendMsgGPS(GPS_SIM_ID, replay_stamp(), &gps_replay);
+}
+
+/** Compare the state interface to a reference record */
+static void replay_truth(void)
+{
+  struct NpsReplayError *e = &nps_replay.error;
+
+  // angle of the rotation between estimated and reference attitudes
+  struct FloatQuat *q = stateGetNedToBodyQuat_f();
+  double dot = fabs(q->qi * record.v[0] + q->qx * record.v[1] + q->qy * record.v[2] + q->qz * record.v[3]);
+  double att_err = 2. * acos(dot < 1. ? dot : 1.);
+  e->nb++;
+  e->att_sq_sum += att_err * att_err;
+  if (att_err > e->att_max) { e->att_max = att_err; }
+
+  double pos_err = -1., speed_err = -1.;
+  struct NedCoor_d ref_pos = { 0., 0., 0. };
+  if (state.ned_initialized_i) {
+    struct LlaCoor_d origin = {
+      RadOfDeg(state.ned_origin_i.lla.lat / 1e7),
+      RadOfDeg(state.ned_origin_i.lla.lon / 1e7),
+      state.ned_origin_i.lla.alt / 1000.
+    };
+    struct LtpDef_d ltp;
+    ltp_def_from_lla_d(&ltp, &origin);
+    struct LlaCoor_d lla = { RadOfDeg(record.v[4]), RadOfDeg(record.v[5]), record.v[6] };
+    ned_of_lla_point_d(&ref_pos, &ltp, &lla);
+
+    struct NedCoor_f *pos = stateGetPositionNed_f();
+    struct NedCoor_f *speed = stateGetSpeedNed_f();
+    pos_err = sqrt((pos->x - ref_pos.x) * (pos->x - ref_pos.x) +
+                   (pos->y - ref_pos.y) * (pos->y - ref_pos.y) +
+                   (pos->z - ref_pos.z) * (pos->z - ref_pos.z));
+    speed_err = sqrt((speed->x - record.v[7]) * (speed->x - record.v[7]) +
+                     (speed->y - record.v[8]) * (speed->y - record.v[8]) +
+                     (speed->z - record.v[9]) * (speed->z - record.v[9]));
+    e->nb_pos++;
+    e->pos_sq_sum += pos_err * pos_err;
+    e->speed_sq_sum += speed_err * speed_err;
+    if (pos_err > e->pos_max) { e->pos_max = pos_err; }
+    if (speed_err > e->speed_max) { e->speed_max = speed_err; }
+  }
+
+  if (nps_replay.out != NULL) {
+    struct FloatEulers *eul = stateGetNedToBodyEulers_f();
+    struct NedCoor_f *pos = stateGetPositionNed_f();
+    struct NedCoor_f *speed = stateGetSpeedNed_f();
+    fprintf(nps_replay.out, "%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n",
+            record.time, eul->phi, eul->theta, eul->psi,
+            pos->x, pos->y, pos->z, speed->x, speed->y, speed->z,
+            ref_pos.x, ref_pos.y, ref_pos.z,
+            att_err, pos_err, speed_err);
+  }
+}
+
+/** Publish the current record on ABI */
+static void replay_dispatch(void)
+{
+  uint64_t tic = nps_profiler_tic();
+  switch (record.type) {
+    case REPLAY_GYRO:
+      imu.gyro_prev = imu.gyro;
+      imu.gyro.p = RATE_BFP_OF_REAL(record.v[0]);
+      imu.gyro.q = RATE_BFP_OF_REAL(record.v[1]);
+      imu.gyro.r = RATE_BFP_OF_REAL(record.v[2]);
+      AbiSendMsgIMU_GYRO_INT32(IMU_BOARD_ID, replay_stamp(), &imu.gyro);
+      nps_profiler_toc(NPS_PROF_REPLAY_IMU, tic);
+      break;
+    case REPLAY_ACCEL:
+      imu.accel_prev = imu.accel;
+      imu.accel.x = ACCEL_BFP_OF_REAL(record.v[0]);
+      imu.accel.y = ACCEL_BFP_OF_REAL(record.v[1]);
+      imu.accel.z = ACCEL_BFP_OF_REAL(record.v[2]);
+      AbiSendMsgIMU_ACCEL_INT32(IMU_BOARD_ID, replay_stamp(), &imu.accel);
+      nps_profiler_toc(NPS_PROF_REPLAY_IMU, tic);
+      break;
+    case REPLAY_MAG:
+      imu.mag.x = MAG_BFP_OF_REAL(record.v[0]);
+      imu.mag.y = MAG_BFP_OF_REAL(record.v[1]);
+      imu.mag.z = MAG_BFP_OF_REAL(record.v[2]);
+      AbiSendMsgIMU_MAG_INT32(IMU_BOARD_ID, replay_stamp(), &imu.mag);
+      nps_profiler_toc(NPS_PROF_REPLAY_MAG, tic);
+      break;
+    case REPLAY_GPS:
+      replay_gps();
+      nps_profiler_toc(NPS_PROF_REPLAY_GPS, tic);
+      break;
+    case REPLAY_BARO:
+      AbiSendMsgBARO_ABS(BARO_SIM_SENDER_ID, replay_stamp(), (float)record.v[0]);
+      nps_profiler_toc(NPS_PROF_REPLAY_BARO, tic);
+      break;
+    case REPLAY_AIRSPEED:
+#if USE_AIRSPEED
+      stateSetAirspeed_f((float)record.v[0]);
+#endif
+      AbiSendMsgAIRSPEED(AIRSPEED_NPS_ID, (float)record.v[0]);
+      nps_profiler_toc(NPS_PROF_REPLAY_AIRSPEED, tic);
+      break;
+    case REPLAY_TRUTH:
+      replay_truth();
+      break;
+    default:
+      break;
+  }
+  nps_replay.nb_records++;
+}
+
+bool nps_replay_init(char *log_file, char *out_file)
+{
+  memset(&nps_replay, 0, sizeof(nps_replay));
+  memset(&gps_replay, 0, sizeof(gps_replay));
+  gps_replay.week = 1794;
+  nps_replay.log = fopen(log_file, "r");
+  if (nps_replay.log == NULL) {
+    fprintf(stderr, "NPS replay: could not open %s\n", log_file);
+    return false;
+  }
+  if (out_file != NULL) {
+    nps_replay.out = fopen(out_file, "w");
+    if (nps_replay.out == NULL) {
+      fprintf(stderr, "NPS replay: could not open %s\n", out_file);
+    } else {
+      fprintf(nps_replay.out, "time,phi,theta,psi,x,y,z,vx,vy,vz,ref_x,ref_y,ref_z,"
+              "att_err,pos_err,speed_err\n");
+    }
+  }
+  nps_replay.pending = replay_read_record();
+  nps_replay.end = !nps_replay.pending;
+  printf("Replaying sensor log %s\n", log_file);
+  return true;
+}
+
+bool nps_replay_run_step(double time)
+{
+  if (nps_replay.log == NULL || nps_replay.end) {
+    return false;
+  }
+  while (nps_replay.pending && record.time <= time) {
+    replay_dispatch();
+    nps_replay.pending = replay_read_record();
+  }
+  nps_replay.end = !nps_replay.pending;
+  return !nps_replay.end;
+}
+
+void nps_replay_report(void)
+{
+  if (nps_replay.log == NULL) {
+    return;
+  }
+  struct NpsReplayError *e = &nps_replay.error;
+  printf("\nNPS replay: %u records, %.1f s of log\n", nps_replay.nb_records, record.time);
+  if (e->nb > 0) {
+    printf("attitude error  rms %8.3f deg  max %8.3f deg\n",
+           DegOfRad(sqrt(e->att_sq_sum / e->nb)), DegOfRad(e->att_max));
+  }
+  if (e->nb_pos > 0) {
+    printf("position error  rms %8.3f m    max %8.3f m\n", sqrt(e->pos_sq_sum / e->nb_pos), e->pos_max);
+    printf("speed error     rms %8.3f m/s  max %8.3f m/s\n", sqrt(e->speed_sq_sum / e->nb_pos), e->speed_max);
+  }
+  fclose(nps_replay.log);
+  nps_replay.log = NULL;
+  if (nps_replay.out != NULL) {
+    fclose(nps_replay.out);
+    nps_replay.out = NULL;
+  }
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file nps_replay.h
+ *
+ * Replay a sensor log into the AHRS/INS of the simulated airframe.
+ *
+ * Instead of the FDM and the sensor models, the measurements are read
+ * from a log and published on the same ABI messages and sender ids as
+ * the NPS sensor drivers, so that any estimator configured in the
+ * airframe (AHRS, INS, EKF2, MEKF wind, invariant filter, HFF...) runs
+ * unmodified on them. The simulation runs as fast as the host allows,
+ * the time of the log drives sys_time and the ABI timestamps.
+ *
+ * The host time of each measurement dispatch, which includes the
+ * estimator updates done in the ABI callbacks, is profiled per kind of
+ * measurement. When the log contains reference records, the estimate of
+ * the state interface is compared to them.
+ *
+ * The log is a text file streamed line by line, one record per line:
+ * @code
+ * <time s> GYRO <p> <q> <r>                        rad/s, IMU frame
+ * <time s> ACCEL <x> <y> <z>                       m/s^2, IMU frame
+ * <time s> MAG <x> <y> <z>                         normalized, IMU frame
+ * <time s> GPS <fix> <num_sv> <lat> <lon> <alt> <vn> <ve> <vd>
+ *                                                  deg, m above ellipsoid, m/s
+ * <time s> BARO <pressure>                         Pa
+ * <time s> AIRSPEED <airspeed>                     m/s
+ * <time s> TRUTH <qi> <qx> <qy> <qz> <lat> <lon> <alt> <vn> <ve> <vd>
+ *                                                  reference NED to body quaternion,
+ *                                                  position and speed
+ * @endcode
+ * Records must be sorted by time, empty lines and lines starting with
+ * '#' are ignored.
+ */
+
+#ifndef NPS_REPLAY_H
+#define NPS_REPLAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Accumulated estimation errors */
+struct NpsReplayError {
+  uint32_t nb;          ///< number of compared reference records
+  double att_sq_sum;    ///< sum of squared attitude errors in rad^2
+  double att_max;       ///< max attitude error in rad
+  uint32_t nb_pos;      ///< number of records compared once the NED origin is set
+  double pos_sq_sum;    ///< sum of squared position errors in m^2
+  double pos_max;       ///< max position error in m
+  double speed_sq_sum;  ///< sum of squared speed errors in (m/s)^2
+  double speed_max;     ///< max speed error in m/s
+};
+
+struct NpsReplay {
+  FILE *log;            ///< sensor log, NULL when not replaying
+  FILE *out;            ///< estimate and error at each reference record, NULL if not written
+  double time_offset;   ///< time of the first record in the log
+  uint32_t line;        ///< current line number
+  uint32_t nb_records;  ///< number of dispatched records
+  bool pending;         ///< a record has been read but not dispatched yet
+  bool end;             ///< end of the log reached
+  struct NpsReplayError error;
+};
+
+extern struct NpsReplay nps_replay;
+
+/**
+ * Open the sensor log.
+ * Must be called after the autopilot init so that the ABI bindings exist.
+ * @param log_file sensor log to replay
+ * @param out_file file to write estimate and errors to, NULL to disable
+ * @return false if the log could not be opened
+ */
+extern bool nps_replay_init(char *log_file, char *out_file);
+
+/**
+ * Dispatch all records up to the given sim time.
+ * @param time sim time in seconds, 0 at the first record of the log
+ * @return false once the end of the log is reached
+ */
+extern bool nps_replay_run_step(double time);
+
+/** Print the estimation errors and close the files */
+extern void nps_replay_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NPS_REPLAY_H */
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file nps_shm_bus.c
+ *
+ * NPS display messages on the shared memory bus.
+ */
+
+#include "nps_shm_bus.h"
+
+#include <stdio.h>
+
+#include "generated/airframe.h"
+#include "math/pprz_algebra_double.h"
+#include "subsystems/datalink/downlink.h"
+#include "arch/linux/shm_bus.h"
+#include "arch/linux/shm_bus_transport.h"
+
+#include NPS_SENSORS_PARAMS
+
+static struct ShmBus nps_bus;
+static struct shm_bus_transport nps_bus_tp;
+
+bool nps_shm_bus_init(const char *topic)
+{
+  if (shm_bus_open(&nps_bus, topic, SHM_BUS_NB_SLOTS, SHM_BUS_SLOT_SIZE) < 0) {
+    fprintf(stderr, "NPS: can't open shared memory topic %s\n", topic);
+    return false;
+  }
+  shm_bus_transport_init(&nps_bus_tp, &nps_bus);
+  return true;
+}
+
+void nps_shm_bus_display(struct NpsFdm *fdm_data, struct NpsSensors *sensors_data)
+{
+  struct transport_tx *trans = &nps_bus_tp.trans_tx;
+  struct link_device *dev = &nps_bus_tp.device;
+
+  float p = DegOfRad(fdm_data->body_ecef_rotvel.p);
+  float q = DegOfRad(fdm_data->body_ecef_rotvel.q);
+  float r = DegOfRad(fdm_data->body_ecef_rotvel.r);
+  float phi = DegOfRad(fdm_data->ltp_to_body_eulers.phi);
+  float theta = DegOfRad(fdm_data->ltp_to_body_eulers.theta);
+  float psi = DegOfRad(fdm_data->ltp_to_body_eulers.psi);
+  pprz_msg_send_NPS_RATE_ATTITUDE(trans, dev, AC_ID, &p, &q, &r, &phi, &theta, &psi);
+
+  float pprz_lat = fdm_data->lla_pos_pprz.lat;
+  float lat_geod = fdm_data->lla_pos_geod.lat;
+  float lat_geoc = fdm_data->lla_pos_geoc.lat;
+  float pprz_lon = fdm_data->lla_pos_pprz.lon;
+  float lon_geod = fdm_data->lla_pos_geod.lon;
+  float pprz_alt = fdm_data->lla_pos_pprz.alt;
+  float alt_geod = fdm_data->lla_pos_geod.alt;
+  float agl = fdm_data->agl;
+  float asl = fdm_data->hmsl;
+  pprz_msg_send_NPS_POS_LLH(trans, dev, AC_ID, &pprz_lat, &lat_geod, &lat_geoc, &pprz_lon, &lon_geod,
+                            &pprz_alt, &alt_geod, &agl, &asl);
+
+  float ltpp_xdd = fdm_data->ltpprz_ecef_accel.x;
+  float ltpp_ydd = fdm_data->ltpprz_ecef_accel.y;
+  float ltpp_zdd = fdm_data->ltpprz_ecef_accel.z;
+  float ltpp_xd = fdm_data->ltpprz_ecef_vel.x;
+  float ltpp_yd = fdm_data->ltpprz_ecef_vel.y;
+  float ltpp_zd = fdm_data->ltpprz_ecef_vel.z;
+  float ltpp_x = fdm_data->ltpprz_pos.x;
+  float ltpp_y = fdm_data->ltpprz_pos.y;
+  float ltpp_z = fdm_data->ltpprz_pos.z;
+  pprz_msg_send_NPS_SPEED_POS(trans, dev, AC_ID, &ltpp_xdd, &ltpp_ydd, &ltpp_zdd, &ltpp_xd, &ltpp_yd, &ltpp_zd,
+                              &ltpp_x, &ltpp_y, &ltpp_z);
+
+  float bp = DegOfRad(RATE_FLOAT_OF_BFP(sensors_data->gyro.bias_random_walk_value.x) + sensors_data->gyro.bias_initial.x);
+  float bq = DegOfRad(RATE_FLOAT_OF_BFP(sensors_data->gyro.bias_random_walk_value.y) + sensors_data->gyro.bias_initial.y);
+  float br = DegOfRad(RATE_FLOAT_OF_BFP(sensors_data->gyro.bias_random_walk_value.z) + sensors_data->gyro.bias_initial.z);
+  pprz_msg_send_NPS_GYRO_BIAS(trans, dev, AC_ID, &bp, &bq, &br);
+
+  /* transform magnetic field to body frame */
+  struct DoubleVect3 h_body;
+  double_quat_vmult(&h_body, &fdm_data->ltp_to_body_quat, &fdm_data->ltp_h);
+  float acc_x = (sensors_data->accel.value.x - sensors_data->accel.neutral.x) / NPS_ACCEL_SENSITIVITY_XX;
+  float acc_y = (sensors_data->accel.value.y - sensors_data->accel.neutral.y) / NPS_ACCEL_SENSITIVITY_YY;
+  float acc_z = (sensors_data->accel.value.z - sensors_data->accel.neutral.z) / NPS_ACCEL_SENSITIVITY_ZZ;
+  float mag_x = h_body.x, mag_y = h_body.y, mag_z = h_body.z;
+  pprz_msg_send_NPS_SENSORS_SCALED(trans, dev, AC_ID, &acc_x, &acc_y, &acc_z, &mag_x, &mag_y, &mag_z);
+
+  float wind_x = fdm_data->wind.x, wind_y = fdm_data->wind.y, wind_z = fdm_data->wind.z;
+  pprz_msg_send_NPS_WIND(trans, dev, AC_ID, &wind_x, &wind_y, &wind_z);
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, write to
+ * the Free Software Foundation, 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/**
+ * @file nps_shm_bus.h
+ *
+ * NPS display messages on the shared memory bus.
+ *
+ * The NPS_* messages of nps_ivy_display are published as binary pprzlink
+ * telemetry messages on a shared memory topic instead of Ivy text, so many
+ * simulated aircraft on one host don't load the Ivy bus. Ground tools read
+ * the topic directly, or through the shm2ivy bridge.
+ */
+
+#ifndef NPS_SHM_BUS_H
+#define NPS_SHM_BUS_H
+
+#include "nps_fdm.h"
+#include "nps_sensors.h"
+
+/**
+ * Open the shared memory topic.
+ * @param topic topic name, shared by all the simulated aircraft
+ * @return true on success
+ */
+extern bool nps_shm_bus_init(const char *topic);
+
+extern void nps_shm_bus_display(struct NpsFdm *fdm_data, struct NpsSensors *sensors_data);
+
+#endif /* NPS_SHM_BUS_H */
@@ -330,21 +330,45 @@ let print_event_functions = fun out modules ->
 let print_datalink_functions = fun out modules ->
   lprintf out "\n#include \"pprzlink/messages.h\"\n";
   lprintf out "#include \"generated/airframe.h\"\n";
-  lprintf out "static inline void modules_parse_datalink(uint8_t msg_id __attribute__ ((unused)),
-                                          struct link_device *dev __attribute__((unused)),
-                                          struct transport_tx *trans __attribute__((unused)),
-                                          uint8_t *buf __attribute__((unused))) {\n";
+  lprintf out "#include \"subsystems/datalink/dl_dispatch.h\"\n";
+  let handlers = List.flatten (List.map (fun m ->
+    List.filter (fun i -> Xml.tag i = "datalink") (Xml.children m.Module.xml))
+    modules) in
+  (** one handler function per datalink node *)
+  List.iteri (fun n i ->
+    lprintf out "\nstatic void modules_datalink_%d(uint8_t sender_id __attribute__((unused)),\n" n;
+    lprintf out "                                 struct link_device *dev __attribute__((unused)),\n";
+    lprintf out "                                 struct transport_tx *trans __attribute__((unused)),\n";
+    lprintf out "                                 uint8_t *buf __attribute__((unused))) {\n";
+    right ();
+    lprintf out "%s;\n" (ExtXml.attrib i "fun");
+    left ();
+    lprintf out "}\n"
+  ) handlers;
+  (** dispatch classes of a node, both if not specified *)
+  let classes = fun i ->
+    match ExtXml.attrib_or_default i "class" "" with
+        "datalink" -> ["DL_DISPATCH_DATALINK"]
+      | "telemetry" -> ["DL_DISPATCH_TELEMETRY"]
+      | _ -> ["DL_DISPATCH_DATALINK"; "DL_DISPATCH_TELEMETRY"] in
+  let registrations = List.flatten (List.mapi (fun n i ->
+    List.map (fun c -> (c, ExtXml.attrib i "message", n)) (classes i)) handlers) in
+  let entries = List.sort_uniq compare (List.map (fun (c, m, _) -> (c, m)) registrations) in
+  (** check the dispatch pools at compile time *)
+  lprintf out "\n#define MODULES_DATALINK_NB_HANDLERS %d\n" (List.length registrations);
+  lprintf out "#define MODULES_DATALINK_NB_ENTRIES %d\n" (List.length entries);
+  lprintf out "#if MODULES_DATALINK_NB_HANDLERS + DL_DISPATCH_NB_CORE_HANDLERS > DL_DISPATCH_NB_HANDLERS\n";
+  lprintf out "#error \"Too many datalink handlers in modules, increase DL_DISPATCH_NB_HANDLERS\"\n";
+  lprintf out "#endif\n";
+  lprintf out "#if MODULES_DATALINK_NB_ENTRIES + DL_DISPATCH_NB_CORE_HANDLERS > DL_DISPATCH_NB_ENTRIES\n";
+  lprintf out "#error \"Too many datalink messages in modules, increase DL_DISPATCH_NB_ENTRIES\"\n";
+  lprintf out "#endif\n";
+  (** register them in the dispatch table *)
+  lprintf out "\nstatic inline void modules_datalink_register(void) {\n";
   right ();
-  let else_ = ref "" in
-  List.iter (fun m ->
-    List.iter (fun i ->
-      match Xml.tag i with
-          "datalink" ->
-            lprintf out "%sif (msg_id == DL_%s) { %s; }\n" !else_ (ExtXml.attrib i "message") (ExtXml.attrib i "fun");
-            else_ := "else "
-        | _ -> ())
-      (Xml.children m.Module.xml))
-    modules;
+  List.iter (fun (c, m, n) ->
+    lprintf out "dl_dispatch_register(%s, DL_%s, modules_datalink_%d);\n" c m n
+  ) registrations;
   left ();
   lprintf out "}\n"
 
@@ -82,8 +82,15 @@ let output_modes = fun out_h process_name telem_type modes ->
       List.iter
         (fun ((message, _phase), (p, i)) ->
           let message_name = ExtXml.attrib message "name" in
+          let budget = telem_type = "PPRZ" in
           lprintf out_h "if (i%d == (uint32_t)(TELEMETRY_FREQUENCY*%s*%f)) {\n" i p _phase;
           right ();
+          if budget then begin
+            let prio = Compat.uppercase_ascii (ExtXml.attrib_or_default message "priority" "normal") in
+            fprintf out_h "#if USE_PERIODIC_TELEMETRY_BUDGET\n";
+            lprintf out_h "if (periodic_telemetry_budget_check(dev, TELEMETRY_%s_MSG_%s_IDX, TELEMETRY_PRIO_%s)) {\n" telem_type message_name prio;
+            fprintf out_h "#endif\n"
+          end;
           lprintf out_h "for (j = 0; j < TELEMETRY_NB_CBS; j++) {\n";
           right ();
           lprintf out_h "if (telemetry->cbs[TELEMETRY_%s_MSG_%s_IDX].slots[j] != NULL)\n" telem_type message_name;
@@ -96,6 +103,12 @@ let output_modes = fun out_h process_name telem_type modes ->
           fprintf out_h "#if USE_PERIODIC_TELEMETRY_REPORT\n";
           lprintf out_h "if (j == 0) periodic_telemetry_err_report(TELEMETRY_PROCESS_%s, telemetry_mode_%s, %s_MSG_ID_%s);\n" process_name process_name telem_type message_name;
           fprintf out_h "#endif\n";
+          if budget then begin
+            fprintf out_h "#if USE_PERIODIC_TELEMETRY_BUDGET\n";
+            lprintf out_h "periodic_telemetry_budget_sent(dev, TELEMETRY_%s_MSG_%s_IDX);\n" telem_type message_name;
+            lprintf out_h "}\n";
+            fprintf out_h "#endif\n"
+          end;
           left ();
           lprintf out_h "}\n"
         )
@@ -1,89 +1,474 @@
+/*
+ * Copyright (C) 2026 The Paparazzi Team
+ *
+ * This file is part of paparazzi.
+ *
+ * paparazzi is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * paparazzi is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with paparazzi; see the file COPYING.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file mergelogs.c
+ *
+ * Merge .data logs (lines "time sender MSG_NAME fields...").
+ *
+ *   mergelogs [-o merged.data] [-w window] [-m MSG,...] [-n] log1.data log2.data ...
+ *
+ * The logs of several aircraft and ground stations are merged in time
+ * order with a streaming k-way merge: only the current line of each log is
+ * in memory and the output is written in one pass.
+ *
+ * The logs are recorded with different clocks. The offset of each log to
+ * the first one is estimated from the messages that are in both, e.g. the
+ * telemetry of an aircraft in its onboard log and in the ground station
+ * log: a message with the same sender, name and values, unique in the
+ * first window seconds of both logs, gives one time difference, and the
+ * offset is their median. -m restricts the messages used, -n disables the
+ * estimation.
+ *
+ * The timestamps can be decimal or integer numbers, the shifted times are
+ * written with the same number of decimals. Lines of a log with a zero
+ * offset are copied unchanged.
+ *
+ *   mergelogs -a log1.data log2.data
+ *
+ * appends log2 to log1, with its times shifted by the last time of log1.
+ */
+
+#define _GNU_SOURCE
+
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <unistd.h>
 
+/** Minimum number of shared messages to estimate an offset */
+#define MIN_MATCHES 3
 
-char buf[200];
+struct log {
+  const char *name;
+  FILE *f;
+  char *line;               ///< current line
+  size_t line_cap;
+  ssize_t line_len;
+  const char *rest;         ///< line after the time
+  double time;              ///< shifted time of the current line
+  double offset;
+  int64_t offset_int;       ///< offset for the integer times
+};
 
-float get_time(char* str)
+/** Time of a line, with the position of the text after it and its number of decimals */
+static int parse_time(const char *line, double *t, int64_t *t_int, int *decimals, const char **rest)
 {
-	float time = 0.0f;
-	sscanf(str,"%f", &time);
-	return time;
+  char *e;
+  *t = strtod(line, &e);
+  if (e == line) {
+    return -1;
+  }
+  const char *dot = memchr(line, '.', e - line);
+  *decimals = dot != NULL ? (int)(e - dot - 1) : -1;
+  if (*decimals < 0) {
+    *t_int = strtoll(line, NULL, 10);
+  }
+  *rest = e;
+  return 0;
 }
 
-void add_time(char* str, float offset, FILE* fp)
+/** Read the next timed line, returns -1 at the end */
+static int log_next(struct log *l)
 {
-	float time = 0.0f;
-	char* c = strchr(str, ' ');
-	if (c == 0)
-		return;
+  int64_t t_int;
+  int decimals;
+  while ((l->line_len = getline(&l->line, &l->line_cap, l->f)) > 0) {
+    if (parse_time(l->line, &l->time, &t_int, &decimals, &l->rest) == 0) {
+      l->time = decimals < 0 ? (double)(t_int + l->offset_int) : l->time + l->offset;
+      return 0;
+    }
+  }
+  return -1;
+}
 
-	sscanf(str,"%f", &time);
-	fprintf(fp, "%.3f%s", time+offset, c);
+/** Write the current line with the shifted time, terminated by a newline
+ * even if it is the unterminated last line of a cut log */
+static void log_write(struct log *l, FILE *out)
+{
+  if (l->offset == 0.) {
+    fwrite(l->line, 1, l->line_len, out);
+  } else {
+    double t;
+    int64_t t_int;
+    int decimals;
+    const char *rest;
+    parse_time(l->line, &t, &t_int, &decimals, &rest);
+    if (decimals < 0) {
+      fprintf(out, "%lld", (long long)(t_int + l->offset_int));
+    } else {
+      fprintf(out, "%.*f", decimals, t + l->offset);
+    }
+    fwrite(rest, 1, l->line_len - (rest - l->line), out);
+  }
+  if (l->line[l->line_len - 1] != '\n') {
+    fputc('\n', out);
+  }
 }
 
-int merge(char* fn1, char* fn2)
+/*
+ * Clock offset estimation
+ */
+
+struct stamp {
+  uint64_t hash;            ///< sender, name and values
+  double time;
+};
+
+static uint64_t hash_text(const char *s, size_t len)
 {
-	FILE* f1 = fopen(fn1,"r+w");
-	FILE* f2 = fopen(fn2,"r");
-	int res = 0;
-	char str[200];
-	float offset = 0.0f;
-	int firstline = 1;
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0; i < len; i++) {
+    h = (h ^ (uint8_t)s[i]) * 1099511628211ULL;
+  }
+  return h;
+}
 
-	if ((f1 > 0) && (f2 > 0))
-	{
-		//
-		printf("Searching End Time in File '%s'\n",fn1);
+static int cmp_stamp(const void *a, const void *b)
+{
+  const struct stamp *x = a, *y = b;
+  return x->hash < y->hash ? -1 : x->hash > y->hash;
+}
 
-		while(fgets(str,sizeof(str),f1) != NULL)
-		{
-		}
+static int cmp_double(const void *a, const void *b)
+{
+  double x = *(const double *)a, y = *(const double *)b;
+  return x < y ? -1 : x > y;
+}
 
-		printf("Last Line:\n%s\n",str);
-		offset = get_time(str);
-		printf("Last Time Stamp: %f\n", offset);
+/** Is the message name in the comma separated list */
+static int msg_selected(const char *msgs, const char *rest)
+{
+  if (msgs == NULL) {
+    return 1;
+  }
+  const char *name = rest;
+  while (*name == ' ' || *name == '\t') { name++; }
+  name += strcspn(name, " \t");                   // sender
+  while (*name == ' ' || *name == '\t') { name++; }
+  size_t n = strcspn(name, " \t\r\n");
+  for (const char *p = msgs; *p != '\0';) {
+    size_t m = strcspn(p, ",");
+    if (m == n && strncmp(p, name, n) == 0) {
+      return 1;
+    }
+    p += m + (p[m] == ',');
+  }
+  return 0;
+}
 
-		while(fgets(str,sizeof(str),f2) != NULL)
-		{
-			// Find initial time
-			//if (firstline)
-			//{
-			//	firstline = 0;
-			//	offset -= get_time(str);
-			//}
+/**
+ * Messages of the first window seconds of a log, sorted by hash, the
+ * messages sent several times with the same values are removed.
+ */
+static size_t read_stamps(const char *file, double window, const char *msgs, struct stamp **stamps)
+{
+  FILE *f = fopen(file, "r");
+  size_t nb = 0, cap = 0;
+  *stamps = NULL;
+  if (f == NULL) {
+    return 0;
+  }
+  char *line = NULL;
+  size_t line_cap = 0;
+  ssize_t len;
+  double t0 = NAN;
+  while ((len = getline(&line, &line_cap, f)) > 0) {
+    double t;
+    int64_t t_int;
+    int decimals;
+    const char *rest;
+    if (parse_time(line, &t, &t_int, &decimals, &rest) < 0) {
+      continue;
+    }
+    if (isnan(t0)) {
+      t0 = t;
+    }
+    if (t - t0 > window) {
+      break;
+    }
+    if (!msg_selected(msgs, rest)) {
+      continue;
+    }
+    if (nb == cap) {
+      cap = cap ? 2 * cap : 4096;
+      *stamps = realloc(*stamps, cap * sizeof(struct stamp));
+    }
+    size_t n = len - (rest - line);
+    while (n > 0 && (rest[n - 1] == '\n' || rest[n - 1] == '\r' || rest[n - 1] == ' ')) {
+      n--;
+    }
+    (*stamps)[nb].hash = hash_text(rest, n);
+    (*stamps)[nb].time = t;
+    nb++;
+  }
+  free(line);
+  fclose(f);
 
-			// Change Time and add to first file:
-			add_time(str, offset, f1);
-		}
+  // keep the unique messages only
+  qsort(*stamps, nb, sizeof(struct stamp), cmp_stamp);
+  size_t out = 0;
+  for (size_t i = 0; i < nb;) {
+    size_t j = i + 1;
+    while (j < nb && (*stamps)[j].hash == (*stamps)[i].hash) {
+      j++;
+    }
+    if (j == i + 1) {
+      (*stamps)[out++] = (*stamps)[i];
+    }
+    i = j;
+  }
+  return out;
+}
 
-	}
-	else
-	{
-		fprintf(stderr,"Failed to open file\n");
-		res = -1;
-	}
+/**
+ * Offset to add to the times of a log to align them with the reference.
+ * @return number of shared messages used
+ */
+static size_t estimate_offset(const struct stamp *ref, size_t nb_ref, const struct stamp *other, size_t nb_other,
+                              double *offset)
+{
+  size_t cap = nb_ref < nb_other ? nb_ref : nb_other;
+  double *diff = malloc((cap + 1) * sizeof(double));
+  size_t n = 0;
+  for (size_t i = 0, j = 0; i < nb_ref && j < nb_other;) {
+    if (ref[i].hash < other[j].hash) {
+      i++;
+    } else if (ref[i].hash > other[j].hash) {
+      j++;
+    } else {
+      diff[n++] = ref[i].time - other[j].time;
+      i++;
+      j++;
+    }
+  }
+  if (n > 0) {
+    qsort(diff, n, sizeof(double), cmp_double);
+    *offset = n % 2 ? diff[n / 2] : 0.5 * (diff[n / 2 - 1] + diff[n / 2]);
+  }
+  free(diff);
+  return n;
+}
+
+/*
+ * k-way merge
+ */
+
+/** Is log a before log b, same times in the order of the logs */
+static int before(const struct log *logs, int a, int b)
+{
+  return logs[a].time < logs[b].time || (logs[a].time == logs[b].time && a < b);
+}
 
-	if (f1 > 0)
-		fclose(f1);
-	if (f2 > 0)
-		fclose(f2);
+static void heap_down(const struct log *logs, int *heap, int n, int i)
+{
+  for (;;) {
+    int m = i, l = 2 * i + 1, r = 2 * i + 2;
+    if (l < n && before(logs, heap[l], heap[m])) { m = l; }
+    if (r < n && before(logs, heap[r], heap[m])) { m = r; }
+    if (m == i) {
+      return;
+    }
+    int tmp = heap[i];
+    heap[i] = heap[m];
+    heap[m] = tmp;
+    i = m;
+  }
+}
 
-	return -1;
+static int merge(struct log *logs, int nb_logs, FILE *out)
+{
+  int *heap = malloc(nb_logs * sizeof(int));
+  int n = 0;
+  for (int i = 0; i < nb_logs; i++) {
+    if (log_next(&logs[i]) == 0) {
+      heap[n++] = i;
+    }
+  }
+  for (int i = n / 2 - 1; i >= 0; i--) {
+    heap_down(logs, heap, n, i);
+  }
+  uint64_t nb_lines = 0;
+  while (n > 0) {
+    struct log *l = &logs[heap[0]];
+    log_write(l, out);
+    nb_lines++;
+    if (log_next(l) < 0) {
+      heap[0] = heap[--n];
+    }
+    heap_down(logs, heap, n, 0);
+  }
+  free(heap);
+  fprintf(stderr, "%llu lines merged\n", (unsigned long long)nb_lines);
+  return 0;
 }
 
+/*
+ * Append mode
+ */
 
+/** Time of the last line, read from the end of the file */
+static int last_time(FILE *f, double *t)
+{
+  char buf[65536];
+  if (fseek(f, 0, SEEK_END) != 0) {
+    return -1;
+  }
+  long size = ftell(f);
+  long start = size > (long)sizeof(buf) - 1 ? size - (long)sizeof(buf) + 1 : 0;
+  fseek(f, start, SEEK_SET);
+  size_t n = fread(buf, 1, size - start, f);
+  buf[n] = '\0';
+  // last non empty line
+  while (n > 0 && (buf[n - 1] == '\n' || buf[n - 1] == '\r')) {
+    buf[--n] = '\0';
+  }
+  char *line = strrchr(buf, '\n');
+  line = line != NULL ? line + 1 : buf;
+  int64_t t_int;
+  int decimals;
+  const char *rest;
+  return parse_time(line, t, &t_int, &decimals, &rest);
+}
+
+static int append(const char *file1, const char *file2)
+{
+  FILE *f1 = fopen(file1, "r+");
+  struct log l;
+  memset(&l, 0, sizeof(struct log));
+  l.name = file2;
+  l.f = fopen(file2, "r");
+  if (f1 == NULL || l.f == NULL) {
+    fprintf(stderr, "Failed to open file\n");
+    if (f1 != NULL) { fclose(f1); }
+    if (l.f != NULL) { fclose(l.f); }
+    return -1;
+  }
+  if (last_time(f1, &l.offset) < 0) {
+    fprintf(stderr, "No time found at the end of '%s'\n", file1);
+    l.offset = 0.;
+  }
+  l.offset_int = llround(l.offset);
+  printf("Last Time Stamp: %f\n", l.offset);
+  // a log cut by a power loss may end without a newline
+  if (fseek(f1, -1, SEEK_END) == 0 && fgetc(f1) != '\n') {
+    fseek(f1, 0, SEEK_END);
+    fputc('\n', f1);
+  }
+  fseek(f1, 0, SEEK_END);
+  while (log_next(&l) == 0) {
+    log_write(&l, f1);
+  }
+  free(l.line);
+  fclose(l.f);
+  fclose(f1);
+  return 0;
+}
 
+static void usage(const char *name)
+{
+  fprintf(stderr, "usage: %s [-o merged.data] [-w window] [-m MSG,...] [-n] log1.data log2.data ...\n"
+          "  -o: output file (default: standard output)\n"
+          "  -w: duration in seconds of the start of the logs used to estimate the clock offsets (default 600)\n"
+          "  -m: messages used to estimate the clock offsets (default: all)\n"
+          "  -n: no clock offset estimation\n"
+          "       %s -a log1.data log2.data\n"
+          "  -a: append log2 to log1, shifted by the last time of log1\n", name, name);
+}
 
-int main(int argc, char** argv)
+int main(int argc, char **argv)
 {
-	if (argc < 3)
-	{
-		fprintf(stderr, "Program needs 2 logfile names to merge\n");
-		return -1;
-	}
+  const char *output = NULL;
+  const char *msgs = NULL;
+  double window = 600.;
+  int estimate = 1, append_mode = 0;
+  int opt;
+  while ((opt = getopt(argc, argv, "o:w:m:nah")) != -1) {
+    switch (opt) {
+      case 'o': output = optarg; break;
+      case 'w': window = atof(optarg); break;
+      case 'm': msgs = optarg; break;
+      case 'n': estimate = 0; break;
+      case 'a': append_mode = 1; break;
+      default:
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  int nb_logs = argc - optind;
+  if (nb_logs < 2 || (append_mode && nb_logs != 2)) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (append_mode) {
+    printf("Merging '%s' and '%s'\n", argv[optind], argv[optind + 1]);
+    return append(argv[optind], argv[optind + 1]);
+  }
+
+  struct log *logs = calloc(nb_logs, sizeof(struct log));
+  for (int i = 0; i < nb_logs; i++) {
+    logs[i].name = argv[optind + i];
+    logs[i].f = fopen(logs[i].name, "r");
+    if (logs[i].f == NULL) {
+      fprintf(stderr, "Failed to open '%s'\n", logs[i].name);
+      return EXIT_FAILURE;
+    }
+    setvbuf(logs[i].f, NULL, _IOFBF, 1 << 18);
+  }
 
-	printf("Merging '%s' and '%s'\n",argv[1], argv[2]);
+  if (estimate) {
+    struct stamp *ref;
+    size_t nb_ref = read_stamps(logs[0].name, window, msgs, &ref);
+    for (int i = 1; i < nb_logs; i++) {
+      struct stamp *other;
+      size_t nb_other = read_stamps(logs[i].name, window, msgs, &other);
+      double offset = 0.;
+      size_t n = estimate_offset(ref, nb_ref, other, nb_other, &offset);
+      if (n >= MIN_MATCHES) {
+        logs[i].offset = offset;
+        fprintf(stderr, "%s: offset %.4f s from %zu shared messages\n", logs[i].name, offset, n);
+      } else {
+        fprintf(stderr, "%s: not enough shared messages with %s (%zu), offset 0\n", logs[i].name, logs[0].name, n);
+      }
+      logs[i].offset_int = llround(logs[i].offset);
+      free(other);
+    }
+    free(ref);
+  }
 
-	return merge(argv[1],argv[2]);
+  FILE *out = stdout;
+  if (output != NULL && (out = fopen(output, "w")) == NULL) {
+    fprintf(stderr, "Failed to open '%s'\n", output);
+    return EXIT_FAILURE;
+  }
+  setvbuf(out, NULL, _IOFBF, 1 << 20);
+  int ret = merge(logs, nb_logs, out);
+  if (out != stdout) {
+    fclose(out);
+  }
+  for (int i = 0; i < nb_logs; i++) {
+    fclose(logs[i].f);
+    free(logs[i].line);
+  }
+  free(logs);
+  return ret;
 }
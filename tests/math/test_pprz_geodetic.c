@@ -32,6 +32,7 @@
 #include "math/pprz_geodetic_int.h"
 #include "math/pprz_geodetic_float.h"
 #include "math/pprz_geodetic_double.h"
+#include "math/pprz_geodetic_batch_double.h"
 
 /*
  * toulouse lat 43.6052765, lon 1.4427764, alt 180.123019274324 -> x 4624497.0 y 116475.0 z 4376563.0
@@ -374,12 +375,18 @@ static void test_lla_of_ecef(void)
   cmp_ok(lla_i.lat, "==", lla_ref_i.lat, "latitude (int) matches reference");
   cmp_ok(lla_i.lon, "==", lla_ref_i.lon, "longitude (int) matches reference");
   cmp_ok(lla_i.alt, "==", lla_ref_i.alt, "altitude (int) matches reference");
+
+  /* fast ECEF -> LLA against the exact closed form */
+  struct LlaCoor_d lla_fast;
+  lla_of_ecef_fast_d(&lla_fast, &ecef_ref);
+  ok(fabs(lla_fast.lat - lla_ref.lat) < 1e-10 && fabs(lla_fast.lon - lla_ref.lon) < 1e-10 &&
+     fabs(lla_fast.alt - lla_ref.alt) < 1e-3, "fast ECEF -> LLA matches reference");
 }
 
 int main()
 {
   note("runing geodetic math tests");
-  plan(13);
+  plan(14);
 
   test_ecef_of_ned_int();
   test_enu_of_ecef_int();
@@ -30,11 +30,13 @@
 #include "tap.h"
 #include "math/pprz_algebra_int.h"
 #include "math/pprz_algebra_float.h"
+#include "math/pprz_matrix_fixed_float.h"
+#include "math/RANSAC.h"
 
 int main()
 {
   note("running algebra math tests");
-  plan(3);
+  plan(6);
 
   /* test int32_vect2_normalize */
   struct Int32Vect2 v = {2300, -4200};
@@ -58,5 +60,39 @@ int main()
      "float_quat_of_eulers_zxy(float_eulers_of_quat_zxy(0.9266,   -0.2317,    0.1165,    0.2722)) returned [%f, %f, %f, %f]", quat_zxy.qi, quat_zxy.qx, quat_zxy.qy, quat_zxy.qz);
 
 
+  /*test float_quat_slerp halfway between identity and 90deg yaw*/
+  struct FloatQuat q0, q1, q_half;
+  struct FloatEulers e90 = {0., 0., M_PI_2};
+  float_quat_identity(&q0);
+  float_quat_of_eulers(&q1, &e90);
+  float_quat_slerp(&q_half, &q0, &q1, 0.5);
+  struct FloatEulers e_half;
+  float_eulers_of_quat(&e_half, &q_half);
+  ok(fabs(e_half.psi - M_PI_4) < 1e-5 && fabs(e_half.phi) < 1e-5 && fabs(e_half.theta) < 1e-5,
+     "float_quat_slerp(identity, yaw 90deg, 0.5) returned eulers [%f, %f, %f]", e_half.phi, e_half.theta, e_half.psi);
+
+  /*test float_mat4_invert against float_mat4_mul*/
+  float m4[4][4] = {{4., 1., 0., 2.}, {1., 5., 1., 0.}, {0., 2., 6., 1.}, {1., 0., 1., 3.}};
+  float m4_inv[4][4], m4_id[4][4];
+  bool m4_ok = float_mat4_invert(m4_inv, m4);
+  float_mat4_mul(m4_id, m4, m4_inv);
+  float m4_err = 0.;
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      m4_err = Max(m4_err, fabsf(m4_id[i][j] - (i == j ? 1.f : 0.f)));
+    }
+  }
+  ok(m4_ok && m4_err < 1e-5, "float_mat4_mul(m, float_mat4_invert(m)) is identity, max error %g", m4_err);
+
+  /*test RANSAC_linear_model on a line with 30% outliers*/
+  float line_x[50][1], line_y[50], line_params[2], line_err;
+  for (int i = 0; i < 50; i++) {
+    line_x[i][0] = (float)i;
+    line_y[i] = (i % 10 < 3) ? 100.f - (float)i : 2.f * (float)i + 1.f;
+  }
+  RANSAC_linear_model(2, 100, 0.5f, line_y, 1, line_x, 50, line_params, &line_err);
+  ok(fabs(line_params[0] - 2.) < 1e-3 && fabs(line_params[1] - 1.) < 1e-2,
+     "RANSAC_linear_model(y = 2x + 1 with outliers) returned [%f, %f]", line_params[0], line_params[1]);
+
   done_testing();
 }
@@ -75,14 +75,37 @@ static void test_pos_lla_i(void)
   }
 }
 
+static void test_snapshot(void)
+{
+  struct StateSnapshot snap;
+  ok(!stateSnapshotGet(&snap), "stateSnapshotGet() returns false before first publication");
+
+  struct FloatEulers eulers = {0.1, -0.2, 0.3};
+  stateSetNedToBodyEulers_f(&eulers);
+  struct FloatRates rates = {0.01, 0.02, 0.03};
+  stateSetBodyRates_f(&rates);
+
+  for (uint32_t i = 1; i <= 3; i++) {
+    stateSnapshotPublish(i * 1000);
+  }
+  bool ret = stateSnapshotGet(&snap);
+  ok(ret && snap.timestamp == 3000, "stateSnapshotGet() returns latest snapshot, timestamp %u", snap.timestamp);
+  ok(bit_is_set(snap.status, STATE_SNAPSHOT_ATT) && bit_is_set(snap.status, STATE_SNAPSHOT_RATES) &&
+     fabsf(snap.ned_to_body_eulers.psi - 0.3) < 1e-5 && fabsf(snap.ned_to_body_quat.qi - stateGetNedToBodyQuat_f()->qi) < 1e-6 &&
+     fabsf(snap.body_rates.r - 0.03) < 1e-6,
+     "snapshot holds attitude and rates");
+}
+
 int main()
 {
   note("\n *** running state interface tests ***");
-  plan(1);
+  plan(4);
 
   stateInit();
 
   test_pos_lla_i();
 
+  test_snapshot();
+
   done_testing();
 }